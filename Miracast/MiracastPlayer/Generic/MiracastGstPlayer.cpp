@@ -20,10 +20,13 @@
 #include <gst/audio/audio.h>
 #include <gst/app/gstappsink.h>
 #include <gst/app/gstappsrc.h>
+#include <glib-unix.h>
 #include <unistd.h>
 #include <cstdio>
 #include <cstring>
+#include <algorithm>
 #include <ctime>
+#include <sstream>
 #include <sys/types.h>
 #include <sys/syscall.h>
 #include "MiracastLogger.h"
@@ -31,8 +34,197 @@
 #include "MiracastGstPlayer.h"
 #include <SoC_MiracastPlayer.h>
 
+/* About half a second of 7 packet TS chunks at 10 Mbit/s before the oldest is dropped */
+#define MIRACAST_GSTPLAYER_BUFFER_RING_SIZE   ( 512 )
+
+#define MIRACAST_GSTPLAYER_JITTER_SAMPLE_INTERVAL_MS   ( 1000 )
+#define MIRACAST_GSTPLAYER_STATISTICS_INTERVAL_MS   ( 1000 )
+/* Loss free samples in a row before the jitterbuffer latency is lowered */
+#define MIRACAST_GSTPLAYER_JITTER_CLEAN_SAMPLES   ( 5 )
+#define MIRACAST_GSTPLAYER_JITTER_SHRINK_STEP_MS   ( 10 )
+#define MIRACAST_GSTPLAYER_JITTER_MIN_GROW_STEP_MS   ( 20 )
+/* The latency is never lowered below this many times the average jitter */
+#define MIRACAST_GSTPLAYER_JITTER_HEADROOM_FACTOR   ( 4 )
+
+/* Program layout the Wi-Fi Display spec assigns to every source */
+#define MIRACAST_GSTPLAYER_WFD_PROGRAM_NUMBER   ( 0x0001 )
+#define MIRACAST_GSTPLAYER_WFD_PMT_PID   ( 0x0100 )
+#define MIRACAST_GSTPLAYER_WFD_PCR_PID   ( 0x1000 )
+#define MIRACAST_GSTPLAYER_WFD_VIDEO_PID   ( 0x1011 )
+#define MIRACAST_GSTPLAYER_WFD_AUDIO_PID   ( 0x1100 )
+/* Sources start their PAT and PMT at version 0, so their first tables always replace the primed ones */
+#define MIRACAST_GSTPLAYER_PRIMED_TABLE_VERSION   ( 0x1F )
+
+/* Seven TS packets per RTP packet */
+#define MIRACAST_GSTPLAYER_RTP_PAYLOAD_SIZE   ( 7 * TS_INSPECTOR_PACKET_SIZE )
+/* Assumed until a level is negotiated, about what sources send for 1080p */
+#define MIRACAST_GSTPLAYER_DFLT_BITRATE_KBPS   ( 20000 )
+/* Held past the jitterbuffer by depayloader, tsparse, the buffer ring and the decoder input */
+#define MIRACAST_GSTPLAYER_RTP_POOL_MARGIN_MS   ( 200 )
+/* A caps change at the video sink later than this after a mid-session M4 is not put down to it */
+#define MIRACAST_GSTPLAYER_FORMAT_SWITCH_TIMEOUT_MS   ( 5000 )
+/* Weight of the previous average in the smoothed element latency */
+#define MIRACAST_GSTPLAYER_TRACE_AVG_WEIGHT   ( 16 )
+
+/* MaxBR of the High profile for the WFD level bits, CBP streams stay below it */
+static uint32_t h264_level_max_bitrate_kbps(uint8_t h264_level)
+{
+    switch (h264_level)
+    {
+        case RTSP_H264_LEVEL_3p1_BITMAP:
+            return 17500;
+        case RTSP_H264_LEVEL_3p2_BITMAP:
+        case RTSP_H264_LEVEL_4_BITMAP:
+            return 25000;
+        case RTSP_H264_LEVEL_4p1_BITMAP:
+        case RTSP_H264_LEVEL_4p2_BITMAP:
+            return 62500;
+        default:
+            return MIRACAST_GSTPLAYER_DFLT_BITRATE_KBPS;
+    }
+}
+
+static const char *video_sink_names[MIRACAST_GSTPLAYER_VIDEO_SINK_MAX] = { "westerossink", "fakesink", "appsink" };
+
+/* "<sink> [sync|nosync] [software]" as found in /opt/miracast_video_sink, fields not given keep their value */
+static bool parse_video_sink_flag(const std::string &flag, MIRACAST_GSTPLAYER_SINK_CONFIG_STRUCT &sink_config)
+{
+    std::istringstream words(flag);
+    std::string word;
+    bool sink_found = false;
+
+    if (!(words >> word))
+    {
+        return false;
+    }
+    for (int sink = MIRACAST_GSTPLAYER_VIDEO_SINK_WESTEROS; sink < MIRACAST_GSTPLAYER_VIDEO_SINK_MAX; ++sink)
+    {
+        if (word == video_sink_names[sink])
+        {
+            sink_config.video_sink = static_cast<eMIRA_GSTPLAYER_VIDEO_SINK>(sink);
+            sink_found = true;
+            break;
+        }
+    }
+    while (words >> word)
+    {
+        if ("sync" == word)
+        {
+            sink_config.sync = true;
+        }
+        else if ("nosync" == word)
+        {
+            sink_config.sync = false;
+        }
+        else if ("software" == word)
+        {
+            sink_config.software_decode = true;
+        }
+    }
+    return sink_found;
+}
+
+static uint32_t mpegts_crc32(const guint8 *data, size_t length)
+{
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (size_t index = 0; index < length; ++index)
+    {
+        crc ^= static_cast<uint32_t>(data[index]) << 24;
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc & 0x80000000) ? ((crc << 1) ^ 0x04C11DB7) : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+/* One TS packet carrying a whole PSI section, section_length and CRC are filled in here */
+static void build_psi_packet(guint8 *packet, uint16_t pid, guint8 *section, size_t length)
+{
+    uint32_t crc = 0;
+
+    section[1] = static_cast<guint8>(0xB0 | (((length + 1) >> 8) & 0x0F));
+    section[2] = static_cast<guint8>((length + 1) & 0xFF);
+    crc = mpegts_crc32(section, length);
+
+    memset(packet, 0xFF, TS_INSPECTOR_PACKET_SIZE);
+    packet[0] = TS_INSPECTOR_SYNC_BYTE;
+    packet[1] = static_cast<guint8>(0x40 | ((pid >> 8) & 0x1F));
+    packet[2] = static_cast<guint8>(pid & 0xFF);
+    packet[3] = 0x10;
+    packet[4] = 0x00;
+    memcpy(packet + 5, section, length);
+    packet[5 + length] = static_cast<guint8>(crc >> 24);
+    packet[6 + length] = static_cast<guint8>(crc >> 16);
+    packet[7 + length] = static_cast<guint8>(crc >> 8);
+    packet[8 + length] = static_cast<guint8>(crc);
+}
+
+/* tsdemux names its pads <kind>_<program generation>_<pid>, a PMT it cannot apply to the running program starts a new generation */
+/* The buffer of a probe, the first one for a list, and how many there are */
+static GstBuffer *probe_info_buffer(GstPadProbeInfo *info, guint &count)
+{
+    if (0 != (GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_BUFFER_LIST))
+    {
+        GstBufferList *list = GST_PAD_PROBE_INFO_BUFFER_LIST(info);
+
+        count = gst_buffer_list_length(list);
+        return (0 < count) ? gst_buffer_list_get(list, 0) : nullptr;
+    }
+    count = 1;
+    return GST_PAD_PROBE_INFO_BUFFER(info);
+}
+
+/* current-level-bytes is a guint of queue and a guint64 of appsrc */
+static uint64_t element_level_bytes(GstElement *element)
+{
+    GParamSpec *pspec = (element) ? g_object_class_find_property(G_OBJECT_GET_CLASS(element), "current-level-bytes") : nullptr;
+    GValue value = G_VALUE_INIT,
+           level = G_VALUE_INIT;
+    uint64_t level_bytes = 0;
+
+    if (nullptr == pspec)
+    {
+        return 0;
+    }
+    g_value_init(&value, G_PARAM_SPEC_VALUE_TYPE(pspec));
+    g_value_init(&level, G_TYPE_UINT64);
+    g_object_get_property(G_OBJECT(element), "current-level-bytes", &value);
+    if (g_value_transform(&value, &level))
+    {
+        level_bytes = g_value_get_uint64(&level);
+    }
+    g_value_unset(&level);
+    g_value_unset(&value);
+    return level_bytes;
+}
+
+static bool same_program_generation(GstPad *pad, GstPad *other_pad)
+{
+    gchar *name = gst_pad_get_name(pad),
+          *other_name = gst_pad_get_name(other_pad);
+    const gchar *pid = strrchr(name, '_'),
+                *other_pid = strrchr(other_name, '_');
+    bool same = (nullptr != pid) && (nullptr != other_pid) &&
+                ((pid - name) == (other_pid - other_name)) &&
+                (0 == strncmp(name, other_name, pid - name));
+
+    g_free(name);
+    g_free(other_name);
+    return same;
+}
+
 MiracastGstPlayer *MiracastGstPlayer::m_GstPlayer{nullptr};
 
+const MIRACAST_GSTPLAYER_LATENCY_PROFILE_STRUCT MiracastGstPlayer::m_latency_profiles[MIRACAST_GSTPLAYER_LATENCY_PROFILE_MAX] =
+{
+    /* name, jitterbuffer latency/min/max/mode/drop-on-latency, udpsrc buffer-size, appsrc max-bytes/min-latency, sink sync/max-lateness */
+    { "gaming", 40, 20, 120, 0, TRUE, 1 * 1024 * 1024, 2 * 1024 * 1024, 0, FALSE, G_MININT64 },
+    { "default", 200, 100, 400, 1, FALSE, 0, 20 * 1024 * 1024, -1, TRUE, G_MININT64 },
+    { "robust", 500, 300, 1000, 1, FALSE, 4 * 1024 * 1024, 32 * 1024 * 1024, -1, TRUE, -1 }
+};
+
 MiracastGstPlayer *MiracastGstPlayer::getInstance()
 {
     if (m_GstPlayer == nullptr)
@@ -47,6 +239,7 @@ void MiracastGstPlayer::destroyInstance()
     MIRACASTLOG_TRACE("Entering...");
     if (m_GstPlayer != nullptr)
     {
+        m_GstPlayer->m_reuse_pipeline = false;
         m_GstPlayer->stop();
         if (m_GstPlayer->stop())
         {
@@ -70,7 +263,6 @@ MiracastGstPlayer::MiracastGstPlayer()
     m_bReady = false;
     m_currentPosition = 0.0f;
     m_buffering_level = 100;
-    m_player_statistics_tid = 0;
     SoC_ConfigureVideoDecodeErrorPolicy();
     MIRACASTLOG_TRACE("Exiting...");
 }
@@ -111,7 +303,8 @@ bool MiracastGstPlayer::updateVideoSinkRectangle(void)
 
     MIRACASTLOG_TRACE("Entering...");
 
-    if (( nullptr != m_video_sink ) && ( 0 < m_video_rect_st.width ) && ( 0 < m_video_rect_st.height ))
+    if (( nullptr != m_video_sink ) && ( 0 < m_video_rect_st.width ) && ( 0 < m_video_rect_st.height ) &&
+        ( g_object_class_find_property(G_OBJECT_GET_CLASS(m_video_sink), "window-set") ))
     {
         char rectString[64];
         sprintf(rectString,"%d,%d,%d,%d", m_video_rect_st.startX, m_video_rect_st.startY,
@@ -148,14 +341,20 @@ bool MiracastGstPlayer::launch(std::string& localip , std::string& streaming_por
 
 bool MiracastGstPlayer::pause()
 {
-    changePipelineState(m_append_pipeline,GST_STATE_PAUSED);
+    if (m_append_pipeline)
+    {
+        changePipelineState(m_append_pipeline,GST_STATE_PAUSED);
+    }
     changePipelineState(m_playbin_pipeline,GST_STATE_PAUSED);
     return true;
 }
 
 bool MiracastGstPlayer::resume()
 {
-    changePipelineState(m_append_pipeline,GST_STATE_PLAYING);
+    if (m_append_pipeline)
+    {
+        changePipelineState(m_append_pipeline,GST_STATE_PLAYING);
+    }
     changePipelineState(m_playbin_pipeline,GST_STATE_PLAYING);
     return true;
 }
@@ -197,38 +396,563 @@ void *MiracastGstPlayer::playbackThread(void *ctx)
     pthread_exit(nullptr);
 }
 
-void* MiracastGstPlayer::monitor_player_statistics_thread(void *ctx)
+void MiracastGstPlayer::resetStatistics()
 {
-    MiracastGstPlayer *self = (MiracastGstPlayer *)ctx;
-    int elapsed_seconds = 0,
-        stats_timeout = 0;
-    MIRACASTLOG_TRACE("Entering..!!!");
-    self->m_statistics_thread_loop = true;
-    struct timespec start_time, current_time;
-    std::string opt_flag_buffer = "";
+    std::lock_guard<std::mutex> lock(m_statistics_mutex);
+
+    memset(&m_statistics_st, 0x00, sizeof(m_statistics_st));
+    m_ingress_packets = 0;
+    m_ingress_bytes = 0;
+    m_first_packet_us = 0;
+    m_statistics_start_us = MiracastCommon::get_monotonic_time_us();
+    m_statistics_last_us = m_statistics_start_us;
+    m_statistics_last_bytes = 0;
+    m_statistics_samples = 0;
+}
+
+gboolean MiracastGstPlayer::statisticsCollectorTimeout(gpointer userdata)
+{
+    MiracastGstPlayer *self = static_cast<MiracastGstPlayer*>(userdata);
+    self->collectStatistics();
+    return G_SOURCE_CONTINUE;
+}
+
+/* Counts what enters the jitterbuffer, the only per packet work of the collector */
+GstPadProbeReturn MiracastGstPlayer::ingressStatisticsProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userdata)
+{
+    MiracastGstPlayer *self = static_cast<MiracastGstPlayer*>(userdata);
+
+    if (0 == self->m_first_packet_us.load(std::memory_order_relaxed))
+    {
+        uint64_t expected = 0;
+        self->m_first_packet_us.compare_exchange_strong(expected, MiracastCommon::get_monotonic_time_us());
+    }
+    if (GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_BUFFER_LIST)
+    {
+        GstBufferList *buffer_list = GST_PAD_PROBE_INFO_BUFFER_LIST(info);
+
+        self->m_ingress_packets.fetch_add(gst_buffer_list_length(buffer_list), std::memory_order_relaxed);
+        self->m_ingress_bytes.fetch_add(gst_buffer_list_calculate_size(buffer_list), std::memory_order_relaxed);
+    }
+    else
+    {
+        self->m_ingress_packets.fetch_add(1, std::memory_order_relaxed);
+        self->m_ingress_bytes.fetch_add(gst_buffer_get_size(GST_PAD_PROBE_INFO_BUFFER(info)), std::memory_order_relaxed);
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+/* Arrival is taken where the probe sits, after the jitterbuffer. The PCR jitter therefore shows how
+ * well the source PCR follows its RTP timestamps, the network jitter itself is left to the jitterbuffer. */
+GstPadProbeReturn MiracastGstPlayer::tsInspectorProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userdata)
+{
+    MiracastGstPlayer *self = static_cast<MiracastGstPlayer*>(userdata);
+    uint64_t arrival_us = MiracastCommon::get_monotonic_time_us();
+    GstMapInfo map;
 
-    clock_gettime(CLOCK_REALTIME, &start_time);
-    while (true == self->m_statistics_thread_loop)
+    if (GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_BUFFER_LIST)
     {
-        clock_gettime(CLOCK_REALTIME, &current_time);
-        opt_flag_buffer = MiracastCommon::parse_opt_flag("/opt/miracast_player_stats",true,false);
+        GstBufferList *buffer_list = GST_PAD_PROBE_INFO_BUFFER_LIST(info);
+        guint length = gst_buffer_list_length(buffer_list);
 
-        if (!opt_flag_buffer.empty())
+        for (guint index = 0; index < length; ++index)
         {
-            stats_timeout = std::atoi(opt_flag_buffer.c_str());
-            elapsed_seconds = current_time.tv_sec - start_time.tv_sec;
-            if (elapsed_seconds >= stats_timeout)
+            GstBuffer *buffer = gst_buffer_list_get(buffer_list, index);
+
+            if (gst_buffer_map(buffer, &map, GST_MAP_READ))
             {
-                self->get_player_statistics();
-                // Refresh the Statistics time
-                clock_gettime(CLOCK_REALTIME, &start_time);
+                self->m_ts_inspector.inspect(map.data, map.size, arrival_us);
+                gst_buffer_unmap(buffer, &map);
             }
         }
-        usleep(100000);
     }
-    self->m_player_statistics_tid = 0;
-    MIRACASTLOG_TRACE("Exiting..!!!");
-    pthread_exit(nullptr);
+    else
+    {
+        GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+
+        if (gst_buffer_map(buffer, &map, GST_MAP_READ))
+        {
+            self->m_ts_inspector.inspect(map.data, map.size, arrival_us);
+            gst_buffer_unmap(buffer, &map);
+        }
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+void MiracastGstPlayer::setElementTracer(bool enable)
+{
+    MIRACASTLOG_INFO("Element tracer %s", (enable) ? "on" : "off");
+    m_element_tracer = enable;
+}
+
+/*
+ * Runs on a streaming thread of the element for every buffer it takes. An
+ * element holding more than the ring, which only a stalled one does, gives up
+ * its oldest input.
+ */
+GstPadProbeReturn MiracastGstPlayer::elementTracerInProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userdata)
+{
+    MIRACAST_GSTPLAYER_TRACED_ELEMENT_STRUCT *traced = static_cast<std::shared_ptr<MIRACAST_GSTPLAYER_TRACED_ELEMENT_STRUCT>*>(userdata)->get();
+    guint count = 0;
+    GstBuffer *buffer = probe_info_buffer(info, count);
+    uint64_t now_us = MiracastCommon::get_monotonic_time_us();
+
+    if (nullptr == buffer)
+    {
+        return GST_PAD_PROBE_OK;
+    }
+    std::lock_guard<std::mutex> lock(traced->mutex);
+    if (MIRACAST_GSTPLAYER_TRACE_PENDING_SIZE == traced->pending_count)
+    {
+        traced->pending_first = (traced->pending_first + 1) % MIRACAST_GSTPLAYER_TRACE_PENDING_SIZE;
+        traced->pending_count--;
+    }
+    MIRACAST_GSTPLAYER_TRACE_PENDING_STRUCT &pending = traced->pending[(traced->pending_first + traced->pending_count) % MIRACAST_GSTPLAYER_TRACE_PENDING_SIZE];
+    pending.buffer = buffer;
+    pending.pts = GST_BUFFER_PTS(buffer);
+    pending.in_us = now_us;
+    traced->pending_count++;
+    traced->buffers_in += count;
+    if (traced->buffers_in > traced->buffers_out)
+    {
+        traced->in_flight_max = std::max(traced->in_flight_max, static_cast<uint32_t>(traced->buffers_in - traced->buffers_out));
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+/*
+ * Runs for every buffer the element pushes. Queues and the jitterbuffer hand
+ * on the buffer they took, decoders keep its timestamp, either one finds the
+ * input. Everything that came in before it is through or dropped. Demuxers and
+ * parsers that set timestamps of their own are left with the latest input,
+ * the one that made them push.
+ */
+GstPadProbeReturn MiracastGstPlayer::elementTracerOutProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userdata)
+{
+    MIRACAST_GSTPLAYER_TRACED_ELEMENT_STRUCT *traced = static_cast<std::shared_ptr<MIRACAST_GSTPLAYER_TRACED_ELEMENT_STRUCT>*>(userdata)->get();
+    guint count = 0;
+    GstBuffer *buffer = probe_info_buffer(info, count);
+    uint64_t now_us = MiracastCommon::get_monotonic_time_us(),
+             latency_us = 0;
+    bool found = false;
+
+    if (nullptr == buffer)
+    {
+        return GST_PAD_PROBE_OK;
+    }
+    std::lock_guard<std::mutex> lock(traced->mutex);
+    traced->buffers_out += count;
+    // Made up by the element itself, a gap filler or the codec data of a parser
+    if (0 == traced->pending_count)
+    {
+        return GST_PAD_PROBE_OK;
+    }
+    for (unsigned int index = 0; (index < traced->pending_count) && (!found); ++index)
+    {
+        const MIRACAST_GSTPLAYER_TRACE_PENDING_STRUCT &pending = traced->pending[(traced->pending_first + index) % MIRACAST_GSTPLAYER_TRACE_PENDING_SIZE];
+
+        if ((pending.buffer == buffer) || ((GST_CLOCK_TIME_IS_VALID(pending.pts)) && (pending.pts == GST_BUFFER_PTS(buffer))))
+        {
+            latency_us = now_us - pending.in_us;
+            traced->pending_first = (traced->pending_first + index + 1) % MIRACAST_GSTPLAYER_TRACE_PENDING_SIZE;
+            traced->pending_count -= index + 1;
+            found = true;
+        }
+    }
+    if (!found)
+    {
+        unsigned int latest = (traced->pending_first + traced->pending_count - 1) % MIRACAST_GSTPLAYER_TRACE_PENDING_SIZE;
+
+        latency_us = now_us - traced->pending[latest].in_us;
+        traced->pending_first = latest;
+        traced->pending_count = 1;
+    }
+    traced->latency_avg_us = (0 == traced->latency_avg_us) ? latency_us :
+                                ((traced->latency_avg_us * (MIRACAST_GSTPLAYER_TRACE_AVG_WEIGHT - 1)) + latency_us) / MIRACAST_GSTPLAYER_TRACE_AVG_WEIGHT;
+    traced->latency_max_us = std::max(traced->latency_max_us, latency_us);
+    traced->latency_peak_us = std::max(traced->latency_peak_us, latency_us);
+    return GST_PAD_PROBE_OK;
+}
+
+/* Called by GStreamer once a probe is removed and no streaming thread runs it any more */
+void MiracastGstPlayer::releaseTracedElement(gpointer userdata)
+{
+    delete static_cast<std::shared_ptr<MIRACAST_GSTPLAYER_TRACED_ELEMENT_STRUCT>*>(userdata);
+}
+
+void MiracastGstPlayer::addTracerProbe(const std::shared_ptr<MIRACAST_GSTPLAYER_TRACED_ELEMENT_STRUCT> &traced, GstPad *pad, bool input)
+{
+    gulong probe_id = 0;
+
+    for (const std::pair<GstPad*, gulong> &probe : traced->probes)
+    {
+        if (pad == probe.first)
+        {
+            return;
+        }
+    }
+    probe_id = gst_pad_add_probe(pad,
+                                    static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST),
+                                    (input) ? elementTracerInProbe : elementTracerOutProbe,
+                                    new std::shared_ptr<MIRACAST_GSTPLAYER_TRACED_ELEMENT_STRUCT>(traced),
+                                    releaseTracedElement);
+    if (0 != probe_id)
+    {
+        traced->probes.push_back(std::make_pair(GST_PAD(gst_object_ref(pad)), probe_id));
+    }
+}
+
+/* Sources and sinks have nothing to measure, bins are traced through their children */
+void MiracastGstPlayer::traceElement(GstElement *element)
+{
+    std::shared_ptr<MIRACAST_GSTPLAYER_TRACED_ELEMENT_STRUCT> traced;
+    GstIterator *pads = nullptr;
+    GValue item = G_VALUE_INIT;
+
+    if ((GST_IS_BIN(element)) || (0 == element->numsinkpads) || (0 == element->numsrcpads))
+    {
+        return;
+    }
+    for (const std::shared_ptr<MIRACAST_GSTPLAYER_TRACED_ELEMENT_STRUCT> &existing : m_traced_elements)
+    {
+        if (element == existing->element)
+        {
+            traced = existing;
+            break;
+        }
+    }
+    if (nullptr == traced)
+    {
+        if (MIRACAST_PLAYER_MAX_TRACED_ELEMENTS <= m_traced_elements.size())
+        {
+            return;
+        }
+        traced = std::make_shared<MIRACAST_GSTPLAYER_TRACED_ELEMENT_STRUCT>();
+        traced->name = GST_ELEMENT_NAME(element);
+        traced->element = GST_ELEMENT(gst_object_ref(element));
+        traced->pending_first = traced->pending_count = 0;
+        traced->buffers_in = traced->buffers_out = 0;
+        traced->latency_avg_us = traced->latency_max_us = traced->latency_peak_us = 0;
+        traced->in_flight_max = 0;
+        m_traced_elements.push_back(traced);
+
+        pads = gst_element_iterate_sink_pads(element);
+        while (GST_ITERATOR_OK == gst_iterator_next(pads, &item))
+        {
+            addTracerProbe(traced, GST_PAD(g_value_get_object(&item)), true);
+            g_value_reset(&item);
+        }
+        gst_iterator_free(pads);
+    }
+    // Again on every run, tsdemux adds its pads once the program is known
+    pads = gst_element_iterate_src_pads(element);
+    while (GST_ITERATOR_OK == gst_iterator_next(pads, &item))
+    {
+        addTracerProbe(traced, GST_PAD(g_value_get_object(&item)), false);
+        g_value_reset(&item);
+    }
+    g_value_unset(&item);
+    gst_iterator_free(pads);
+}
+
+/* Runs on the main loop with the collector, follows the elements as the decode chains come and go */
+void MiracastGstPlayer::updateElementTracer()
+{
+    GstElement *pipelines[] = { m_append_pipeline, m_playbin_pipeline };
+
+    // A chain replaced by a mid-session format change
+    for (size_t index = 0; index < m_traced_elements.size();)
+    {
+        GstElement *element = m_traced_elements[index]->element;
+
+        if ((nullptr != element) && (nullptr == GST_OBJECT_PARENT(element)))
+        {
+            for (std::pair<GstPad*, gulong> &probe : m_traced_elements[index]->probes)
+            {
+                gst_pad_remove_probe(probe.first, probe.second);
+                gst_object_unref(probe.first);
+            }
+            gst_object_unref(element);
+            m_traced_elements.erase(m_traced_elements.begin() + index);
+        }
+        else
+        {
+            ++index;
+        }
+    }
+
+    for (GstElement *pipeline : pipelines)
+    {
+        GstIterator *elements = nullptr;
+        GValue item = G_VALUE_INIT;
+        bool done = false;
+
+        if (nullptr == pipeline)
+        {
+            continue;
+        }
+        elements = gst_bin_iterate_recurse(GST_BIN(pipeline));
+        while (!done)
+        {
+            switch (gst_iterator_next(elements, &item))
+            {
+                case GST_ITERATOR_OK:
+                    traceElement(GST_ELEMENT(g_value_get_object(&item)));
+                    g_value_reset(&item);
+                    break;
+                case GST_ITERATOR_RESYNC:
+                    // Elements seen before the resync are only looked up again
+                    gst_iterator_resync(elements);
+                    break;
+                default:
+                    done = true;
+                    break;
+            }
+        }
+        g_value_unset(&item);
+        gst_iterator_free(elements);
+    }
+
+    // Through the buffer ring and pushbufferHandler(), the same buffer comes out of appsrc
+    if ((m_appsink) && (m_appsrc) &&
+        (m_traced_elements.end() == std::find_if(m_traced_elements.begin(), m_traced_elements.end(),
+                                    [](const std::shared_ptr<MIRACAST_GSTPLAYER_TRACED_ELEMENT_STRUCT> &traced) { return nullptr == traced->element; })) &&
+        (MIRACAST_PLAYER_MAX_TRACED_ELEMENTS > m_traced_elements.size()))
+    {
+        std::shared_ptr<MIRACAST_GSTPLAYER_TRACED_ELEMENT_STRUCT> hop = std::make_shared<MIRACAST_GSTPLAYER_TRACED_ELEMENT_STRUCT>();
+        GstPad *in_pad = gst_element_get_static_pad(m_appsink, "sink"),
+               *out_pad = gst_element_get_static_pad(m_appsrc, "src");
+
+        hop->name = "appsink>appsrc";
+        hop->element = nullptr;
+        hop->pending_first = hop->pending_count = 0;
+        hop->buffers_in = hop->buffers_out = 0;
+        hop->latency_avg_us = hop->latency_max_us = hop->latency_peak_us = 0;
+        hop->in_flight_max = 0;
+        if ((in_pad) && (out_pad))
+        {
+            addTracerProbe(hop, in_pad, true);
+            addTracerProbe(hop, out_pad, false);
+            m_traced_elements.push_back(hop);
+        }
+        if (in_pad)
+        {
+            gst_object_unref(in_pad);
+        }
+        if (out_pad)
+        {
+            gst_object_unref(out_pad);
+        }
+    }
+}
+
+/* The latency maximum of the collector interval starts over with every call */
+void MiracastGstPlayer::collectElementTrace(MIRACAST_PLAYER_ELEMENT_TRACE_STRUCT &element_trace)
+{
+    element_trace.enabled = m_element_tracer;
+    element_trace.element_count = 0;
+    for (const std::shared_ptr<MIRACAST_GSTPLAYER_TRACED_ELEMENT_STRUCT> &traced : m_traced_elements)
+    {
+        MIRACAST_PLAYER_ELEMENT_LATENCY_STRUCT &element = element_trace.elements[element_trace.element_count++];
+
+        snprintf(element.name, sizeof(element.name), "%s", traced->name.c_str());
+        element.level_bytes = element_level_bytes((traced->element) ? traced->element : m_appsrc);
+        {
+            std::lock_guard<std::mutex> lock(traced->mutex);
+
+            element.buffers_in = traced->buffers_in;
+            element.buffers_out = traced->buffers_out;
+            element.latency_avg_us = traced->latency_avg_us;
+            element.latency_max_us = traced->latency_max_us;
+            element.latency_peak_us = traced->latency_peak_us;
+            element.in_flight = (traced->buffers_in > traced->buffers_out) ? static_cast<uint32_t>(traced->buffers_in - traced->buffers_out) : 0;
+            element.in_flight_max = traced->in_flight_max;
+            traced->latency_max_us = 0;
+        }
+    }
+}
+
+/* Before the pipelines stop or go away, the elements are held until then */
+void MiracastGstPlayer::detachElementTracer()
+{
+    for (const std::shared_ptr<MIRACAST_GSTPLAYER_TRACED_ELEMENT_STRUCT> &traced : m_traced_elements)
+    {
+        for (std::pair<GstPad*, gulong> &probe : traced->probes)
+        {
+            gst_pad_remove_probe(probe.first, probe.second);
+            gst_object_unref(probe.first);
+        }
+        traced->probes.clear();
+        if (traced->element)
+        {
+            gst_object_unref(traced->element);
+            traced->element = nullptr;
+        }
+    }
+    m_traced_elements.clear();
+}
+
+void MiracastGstPlayer::onQosMessage(GstMessage *message)
+{
+    GstFormat format;
+    guint64 processed = 0,
+            dropped = 0;
+    gint64 jitter = 0;
+    gdouble proportion = 0;
+    gint quality = 0;
+
+    gst_message_parse_qos_stats(message, &format, &processed, &dropped);
+    gst_message_parse_qos_values(message, &jitter, &proportion, &quality);
+    MIRACASTLOG_VERBOSE("QoS from [%s]: Format [%s], Processed [%lu], Dropped [%lu], Jitter [%ld], Proportion [%lf], Quality [%d].",
+                        GST_OBJECT_NAME(GST_MESSAGE_SRC(message)),
+                        gst_format_get_name(format),
+                        processed,
+                        dropped,
+                        jitter,
+                        proportion,
+                        quality);
+
+    std::lock_guard<std::mutex> lock(m_statistics_mutex);
+    m_statistics_st.qos_messages++;
+    m_statistics_st.qos_jitter_us = jitter / static_cast<gint64>(GST_USECOND);
+    m_statistics_st.qos_proportion = proportion;
+    // Counted per element, the sink and the decoder both report
+    m_statistics_st.qos_dropped = std::max<uint64_t>(m_statistics_st.qos_dropped, dropped);
+}
+
+/* Runs on the main loop once per MIRACAST_GSTPLAYER_STATISTICS_INTERVAL_MS, reads the element
+ * counters and hands the snapshot to the RTSP handler for getPlayerStatistics and its notification. */
+void MiracastGstPlayer::collectStatistics()
+{
+    MIRACAST_PLAYER_STATISTICS_STRUCT statistics;
+    MIRACAST_GSTPLAYER_LATENCY_STRUCT latency;
+    TS_INSPECTOR_STATS_STRUCT ts_stats{};
+    GstStructure *stats = nullptr;
+    guint64 rendered = 0,
+            dropped = 0,
+            num_lost = 0,
+            num_late = 0,
+            num_duplicates = 0,
+            queue_bytes = 0;
+    uint64_t now_us = MiracastCommon::get_monotonic_time_us(),
+             ingress_bytes = m_ingress_bytes.load(std::memory_order_relaxed);
+
+    if ((m_video_sink) && (g_object_class_find_property(G_OBJECT_GET_CLASS(m_video_sink), "stats")))
+    {
+        g_object_get(G_OBJECT(m_video_sink), "stats", &stats, nullptr);
+        if (stats)
+        {
+            gst_structure_get_uint64(stats, "rendered", &rendered);
+            gst_structure_get_uint64(stats, "dropped", &dropped);
+            gst_structure_free(stats);
+            stats = nullptr;
+        }
+    }
+    if (m_rtpjitterbuffer)
+    {
+        g_object_get(G_OBJECT(m_rtpjitterbuffer), "stats", &stats, nullptr);
+        if (stats)
+        {
+            gst_structure_get_uint64(stats, "num-lost", &num_lost);
+            gst_structure_get_uint64(stats, "num-late", &num_late);
+            gst_structure_get_uint64(stats, "num-duplicates", &num_duplicates);
+            gst_structure_free(stats);
+            stats = nullptr;
+        }
+    }
+    if (m_appsrc)
+    {
+        g_object_get(G_OBJECT(m_appsrc), "current-level-bytes", &queue_bytes, nullptr);
+    }
+    getLatencyStatistics(latency);
+    if (m_ts_inspector_enabled)
+    {
+        m_ts_inspector.get_statistics(ts_stats);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_statistics_mutex);
+        MIRACAST_PLAYER_STATISTICS_STRUCT &current = m_statistics_st;
+
+        current.streaming = true;
+        current.duration_ms = (now_us - m_statistics_start_us) / 1000;
+        current.rendered_frames = rendered;
+        current.dropped_frames = dropped;
+        current.decoder_queue_bytes = queue_bytes;
+        current.rtp_packets = m_ingress_packets.load(std::memory_order_relaxed);
+        current.rtp_lost = num_lost;
+        current.rtp_late = num_late;
+        current.rtp_duplicates = num_duplicates;
+        if (m_rtp_receiver)
+        {
+            RTP_RECEIVER_STATS_STRUCT rtp_stats;
+
+            m_rtp_receiver->get_statistics(rtp_stats);
+            current.rtp_reordered = rtp_stats.reordered;
+            current.kernel_drops = rtp_stats.kernel_drops;
+            current.buffer_pool_size = rtp_stats.pool_size;
+            current.buffer_pool_high_water = rtp_stats.pool_high_water;
+            current.buffer_pool_hits = rtp_stats.pool_hits;
+            current.buffer_pool_misses = rtp_stats.pool_misses;
+            current.buffer_pool_exhausted = rtp_stats.pool_exhausted;
+        }
+        if (now_us > m_statistics_last_us)
+        {
+            current.bitrate_kbps = static_cast<uint32_t>(((ingress_bytes - m_statistics_last_bytes) * 8000) / (now_us - m_statistics_last_us));
+        }
+        current.ingress_to_render_avg_us = (0 < latency.frames) ? (latency.ingress_to_render_sum_us / latency.frames) : 0;
+        {
+            std::lock_guard<std::mutex> jitter_lock(m_jitter_mutex);
+            current.jitterbuffer_latency_ms = m_jitter_st.latency_ms;
+        }
+        current.ts_packets = ts_stats.packets;
+        current.ts_cc_errors = ts_stats.cc_errors;
+        current.ts_sync_losses = ts_stats.sync_losses;
+        current.ts_transport_errors = ts_stats.transport_errors;
+        current.pcr_pid = ts_stats.pcr_pid;
+        current.pcr_jitter_us = ts_stats.pcr_jitter_us;
+        current.pcr_jitter_max_us = ts_stats.pcr_jitter_max_us;
+        current.ts_pid_count = std::min<unsigned int>(ts_stats.pid_count, MIRACAST_PLAYER_STATISTICS_MAX_TS_PIDS);
+        for (unsigned int index = 0; index < current.ts_pid_count; ++index)
+        {
+            current.ts_pids[index].pid = ts_stats.pids[index].pid;
+            current.ts_pids[index].packets = ts_stats.pids[index].packets;
+            current.ts_pids[index].cc_errors = ts_stats.pids[index].cc_errors;
+            current.ts_pids[index].bitrate_kbps = ts_stats.pids[index].bitrate_kbps;
+        }
+        m_statistics_last_us = now_us;
+        m_statistics_last_bytes = ingress_bytes;
+        statistics = current;
+    }
+
+    if (m_rtsp_reference_instance)
+    {
+        m_rtsp_reference_instance->update_PlayerStatistics(statistics);
+    }
+    if ((m_element_tracer) || (!m_traced_elements.empty()))
+    {
+        MIRACAST_PLAYER_ELEMENT_TRACE_STRUCT element_trace;
+
+        if (m_element_tracer)
+        {
+            updateElementTracer();
+        }
+        // Switched off, the numbers so far stay with the RTSP handler
+        collectElementTrace(element_trace);
+        if (!m_element_tracer)
+        {
+            detachElementTracer();
+        }
+        if (m_rtsp_reference_instance)
+        {
+            m_rtsp_reference_instance->update_ElementTrace(element_trace);
+        }
+    }
+    if ((0 < m_statistics_log_interval) && (m_statistics_log_interval <= ++m_statistics_samples))
+    {
+        m_statistics_samples = 0;
+        get_player_statistics();
+    }
 }
 
 double MiracastGstPlayer::getDuration( GstElement *pipeline )
@@ -366,8 +1090,98 @@ bool MiracastGstPlayer::get_player_statistics()
                             dropped_video_frames);
         gst_structure_free( stats );
      }
-    print_pipeline_state(m_append_pipeline);
-    print_pipeline_state(m_playbin_pipeline);
+
+    MIRACAST_GSTPLAYER_LATENCY_STRUCT latency;
+
+    getLatencyStatistics(latency);
+    MIRACASTLOG_INFO("Pipeline Mode: [ %s ], Frames: [ %lu ]",
+                        (MIRACAST_GSTPLAYER_PIPELINE_MODE_SINGLE == m_active_pipeline_mode) ? "single" : "dual",
+                        latency.frames);
+    if (m_customQueueHandle)
+    {
+        MIRACASTLOG_INFO("Appsrc Ring: Dropped Buffers [ %lu ]", m_customQueueHandle->get_dropped_count());
+    }
+    if (m_rtp_receiver)
+    {
+        RTP_RECEIVER_STATS_STRUCT rtp_stats;
+
+        m_rtp_receiver->get_statistics(rtp_stats);
+        MIRACASTLOG_INFO("RTP Receiver: Packets [ %lu ], Syscalls [ %lu ], Max Batch [ %u ], Reordered [ %lu ], Kernel Drops [ %lu ], Truncated [ %lu ], Rcvbuf [ %d ]",
+                            rtp_stats.packets,
+                            rtp_stats.syscalls,
+                            rtp_stats.max_batch,
+                            rtp_stats.reordered,
+                            rtp_stats.kernel_drops,
+                            rtp_stats.truncated,
+                            rtp_stats.rcvbuf_size);
+        MIRACASTLOG_INFO("RTP Buffer Pool: Slots [ %u ], In Use [ %u ], High Water [ %u ], Hits [ %lu ], Misses [ %lu ], Exhausted [ %lu ]",
+                            rtp_stats.pool_size,
+                            rtp_stats.slots_in_use,
+                            rtp_stats.pool_high_water,
+                            rtp_stats.pool_hits,
+                            rtp_stats.pool_misses,
+                            rtp_stats.pool_exhausted);
+    }
+    if (m_ts_inspector_enabled)
+    {
+        MIRACAST_PLAYER_STATISTICS_STRUCT statistics;
+        {
+            std::lock_guard<std::mutex> lock(m_statistics_mutex);
+            statistics = m_statistics_st;
+        }
+        MIRACASTLOG_INFO("TS Inspector: Packets [ %lu ], CC Errors [ %lu ], Sync Losses [ %lu ], Transport Errors [ %lu ], PCR PID [ 0x%04x ] Jitter avg [ %lu ] max [ %lu ] us",
+                            statistics.ts_packets,
+                            statistics.ts_cc_errors,
+                            statistics.ts_sync_losses,
+                            statistics.ts_transport_errors,
+                            statistics.pcr_pid,
+                            statistics.pcr_jitter_us,
+                            statistics.pcr_jitter_max_us);
+        for (unsigned int index = 0; index < statistics.ts_pid_count; ++index)
+        {
+            MIRACASTLOG_INFO("TS PID [ 0x%04x ]: Packets [ %lu ], CC Errors [ %lu ], Bitrate [ %u ] kbps",
+                                statistics.ts_pids[index].pid,
+                                statistics.ts_pids[index].packets,
+                                statistics.ts_pids[index].cc_errors,
+                                statistics.ts_pids[index].bitrate_kbps);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_jitter_mutex);
+        MIRACASTLOG_INFO("Jitterbuffer: Profile [ %s ], Latency [ %u ] ms, Increased [ %lu ], Decreased [ %lu ]",
+                            m_latency_profiles[m_latency_profile].name,
+                            m_jitter_st.latency_ms,
+                            m_jitter_st.increases,
+                            m_jitter_st.decreases);
+    }
+    if (0 < latency.frames)
+    {
+        MIRACASTLOG_INFO("Ingress to Sink: avg [ %.3f ] max [ %.3f ] ms",
+                            (latency.ingress_to_sink_sum_us / static_cast<double>(latency.frames)) / 1000.0,
+                            latency.ingress_to_sink_max_us / 1000.0);
+        MIRACASTLOG_INFO("Ingress to Render: avg [ %.3f ] min [ %.3f ] max [ %.3f ] ms",
+                            (latency.ingress_to_render_sum_us / static_cast<double>(latency.frames)) / 1000.0,
+                            latency.ingress_to_render_min_us / 1000.0,
+                            latency.ingress_to_render_max_us / 1000.0);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_statistics_mutex);
+        MIRACASTLOG_INFO("Time to First Frame: [ %.3f ] ms, First RTP Packet: [ %.3f ] ms",
+                            m_statistics_st.time_to_first_frame_us / 1000.0,
+                            m_statistics_st.time_to_first_packet_us / 1000.0);
+        MIRACASTLOG_INFO("Pipeline Setup: [ %.3f ] ms, Reused: [ %s ]",
+                            m_statistics_st.pipeline_setup_us / 1000.0,
+                            (m_statistics_st.pipeline_reused) ? "yes" : "no");
+        MIRACASTLOG_INFO("Format Switches: [ %lu ], Gap latest [ %.3f ] max [ %.3f ] ms",
+                            m_statistics_st.format_switches,
+                            m_statistics_st.format_switch_gap_us / 1000.0,
+                            m_statistics_st.format_switch_gap_max_us / 1000.0);
+    }
+    if (m_append_pipeline)
+    {
+        print_pipeline_state(m_append_pipeline);
+    }
+    print_pipeline_state(m_playbin_pipeline);
     MIRACASTLOG_INFO("\n=============================================");
     MIRACASTLOG_TRACE("Exiting..!!!");	
     return ret;
@@ -382,13 +1196,315 @@ bool MiracastGstPlayer::get_player_statistics()
  */
 void MiracastGstPlayer::onFirstVideoFrameCallback(GstElement* object, guint arg0, gpointer arg1,gpointer userdata)
 {
-    MIRACASTLOG_TRACE("Entering..!!!");
     MiracastGstPlayer *self = static_cast<MiracastGstPlayer*>(userdata);
 
-    self->m_firstVideoFrameReceived = true;
+    self->onFirstVideoFrame();
+}
+
+/* Rendered frames are counted by the sink itself, only the first one is of interest here */
+void MiracastGstPlayer::fakesinkHandoff(GstElement *sink, GstBuffer *buffer, GstPad *pad, gpointer userdata)
+{
+    g_signal_handlers_disconnect_by_func(sink, reinterpret_cast<gpointer>(fakesinkHandoff), userdata);
+    g_object_set(G_OBJECT(sink), "signal-handoffs", FALSE, nullptr);
+    static_cast<MiracastGstPlayer*>(userdata)->onFirstVideoFrame();
+}
+
+/* Stands in for an application consuming the frames, each one is pulled and released right away */
+GstFlowReturn MiracastGstPlayer::appsinkNewSample(GstElement *sink, gpointer userdata)
+{
+    MiracastGstPlayer *self = static_cast<MiracastGstPlayer*>(userdata);
+    GstSample *sample = gst_app_sink_pull_sample(GST_APP_SINK(sink));
+
+    if (nullptr == sample)
+    {
+        return GST_FLOW_EOS;
+    }
+    gst_sample_unref(sample);
+    if (!self->m_firstVideoFrameReceived)
+    {
+        self->onFirstVideoFrame();
+    }
+    return GST_FLOW_OK;
+}
+
+void MiracastGstPlayer::onFirstVideoFrame()
+{
+    MIRACASTLOG_TRACE("Entering..!!!");
+    uint64_t first_frame_us = MiracastCommon::get_monotonic_time_us(),
+             first_packet_us = m_first_packet_us.load(),
+             play_request_us = (m_rtsp_reference_instance) ? m_rtsp_reference_instance->get_PlayRequestTime() : 0;
+
+    m_firstVideoFrameReceived = true;
     MIRACASTLOG_INFO("!!! First Video Frame has received !!!");
-    self->notifyPlaybackState(MIRACAST_GSTPLAYER_STATE_FIRST_VIDEO_FRAME_RECEIVED);
+    if ((0 < play_request_us) && (play_request_us < first_frame_us))
+    {
+        uint64_t time_to_first_frame_us = first_frame_us - play_request_us,
+                 time_to_first_packet_us = (play_request_us < first_packet_us) ? (first_packet_us - play_request_us) : 0;
+        {
+            std::lock_guard<std::mutex> lock(m_statistics_mutex);
+            m_statistics_st.time_to_first_frame_us = time_to_first_frame_us;
+            m_statistics_st.time_to_first_packet_us = time_to_first_packet_us;
+        }
+        m_rtsp_reference_instance->record_TimeToFirstFrame(time_to_first_frame_us);
+        MIRACASTLOG_INFO("#### MCAST-TRIAGE-OK Time to first frame [%.3f] ms, first RTP packet after [%.3f] ms ####",
+                            time_to_first_frame_us / 1000.0,
+                            time_to_first_packet_us / 1000.0);
+    }
+    notifyPlaybackState(MIRACAST_GSTPLAYER_STATE_FIRST_VIDEO_FRAME_RECEIVED);
+    MIRACASTLOG_TRACE("Exiting..!!!");
+}
+
+bool MiracastGstPlayer::setNegotiatedFormat(const RTSP_WFD_VIDEO_FMT_STRUCT &video_format, const RTSP_WFD_AUDIO_FMT_STRUCT &audio_format)
+{
+    MIRACASTLOG_TRACE("Entering..!!!");
+    {
+        std::lock_guard<std::mutex> lock(m_format_mutex);
+
+        if ((m_format_valid) &&
+            (0 == memcmp(&m_video_format, &video_format, sizeof(m_video_format))) &&
+            (0 == memcmp(&m_audio_format, &audio_format, sizeof(m_audio_format))))
+        {
+            MIRACASTLOG_TRACE("Exiting..!!!");
+            return true;
+        }
+        // The pipeline stays up, tsdemuxPadAdded() moves or replaces the chains once the source sends the new streams
+        if ((m_format_valid) && (0 < m_ingress_packets.load(std::memory_order_relaxed)))
+        {
+            MIRACASTLOG_INFO("Format changed while streaming, video profile[%#04X] level[%#04X] audio[%d]",
+                                video_format.st_h264_codecs.profile,
+                                video_format.st_h264_codecs.level,
+                                audio_format.audio_format);
+            m_format_switch_request_us = MiracastCommon::get_monotonic_time_us();
+        }
+        m_video_format = video_format;
+        m_audio_format = audio_format;
+        m_format_valid = true;
+    }
+    if (nullptr == m_main_loop_context)
+    {
+        MIRACASTLOG_TRACE("Exiting..!!!");
+        return false;
+    }
+    // A pre-warm still pending picks up the new format by itself
+    if ((m_prewarm_source) && (g_source_is_destroyed(m_prewarm_source)))
+    {
+        g_source_unref(m_prewarm_source);
+        m_prewarm_source = nullptr;
+    }
+    if (nullptr == m_prewarm_source)
+    {
+        m_prewarm_source = g_idle_source_new();
+        g_source_set_callback(m_prewarm_source, prewarmDecodeChain, this, nullptr);
+        g_source_attach(m_prewarm_source, m_main_loop_context);
+    }
+    MIRACASTLOG_TRACE("Exiting..!!!");
+    return true;
+}
+
+GstCaps *MiracastGstPlayer::createNegotiatedVideoCaps(const RTSP_WFD_VIDEO_FMT_STRUCT &video_format)
+{
+    if (0 == video_format.st_h264_codecs.profile)
+    {
+        return nullptr;
+    }
+    return gst_caps_new_simple("video/x-h264",
+                                "stream-format", G_TYPE_STRING, "byte-stream",
+                                nullptr);
+}
+
+GstCaps *MiracastGstPlayer::createNegotiatedAudioCaps(const RTSP_WFD_AUDIO_FMT_STRUCT &audio_format)
+{
+    switch (audio_format.audio_format)
+    {
+        case RTSP_LPCM_AUDIO_FORMAT:
+            return gst_caps_new_empty_simple("audio/x-private-ts-lpcm");
+        case RTSP_AAC_AUDIO_FORMAT:
+            return gst_caps_new_simple("audio/mpeg",
+                                        "mpegversion", G_TYPE_INT, 4,
+                                        "stream-format", G_TYPE_STRING, "adts",
+                                        nullptr);
+        case RTSP_AC3_AUDIO_FORMAT:
+            return gst_caps_new_empty_simple("audio/x-ac3");
+        default:
+            break;
+    }
+    return nullptr;
+}
+
+/* The best ranked factory of the type whose sink pad takes the caps, nullptr if there is none */
+GstElementFactory *MiracastGstPlayer::findElementFactory(GstCaps *caps, GstElementFactoryListType type, bool software_only)
+{
+    GList *factories = gst_element_factory_list_get_elements(type, GST_RANK_MARGINAL);
+    GList *matches = gst_element_factory_list_filter(factories, caps, GST_PAD_SINK, FALSE);
+    GstElementFactory *factory = nullptr;
+
+    matches = g_list_sort(matches, gst_plugin_feature_rank_compare_func);
+    for (GList *item = matches; (nullptr != item) && (nullptr == factory); item = item->next)
+    {
+        const gchar *klass = gst_element_factory_get_metadata(GST_ELEMENT_FACTORY(item->data), GST_ELEMENT_METADATA_KLASS);
+
+        if ((!software_only) || (nullptr == klass) || (nullptr == strstr(klass, "Hardware")))
+        {
+            factory = GST_ELEMENT_FACTORY(gst_object_ref(item->data));
+        }
+    }
+    gst_plugin_feature_list_free(matches);
+    gst_plugin_feature_list_free(factories);
+    return factory;
+}
+
+/* Loads the plugins of the best ranked parser and decoder for the caps, so that the decode chain only has to instantiate them */
+void MiracastGstPlayer::loadDecoderPlugins(GstCaps *caps)
+{
+    const GstElementFactoryListType types[] = { GST_ELEMENT_FACTORY_TYPE_PARSER, GST_ELEMENT_FACTORY_TYPE_DECODER };
+
+    for (GstElementFactoryListType type : types)
+    {
+        GstElementFactory *factory = findElementFactory(caps, type, m_active_sink_config.software_decode);
+        GstPluginFeature *feature = nullptr;
+
+        if (nullptr == factory)
+        {
+            continue;
+        }
+        feature = gst_plugin_feature_load(GST_PLUGIN_FEATURE(factory));
+        if (feature)
+        {
+            MIRACASTLOG_INFO("Pre-loaded %s [%s]", (GST_ELEMENT_FACTORY_TYPE_PARSER == type) ? "parser" : "decoder", GST_OBJECT_NAME(feature));
+            gst_object_unref(feature);
+        }
+        gst_object_unref(factory);
+    }
+}
+
+/*
+ * Pushes a PAT and a PMT for the negotiated streams into the playback appsrc.
+ * tsdemux then exposes its pads and the decode chains are built during M5-M7
+ * instead of after the first packet. tsdemux skips a table version it has
+ * already seen, so the primed tables carry a version the source does not start
+ * with: its own PAT and PMT are applied as an update, on whatever PIDs it uses,
+ * without a flush of the decode chains and sinks.
+ */
+bool MiracastGstPlayer::primeProgram(const RTSP_WFD_VIDEO_FMT_STRUCT &video_format, const RTSP_WFD_AUDIO_FMT_STRUCT &audio_format)
+{
+    guint8 packets[2 * TS_INSPECTOR_PACKET_SIZE];
+    guint8 section[TS_INSPECTOR_PACKET_SIZE];
+    size_t length = 0;
+    GstBuffer *buffer = nullptr;
+
+    if ((MIRACAST_GSTPLAYER_PIPELINE_MODE_DUAL != m_active_pipeline_mode) || (nullptr == m_appsrc))
+    {
+        return false;
+    }
+    if (0 < m_ingress_packets.load(std::memory_order_relaxed))
+    {
+        MIRACASTLOG_INFO("Stream already running, tsdemux takes the tables of the source");
+        return false;
+    }
+
+    const guint8 pat[] = { 0x00, 0x00, 0x00,
+                           0x00, 0x01, (0xC1 | (MIRACAST_GSTPLAYER_PRIMED_TABLE_VERSION << 1)), 0x00, 0x00,
+                           (MIRACAST_GSTPLAYER_WFD_PROGRAM_NUMBER >> 8), (MIRACAST_GSTPLAYER_WFD_PROGRAM_NUMBER & 0xFF),
+                           (0xE0 | (MIRACAST_GSTPLAYER_WFD_PMT_PID >> 8)), (MIRACAST_GSTPLAYER_WFD_PMT_PID & 0xFF) };
+    memcpy(section, pat, sizeof(pat));
+    build_psi_packet(packets, 0x0000, section, sizeof(pat));
+
+    const guint8 pmt[] = { 0x02, 0x00, 0x00,
+                           (MIRACAST_GSTPLAYER_WFD_PROGRAM_NUMBER >> 8), (MIRACAST_GSTPLAYER_WFD_PROGRAM_NUMBER & 0xFF), (0xC1 | (MIRACAST_GSTPLAYER_PRIMED_TABLE_VERSION << 1)), 0x00, 0x00,
+                           (0xE0 | (MIRACAST_GSTPLAYER_WFD_PCR_PID >> 8)), (MIRACAST_GSTPLAYER_WFD_PCR_PID & 0xFF) };
+    memcpy(section, pmt, sizeof(pmt));
+    length = sizeof(pmt);
+    if (RTSP_LPCM_AUDIO_FORMAT == audio_format.audio_format)
+    {
+        // WFD LPCM is the HDMV flavour, only the registration descriptor tells tsdemux so
+        const guint8 program_info[] = { 0xF0, 0x06, 0x05, 0x04, 'H', 'D', 'M', 'V' };
+        memcpy(section + length, program_info, sizeof(program_info));
+        length += sizeof(program_info);
+    }
+    else
+    {
+        section[length++] = 0xF0;
+        section[length++] = 0x00;
+    }
+    if (0 != video_format.st_h264_codecs.profile)
+    {
+        const guint8 video_stream[] = { 0x1B, (0xE0 | (MIRACAST_GSTPLAYER_WFD_VIDEO_PID >> 8)), (MIRACAST_GSTPLAYER_WFD_VIDEO_PID & 0xFF), 0xF0, 0x00 };
+        memcpy(section + length, video_stream, sizeof(video_stream));
+        length += sizeof(video_stream);
+    }
+    if ((RTSP_LPCM_AUDIO_FORMAT == audio_format.audio_format) ||
+        (RTSP_AAC_AUDIO_FORMAT == audio_format.audio_format) ||
+        (RTSP_AC3_AUDIO_FORMAT == audio_format.audio_format))
+    {
+        const guint8 stream_types[] = { 0x00, 0x83, 0x0F, 0x81 };
+        const guint8 audio_stream[] = { stream_types[audio_format.audio_format], (0xE0 | (MIRACAST_GSTPLAYER_WFD_AUDIO_PID >> 8)), (MIRACAST_GSTPLAYER_WFD_AUDIO_PID & 0xFF), 0xF0, 0x00 };
+        memcpy(section + length, audio_stream, sizeof(audio_stream));
+        length += sizeof(audio_stream);
+    }
+    build_psi_packet(packets + TS_INSPECTOR_PACKET_SIZE, MIRACAST_GSTPLAYER_WFD_PMT_PID, section, length);
+
+    buffer = gst_buffer_new_allocate(nullptr, sizeof(packets), nullptr);
+    gst_buffer_fill(buffer, 0, packets, sizeof(packets));
+    if (GST_FLOW_OK != gst_app_src_push_buffer(GST_APP_SRC(m_appsrc), buffer))
+    {
+        MIRACASTLOG_ERROR("Unable to push the program tables to appsrc");
+        return false;
+    }
+    return true;
+}
+
+/* Runs on the main loop once a format is known, normally well before the M7 PLAY */
+gboolean MiracastGstPlayer::prewarmDecodeChain(gpointer userdata)
+{
+    MiracastGstPlayer *self = static_cast<MiracastGstPlayer*>(userdata);
+    RTSP_WFD_VIDEO_FMT_STRUCT video_format;
+    RTSP_WFD_AUDIO_FMT_STRUCT audio_format;
+    uint64_t start_us = MiracastCommon::get_monotonic_time_us();
+    GstCaps *caps = nullptr;
+    bool primed = false;
+
+    MIRACASTLOG_TRACE("Entering..!!!");
+    {
+        std::lock_guard<std::mutex> lock(self->m_format_mutex);
+        video_format = self->m_video_format;
+        audio_format = self->m_audio_format;
+    }
+    // Sized for the negotiated level up front, growing later would allocate while the stream runs
+    if (self->m_rtp_receiver)
+    {
+        self->m_rtp_receiver->reserve(self->getRTPPoolSize(video_format.st_h264_codecs.level));
+    }
+    if (!self->m_prewarm_enabled)
+    {
+        MIRACASTLOG_TRACE("Exiting..!!!");
+        return G_SOURCE_REMOVE;
+    }
+    if (nullptr != (caps = createNegotiatedVideoCaps(video_format)))
+    {
+        self->loadDecoderPlugins(caps);
+        gst_caps_unref(caps);
+    }
+    if (nullptr != (caps = createNegotiatedAudioCaps(audio_format)))
+    {
+        self->loadDecoderPlugins(caps);
+        gst_caps_unref(caps);
+    }
+    primed = self->primeProgram(video_format, audio_format);
+    MIRACASTLOG_INFO("Decode chain pre-warmed in [%llu] us, program tables %s",
+                        static_cast<unsigned long long>(MiracastCommon::get_monotonic_time_us() - start_us),
+                        (primed) ? "pushed" : "not pushed");
     MIRACASTLOG_TRACE("Exiting..!!!");
+    return G_SOURCE_REMOVE;
+}
+
+/* Slots for everything in flight behind the receiver at the highest bitrate the level allows */
+unsigned int MiracastGstPlayer::getRTPPoolSize(uint8_t h264_level)
+{
+    const MIRACAST_GSTPLAYER_LATENCY_PROFILE_STRUCT &profile = m_latency_profiles[m_latency_profile];
+    uint64_t hold_ms = profile.jitterbuffer_max_latency_ms + MIRACAST_GSTPLAYER_RTP_POOL_MARGIN_MS,
+             pool_size = (static_cast<uint64_t>(h264_level_max_bitrate_kbps(h264_level)) * hold_ms) / (8 * MIRACAST_GSTPLAYER_RTP_PAYLOAD_SIZE);
+
+    return static_cast<unsigned int>(std::max<uint64_t>(std::min<uint64_t>(pool_size, RTP_RECEIVER_MAX_POOL_SIZE), RTP_RECEIVER_BATCH_SIZE));
 }
 
 void MiracastGstPlayer::notifyPlaybackState(eMIRA_GSTPLAYER_STATES gst_player_state, eM_PLAYER_REASON_CODE state_reason_code )
@@ -454,9 +1570,11 @@ GstFlowReturn MiracastGstPlayer::appendPipelineNewSampleHandler(GstElement *elt,
     // Unmap and cleanup
     gst_buffer_unmap(buffer, &map);
 #else
-    //MIRACASTLOG_INFO("Sending GstBuffer to Q");
     gst_buffer_ref(buffer);
-    self->m_customQueueHandle->sendData(static_cast<void*>(buffer));
+    if (!self->m_customQueueHandle->push(static_cast<void*>(buffer)))
+    {
+        MIRACASTLOG_VERBOSE("appsrc side is behind, dropped the oldest buffer");
+    }
 #endif
     gst_sample_unref(sample);
 
@@ -489,6 +1607,7 @@ gboolean MiracastGstPlayer::appendPipelineBusMessage(GstBus * bus, GstMessage *
             g_error_free(error);
             g_free(info);
             GST_DEBUG_BIN_TO_DOT_FILE((GstBin *)self->m_append_pipeline, GST_DEBUG_GRAPH_SHOW_ALL, "miracast_udpsrc2appsink_error");
+            self->m_pipeline_failed = true;
             gst_element_set_state(self->m_append_pipeline, GST_STATE_READY);
             self->notifyPlaybackState(MIRACAST_GSTPLAYER_STATE_STOPPED,MIRACAST_PLAYER_REASON_CODE_GST_ERROR);
         }
@@ -519,6 +1638,17 @@ gboolean MiracastGstPlayer::appendPipelineBusMessage(GstBus * bus, GstMessage *
             }
         }
         break;
+        case GST_MESSAGE_LATENCY:
+        {
+            MIRACASTLOG_INFO("Latency changed by [%s], recalculating", GST_OBJECT_NAME(GST_MESSAGE_SRC(message)));
+            gst_bin_recalculate_latency(GST_BIN(self->m_append_pipeline));
+        }
+        break;
+        case GST_MESSAGE_ELEMENT:
+        {
+            self->onJitterBufferDropMessage(message);
+        }
+        break;
         default:
             break;
     }
@@ -549,6 +1679,8 @@ gboolean MiracastGstPlayer::playbinPipelineBusMessage (GstBus * bus, GstMessage
                 MIRACASTLOG_ERROR("#### GST-FAIL Error received from element [%s | %s | %s] ####", GST_OBJECT_NAME(message->src), error->message, info ? info : "none");
                 g_error_free(error);
                 g_free(info);
+                // Not kept for the next session, whatever failed is built again
+                self->m_pipeline_failed = true;
             }
             GST_DEBUG_BIN_TO_DOT_FILE((GstBin *)self->m_playbin_pipeline, GST_DEBUG_GRAPH_SHOW_ALL, "miracast_playbin2appSrc_error");
             self->notifyPlaybackState(MIRACAST_GSTPLAYER_STATE_STOPPED,MIRACAST_PLAYER_REASON_CODE_GST_ERROR);
@@ -613,25 +1745,19 @@ gboolean MiracastGstPlayer::playbinPipelineBusMessage (GstBus * bus, GstMessage
         case GST_MESSAGE_QOS:
         {
             MIRACASTLOG_VERBOSE("Received [%s], a buffer was dropped or an element changed its processing strategy for Quality of Service reasons.", gst_message_type_get_name(message->type));
-            GstFormat format;
-            guint64 processed;
-            guint64 dropped;
-            gst_message_parse_qos_stats(message, &format, &processed, &dropped);
-            MIRACASTLOG_VERBOSE("Format [%s], Processed [%lu], Dropped [%lu].", gst_format_get_name(format), processed, dropped);
-
-            gint64 jitter;
-            gdouble proportion;
-            gint quality;
-            gst_message_parse_qos_values(message, &jitter, &proportion, &quality);
-            MIRACASTLOG_VERBOSE("Jitter [%lu], Proportion [%lf],  Quality [%u].", jitter, proportion, quality);
-
-            gboolean live;
-            guint64 running_time;
-            guint64 stream_time;
-            guint64 timestamp;
-            guint64 duration;
-            gst_message_parse_qos(message, &live, &running_time, &stream_time, &timestamp, &duration);
-            MIRACASTLOG_VERBOSE("live stream [%d], runninng_time [%lu], stream_time [%lu], timestamp [%lu], duration [%lu].", live, running_time, stream_time, timestamp, duration);
+            self->onQosMessage(message);
+        }
+        break;
+        case GST_MESSAGE_LATENCY:
+        {
+            MIRACASTLOG_INFO("Latency changed by [%s], recalculating", GST_OBJECT_NAME(GST_MESSAGE_SRC(message)));
+            gst_bin_recalculate_latency(GST_BIN(self->m_playbin_pipeline));
+        }
+        break;
+        case GST_MESSAGE_ELEMENT:
+        {
+            // The jitterbuffer sits in this pipeline in single pipeline mode
+            self->onJitterBufferDropMessage(message);
         }
         break;
         default:
@@ -640,31 +1766,96 @@ gboolean MiracastGstPlayer::playbinPipelineBusMessage (GstBus * bus, GstMessage
     return TRUE;
 }
 
-void* MiracastGstPlayer::pushbuffer_handler_thread(void *ctx)
+/* Runs on the main loop whenever the ring signals its eventfd, until the ring is empty again */
+gboolean MiracastGstPlayer::pushbufferHandler(gint fd, GIOCondition condition, gpointer userdata)
 {
-    MiracastGstPlayer *self = (MiracastGstPlayer *)ctx;
-    MIRACASTLOG_TRACE("Entering..!!!");
-    void* buffer = nullptr;
-    GstBuffer *gstBuffer = nullptr;
-    self->m_pushBufferLoop = true;
-    while (self && (self->m_pushBufferLoop))
+    MiracastGstPlayer *self = (MiracastGstPlayer *)userdata;
+    void* buffers[MIRACAST_GSTPLAYER_BUFFER_RING_SIZE];
+
+    do
     {
-        MIRACASTLOG_TRACE("Pushing buffer to appsrc.!!!");
-        usleep(50);
-        self->m_customQueueHandle->ReceiveData(buffer);
+        size_t count = self->m_customQueueHandle->pop_all(buffers, MIRACAST_GSTPLAYER_BUFFER_RING_SIZE, 0);
+        GstFlowReturn ret = GST_FLOW_OK;
+
+        if (0 == count)
+        {
+            continue;
+        }
 
-        if (nullptr != buffer)
+        // Everything queued since the last wake-up goes to appsrc in one call
+        if (1 == count)
+        {
+            ret = gst_app_src_push_buffer(GST_APP_SRC(self->m_appsrc), static_cast<GstBuffer*>(buffers[0]));
+        }
+        else
         {
-            gstBuffer = static_cast<GstBuffer*>(buffer);
-            // Push the new buffer to appsrc
-            GstFlowReturn ret = gst_app_src_push_buffer(GST_APP_SRC(self->m_appsrc), gstBuffer);
-            if (ret != GST_FLOW_OK)
+            GstBufferList *buffer_list = gst_buffer_list_new_sized(count);
+
+            for (size_t index = 0; index < count; ++index)
             {
-                MIRACASTLOG_ERROR("Error pushing buffer to appsrc");
+                gst_buffer_list_add(buffer_list, static_cast<GstBuffer*>(buffers[index]));
             }
+            ret = gst_app_src_push_buffer_list(GST_APP_SRC(self->m_appsrc), buffer_list);
+        }
+        if (ret != GST_FLOW_OK)
+        {
+            MIRACASTLOG_ERROR("Error pushing [%zu] buffers to appsrc", count);
+        }
+    }
+    while (!self->m_customQueueHandle->arm_event_fd());
+    return G_SOURCE_CONTINUE;
+}
+
+void* MiracastGstPlayer::rtp_receive_thread(void *ctx)
+{
+    MiracastGstPlayer *self = (MiracastGstPlayer *)ctx;
+    RTP_RECEIVER_PACKET_STRUCT packets[RTP_RECEIVER_BATCH_SIZE];
+    MIRACASTLOG_TRACE("Entering..!!!");
+
+    while (self->m_rtp_receive_loop)
+    {
+        int count = self->m_rtp_receiver->receive(packets, RTP_RECEIVER_BATCH_SIZE, -1);
+        GstClockTime arrival_time = GST_CLOCK_TIME_NONE;
+        GstClock *clock = nullptr;
+
+        if (0 > count)
+        {
+            break;
+        }
+        if (0 == count)
+        {
+            continue;
+        }
+
+        // The whole batch came off the socket together, stamp it with one arrival time as udpsrc would
+        clock = gst_element_get_clock(self->m_udpsrc);
+        if (clock)
+        {
+            arrival_time = gst_clock_get_time(clock) - gst_element_get_base_time(self->m_udpsrc);
+            gst_object_unref(clock);
+        }
+
+        GstBufferList *buffer_list = gst_buffer_list_new_sized(count);
+
+        for (int index = 0; index < count; ++index)
+        {
+            // The slot goes back to the receiver when the last reference to the buffer is dropped
+            GstBuffer *buffer = gst_buffer_new_wrapped_full(GST_MEMORY_FLAG_READONLY,
+                                                            packets[index].data,
+                                                            RTP_RECEIVER_SLOT_SIZE,
+                                                            0,
+                                                            packets[index].length,
+                                                            packets[index].slot_handle,
+                                                            MiracastRTPReceiver::release_slot);
+
+            GST_BUFFER_DTS(buffer) = arrival_time;
+            GST_BUFFER_PTS(buffer) = arrival_time;
+            gst_buffer_list_add(buffer_list, buffer);
+        }
+        if (GST_FLOW_OK != gst_app_src_push_buffer_list(GST_APP_SRC(self->m_udpsrc), buffer_list))
+        {
+            MIRACASTLOG_ERROR("Error pushing [%d] RTP packets to appsrc", count);
         }
-        gstBuffer = NULL;
-        buffer = NULL;
     }
     MIRACASTLOG_TRACE("Exiting..!!!");
     pthread_exit(nullptr);
@@ -689,20 +1880,31 @@ void MiracastGstPlayer::source_setup(GstElement *pipeline, GstElement *source, g
     MIRACASTLOG_INFO("Entering...");
     MIRACASTLOG_INFO("Source has been created. Configuring [%x]",source);
     self->m_appsrc = source;
+    self->configurePlaybackAppsrc();
+    MIRACASTLOG_INFO("Exiting... ");
+}
+
+void MiracastGstPlayer::configurePlaybackAppsrc()
+{
     // Set AppSrc parameters
     GstAppSrcCallbacks callbacks = {gst_bin_need_data, gst_bin_enough_data, NULL};
-    gst_app_src_set_callbacks(GST_APP_SRC(self->m_appsrc), &callbacks, (gpointer)(self), NULL);
-    g_object_set(GST_APP_SRC(self->m_appsrc), "max-bytes", (guint64) 20 * 1024 * 1024, NULL);
+    gst_app_src_set_callbacks(GST_APP_SRC(m_appsrc), &callbacks, (gpointer)(this), NULL);
+    const MIRACAST_GSTPLAYER_LATENCY_PROFILE_STRUCT &profile = m_latency_profiles[m_latency_profile];
+    g_object_set(GST_APP_SRC(m_appsrc), "max-bytes", profile.appsrc_max_bytes, NULL);
+    g_object_set(GST_APP_SRC(m_appsrc), "min-latency", profile.appsrc_min_latency_ns, NULL);
 
-    g_object_set(GST_APP_SRC(self->m_appsrc), "format", GST_FORMAT_TIME, NULL);
-    g_object_set(GST_APP_SRC(self->m_appsrc), "is-live", true, NULL);
+    g_object_set(GST_APP_SRC(m_appsrc), "format", GST_FORMAT_TIME, NULL);
+    g_object_set(GST_APP_SRC(m_appsrc), "is-live", true, NULL);
     const gchar *set_cap = "video/mpegts, systemstream=(boolean)true, packetsize=(int)188";
     GstCaps *caps = gst_caps_from_string (set_cap);
-    g_object_set(GST_APP_SRC(self->m_appsrc), "caps", caps, NULL);
+    g_object_set(GST_APP_SRC(m_appsrc), "caps", caps, NULL);
     if(caps) {
-      self->m_capsSrc = caps;
+      // A reused playbin sets up a new source every session
+      if (m_capsSrc) {
+        gst_caps_unref(m_capsSrc);
+      }
+      m_capsSrc = caps;
     }
-    MIRACASTLOG_INFO("Exiting... ");
 }
 
 void MiracastGstPlayer::gstBufferReleaseCallback(void* userParam)
@@ -712,93 +1914,1083 @@ void MiracastGstPlayer::gstBufferReleaseCallback(void* userParam)
 
     if (nullptr != gstBuffer)
     {
-        MIRACASTLOG_INFO("gstBuffer[%x]",gstBuffer);
+        MIRACASTLOG_TRACE("gstBuffer[%x]",gstBuffer);
         gst_buffer_unref(gstBuffer);
     }
 }
 
-bool MiracastGstPlayer::createPipeline()
+/* decodebin exposes one pad per decoded stream, the first video and audio pads go to the sinks */
+void MiracastGstPlayer::decodebinPadAdded(GstElement *decodebin, GstPad *pad, gpointer userdata)
 {
-    MIRACASTLOG_TRACE("Entering..!!!");
-    GstStateChangeReturn ret;
-    GstBus *bus = nullptr;
-    bool return_value = true;
-    m_customQueueHandle = new MessageQueue(500,gstBufferReleaseCallback);
+    MiracastGstPlayer *self = static_cast<MiracastGstPlayer*>(userdata);
+    GstCaps *caps = gst_pad_get_current_caps(pad);
+    const gchar *media_type = nullptr;
 
-    if (nullptr == m_customQueueHandle)
+    MIRACASTLOG_TRACE("Entering...");
+
+    if (nullptr == caps)
     {
-        MIRACASTLOG_ERROR("Failed to create MessageQueue");
-        return false;
+        caps = gst_pad_query_caps(pad, nullptr);
     }
-
-    /* create gst pipeline */
-    m_main_loop_context = g_main_context_new();
-    g_main_context_push_thread_default(m_main_loop_context);
-    m_main_loop = g_main_loop_new(m_main_loop_context, FALSE);
-
-    MIRACASTLOG_INFO("Creating Pipeline...");
-
-    // Create a new pipeline
-    m_append_pipeline = gst_pipeline_new("miracast_data_collector");
-    // Create elements
-    m_udpsrc = gst_element_factory_make("udpsrc", "miracast_udpsrc");
-    m_rtpjitterbuffer = gst_element_factory_make("rtpjitterbuffer", "miracast_rtpjitterbuffer");
-    m_rtpmp2tdepay = gst_element_factory_make("rtpmp2tdepay", "miracast_rtpmp2tdepay");
-    m_tsparse = gst_element_factory_make("tsparse", "miracast_tsparse");
-    m_appsink = gst_element_factory_make("appsink", "miracast_appsink");
-    m_video_sink = gst_element_factory_make("westerossink", "miracast_westerossink");
-    m_audio_sink = SoC_GetAudioSinkProperty();
-
-    if (!m_append_pipeline || !m_udpsrc || !m_rtpjitterbuffer || !m_rtpmp2tdepay ||
-        !m_tsparse || !m_appsink || !m_video_sink )
+    if ((nullptr == caps) || (0 == gst_caps_get_size(caps)))
     {
-        MIRACASTLOG_ERROR("Append Pipeline[%x]: Element creation failure, check below",m_append_pipeline);
-        MIRACASTLOG_WARNING("udpsrc[%x]rtpjitterbuffer[%x]rtpmp2tdepay[%x]",m_udpsrc,m_rtpjitterbuffer,m_rtpmp2tdepay);
-        MIRACASTLOG_WARNING("tsparse[%x]appsink[%x]videosink[%x]audiosink[%x]",
-                            m_tsparse,m_appsink,m_video_sink,m_audio_sink);
-        return -1;
+        MIRACASTLOG_ERROR("No caps on decodebin pad [%s]", GST_PAD_NAME(pad));
+        if (caps)
+        {
+            gst_caps_unref(caps);
+        }
+        return;
     }
+    media_type = gst_structure_get_name(gst_caps_get_structure(caps, 0));
+    MIRACASTLOG_INFO("decodebin pad [%s] caps [%s]", GST_PAD_NAME(pad), media_type);
 
-    /*{{{ udpsrc related element configuration*/
-    MIRACASTLOG_TRACE(">>>>>>>udpsrc configuration start");
-    MIRACASTLOG_TRACE("Set the port[%llu] and to udp source.",m_streaming_port);
-    g_object_set(G_OBJECT(m_udpsrc), "port", m_streaming_port, nullptr);
-
-    GstCaps *caps = gst_caps_new_simple("application/x-rtp", "media", G_TYPE_STRING, "video", nullptr);
-    if (caps)
+    if ((g_str_has_prefix(media_type, "video/")) && (!self->m_video_linked))
     {
-        g_object_set(m_udpsrc, "caps", caps, nullptr);
-        gst_caps_unref(caps);
-        MIRACASTLOG_TRACE("Set the caps to udp source.");
+        GstPad *sink_pad = nullptr;
+
+        // Still in the pipeline when the decodebin replaces a chain of another codec
+        if (!gst_object_has_as_parent(GST_OBJECT(self->m_video_sink), GST_OBJECT(self->m_playbin_pipeline)))
+        {
+            // The extra ref keeps stop() balanced, it releases the sink after the pipeline
+            gst_object_ref(self->m_video_sink);
+            gst_bin_add(GST_BIN(self->m_playbin_pipeline), self->m_video_sink);
+            gst_element_sync_state_with_parent(self->m_video_sink);
+        }
+        sink_pad = gst_element_get_static_pad(self->m_video_sink, "sink");
+        if (GST_PAD_LINK_OK != gst_pad_link(pad, sink_pad))
+        {
+            MIRACASTLOG_ERROR("Failed to link decodebin to the video sink");
+        }
+        else
+        {
+            self->m_video_linked = true;
+        }
+        gst_object_unref(sink_pad);
     }
-    else
+    else if ((g_str_has_prefix(media_type, "audio/")) && (!self->m_audio_linked))
     {
-        MIRACASTLOG_ERROR("Unable to Set caps to udp source.");
+        // Unnamed, a format switch or a reused pipeline plugs the audio chain again
+        GstElement *audio_convert = gst_element_factory_make("audioconvert", nullptr);
+        GstElement *audio_resample = gst_element_factory_make("audioresample", nullptr);
+        GstElement *audio_sink = self->m_audio_sink;
+        GstPad *sink_pad = nullptr;
+        bool sink_in_pipeline = false;
+
+        if (nullptr == audio_sink)
+        {
+            audio_sink = gst_element_factory_make("autoaudiosink", nullptr);
+        }
+        else if (gst_object_has_as_parent(GST_OBJECT(audio_sink), GST_OBJECT(self->m_playbin_pipeline)))
+        {
+            sink_in_pipeline = true;
+        }
+        else
+        {
+            gst_object_ref(audio_sink);
+        }
+
+        if (!audio_convert || !audio_resample || !audio_sink)
+        {
+            MIRACASTLOG_ERROR("audioconvert[%p]audioresample[%p]audiosink[%p] creation failure",
+                                audio_convert, audio_resample, audio_sink);
+            if (audio_convert)
+            {
+                gst_object_unref(audio_convert);
+            }
+            if (audio_resample)
+            {
+                gst_object_unref(audio_resample);
+            }
+            if ((audio_sink) && (!sink_in_pipeline))
+            {
+                gst_object_unref(audio_sink);
+            }
+        }
+        else
+        {
+            gst_bin_add_many(GST_BIN(self->m_playbin_pipeline), audio_convert, audio_resample, nullptr);
+            if (!sink_in_pipeline)
+            {
+                gst_bin_add(GST_BIN(self->m_playbin_pipeline), audio_sink);
+            }
+            gst_element_link_many(audio_convert, audio_resample, audio_sink, nullptr);
+            gst_element_sync_state_with_parent(audio_sink);
+            gst_element_sync_state_with_parent(audio_resample);
+            gst_element_sync_state_with_parent(audio_convert);
+
+            sink_pad = gst_element_get_static_pad(audio_convert, "sink");
+            if (GST_PAD_LINK_OK != gst_pad_link(pad, sink_pad))
+            {
+                MIRACASTLOG_ERROR("Failed to link decodebin to the audio sink");
+            }
+            else
+            {
+                self->m_audio_linked = true;
+            }
+            gst_object_unref(sink_pad);
+        }
+    }
+    gst_caps_unref(caps);
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+/* tsdemux exposes one pad per elementary stream once it has the PMT, normally the one pushed by primeProgram() */
+void MiracastGstPlayer::tsdemuxPadAdded(GstElement *tsdemux, GstPad *pad, gpointer userdata)
+{
+    MiracastGstPlayer *self = static_cast<MiracastGstPlayer*>(userdata);
+    GstCaps *caps = gst_pad_get_current_caps(pad),
+            *negotiated_caps = nullptr;
+    RTSP_WFD_VIDEO_FMT_STRUCT video_format;
+    RTSP_WFD_AUDIO_FMT_STRUCT audio_format;
+    const gchar *media_type = nullptr;
+    bool format_valid = false,
+         is_video = false;
+
+    MIRACASTLOG_TRACE("Entering...");
+
+    if (nullptr == caps)
+    {
+        caps = gst_pad_query_caps(pad, nullptr);
+    }
+    if ((nullptr == caps) || (0 == gst_caps_get_size(caps)))
+    {
+        MIRACASTLOG_ERROR("No caps on tsdemux pad [%s]", GST_PAD_NAME(pad));
+        if (caps)
+        {
+            gst_caps_unref(caps);
+        }
+        return;
+    }
+    media_type = gst_structure_get_name(gst_caps_get_structure(caps, 0));
+    is_video = g_str_has_prefix(media_type, "video/");
+    MIRACASTLOG_INFO("tsdemux pad [%s] caps [%s]", GST_PAD_NAME(pad), media_type);
+
+    if ((!is_video) && (!g_str_has_prefix(media_type, "audio/")))
+    {
+        gst_caps_unref(caps);
+        MIRACASTLOG_TRACE("Exiting...");
+        return;
+    }
+
+    GstElement *&chain_head = (is_video) ? self->m_video_chain : self->m_audio_chain;
+    GstCaps *&chain_caps = (is_video) ? self->m_video_chain_caps : self->m_audio_chain_caps;
+
+    if (nullptr != chain_head)
+    {
+        GstPad *chain_pad = gst_element_get_static_pad(chain_head, "sink"),
+               *linked_pad = gst_pad_get_peer(chain_pad);
+        bool replaces_linked = (nullptr == linked_pad) || (!same_program_generation(pad, linked_pad)),
+             fits_chain = (nullptr == chain_caps) || (gst_caps_can_intersect(caps, chain_caps));
+
+        // A changed PMT makes tsdemux add the pads of the new program before it removes the old ones,
+        // which then push their EOS. Moving the chain over right away keeps that EOS out of the sinks.
+        // A second stream of a kind in the same program stays unlinked, tsdemux only fails once every pad is.
+        if ((replaces_linked) && (linked_pad))
+        {
+            gst_pad_unlink(linked_pad, chain_pad);
+        }
+        if ((replaces_linked) && (fits_chain) && (GST_PAD_LINK_OK == gst_pad_link(pad, chain_pad)))
+        {
+            MIRACASTLOG_INFO("tsdemux pad [%s] relinked to [%s]", GST_PAD_NAME(pad), GST_ELEMENT_NAME(chain_head));
+            if (is_video)
+            {
+                self->m_video_linked = true;
+            }
+            else
+            {
+                self->m_audio_linked = true;
+            }
+        }
+        if (linked_pad)
+        {
+            gst_object_unref(linked_pad);
+        }
+        gst_object_unref(chain_pad);
+        if ((!replaces_linked) || (fits_chain))
+        {
+            gst_caps_unref(caps);
+            MIRACASTLOG_TRACE("Exiting...");
+            return;
+        }
+        // Another codec, everything up to the sink is built again for it
+        MIRACASTLOG_INFO("tsdemux pad [%s] caps [%s] need a new chain", GST_PAD_NAME(pad), media_type);
+        self->removeDecodeChain(is_video);
+    }
+    {
+        std::lock_guard<std::mutex> lock(self->m_format_mutex);
+        video_format = self->m_video_format;
+        audio_format = self->m_audio_format;
+        format_valid = self->m_format_valid;
+    }
+    if (format_valid)
+    {
+        negotiated_caps = (is_video) ? createNegotiatedVideoCaps(video_format) : createNegotiatedAudioCaps(audio_format);
+    }
+
+    // The source sending something else than M4 settled on is left to decodebin
+    if ((nullptr != negotiated_caps) && (gst_caps_can_intersect(caps, negotiated_caps)))
+    {
+        chain_head = self->buildDecodeChain(pad, negotiated_caps, is_video);
+    }
+    if (nullptr != chain_head)
+    {
+        if (is_video)
+        {
+            self->m_video_linked = true;
+        }
+        else
+        {
+            self->m_audio_linked = true;
+        }
+    }
+    else
+    {
+        MIRACASTLOG_WARNING("No chain from the negotiated format for [%s], autoplugging", media_type);
+        chain_head = self->plugDecodebin(pad);
+    }
+    if (nullptr != chain_head)
+    {
+        chain_caps = gst_caps_ref(caps);
+    }
+    if (negotiated_caps)
+    {
+        gst_caps_unref(negotiated_caps);
+    }
+    gst_caps_unref(caps);
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+/*
+ * queue ! [parser] ! [decoder] ! [audioconvert ! audioresample] ! sink behind a
+ * tsdemux pad, every element picked for the negotiated caps and linked with
+ * them. The queue gives each stream its own streaming thread as the multiqueue
+ * of decodebin would. A sink that takes the caps itself gets the parser output.
+ */
+GstElement *MiracastGstPlayer::buildDecodeChain(GstPad *pad, GstCaps *caps, bool is_video)
+{
+    GstElement *chain[6] = {nullptr};
+    GstElement *sink = (is_video) ? m_video_sink : m_audio_sink;
+    GstElementFactory *parser_factory = nullptr,
+                      *decoder_factory = nullptr;
+    GstCaps *filter_caps = nullptr;
+    GstPad *chain_pad = nullptr;
+    bool sink_decodes = false,
+         sink_in_pipeline = false,
+         return_value = true;
+    int count = 0,
+        owned_count = 0,
+        parser_index = -1;
+
+    // A software decode is asked for to take the platform out of the measurement, so the sink must not decode either
+    if ((nullptr != sink) && (!m_active_sink_config.software_decode))
+    {
+        GstPad *sink_pad = gst_element_get_static_pad(sink, "sink");
+        GstCaps *sink_caps = (sink_pad) ? gst_pad_query_caps(sink_pad, nullptr) : nullptr;
+
+        sink_decodes = (nullptr != sink_caps) && (!gst_caps_is_any(sink_caps)) && (gst_caps_can_intersect(sink_caps, caps));
+        if (sink_caps)
+        {
+            gst_caps_unref(sink_caps);
+        }
+        if (sink_pad)
+        {
+            gst_object_unref(sink_pad);
+        }
+    }
+    parser_factory = findElementFactory(caps, GST_ELEMENT_FACTORY_TYPE_PARSER);
+    if (!sink_decodes)
+    {
+        decoder_factory = findElementFactory(caps, GST_ELEMENT_FACTORY_TYPE_DECODER, m_active_sink_config.software_decode);
+        if (nullptr == decoder_factory)
+        {
+            if (parser_factory)
+            {
+                gst_object_unref(parser_factory);
+            }
+            return nullptr;
+        }
+    }
+
+    chain[count++] = gst_element_factory_make("queue", nullptr);
+    if (parser_factory)
+    {
+        parser_index = count;
+        chain[count++] = gst_element_factory_create(parser_factory, nullptr);
+    }
+    if (decoder_factory)
+    {
+        chain[count++] = gst_element_factory_create(decoder_factory, nullptr);
+    }
+    if ((!is_video) && (!sink_decodes))
+    {
+        chain[count++] = gst_element_factory_make("audioconvert", nullptr);
+        chain[count++] = gst_element_factory_make("audioresample", nullptr);
+    }
+    if (nullptr == sink)
+    {
+        sink = gst_element_factory_make("autoaudiosink", nullptr);
+    }
+    else if (gst_object_has_as_parent(GST_OBJECT(sink), GST_OBJECT(m_playbin_pipeline)))
+    {
+        // Left running by removeDecodeChain(), the new chain is only linked to it
+        sink_in_pipeline = true;
+    }
+    else
+    {
+        // The extra ref keeps stop() balanced, it releases the sink after the pipeline
+        gst_object_ref(sink);
+    }
+    chain[count++] = sink;
+    owned_count = (sink_in_pipeline) ? count - 1 : count;
+
+    MIRACASTLOG_INFO("%s chain: parser [%s] decoder [%s]%s",
+                        (is_video) ? "Video" : "Audio",
+                        (parser_factory) ? GST_OBJECT_NAME(parser_factory) : "none",
+                        (decoder_factory) ? GST_OBJECT_NAME(decoder_factory) : "none",
+                        (sink_decodes) ? ", decoded by the sink" : "");
+    if (parser_factory)
+    {
+        gst_object_unref(parser_factory);
+    }
+    if (decoder_factory)
+    {
+        gst_object_unref(decoder_factory);
+    }
+
+    for (int index = 0; index < count; ++index)
+    {
+        if (nullptr == chain[index])
+        {
+            MIRACASTLOG_ERROR("Element [%d] of the decode chain could not be created", index);
+            return_value = false;
+        }
+    }
+    if (!return_value)
+    {
+        for (int index = 0; index < owned_count; ++index)
+        {
+            if (chain[index])
+            {
+                gst_object_unref(chain[index]);
+            }
+        }
+        return nullptr;
+    }
+
+    for (int index = 0; index < owned_count; ++index)
+    {
+        gst_bin_add(GST_BIN(m_playbin_pipeline), chain[index]);
+    }
+    // Fixed caps behind the parser, whole access units for the video decoder
+    filter_caps = gst_caps_copy(caps);
+    if (is_video)
+    {
+        gst_caps_set_simple(filter_caps, "alignment", G_TYPE_STRING, "au", nullptr);
+    }
+    for (int index = 0; (return_value) && (index < count - 1); ++index)
+    {
+        return_value = (index == parser_index) ?
+                        gst_element_link_filtered(chain[index], chain[index + 1], filter_caps) :
+                        gst_element_link(chain[index], chain[index + 1]);
+    }
+    gst_caps_unref(filter_caps);
+
+    chain_pad = gst_element_get_static_pad(chain[0], "sink");
+    if ((return_value) && (GST_PAD_LINK_OK != gst_pad_link(pad, chain_pad)))
+    {
+        return_value = false;
+    }
+    gst_object_unref(chain_pad);
+
+    if (!return_value)
+    {
+        MIRACASTLOG_ERROR("Unable to link the %s decode chain", (is_video) ? "video" : "audio");
+        for (int index = 0; index < owned_count; ++index)
+        {
+            gst_element_set_state(chain[index], GST_STATE_NULL);
+            gst_bin_remove(GST_BIN(m_playbin_pipeline), chain[index]);
+        }
+        // Back to how it was created, decodebinPadAdded() takes its own reference again
+        if ((!sink_in_pipeline) && ((sink == m_video_sink) || (sink == m_audio_sink)))
+        {
+            g_object_force_floating(G_OBJECT(sink));
+        }
+        return nullptr;
+    }
+    for (int index = owned_count - 1; index >= 0; --index)
+    {
+        gst_element_sync_state_with_parent(chain[index]);
+    }
+    return chain[0];
+}
+
+/*
+ * Takes the chain of a stream out of the running pipeline for one of another
+ * codec. The sink is left in place and keeps its state and its clock, only the
+ * link to it goes. Runs on the tsdemux streaming thread, the only one pushing
+ * into the chain, whose tsdemux pad is already unlinked.
+ */
+void MiracastGstPlayer::removeDecodeChain(bool is_video)
+{
+    GstElement *&chain_head = (is_video) ? m_video_chain : m_audio_chain;
+    GstCaps *&chain_caps = (is_video) ? m_video_chain_caps : m_audio_chain_caps;
+    GstElement *sink = (is_video) ? m_video_sink : m_audio_sink;
+    std::vector<GstElement*> elements;
+    std::vector<GstPad*> sink_links;
+
+    if (nullptr == chain_head)
+    {
+        return;
+    }
+    // Downstream from the head over every linked src pad, a decodebin counts as one element
+    elements.push_back(GST_ELEMENT(gst_object_ref(chain_head)));
+    for (size_t index = 0; index < elements.size(); ++index)
+    {
+        GstIterator *pads = gst_element_iterate_src_pads(elements[index]);
+        GValue item = G_VALUE_INIT;
+
+        while (GST_ITERATOR_OK == gst_iterator_next(pads, &item))
+        {
+            GstPad *src_pad = GST_PAD(g_value_get_object(&item)),
+                   *peer_pad = gst_pad_get_peer(src_pad);
+            GstElement *next = (peer_pad) ? gst_pad_get_parent_element(peer_pad) : nullptr;
+
+            if ((nullptr != next) && (sink == next))
+            {
+                sink_links.push_back(GST_PAD(gst_object_ref(src_pad)));
+            }
+            else if ((nullptr != next) && (elements.end() == std::find(elements.begin(), elements.end(), next)))
+            {
+                elements.push_back(GST_ELEMENT(gst_object_ref(next)));
+            }
+            if (next)
+            {
+                gst_object_unref(next);
+            }
+            if (peer_pad)
+            {
+                gst_object_unref(peer_pad);
+            }
+            g_value_reset(&item);
+        }
+        g_value_unset(&item);
+        gst_iterator_free(pads);
+    }
+
+    // Stopped before the sink is unlinked, so that no streaming thread of the chain runs into the unlinked pad
+    for (GstElement *element : elements)
+    {
+        gst_element_set_state(element, GST_STATE_NULL);
+    }
+    for (GstPad *src_pad : sink_links)
+    {
+        GstPad *peer_pad = gst_pad_get_peer(src_pad);
+
+        if (peer_pad)
+        {
+            gst_pad_unlink(src_pad, peer_pad);
+            gst_object_unref(peer_pad);
+        }
+        gst_object_unref(src_pad);
+    }
+    for (GstElement *element : elements)
+    {
+        gst_bin_remove(GST_BIN(m_playbin_pipeline), element);
+        gst_object_unref(element);
+    }
+    MIRACASTLOG_INFO("%s chain of [%u] elements removed, the sink keeps running", (is_video) ? "Video" : "Audio", static_cast<unsigned int>(elements.size()));
+
+    chain_head = nullptr;
+    if (chain_caps)
+    {
+        gst_caps_unref(chain_caps);
+        chain_caps = nullptr;
+    }
+    if (is_video)
+    {
+        m_video_linked = false;
+    }
+    else
+    {
+        m_audio_linked = false;
+    }
+}
+
+/* Autoplugging for a stream the negotiated format does not describe, decodebinPadAdded() adds the sinks */
+GstElement *MiracastGstPlayer::plugDecodebin(GstPad *pad)
+{
+    GstElement *decodebin = gst_element_factory_make("decodebin", nullptr);
+    GstPad *sink_pad = nullptr;
+
+    if (nullptr == decodebin)
+    {
+        MIRACASTLOG_ERROR("decodebin creation failure");
+        return nullptr;
+    }
+    g_signal_connect(decodebin, "pad-added", G_CALLBACK(decodebinPadAdded), this);
+    gst_bin_add(GST_BIN(m_playbin_pipeline), decodebin);
+    gst_element_sync_state_with_parent(decodebin);
+
+    sink_pad = gst_element_get_static_pad(decodebin, "sink");
+    if (GST_PAD_LINK_OK != gst_pad_link(pad, sink_pad))
+    {
+        MIRACASTLOG_ERROR("Failed to link tsdemux pad [%s] to decodebin", GST_PAD_NAME(pad));
+    }
+    gst_object_unref(sink_pad);
+    return decodebin;
+}
+
+/**
+ * Runs on every frame entering the video sink. The running time of a frame is
+ * its UDP ingress time on the clock of the pipeline holding udpsrc, and the sink
+ * renders it at that running time plus the latency of the pipeline holding the
+ * sink. In dual mode those are two pipelines with their own clock and base time,
+ * so each part is taken on its own clock.
+ */
+GstPadProbeReturn MiracastGstPlayer::videoSinkLatencyProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userdata)
+{
+    MiracastGstPlayer *self = static_cast<MiracastGstPlayer*>(userdata);
+    GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    GstElement *ingress_pipeline = (nullptr != self->m_append_pipeline) ? self->m_append_pipeline : self->m_playbin_pipeline;
+    GstEvent *segment_event = nullptr;
+    GstClock *ingress_clock = nullptr,
+             *render_clock = nullptr;
+    const GstSegment *segment = nullptr;
+    GstClockTime running_time = GST_CLOCK_TIME_NONE,
+                 render_latency = 0;
+    gint64 ingress_to_sink = 0,
+           until_render = 0;
+
+    if ((nullptr == buffer) || (!GST_BUFFER_PTS_IS_VALID(buffer)) || (nullptr == ingress_pipeline))
+    {
+        return GST_PAD_PROBE_OK;
+    }
+
+    segment_event = gst_pad_get_sticky_event(pad, GST_EVENT_SEGMENT, 0);
+    if (nullptr == segment_event)
+    {
+        return GST_PAD_PROBE_OK;
+    }
+    gst_event_parse_segment(segment_event, &segment);
+    running_time = gst_segment_to_running_time(segment, GST_FORMAT_TIME, GST_BUFFER_PTS(buffer));
+    gst_event_unref(segment_event);
+
+    ingress_clock = gst_element_get_clock(ingress_pipeline);
+    render_clock = gst_element_get_clock(self->m_playbin_pipeline);
+
+    if ((GST_CLOCK_TIME_IS_VALID(running_time)) && (nullptr != ingress_clock) && (nullptr != render_clock))
+    {
+        render_latency = gst_pipeline_get_latency(GST_PIPELINE(self->m_playbin_pipeline));
+        render_latency = GST_CLOCK_TIME_IS_VALID(render_latency) ? render_latency : 0;
+
+        ingress_to_sink = GST_CLOCK_DIFF(gst_element_get_base_time(ingress_pipeline) + running_time,
+                                            gst_clock_get_time(ingress_clock));
+        until_render = GST_CLOCK_DIFF(gst_clock_get_time(render_clock),
+                                        gst_element_get_base_time(self->m_playbin_pipeline) + running_time + render_latency);
+
+        if (0 <= ingress_to_sink)
+        {
+            uint64_t sink_us = static_cast<uint64_t>(ingress_to_sink) / 1000,
+                     // A late frame is shown as soon as it arrives
+                     render_us = sink_us + ((0 < until_render) ? (static_cast<uint64_t>(until_render) / 1000) : 0);
+            std::lock_guard<std::mutex> lock(self->m_latency_mutex);
+            MIRACAST_GSTPLAYER_LATENCY_STRUCT &latency = self->m_latency_st;
+
+            latency.ingress_to_sink_sum_us += sink_us;
+            latency.ingress_to_sink_max_us = std::max(latency.ingress_to_sink_max_us, sink_us);
+            latency.ingress_to_render_sum_us += render_us;
+            latency.ingress_to_render_min_us = (0 == latency.frames) ? render_us : std::min(latency.ingress_to_render_min_us, render_us);
+            latency.ingress_to_render_max_us = std::max(latency.ingress_to_render_max_us, render_us);
+            ++latency.frames;
+        }
+    }
+    if (ingress_clock)
+    {
+        gst_object_unref(ingress_clock);
+    }
+    if (render_clock)
+    {
+        gst_object_unref(render_clock);
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+/*
+ * Times a mid-session format change at the video sink. The gap runs from the
+ * last frame before the caps changed to the first frame after, which is how
+ * long the picture stands still while the decoder reconfigures.
+ */
+GstPadProbeReturn MiracastGstPlayer::videoSinkFormatProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userdata)
+{
+    MiracastGstPlayer *self = static_cast<MiracastGstPlayer*>(userdata);
+    uint64_t now_us = MiracastCommon::get_monotonic_time_us(),
+             request_us = self->m_format_switch_request_us.load();
+
+    if (0 != (GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM))
+    {
+        GstEvent *event = GST_PAD_PROBE_INFO_EVENT(info);
+        GstCaps *caps = nullptr,
+                *current_caps = nullptr;
+
+        if ((0 == request_us) || (GST_EVENT_CAPS != GST_EVENT_TYPE(event)))
+        {
+            return GST_PAD_PROBE_OK;
+        }
+        if ((now_us - request_us) > (MIRACAST_GSTPLAYER_FORMAT_SWITCH_TIMEOUT_MS * 1000))
+        {
+            MIRACASTLOG_INFO("No caps change within [%u] ms of the format change", MIRACAST_GSTPLAYER_FORMAT_SWITCH_TIMEOUT_MS);
+            self->m_format_switch_request_us = 0;
+            return GST_PAD_PROBE_OK;
+        }
+        // The probe runs before the event is stored, the pad still has the caps of the old format
+        gst_event_parse_caps(event, &caps);
+        current_caps = gst_pad_get_current_caps(pad);
+        if ((current_caps) && (!gst_caps_is_equal(caps, current_caps)))
+        {
+            self->m_video_caps_switched = true;
+        }
+        if (current_caps)
+        {
+            gst_caps_unref(current_caps);
+        }
+        return GST_PAD_PROBE_OK;
+    }
+
+    if ((self->m_video_caps_switched) && (0 != self->m_last_video_frame_us))
+    {
+        uint64_t gap_us = now_us - self->m_last_video_frame_us;
+        {
+            std::lock_guard<std::mutex> lock(self->m_statistics_mutex);
+            self->m_statistics_st.format_switches++;
+            self->m_statistics_st.format_switch_gap_us = gap_us;
+            self->m_statistics_st.format_switch_gap_max_us = std::max(self->m_statistics_st.format_switch_gap_max_us, gap_us);
+        }
+        MIRACASTLOG_INFO("#### MCAST-TRIAGE-OK Format switched, [%.3f] ms without a new frame, first frame [%.3f] ms after M4 ####",
+                            gap_us / 1000.0,
+                            (now_us - request_us) / 1000.0);
+        self->m_format_switch_request_us = 0;
+    }
+    self->m_video_caps_switched = false;
+    self->m_last_video_frame_us = now_us;
+    return GST_PAD_PROBE_OK;
+}
+
+void MiracastGstPlayer::setPipelineMode(eMIRA_GSTPLAYER_PIPELINE_MODE pipeline_mode)
+{
+    MIRACASTLOG_INFO("Pipeline mode [%s] for the next session",
+                        (MIRACAST_GSTPLAYER_PIPELINE_MODE_SINGLE == pipeline_mode) ? "single" : "dual");
+    m_pipeline_mode = pipeline_mode;
+}
+
+void MiracastGstPlayer::getLatencyStatistics(MIRACAST_GSTPLAYER_LATENCY_STRUCT &latency)
+{
+    std::lock_guard<std::mutex> lock(m_latency_mutex);
+    latency = m_latency_st;
+}
+
+void MiracastGstPlayer::getPlayerStatistics(MIRACAST_PLAYER_STATISTICS_STRUCT &statistics)
+{
+    std::lock_guard<std::mutex> lock(m_statistics_mutex);
+    statistics = m_statistics_st;
+}
+
+bool MiracastGstPlayer::setVideoSinkConfig(const MIRACAST_GSTPLAYER_SINK_CONFIG_STRUCT &sink_config)
+{
+    if (MIRACAST_GSTPLAYER_VIDEO_SINK_MAX <= sink_config.video_sink)
+    {
+        MIRACASTLOG_ERROR("Invalid video sink [%d]", sink_config.video_sink);
+        return false;
+    }
+    MIRACASTLOG_INFO("Video sink [%s] sync[%d] software decode[%d] for the next session",
+                        video_sink_names[sink_config.video_sink],
+                        sink_config.sync,
+                        sink_config.software_decode);
+    m_sink_config = sink_config;
+    return true;
+}
+
+bool MiracastGstPlayer::setLatencyProfile(eMIRA_GSTPLAYER_LATENCY_PROFILE latency_profile)
+{
+    if (MIRACAST_GSTPLAYER_LATENCY_PROFILE_MAX <= latency_profile)
+    {
+        MIRACASTLOG_ERROR("Invalid latency profile [%d]", latency_profile);
+        return false;
+    }
+    m_latency_profile = latency_profile;
+    resetJitterController();
+    applyLatencyProfile();
+    return true;
+}
+
+void MiracastGstPlayer::resetJitterController()
+{
+    std::lock_guard<std::mutex> lock(m_jitter_mutex);
+    memset(&m_jitter_st, 0x00, sizeof(m_jitter_st));
+    m_jitter_st.latency_ms = m_latency_profiles[m_latency_profile].jitterbuffer_latency_ms;
+}
+
+void MiracastGstPlayer::onJitterBufferDropMessage(GstMessage *message)
+{
+    const GstStructure *structure = gst_message_get_structure(message);
+
+    if ((nullptr == structure) || (!gst_structure_has_name(structure, "drop-msg")))
+    {
+        return;
+    }
+    MIRACASTLOG_VERBOSE("Jitterbuffer dropped a packet, reason [%s]",
+                        gst_structure_get_string(structure, "reason") ? gst_structure_get_string(structure, "reason") : "none");
+
+    std::lock_guard<std::mutex> lock(m_jitter_mutex);
+    m_jitter_st.drop_messages++;
+}
+
+gboolean MiracastGstPlayer::jitterControllerTimeout(gpointer userdata)
+{
+    MiracastGstPlayer *self = static_cast<MiracastGstPlayer*>(userdata);
+    self->updateJitterBufferLatency();
+    return G_SOURCE_CONTINUE;
+}
+
+/* Grows the latency by half as soon as packets are lost, late or dropped, and walks it back
+ * down in small steps once the link has been clean for a while, never below the headroom
+ * the measured jitter needs or outside the bounds of the latency profile. */
+void MiracastGstPlayer::updateJitterBufferLatency()
+{
+    GstStructure *stats = nullptr;
+    guint64 num_lost = 0,
+            num_late = 0,
+            avg_jitter_ns = 0;
+    guint latency_ms = 0;
+
+    if (nullptr == m_rtpjitterbuffer)
+    {
+        return;
+    }
+    g_object_get(G_OBJECT(m_rtpjitterbuffer), "stats", &stats, nullptr);
+    if (stats)
+    {
+        gst_structure_get_uint64(stats, "num-lost", &num_lost);
+        gst_structure_get_uint64(stats, "num-late", &num_late);
+        gst_structure_get_uint64(stats, "avg-jitter", &avg_jitter_ns);
+        gst_structure_free(stats);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_jitter_mutex);
+        const MIRACAST_GSTPLAYER_LATENCY_PROFILE_STRUCT &profile = m_latency_profiles[m_latency_profile];
+        guint64 lost = (num_lost >= m_jitter_st.last_num_lost) ? (num_lost - m_jitter_st.last_num_lost) : num_lost,
+                late = (num_late >= m_jitter_st.last_num_late) ? (num_late - m_jitter_st.last_num_late) : num_late,
+                drops = m_jitter_st.drop_messages;
+        guint floor_ms = static_cast<guint>(std::min<guint64>((avg_jitter_ns / GST_MSECOND) * MIRACAST_GSTPLAYER_JITTER_HEADROOM_FACTOR,
+                                                              profile.jitterbuffer_max_latency_ms));
+
+        floor_ms = std::max(floor_ms, profile.jitterbuffer_min_latency_ms);
+        m_jitter_st.last_num_lost = num_lost;
+        m_jitter_st.last_num_late = num_late;
+        m_jitter_st.drop_messages = 0;
+        latency_ms = m_jitter_st.latency_ms;
+
+        if (0 < (lost + late + drops))
+        {
+            latency_ms += std::max<guint>(latency_ms / 2, MIRACAST_GSTPLAYER_JITTER_MIN_GROW_STEP_MS);
+            m_jitter_st.clean_samples = 0;
+        }
+        else if (latency_ms < floor_ms)
+        {
+            latency_ms = floor_ms;
+            m_jitter_st.clean_samples = 0;
+        }
+        else if ((MIRACAST_GSTPLAYER_JITTER_CLEAN_SAMPLES <= ++m_jitter_st.clean_samples) && (latency_ms > floor_ms))
+        {
+            latency_ms = std::max<guint>(latency_ms - MIRACAST_GSTPLAYER_JITTER_SHRINK_STEP_MS, floor_ms);
+        }
+        latency_ms = std::min(std::max(latency_ms, profile.jitterbuffer_min_latency_ms), profile.jitterbuffer_max_latency_ms);
+
+        if (latency_ms == m_jitter_st.latency_ms)
+        {
+            return;
+        }
+        MIRACASTLOG_INFO("Jitterbuffer latency [%u] -> [%u] ms, lost [%llu] late [%llu] drops [%llu] jitter [%llu] us",
+                            m_jitter_st.latency_ms,
+                            latency_ms,
+                            lost,
+                            late,
+                            drops,
+                            avg_jitter_ns / GST_USECOND);
+        if (latency_ms > m_jitter_st.latency_ms)
+        {
+            m_jitter_st.increases++;
+        }
+        else
+        {
+            m_jitter_st.decreases++;
+        }
+        m_jitter_st.latency_ms = latency_ms;
+    }
+    // Posts a latency message, the bus handler then redistributes the pipeline latency
+    g_object_set(G_OBJECT(m_rtpjitterbuffer), "latency", latency_ms, nullptr);
+}
+
+void MiracastGstPlayer::applyLatencyProfile()
+{
+    const MIRACAST_GSTPLAYER_LATENCY_PROFILE_STRUCT &profile = m_latency_profiles[m_latency_profile];
+
+    MIRACASTLOG_INFO("Latency profile [%s]: jitterbuffer[%ums,mode %d,drop %d] udpsrc[%d] appsrc[%llu,%lld] sink[sync %d]",
+                        profile.name,
+                        profile.jitterbuffer_latency_ms,
+                        profile.jitterbuffer_mode,
+                        profile.jitterbuffer_drop_on_latency,
+                        profile.udpsrc_buffer_size,
+                        profile.appsrc_max_bytes,
+                        profile.appsrc_min_latency_ns,
+                        profile.video_sink_sync);
+
+    if (m_rtpjitterbuffer)
+    {
+        g_object_set(G_OBJECT(m_rtpjitterbuffer),
+                        "latency", profile.jitterbuffer_latency_ms,
+                        "mode", profile.jitterbuffer_mode,
+                        "drop-on-latency", profile.jitterbuffer_drop_on_latency,
+                        nullptr );
+    }
+    // The socket is opened on READY, a running session keeps its receive buffer
+    if ((m_udpsrc) && (nullptr == m_rtp_receiver) && (0 < profile.udpsrc_buffer_size))
+    {
+        g_object_set(G_OBJECT(m_udpsrc), "buffer-size", profile.udpsrc_buffer_size, nullptr);
+    }
+    if (m_appsrc)
+    {
+        g_object_set(G_OBJECT(m_appsrc),
+                        "max-bytes", profile.appsrc_max_bytes,
+                        "min-latency", profile.appsrc_min_latency_ns,
+                        nullptr );
+    }
+    if (m_video_sink)
+    {
+        GObjectClass *sink_class = G_OBJECT_GET_CLASS(m_video_sink);
+
+        if (g_object_class_find_property(sink_class, "sync"))
+        {
+            gboolean sync = (MIRACAST_GSTPLAYER_VIDEO_SINK_WESTEROS == m_active_sink_config.video_sink) ?
+                                profile.video_sink_sync : static_cast<gboolean>(m_active_sink_config.sync);
+
+            g_object_set(G_OBJECT(m_video_sink), "sync", sync, nullptr);
+        }
+        if ((G_MININT64 != profile.video_sink_max_lateness_ns) &&
+            (g_object_class_find_property(sink_class, "max-lateness")))
+        {
+            g_object_set(G_OBJECT(m_video_sink), "max-lateness", profile.video_sink_max_lateness_ns, nullptr);
+        }
+    }
+}
+
+void MiracastGstPlayer::configureRtpSourceElements()
+{
+    /*{{{ udpsrc related element configuration*/
+    MIRACASTLOG_TRACE(">>>>>>>udpsrc configuration start");
+    if (m_rtp_receiver)
+    {
+        // rtp_receive_thread() stamps the arrival time itself
+        MIRACASTLOG_TRACE("RTP receiver listens on port[%u], configure appsrc.",m_rtp_receiver->get_port());
+        g_object_set(G_OBJECT(m_udpsrc), "is-live", TRUE, "format", GST_FORMAT_TIME, "do-timestamp", FALSE, nullptr);
+    }
+    else
+    {
+        MIRACASTLOG_TRACE("Set the port[%llu] and to udp source.",m_streaming_port);
+        g_object_set(G_OBJECT(m_udpsrc), "port", m_streaming_port, nullptr);
+    }
+
+    GstCaps *caps = gst_caps_new_simple("application/x-rtp", "media", G_TYPE_STRING, "video", nullptr);
+    if (caps)
+    {
+        g_object_set(m_udpsrc, "caps", caps, nullptr);
+        gst_caps_unref(caps);
+        MIRACASTLOG_TRACE("Set the caps to udp source.");
+    }
+    else
+    {
+        MIRACASTLOG_ERROR("Unable to Set caps to udp source.");
+    }
+    MIRACASTLOG_TRACE("udpsrc configuration end<<<<<<<<");
+    /*}}}*/
+
+    /*{{{ rtpjitterbuffer related element configuration*/
+    MIRACASTLOG_TRACE(">>>>>>>rtpjitterbuffer configuration start");
+    MIRACASTLOG_TRACE("Set the 'post-drop-messages' and 'do-lost' to rtpjitterbuffer.");
+    g_object_set(G_OBJECT(m_rtpjitterbuffer), "post-drop-messages", true, "do-lost" , true , nullptr );
+    std::string opt_flag_buffer = MiracastCommon::parse_opt_flag("/opt/miracast_faststart-min-packets",true,false);
+
+    if (!opt_flag_buffer.empty())
+    {
+        uint64_t packetsPerBuffer = std::stoull(opt_flag_buffer);
+        MIRACASTLOG_INFO("Set 'faststart-min-packets' to rtpjitterbuffer");
+        g_object_set(G_OBJECT(m_rtpjitterbuffer), "faststart-min-packets", packetsPerBuffer, nullptr );
+    }
+    MIRACASTLOG_TRACE("rtpjitterbuffer configuration end<<<<<<<<");
+    
+    /*}}}*/
+}
+
+bool MiracastGstPlayer::createSinglePipeline()
+{
+    MIRACASTLOG_TRACE("Entering..!!!");
+    GstBus *bus = nullptr;
+    GstElement *demuxer = nullptr;
+
+    MIRACASTLOG_INFO("Creating Single Pipeline...");
+
+    m_playbin_pipeline = gst_pipeline_new("miracast_single_pipeline");
+    if (!m_autoplug_decode)
+    {
+        m_tsdemux = gst_element_factory_make("tsdemux", "miracast_tsdemux");
+    }
+    // decodebin autoplugs the whole stream when tsdemux is not available
+    if (nullptr == m_tsdemux)
+    {
+        m_decodebin = gst_element_factory_make("decodebin", "miracast_decodebin");
+    }
+    demuxer = (m_tsdemux) ? m_tsdemux : m_decodebin;
+
+    if (!m_playbin_pipeline || !m_udpsrc || !m_rtpjitterbuffer || !m_rtpmp2tdepay ||
+        !demuxer || !m_video_sink )
+    {
+        MIRACASTLOG_ERROR("Single Pipeline[%x]: Element creation failure, check below",m_playbin_pipeline);
+        MIRACASTLOG_WARNING("udpsrc[%x]rtpjitterbuffer[%x]rtpmp2tdepay[%x]",m_udpsrc,m_rtpjitterbuffer,m_rtpmp2tdepay);
+        MIRACASTLOG_WARNING("tsdemux[%x]decodebin[%x]videosink[%x]audiosink[%x]",
+                            m_tsdemux,m_decodebin,m_video_sink,m_audio_sink);
+        return false;
+    }
+
+    configureRtpSourceElements();
+
+    bus = gst_element_get_bus(m_playbin_pipeline);
+    gst_bus_add_watch(bus, (GstBusFunc)playbinPipelineBusMessage, this);
+    gst_object_unref(bus);
+
+    configureVideoSink();
+
+    // The sinks are added once the streams are found
+    if (m_tsdemux)
+    {
+        g_signal_connect(m_tsdemux, "pad-added", G_CALLBACK(tsdemuxPadAdded), this);
+    }
+    else
+    {
+        g_signal_connect(m_decodebin, "pad-added", G_CALLBACK(decodebinPadAdded), this);
+    }
+
+    gst_bin_add_many(GST_BIN(m_playbin_pipeline),
+                        m_udpsrc,
+                        m_rtpjitterbuffer,
+                        m_rtpmp2tdepay,
+                        demuxer,
+                        nullptr );
+
+    if (!gst_element_link_many(m_udpsrc,
+                                m_rtpjitterbuffer,
+                                m_rtpmp2tdepay,
+                                demuxer,
+                                nullptr ))
+    {
+        MIRACASTLOG_ERROR("Elements (udpsrc->rtpjitterbuffer->rtpmp2tdepay->%s) could not be linked", GST_ELEMENT_NAME(demuxer));
+        return false;
+    }
+    MIRACASTLOG_TRACE("Exiting..!!!");
+    return true;
+}
+
+/* appsrc ! tsdemux, the decode chains are added from tsdemuxPadAdded() */
+bool MiracastGstPlayer::createDecodePipeline()
+{
+    MIRACASTLOG_TRACE("Entering..!!!");
+    GstElement *appsrc = gst_element_factory_make("appsrc", "miracast_appsrc");
+    GstBus *bus = nullptr;
+
+    m_tsdemux = gst_element_factory_make("tsdemux", "miracast_tsdemux");
+    m_playbin_pipeline = gst_pipeline_new("miracast_decode_pipeline");
+
+    if (!appsrc || !m_tsdemux || !m_playbin_pipeline)
+    {
+        MIRACASTLOG_WARNING("appsrc[%x]tsdemux[%x]pipeline[%x] creation failure, falling back to playbin",
+                            appsrc,m_tsdemux,m_playbin_pipeline);
+        if (appsrc)
+        {
+            gst_object_unref(appsrc);
+        }
+        if (m_tsdemux)
+        {
+            gst_object_unref(m_tsdemux);
+            m_tsdemux = nullptr;
+        }
+        if (m_playbin_pipeline)
+        {
+            gst_object_unref(m_playbin_pipeline);
+            m_playbin_pipeline = nullptr;
+        }
+        return false;
+    }
+
+    gst_bin_add_many(GST_BIN(m_playbin_pipeline), appsrc, m_tsdemux, nullptr);
+    if (!gst_element_link(appsrc, m_tsdemux))
+    {
+        MIRACASTLOG_WARNING("Elements (appsrc->tsdemux) could not be linked, falling back to playbin");
+        gst_object_unref(m_playbin_pipeline);
+        m_playbin_pipeline = nullptr;
+        m_tsdemux = nullptr;
+        return false;
+    }
+    m_appsrc = appsrc;
+    configurePlaybackAppsrc();
+
+    bus = gst_element_get_bus(m_playbin_pipeline);
+    gst_bus_add_watch(bus, (GstBusFunc)playbinPipelineBusMessage, this);
+    gst_object_unref(bus);
+
+    configureVideoSink();
+
+    g_signal_connect(m_tsdemux, "pad-added", G_CALLBACK(tsdemuxPadAdded), this);
+    MIRACASTLOG_TRACE("Exiting..!!!");
+    return true;
+}
+
+bool MiracastGstPlayer::createDualPipeline()
+{
+    MIRACASTLOG_TRACE("Entering..!!!");
+    GstBus *bus = nullptr;
+
+    MIRACASTLOG_INFO("Creating Pipeline...");
+
+    m_customQueueHandle = new MessageRing(MIRACAST_GSTPLAYER_BUFFER_RING_SIZE,gstBufferReleaseCallback);
+
+    if (nullptr == m_customQueueHandle)
+    {
+        MIRACASTLOG_ERROR("Failed to create MessageRing");
+        return false;
     }
-    MIRACASTLOG_TRACE("udpsrc configuration end<<<<<<<<");
-    /*}}}*/
 
-    /*{{{ rtpjitterbuffer related element configuration*/
-    MIRACASTLOG_TRACE(">>>>>>>rtpjitterbuffer configuration start");
-    MIRACASTLOG_TRACE("Set the 'post-drop-messages' and 'do-lost' to rtpjitterbuffer.");
-    g_object_set(G_OBJECT(m_rtpjitterbuffer), "post-drop-messages", true, "do-lost" , true , nullptr );
-    std::string opt_flag_buffer = MiracastCommon::parse_opt_flag("/opt/miracast_faststart-min-packets",true,false);
+    // Create a new pipeline
+    m_append_pipeline = gst_pipeline_new("miracast_data_collector");
+    // Create elements
+    m_tsparse = gst_element_factory_make("tsparse", "miracast_tsparse");
+    m_appsink = gst_element_factory_make("appsink", "miracast_appsink");
 
-    if (!opt_flag_buffer.empty())
+    if (!m_append_pipeline || !m_udpsrc || !m_rtpjitterbuffer || !m_rtpmp2tdepay ||
+        !m_tsparse || !m_appsink || !m_video_sink )
     {
-        uint64_t packetsPerBuffer = std::stoull(opt_flag_buffer);
-        MIRACASTLOG_INFO("Set 'faststart-min-packets' to rtpjitterbuffer");
-        g_object_set(G_OBJECT(m_rtpjitterbuffer), "faststart-min-packets", packetsPerBuffer, nullptr );
+        MIRACASTLOG_ERROR("Append Pipeline[%x]: Element creation failure, check below",m_append_pipeline);
+        MIRACASTLOG_WARNING("udpsrc[%x]rtpjitterbuffer[%x]rtpmp2tdepay[%x]",m_udpsrc,m_rtpjitterbuffer,m_rtpmp2tdepay);
+        MIRACASTLOG_WARNING("tsparse[%x]appsink[%x]videosink[%x]audiosink[%x]",
+                            m_tsparse,m_appsink,m_video_sink,m_audio_sink);
+        return false;
     }
-    MIRACASTLOG_TRACE("rtpjitterbuffer configuration end<<<<<<<<");
-    
-    /*}}}*/
+
+    configureRtpSourceElements();
 
     /*{{{ tsparse related element configuration*/
     MIRACASTLOG_TRACE(">>>>>>>tsparse configuration start");
     MIRACASTLOG_TRACE("Set 'set-timestamps' to tsparse");
     g_object_set(G_OBJECT(m_tsparse), "set-timestamps", true, nullptr );
-    opt_flag_buffer = MiracastCommon::parse_opt_flag("/opt/miracast_tsparse_alignment",true,false);
+    std::string opt_flag_buffer = MiracastCommon::parse_opt_flag("/opt/miracast_tsparse_alignment",true,false);
 
     if (!opt_flag_buffer.empty())
     {
@@ -842,7 +3034,15 @@ bool MiracastGstPlayer::createPipeline()
     {
         MIRACASTLOG_ERROR("Elements (udpsrc->rtpjitterbuffer->queue->rtpmp2tdepay->tsparse->appsink) could not be linked");
         gst_object_unref(m_append_pipeline);
-        return -1;
+        m_append_pipeline = nullptr;
+        return false;
+    }
+
+    // playbin typefinds and autoplugs, so it is only the fallback
+    if ((!m_autoplug_decode) && (createDecodePipeline()))
+    {
+        MIRACASTLOG_TRACE("Exiting..!!!");
+        return true;
     }
 
     // Set up pipeline
@@ -873,30 +3073,191 @@ bool MiracastGstPlayer::createPipeline()
 
         g_signal_connect(m_playbin_pipeline, "source-setup", G_CALLBACK(source_setup), this);
         
-        /*{{{ westerossink related element configuration*/
-        MIRACASTLOG_TRACE(">>>>>>>westerossink configuration start");
-        updateVideoSinkRectangle();
-
-        g_signal_connect(m_video_sink, "first-video-frame-callback",G_CALLBACK(onFirstVideoFrameCallback), (gpointer)this);
-        MIRACASTLOG_TRACE("westerossink configuration end<<<<<<<<");
+        configureVideoSink();
         g_object_set(m_playbin_pipeline, "video-sink", m_video_sink, nullptr);
-        /*}}}*/
 
 	if (m_audio_sink)
         {
 	    g_object_set(m_playbin_pipeline, "audio-sink", m_audio_sink, nullptr);
         }
     }
+    MIRACASTLOG_TRACE("Exiting..!!!");
+    return true;
+}
+
+/* westerossink, or the headless sink of the sink config. Only the headless sinks are set up here */
+GstElement *MiracastGstPlayer::createVideoSink()
+{
+    GstElement *video_sink = nullptr;
+
+    switch (m_active_sink_config.video_sink)
+    {
+        case MIRACAST_GSTPLAYER_VIDEO_SINK_FAKESINK:
+            video_sink = gst_element_factory_make("fakesink", "miracast_video_fakesink");
+            if (video_sink)
+            {
+                g_object_set(G_OBJECT(video_sink), "signal-handoffs", TRUE, nullptr);
+                g_signal_connect(video_sink, "handoff", G_CALLBACK(fakesinkHandoff), this);
+            }
+            break;
+        case MIRACAST_GSTPLAYER_VIDEO_SINK_APPSINK:
+            video_sink = gst_element_factory_make("appsink", "miracast_video_appsink");
+            if (video_sink)
+            {
+                // A consumer falling behind loses the older frames instead of stalling the decoder
+                g_object_set(G_OBJECT(video_sink),
+                                "emit-signals", TRUE,
+                                "max-buffers", 1,
+                                "drop", TRUE,
+                                nullptr );
+                g_signal_connect(video_sink, "new-sample", G_CALLBACK(appsinkNewSample), this);
+            }
+            break;
+        default:
+            video_sink = gst_element_factory_make("westerossink", "miracast_westerossink");
+            break;
+    }
+    MIRACASTLOG_INFO("Video sink [%s] sync[%d] software decode[%d]",
+                        video_sink_names[m_active_sink_config.video_sink],
+                        m_active_sink_config.sync,
+                        m_active_sink_config.software_decode);
+    return video_sink;
+}
+
+void MiracastGstPlayer::configureVideoSink()
+{
+    // The headless sinks report their first frame through the callbacks set in createVideoSink()
+    if (MIRACAST_GSTPLAYER_VIDEO_SINK_WESTEROS != m_active_sink_config.video_sink)
+    {
+        return;
+    }
+    /*{{{ westerossink related element configuration*/
+    MIRACASTLOG_TRACE(">>>>>>>westerossink configuration start");
+    updateVideoSinkRectangle();
+
+    g_signal_connect(m_video_sink, "first-video-frame-callback",G_CALLBACK(onFirstVideoFrameCallback), (gpointer)this);
+    MIRACASTLOG_TRACE("westerossink configuration end<<<<<<<<");
+    /*}}}*/
+}
+
+bool MiracastGstPlayer::createPipeline()
+{
+    MIRACASTLOG_TRACE("Entering..!!!");
+    GstStateChangeReturn ret;
+    uint64_t setup_start_us = MiracastCommon::get_monotonic_time_us(),
+             setup_us = 0;
+    // What the idle pipeline of the previous session was built for
+    eMIRA_GSTPLAYER_PIPELINE_MODE idle_pipeline_mode = m_active_pipeline_mode;
+    MIRACAST_GSTPLAYER_SINK_CONFIG_STRUCT idle_sink_config = m_active_sink_config;
+    bool idle_autoplug_decode = m_autoplug_decode,
+         idle_ts_inspector_enabled = m_ts_inspector_enabled,
+         reused = false,
+         return_value = true;
+
+    m_active_pipeline_mode = m_pipeline_mode;
+    if (!MiracastCommon::parse_opt_flag("/opt/miracast_single_pipeline").empty())
+    {
+        m_active_pipeline_mode = MIRACAST_GSTPLAYER_PIPELINE_MODE_SINGLE;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_latency_mutex);
+        memset(&m_latency_st, 0x00, sizeof(m_latency_st));
+    }
+    m_video_linked = false;
+    m_audio_linked = false;
+    m_format_switch_request_us = 0;
+    m_last_video_frame_us = 0;
+    m_video_caps_switched = false;
+    resetJitterController();
+    resetStatistics();
+    m_ts_inspector.reset();
+    m_ts_inspector_enabled = MiracastCommon::parse_opt_flag("/opt/miracast_disable_ts_inspector").empty();
+    m_prewarm_enabled = MiracastCommon::parse_opt_flag("/opt/miracast_disable_prewarm").empty();
+    m_autoplug_decode = !MiracastCommon::parse_opt_flag("/opt/miracast_autoplug_decode").empty();
+    if (!MiracastCommon::parse_opt_flag("/opt/miracast_element_tracer").empty())
+    {
+        m_element_tracer = true;
+    }
+    m_active_sink_config = m_sink_config;
+    std::string video_sink_flag = MiracastCommon::parse_opt_flag("/opt/miracast_video_sink");
+    if ((!video_sink_flag.empty()) && (!parse_video_sink_flag(video_sink_flag, m_active_sink_config)))
+    {
+        MIRACASTLOG_WARNING("Unknown video sink [%s] in /opt/miracast_video_sink", video_sink_flag.c_str());
+    }
+    m_firstVideoFrameReceived = false;
+    {
+        // A format of the previous session must not be mistaken for this one
+        std::lock_guard<std::mutex> lock(m_format_mutex);
+        m_format_valid = false;
+    }
+    // Read once per session, the collector itself never touches the file system
+    std::string stats_log_interval = MiracastCommon::parse_opt_flag("/opt/miracast_player_stats",true,false);
+    m_statistics_log_interval = (stats_log_interval.empty()) ? 0 : static_cast<unsigned int>(std::max(1, std::atoi(stats_log_interval.c_str())));
+
+    m_reuse_pipeline = !MiracastCommon::parse_opt_flag("/opt/miracast_reuse_pipeline").empty();
+    m_pipeline_failed = false;
+
+    if (m_pipeline_idle)
+    {
+        if ((idle_pipeline_mode == m_active_pipeline_mode) &&
+            (idle_sink_config.video_sink == m_active_sink_config.video_sink) &&
+            (idle_sink_config.sync == m_active_sink_config.sync) &&
+            (idle_sink_config.software_decode == m_active_sink_config.software_decode) &&
+            (idle_autoplug_decode == m_autoplug_decode) &&
+            (idle_ts_inspector_enabled == m_ts_inspector_enabled))
+        {
+            reused = reuseIdlePipeline();
+        }
+        if (!reused)
+        {
+            MIRACASTLOG_INFO("Pipeline of the previous session does not fit this one, building a new one");
+            releasePipeline();
+        }
+    }
+    if ((!reused) && (!buildPipeline()))
+    {
+        return false;
+    }
+    if (nullptr != m_customQueueHandle)
+    {
+        int event_fd = m_customQueueHandle->get_event_fd();
+
+        if (-1 == event_fd)
+        {
+            return false;
+        }
+        m_pushbuffer_source = g_unix_fd_source_new(event_fd, G_IO_IN);
+        g_source_set_callback(m_pushbuffer_source, (GSourceFunc)pushbufferHandler, this, nullptr);
+        g_source_attach(m_pushbuffer_source, m_main_loop_context);
+    }
+    applyLatencyProfile();
+
+    if (MiracastCommon::parse_opt_flag("/opt/miracast_fixed_jitterbuffer").empty())
+    {
+        m_jitter_source = g_timeout_source_new_seconds(MIRACAST_GSTPLAYER_JITTER_SAMPLE_INTERVAL_MS / 1000);
+        g_source_set_callback(m_jitter_source, jitterControllerTimeout, this, nullptr);
+        g_source_attach(m_jitter_source, m_main_loop_context);
+    }
+
+    // Whole seconds, so that GLib runs it in the same wake-up as the jitter controller
+    m_statistics_source = g_timeout_source_new_seconds(MIRACAST_GSTPLAYER_STATISTICS_INTERVAL_MS / 1000);
+    g_source_set_callback(m_statistics_source, statisticsCollectorTimeout, this, nullptr);
+    g_source_attach(m_statistics_source, m_main_loop_context);
 
-    g_main_context_pop_thread_default(m_main_loop_context);
     pthread_create(&m_playback_thread, nullptr, MiracastGstPlayer::playbackThread, this);
-    pthread_create(&m_player_statistics_tid, nullptr, MiracastGstPlayer::monitor_player_statistics_thread, this);
-    pthread_create(&m_pushbuffer_handler_tid, nullptr, MiracastGstPlayer::pushbuffer_handler_thread, this);
+    if (m_rtp_receiver)
+    {
+        m_rtp_receive_loop = true;
+        pthread_create(&m_rtp_receive_tid, nullptr, MiracastGstPlayer::rtp_receive_thread, this);
+    }
 
     /* launching things */
     MIRACASTLOG_INFO("m_playbin_pipeline, GST_STATE_PLAYING");
     ret = gst_element_set_state(m_playbin_pipeline, GST_STATE_PLAYING);
-    ret = gst_element_set_state(m_append_pipeline, GST_STATE_PLAYING);
+    if (m_append_pipeline)
+    {
+        ret = gst_element_set_state(m_append_pipeline, GST_STATE_PLAYING);
+    }
 
     if (ret == GST_STATE_CHANGE_FAILURE)
     {
@@ -908,14 +3269,128 @@ bool MiracastGstPlayer::createPipeline()
         MIRACASTLOG_TRACE("Streaming live");
         m_is_live = true;
     }
+    setup_us = MiracastCommon::get_monotonic_time_us() - setup_start_us;
+    {
+        std::lock_guard<std::mutex> lock(m_statistics_mutex);
+        m_statistics_st.pipeline_reused = reused;
+        m_statistics_st.pipeline_setup_us = setup_us;
+    }
+    MIRACASTLOG_INFO("Pipeline %s and started in [%.3f] ms", (reused) ? "reused" : "built", setup_us / 1000.0);
 
     MIRACASTLOG_TRACE("Exiting..!!!");
     return return_value;
 }
 
+/* recvmmsg receiver on the port of the session, grown to the negotiated level by prewarmDecodeChain() once M4 is through */
+bool MiracastGstPlayer::openRTPReceiver()
+{
+    const MIRACAST_GSTPLAYER_LATENCY_PROFILE_STRUCT &profile = m_latency_profiles[m_latency_profile];
+
+    m_rtp_receiver = new MiracastRTPReceiver(getRTPPoolSize(0));
+    if (m_rtp_receiver->open(static_cast<unsigned short>(m_streaming_port),
+                                std::max(profile.udpsrc_buffer_size, static_cast<gint>(RTP_RECEIVER_DFLT_RCVBUF_SIZE))))
+    {
+        return true;
+    }
+    MIRACASTLOG_ERROR("Unable to open the RTP receiver on port[%llu]", m_streaming_port);
+    delete m_rtp_receiver;
+    m_rtp_receiver = nullptr;
+    return false;
+}
+
+bool MiracastGstPlayer::buildPipeline()
+{
+    MIRACASTLOG_TRACE("Entering..!!!");
+    GstPad *video_sink_pad = nullptr;
+    bool return_value = true;
+
+    /* create gst pipeline */
+    m_main_loop_context = g_main_context_new();
+    g_main_context_push_thread_default(m_main_loop_context);
+    m_main_loop = g_main_loop_new(m_main_loop_context, FALSE);
+
+    // Create elements
+    if ((MiracastCommon::parse_opt_flag("/opt/miracast_use_udpsrc").empty()) && (openRTPReceiver()))
+    {
+        m_udpsrc = gst_element_factory_make("appsrc", "miracast_rtpsrc");
+    }
+    if (nullptr == m_udpsrc)
+    {
+        m_udpsrc = gst_element_factory_make("udpsrc", "miracast_udpsrc");
+    }
+    m_rtpjitterbuffer = gst_element_factory_make("rtpjitterbuffer", "miracast_rtpjitterbuffer");
+    m_rtpmp2tdepay = gst_element_factory_make("rtpmp2tdepay", "miracast_rtpmp2tdepay");
+    m_video_sink = createVideoSink();
+    m_soc_audio_sink = (MIRACAST_GSTPLAYER_VIDEO_SINK_WESTEROS == m_active_sink_config.video_sink);
+    if (m_soc_audio_sink)
+    {
+        m_audio_sink = SoC_GetAudioSinkProperty();
+    }
+    else
+    {
+        // Headless, nothing of the SoC is touched and the audio is decoded and dropped as well
+        m_audio_sink = gst_element_factory_make("fakesink", "miracast_audio_fakesink");
+        if (m_audio_sink)
+        {
+            g_object_set(G_OBJECT(m_audio_sink), "sync", static_cast<gboolean>(m_active_sink_config.sync), nullptr);
+        }
+    }
+
+    if (MIRACAST_GSTPLAYER_PIPELINE_MODE_SINGLE == m_active_pipeline_mode)
+    {
+        return_value = createSinglePipeline();
+    }
+    else
+    {
+        return_value = createDualPipeline();
+    }
+    if (!return_value)
+    {
+        g_main_context_pop_thread_default(m_main_loop_context);
+        if (m_rtp_receiver)
+        {
+            delete m_rtp_receiver;
+            m_rtp_receiver = nullptr;
+        }
+        return false;
+    }
+
+    GstPad *ingress_pad = gst_element_get_static_pad(m_rtpjitterbuffer, "sink");
+    if (ingress_pad)
+    {
+        gst_pad_add_probe(ingress_pad, static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST), ingressStatisticsProbe, this, nullptr);
+        gst_object_unref(ingress_pad);
+    }
+
+    if (m_ts_inspector_enabled)
+    {
+        GstPad *ts_pad = gst_element_get_static_pad((m_tsparse) ? m_tsparse : m_rtpmp2tdepay, "src");
+        if (ts_pad)
+        {
+            gst_pad_add_probe(ts_pad, static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST), tsInspectorProbe, this, nullptr);
+            gst_object_unref(ts_pad);
+        }
+    }
+
+    // Both modes end in the same video sink, so the latency is measured there
+    video_sink_pad = gst_element_get_static_pad(m_video_sink, "sink");
+    if (video_sink_pad)
+    {
+        gst_pad_add_probe(video_sink_pad, GST_PAD_PROBE_TYPE_BUFFER, videoSinkLatencyProbe, this, nullptr);
+        gst_pad_add_probe(video_sink_pad, static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM), videoSinkFormatProbe, this, nullptr);
+        gst_object_unref(video_sink_pad);
+    }
+
+    g_main_context_pop_thread_default(m_main_loop_context);
+    MIRACASTLOG_TRACE("Exiting..!!!");
+    return true;
+}
+
 bool MiracastGstPlayer::stop()
 {
     GstStateChangeReturn ret;
+    // READY keeps what the sinks and decoders allocated, NULL releases it
+    GstState stop_state = ((m_reuse_pipeline) && (!m_pipeline_failed)) ? GST_STATE_READY : GST_STATE_NULL;
     MIRACASTLOG_TRACE("Entering..");
 
     if (!m_playbin_pipeline)
@@ -923,29 +3398,67 @@ bool MiracastGstPlayer::stop()
         MIRACASTLOG_ERROR("Pipeline is NULL");
         return false;
     }
-    m_pushBufferLoop = false;
-
-    if (m_customQueueHandle)
+    if (m_pipeline_idle)
+    {
+        // No session left, only the pipeline kept for the next one
+        MIRACASTLOG_INFO("Releasing the pipeline kept for the next session");
+        releasePipeline();
+        MIRACASTLOG_TRACE("Exiting..");
+        return true;
+    }
+    if (m_pushbuffer_source)
     {
         MIRACASTLOG_INFO("detaching MsgQ");
-        m_customQueueHandle->detachQueue();
-        if(m_pushbuffer_handler_tid)
-        {
-            pthread_join(m_pushbuffer_handler_tid,nullptr);
-        }
+        g_source_destroy(m_pushbuffer_source);
+        g_source_unref(m_pushbuffer_source);
+        m_pushbuffer_source = nullptr;
+    }
+    if (m_rtp_receive_tid)
+    {
+        m_rtp_receive_loop = false;
+        m_rtp_receiver->interrupt();
+        pthread_join(m_rtp_receive_tid,nullptr);
+        m_rtp_receive_tid = 0;
     }
 
-    ret = gst_element_set_state(m_playbin_pipeline, GST_STATE_NULL);
+    ret = gst_element_set_state(m_playbin_pipeline, stop_state);
     if (ret == GST_STATE_CHANGE_FAILURE)
     {
-        MIRACASTLOG_ERROR("Failed to set gst_element_set_state as NULL");
+        MIRACASTLOG_ERROR("Failed to set gst_element_set_state as %s", gst_element_state_get_name(stop_state));
+        m_pipeline_failed = true;
     }
-    ret = gst_element_set_state(m_append_pipeline, GST_STATE_NULL);
-    if (ret == GST_STATE_CHANGE_FAILURE)
+    // The RTP source side always goes down to NULL, the next session binds another port
+    if ((GST_STATE_READY == stop_state) && (nullptr == m_append_pipeline))
+    {
+        gst_element_set_state(m_udpsrc, GST_STATE_NULL);
+    }
+    if (m_append_pipeline)
     {
-        MIRACASTLOG_ERROR("Failed to set gst_element_set_state as NULL");
+        ret = gst_element_set_state(m_append_pipeline, GST_STATE_NULL);
+        if (ret == GST_STATE_CHANGE_FAILURE)
+        {
+            MIRACASTLOG_ERROR("Failed to set gst_element_set_state as NULL");
+        }
     }
 
+    if (m_jitter_source)
+    {
+        g_source_destroy(m_jitter_source);
+        g_source_unref(m_jitter_source);
+        m_jitter_source = nullptr;
+    }
+    if (m_statistics_source)
+    {
+        g_source_destroy(m_statistics_source);
+        g_source_unref(m_statistics_source);
+        m_statistics_source = nullptr;
+    }
+    if (m_prewarm_source)
+    {
+        g_source_destroy(m_prewarm_source);
+        g_source_unref(m_prewarm_source);
+        m_prewarm_source = nullptr;
+    }
     if (m_main_loop)
     {
         g_main_loop_quit(m_main_loop);
@@ -954,16 +3467,103 @@ bool MiracastGstPlayer::stop()
     {
         pthread_join(m_playback_thread,nullptr);
     }
-    if (m_player_statistics_tid)
+    // Taken up again by the collector of the next session
+    detachElementTracer();
+    if (m_rtsp_reference_instance)
     {
-        m_statistics_thread_loop = false;
-        pthread_join(m_player_statistics_tid,nullptr);
+        MIRACAST_PLAYER_STATISTICS_STRUCT statistics;
+        {
+            std::lock_guard<std::mutex> lock(m_statistics_mutex);
+            m_statistics_st.streaming = false;
+            statistics = m_statistics_st;
+        }
+        m_rtsp_reference_instance->update_PlayerStatistics(statistics);
     }
-    GstBus *bus = gst_pipeline_get_bus(GST_PIPELINE(m_append_pipeline));
-    if (bus)
+    if ((GST_STATE_READY == stop_state) && (!m_pipeline_failed))
     {
-        gst_bus_set_sync_handler(bus, nullptr, nullptr, nullptr);
-        gst_object_unref(bus);
+        // Only what belongs to the session goes, reuseIdlePipeline() sets it up again
+        if (m_customQueueHandle)
+        {
+            MIRACASTLOG_INFO("Flushing MsgQ");
+            delete m_customQueueHandle;
+            m_customQueueHandle = nullptr;
+        }
+        if (m_rtp_receiver)
+        {
+            delete m_rtp_receiver;
+            m_rtp_receiver = nullptr;
+        }
+        // playbin sets up a new source on its way up again, handed over by source_setup()
+        if (nullptr == m_tsdemux)
+        {
+            m_appsrc = nullptr;
+        }
+        m_pipeline_idle = true;
+        MIRACASTLOG_INFO("Pipeline kept in READY for the next session");
+    }
+    else
+    {
+        releasePipeline();
+    }
+    MIRACASTLOG_TRACE("Exiting..");
+    return true;
+}
+
+/*
+ * Takes the pipeline kept by stop() for this session. The jitterbuffer and
+ * tsdemux came back empty from NULL and READY, and tsdemuxPadAdded() links the
+ * kept chains to the new pads. What is set up again belongs to the session:
+ * the RTP source on the new port and the buffer ring of the dual pipeline.
+ */
+bool MiracastGstPlayer::reuseIdlePipeline()
+{
+    bool use_rtp_receiver = MiracastCommon::parse_opt_flag("/opt/miracast_use_udpsrc").empty();
+
+    MIRACASTLOG_TRACE("Entering..!!!");
+    // The receiver feeds an appsrc, udpsrc is another element in front of the jitterbuffer
+    if (use_rtp_receiver != static_cast<bool>(GST_IS_APP_SRC(m_udpsrc)))
+    {
+        MIRACASTLOG_TRACE("Exiting..!!!");
+        return false;
+    }
+    if ((use_rtp_receiver) && (!openRTPReceiver()))
+    {
+        MIRACASTLOG_TRACE("Exiting..!!!");
+        return false;
+    }
+    if (m_append_pipeline)
+    {
+        m_customQueueHandle = new MessageRing(MIRACAST_GSTPLAYER_BUFFER_RING_SIZE,gstBufferReleaseCallback);
+    }
+    configureRtpSourceElements();
+    updateVideoSinkRectangle();
+    m_pipeline_idle = false;
+    MIRACASTLOG_INFO("Reusing the pipeline of the previous session on port[%llu]", m_streaming_port);
+    MIRACASTLOG_TRACE("Exiting..!!!");
+    return true;
+}
+
+/* Everything the pipelines hold, after stop() has ended the session */
+void MiracastGstPlayer::releasePipeline()
+{
+    MIRACASTLOG_TRACE("Entering..");
+    // Already down to NULL, unless the pipeline was kept in READY
+    gst_element_set_state(m_playbin_pipeline, GST_STATE_NULL);
+    if (m_append_pipeline)
+    {
+        gst_element_set_state(m_append_pipeline, GST_STATE_NULL);
+    }
+
+    GstBus *bus = nullptr;
+
+    if (m_append_pipeline)
+    {
+        bus = gst_pipeline_get_bus(GST_PIPELINE(m_append_pipeline));
+        if (bus)
+        {
+            gst_bus_set_sync_handler(bus, nullptr, nullptr, nullptr);
+            gst_object_unref(bus);
+        }
     }
 
     bus = gst_pipeline_get_bus(GST_PIPELINE(m_playbin_pipeline));
@@ -975,7 +3575,14 @@ bool MiracastGstPlayer::stop()
 
     if (m_audio_sink)
     {
-        SoC_ReleaseAudioSinkProperty(m_audio_sink);
+        if (m_soc_audio_sink)
+        {
+            SoC_ReleaseAudioSinkProperty(m_audio_sink);
+        }
+        else
+        {
+            gst_object_unref(m_audio_sink);
+        }
         m_audio_sink = nullptr;
     }
 
@@ -985,6 +3592,14 @@ bool MiracastGstPlayer::stop()
         m_video_sink = nullptr;
     }
 
+    if (nullptr == m_append_pipeline)
+    {
+        // Single pipeline mode, the pipeline owns these and releases them with itself
+        m_udpsrc = nullptr;
+        m_rtpjitterbuffer = nullptr;
+        m_rtpmp2tdepay = nullptr;
+        m_decodebin = nullptr;
+    }
     if (m_tsparse)
     {
         gst_bin_remove(GST_BIN(m_append_pipeline), m_tsparse);
@@ -1001,7 +3616,7 @@ bool MiracastGstPlayer::stop()
     {
         gst_bin_remove(GST_BIN(m_append_pipeline), m_rtpjitterbuffer);
         gst_object_unref(m_rtpjitterbuffer);
-        m_tsparse = nullptr;
+        m_rtpjitterbuffer = nullptr;
     }
     if (m_udpsrc)
     {
@@ -1034,12 +3649,33 @@ bool MiracastGstPlayer::stop()
         gst_caps_unref(m_capsSrc);
         m_capsSrc = nullptr;
     }
+    // Owned by playbin or the decode pipeline
+    m_appsrc = nullptr;
+    m_tsdemux = nullptr;
+    m_video_chain = nullptr;
+    m_audio_chain = nullptr;
+    if (m_video_chain_caps)
+    {
+        gst_caps_unref(m_video_chain_caps);
+        m_video_chain_caps = nullptr;
+    }
+    if (m_audio_chain_caps)
+    {
+        gst_caps_unref(m_audio_chain_caps);
+        m_audio_chain_caps = nullptr;
+    }
+    // Only now that the pipelines are gone every slot is back in the pool
+    if (m_rtp_receiver)
+    {
+        delete m_rtp_receiver;
+        m_rtp_receiver = nullptr;
+    }
     if (m_customQueueHandle)
     {
         MIRACASTLOG_INFO("Flushing MsgQ");
         delete m_customQueueHandle;
         m_customQueueHandle = nullptr;
     }
+    m_pipeline_idle = false;
     MIRACASTLOG_TRACE("Exiting..");
-    return true;
-}
\ No newline at end of file
+}
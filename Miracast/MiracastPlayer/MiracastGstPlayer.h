@@ -22,12 +22,17 @@
 
 #include <string>
 #include <vector>
+#include <mutex>
 #include <gst/gst.h>
 #include <gst/app/gstappsink.h>
 #include <gst/app/gstappsrc.h>
 #include <glib.h>
 #include <pthread.h>
 #include <stdint.h>
+#include <atomic>
+#include <memory>
+#include "MiracastRTPReceiver.h"
+#include "MiracastTSInspector.h"
 
 /**
  * @enum GstPlayFlags
@@ -47,12 +52,91 @@ typedef enum {
 	GST_PLAY_FLAG_SOFT_COLORBALANCE = (1 << 10) /**< value is 0x400 */
 }GstPlayFlags;
 
+typedef struct miracast_gstplayer_latency_st
+{
+    uint64_t frames;
+    /* UDP ingress until the frame reaches the video sink */
+    uint64_t ingress_to_sink_sum_us;
+    uint64_t ingress_to_sink_max_us;
+    /* UDP ingress until the frame is due on screen */
+    uint64_t ingress_to_render_sum_us;
+    uint64_t ingress_to_render_min_us;
+    uint64_t ingress_to_render_max_us;
+} MIRACAST_GSTPLAYER_LATENCY_STRUCT;
+
+typedef struct miracast_gstplayer_latency_profile_st
+{
+    const char *name;
+    /* rtpjitterbuffer, the latency is adapted to the link within the min/max bounds */
+    guint jitterbuffer_latency_ms;
+    guint jitterbuffer_min_latency_ms;
+    guint jitterbuffer_max_latency_ms;
+    /* 0:none, 1:slave, 2:buffer, 4:synced */
+    gint jitterbuffer_mode;
+    gboolean jitterbuffer_drop_on_latency;
+    /* udpsrc SO_RCVBUF in bytes, 0 keeps the kernel default */
+    gint udpsrc_buffer_size;
+    /* playbin appsrc of the dual pipeline */
+    guint64 appsrc_max_bytes;
+    gint64 appsrc_min_latency_ns;
+    /* video sink */
+    gboolean video_sink_sync;
+    /* -1 renders every late frame, G_MININT64 keeps the sink default */
+    gint64 video_sink_max_lateness_ns;
+} MIRACAST_GSTPLAYER_LATENCY_PROFILE_STRUCT;
+
+typedef struct miracast_gstplayer_jitter_controller_st
+{
+    guint latency_ms;
+    /* rtpjitterbuffer stats at the previous sample */
+    guint64 last_num_lost;
+    guint64 last_num_late;
+    /* drop-msg posted since the previous sample */
+    guint64 drop_messages;
+    guint clean_samples;
+    guint64 increases;
+    guint64 decreases;
+} MIRACAST_GSTPLAYER_JITTER_CONTROLLER_STRUCT;
+
+/* Inputs an element may hold before the oldest is given up, a jitterbuffer holds a few hundred RTP packets */
+#define MIRACAST_GSTPLAYER_TRACE_PENDING_SIZE   ( 1024 )
+
+typedef struct miracast_gstplayer_trace_pending_st
+{
+    /* Identity of the buffer, the timestamp for an element handing on a new one */
+    const GstBuffer *buffer;
+    GstClockTime pts;
+    uint64_t in_us;
+} MIRACAST_GSTPLAYER_TRACE_PENDING_STRUCT;
+
+/* An element, or the appsink to appsrc hop of the dual pipeline, as the element tracer sees it */
+typedef struct miracast_gstplayer_traced_element_st
+{
+    std::string name;
+    /* Held until the tracer lets go, nullptr for the hop */
+    GstElement *element;
+    /* Pads with a probe of the tracer, held as well. Touched on the main loop only */
+    std::vector<std::pair<GstPad*, gulong>> probes;
+    /* The rest is shared with the streaming threads of the element */
+    std::mutex mutex;
+    MIRACAST_GSTPLAYER_TRACE_PENDING_STRUCT pending[MIRACAST_GSTPLAYER_TRACE_PENDING_SIZE];
+    unsigned int pending_first;
+    unsigned int pending_count;
+    uint64_t buffers_in;
+    uint64_t buffers_out;
+    uint64_t latency_avg_us;
+    uint64_t latency_max_us;
+    uint64_t latency_peak_us;
+    uint32_t in_flight_max;
+} MIRACAST_GSTPLAYER_TRACED_ELEMENT_STRUCT;
+
 class MiracastGstPlayer
 {
 public:
     static MiracastGstPlayer *getInstance();
     static void destroyInstance();
     bool launch(std::string& localip , std::string& streaming_port,MiracastRTSPMsg *rtsp_instance);
+    /* With /opt/miracast_reuse_pipeline the pipeline is kept for the next launch(), a stop() without a session releases it */
     bool stop();
     bool pause();
     bool resume();
@@ -62,25 +146,78 @@ public:
     bool seekTo(double seconds,GstElement *pipeline = nullptr);
     double getCurrentPosition(GstElement *pipeline = nullptr);
     bool get_player_statistics();
+    /* Takes effect on the next launch(), /opt/miracast_single_pipeline forces the single pipeline */
+    void setPipelineMode(eMIRA_GSTPLAYER_PIPELINE_MODE pipeline_mode);
+    eMIRA_GSTPLAYER_PIPELINE_MODE getPipelineMode() const { return m_pipeline_mode; }
+    void getLatencyStatistics(MIRACAST_GSTPLAYER_LATENCY_STRUCT &latency);
+    /* Snapshot of the last collector run, the same numbers the RTSP handler gets */
+    void getPlayerStatistics(MIRACAST_PLAYER_STATISTICS_STRUCT &statistics);
+    /* Applied to the running pipeline right away, udpsrc buffer-size only on the next launch() */
+    bool setLatencyProfile(eMIRA_GSTPLAYER_LATENCY_PROFILE latency_profile);
+    eMIRA_GSTPLAYER_LATENCY_PROFILE getLatencyProfile() const { return m_latency_profile; }
+    /* Takes effect on the next launch(), /opt/miracast_video_sink overrides it */
+    bool setVideoSinkConfig(const MIRACAST_GSTPLAYER_SINK_CONFIG_STRUCT &sink_config);
+    const MIRACAST_GSTPLAYER_SINK_CONFIG_STRUCT &getVideoSinkConfig() const { return m_sink_config; }
     void print_pipeline_state(GstElement *pipeline = nullptr);
+    /* Format selected in M4, the decode chain is prepared for it before the first packet arrives.
+     * A format set while the stream runs is switched to without stopping the pipeline */
+    bool setNegotiatedFormat(const RTSP_WFD_VIDEO_FMT_STRUCT &video_format, const RTSP_WFD_AUDIO_FMT_STRUCT &audio_format);
+    /* Taken by the running pipeline at the next collector run, /opt/miracast_element_tracer switches it on for a session */
+    void setElementTracer(bool enable);
 
 private:
     GstElement  *m_append_pipeline{nullptr};
+    /* udpsrc, or the appsrc fed by m_rtp_receiver */
     GstElement  *m_udpsrc{nullptr};
     GstElement  *m_rtpjitterbuffer{nullptr};
     GstElement  *m_rtpmp2tdepay{nullptr};
     GstElement  *m_Queue{nullptr};
     GstElement  *m_tsparse{nullptr};
     GstElement  *m_appsink{nullptr};
+    GstElement  *m_decodebin{nullptr};
+    /* In front of the chains built from the negotiated format, unless /opt/miracast_autoplug_decode is present */
+    GstElement  *m_tsdemux{nullptr};
+    bool m_autoplug_decode{false};
+    /* First element behind the tsdemux pad of each stream, owned by the pipeline */
+    GstElement  *m_video_chain{nullptr};
+    GstElement  *m_audio_chain{nullptr};
+    /* Caps of the tsdemux pad each chain was built for, a replacement pad they do not fit gets a new chain */
+    GstCaps     *m_video_chain_caps{nullptr};
+    GstCaps     *m_audio_chain_caps{nullptr};
 
+    /* playbin or appsrc->tsdemux, or the whole udpsrc to sinks pipeline in single pipeline mode */
     GstElement  *m_playbin_pipeline{nullptr};
-    GstElement  *m_appsrc;
-    GstCaps     *m_capsSrc;
+    GstElement  *m_appsrc{nullptr};
+    GstCaps     *m_capsSrc{nullptr};
 
     bool m_firstVideoFrameReceived{false};
+    eMIRA_GSTPLAYER_PIPELINE_MODE m_pipeline_mode{MIRACAST_GSTPLAYER_PIPELINE_MODE_DUAL};
+    eMIRA_GSTPLAYER_PIPELINE_MODE m_active_pipeline_mode{MIRACAST_GSTPLAYER_PIPELINE_MODE_DUAL};
+    bool m_video_linked{false};
+    bool m_audio_linked{false};
+    /* Set from the RTSP handler thread, read on the main loop and by the jitter controller */
+    std::atomic<eMIRA_GSTPLAYER_LATENCY_PROFILE> m_latency_profile{MIRACAST_GSTPLAYER_LATENCY_PROFILE_DEFAULT};
+    static const MIRACAST_GSTPLAYER_LATENCY_PROFILE_STRUCT m_latency_profiles[MIRACAST_GSTPLAYER_LATENCY_PROFILE_MAX];
+    MIRACAST_GSTPLAYER_SINK_CONFIG_STRUCT m_sink_config{MIRACAST_GSTPLAYER_VIDEO_SINK_WESTEROS, true, false};
+    MIRACAST_GSTPLAYER_SINK_CONFIG_STRUCT m_active_sink_config{MIRACAST_GSTPLAYER_VIDEO_SINK_WESTEROS, true, false};
+    /* Read per session, destroyInstance() and a failed session release the pipeline regardless */
+    bool m_reuse_pipeline{false};
+    /* Kept by stop() with the sinks and decode chains in READY, until launch() takes it or releasePipeline() */
+    bool m_pipeline_idle{false};
+    /* Set by the bus handlers on an error */
+    std::atomic<bool> m_pipeline_failed{false};
+    /* The audio sink came from the SoC and goes back there */
+    bool m_soc_audio_sink{false};
+
+    std::mutex m_jitter_mutex;
+    MIRACAST_GSTPLAYER_JITTER_CONTROLLER_STRUCT m_jitter_st{};
+    GSource *m_jitter_source{nullptr};
+
+    std::mutex m_latency_mutex;
+    MIRACAST_GSTPLAYER_LATENCY_STRUCT m_latency_st{};
 
     MiracastRTSPMsg *m_rtsp_reference_instance{nullptr};
-    MessageQueue* m_customQueueHandle{nullptr};
+    MessageRing* m_customQueueHandle{nullptr};
 
     std::string m_uri;
     guint64 m_streaming_port;
@@ -95,9 +232,15 @@ private:
     pthread_t m_playback_thread{0};
     VIDEO_RECT_STRUCT m_video_rect_st;
 
-    bool m_pushBufferLoop;
-    pthread_t m_pushbuffer_handler_tid{0};
-    static void *pushbuffer_handler_thread(void *ctx);
+    /* Feeds appsrc from the buffer ring on the main loop, woken by the eventfd of the ring */
+    GSource *m_pushbuffer_source{nullptr};
+    static gboolean pushbufferHandler(gint fd, GIOCondition condition, gpointer userdata);
+
+    /* Replaces udpsrc unless /opt/miracast_use_udpsrc is present */
+    MiracastRTPReceiver *m_rtp_receiver{nullptr};
+    std::atomic<bool> m_rtp_receive_loop{false};
+    pthread_t m_rtp_receive_tid{0};
+    static void *rtp_receive_thread(void *ctx);
 
     static MiracastGstPlayer *m_GstPlayer;
     MiracastGstPlayer();
@@ -106,8 +249,27 @@ private:
     MiracastGstPlayer(const MiracastGstPlayer &) = delete;
 
     bool createPipeline();
+    bool buildPipeline();
+    bool reuseIdlePipeline();
+    void releasePipeline();
+    bool openRTPReceiver();
+    bool createDualPipeline();
+    bool createSinglePipeline();
+    bool createDecodePipeline();
+    void configurePlaybackAppsrc();
+    void configureRtpSourceElements();
+    void applyLatencyProfile();
+    void resetJitterController();
+    void updateJitterBufferLatency();
+    void onJitterBufferDropMessage(GstMessage *message);
+    static gboolean jitterControllerTimeout(gpointer userdata);
     bool updateVideoSinkRectangle(void);
+    GstElement *createVideoSink();
+    void configureVideoSink();
+    void onFirstVideoFrame();
     static void onFirstVideoFrameCallback(GstElement* object, guint arg0, gpointer arg1,gpointer userdata);
+    static void fakesinkHandoff(GstElement *sink, GstBuffer *buffer, GstPad *pad, gpointer userdata);
+    static GstFlowReturn appsinkNewSample(GstElement *sink, gpointer userdata);
     void notifyPlaybackState(eMIRA_GSTPLAYER_STATES gst_player_state, eM_PLAYER_REASON_CODE state_reason_code = MIRACAST_PLAYER_REASON_CODE_SUCCESS );
     bool changePipelineState(GstElement* pipeline, GstState state) const;
 
@@ -115,10 +277,62 @@ private:
     GMainLoop *m_main_loop{nullptr};
     GMainContext *m_main_loop_context{nullptr};
 
-    bool m_statistics_thread_loop{false};
-    
-    pthread_t m_player_statistics_tid{0};
-    static void *monitor_player_statistics_thread(void *ctx);
+    /* Collected on the main loop and published to the RTSP handler, QoS fields filled by the bus handler */
+    std::mutex m_statistics_mutex;
+    MIRACAST_PLAYER_STATISTICS_STRUCT m_statistics_st{};
+    std::atomic<uint64_t> m_ingress_packets{0};
+    std::atomic<uint64_t> m_ingress_bytes{0};
+    uint64_t m_statistics_start_us{0};
+    uint64_t m_statistics_last_us{0};
+    uint64_t m_statistics_last_bytes{0};
+    /* Collector runs between get_player_statistics() logs, from /opt/miracast_player_stats, 0 for none */
+    unsigned int m_statistics_log_interval{0};
+    unsigned int m_statistics_samples{0};
+    GSource *m_statistics_source{nullptr};
+    void resetStatistics();
+    void collectStatistics();
+    void onQosMessage(GstMessage *message);
+    static gboolean statisticsCollectorTimeout(gpointer userdata);
+    static GstPadProbeReturn ingressStatisticsProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userdata);
+
+    /* Probes on every element of both pipelines while switched on, added and removed by the collector */
+    std::atomic<bool> m_element_tracer{false};
+    std::vector<std::shared_ptr<MIRACAST_GSTPLAYER_TRACED_ELEMENT_STRUCT>> m_traced_elements;
+    void updateElementTracer();
+    void traceElement(GstElement *element);
+    void addTracerProbe(const std::shared_ptr<MIRACAST_GSTPLAYER_TRACED_ELEMENT_STRUCT> &traced, GstPad *pad, bool input);
+    void collectElementTrace(MIRACAST_PLAYER_ELEMENT_TRACE_STRUCT &element_trace);
+    void detachElementTracer();
+    static void releaseTracedElement(gpointer userdata);
+    static GstPadProbeReturn elementTracerInProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userdata);
+    static GstPadProbeReturn elementTracerOutProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userdata);
+
+    /* Behind tsparse, or the depayloader in single mode, unless /opt/miracast_disable_ts_inspector is present */
+    MiracastTSInspector m_ts_inspector;
+    bool m_ts_inspector_enabled{false};
+    static GstPadProbeReturn tsInspectorProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userdata);
+
+    /* Set from the RTSP thread, the pre-warm runs on the main loop. Off with /opt/miracast_disable_prewarm */
+    std::mutex m_format_mutex;
+    RTSP_WFD_VIDEO_FMT_STRUCT m_video_format{};
+    RTSP_WFD_AUDIO_FMT_STRUCT m_audio_format{};
+    bool m_format_valid{false};
+    bool m_prewarm_enabled{false};
+    GSource *m_prewarm_source{nullptr};
+    /* First RTP packet into the jitterbuffer, for the time to first frame breakdown */
+    std::atomic<uint64_t> m_first_packet_us{0};
+    /* Set by a mid-session M4, taken by videoSinkFormatProbe() at the next caps change of the video sink */
+    std::atomic<uint64_t> m_format_switch_request_us{0};
+    /* Streaming thread of the video sink only */
+    uint64_t m_last_video_frame_us{0};
+    bool m_video_caps_switched{false};
+    static gboolean prewarmDecodeChain(gpointer userdata);
+    static GstCaps *createNegotiatedVideoCaps(const RTSP_WFD_VIDEO_FMT_STRUCT &video_format);
+    static GstCaps *createNegotiatedAudioCaps(const RTSP_WFD_AUDIO_FMT_STRUCT &audio_format);
+    void loadDecoderPlugins(GstCaps *caps);
+    static GstElementFactory *findElementFactory(GstCaps *caps, GstElementFactoryListType type, bool software_only = false);
+    bool primeProgram(const RTSP_WFD_VIDEO_FMT_STRUCT &video_format, const RTSP_WFD_AUDIO_FMT_STRUCT &audio_format);
+    unsigned int getRTPPoolSize(uint8_t h264_level);
 
     static GstFlowReturn appendPipelineNewSampleHandler(GstElement *elt, gpointer userdata);
     static gboolean appendPipelineBusMessage(GstBus * bus, GstMessage * message, gpointer userdata);
@@ -127,6 +341,13 @@ private:
     static void gst_bin_enough_data(GstAppSrc *src, gpointer user_data);
     static void source_setup(GstElement *pipeline, GstElement *source, gpointer userdata);
     static void gstBufferReleaseCallback(void* userParam);
+    static void decodebinPadAdded(GstElement *decodebin, GstPad *pad, gpointer userdata);
+    static void tsdemuxPadAdded(GstElement *tsdemux, GstPad *pad, gpointer userdata);
+    GstElement *buildDecodeChain(GstPad *pad, GstCaps *caps, bool is_video);
+    void removeDecodeChain(bool is_video);
+    GstElement *plugDecodebin(GstPad *pad);
+    static GstPadProbeReturn videoSinkLatencyProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userdata);
+    static GstPadProbeReturn videoSinkFormatProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userdata);
 };
 
 #endif /* _MIRACAST_GST_PLAYER_H_ */
\ No newline at end of file
@@ -50,12 +50,28 @@ const string WPEFramework::Plugin::MiracastPlayer::METHOD_MIRACAST_SET_RTSP_WAIT
 const string WPEFramework::Plugin::MiracastPlayer::METHOD_MIRACAST_PLAYER_SET_LOG_LEVEL = "setLogging";
 const string WPEFramework::Plugin::MiracastPlayer::METHOD_MIRACAST_PLAYER_SET_WESTEROS_ENVIRONMENT = "setWesterosEnvironment";
 const string WPEFramework::Plugin::MiracastPlayer::METHOD_MIRACAST_PLAYER_UNSET_WESTEROS_ENVIRONMENT = "unsetWesterosEnvironment";
+const string WPEFramework::Plugin::MiracastPlayer::METHOD_MIRACAST_GET_RTSP_LATENCY_STATS = "getRTSPLatencyStats";
+const string WPEFramework::Plugin::MiracastPlayer::METHOD_MIRACAST_INJECT_UIBC_EVENTS = "injectUIBCEvents";
+const string WPEFramework::Plugin::MiracastPlayer::METHOD_MIRACAST_SET_LATENCY_PROFILE = "setLatencyProfile";
+const string WPEFramework::Plugin::MiracastPlayer::METHOD_MIRACAST_GET_LATENCY_PROFILE = "getLatencyProfile";
+const string WPEFramework::Plugin::MiracastPlayer::METHOD_MIRACAST_GET_PLAYER_STATISTICS = "getPlayerStatistics";
+const string WPEFramework::Plugin::MiracastPlayer::METHOD_MIRACAST_SET_PLAYER_STATISTICS_INTERVAL = "setPlayerStatisticsInterval";
+const string WPEFramework::Plugin::MiracastPlayer::METHOD_MIRACAST_SET_VIDEO_SINK = "setVideoSink";
+const string WPEFramework::Plugin::MiracastPlayer::METHOD_MIRACAST_GET_VIDEO_SINK = "getVideoSink";
+const string WPEFramework::Plugin::MiracastPlayer::METHOD_MIRACAST_SET_PIPELINE_MODE = "setPipelineMode";
+const string WPEFramework::Plugin::MiracastPlayer::METHOD_MIRACAST_GET_PIPELINE_MODE = "getPipelineMode";
+const string WPEFramework::Plugin::MiracastPlayer::METHOD_MIRACAST_SET_ELEMENT_TRACER = "setElementTracer";
+const string WPEFramework::Plugin::MiracastPlayer::METHOD_MIRACAST_GET_ELEMENT_LATENCY = "getElementLatency";
 
 #ifdef ENABLE_MIRACAST_PLAYER_TEST_NOTIFIER
 const string WPEFramework::Plugin::MiracastPlayer::METHOD_MIRACAST_TEST_NOTIFIER = "testNotifier";
 #endif
 
 #define EVT_ON_STATE_CHANGE "onStateChange"
+#define EVT_ON_PLAYER_STATISTICS "onPlayerStatistics"
+
+/* Upper bound of the onPlayerStatistics interval in seconds */
+#define MIRACAST_PLAYER_STATISTICS_MAX_INTERVAL_SEC ( 3600 )
 
 namespace WPEFramework
 {
@@ -97,6 +113,18 @@ namespace WPEFramework
 			Register(METHOD_MIRACAST_PLAYER_SET_LOG_LEVEL, &MiracastPlayer::setLogging, this);
 			Register(METHOD_MIRACAST_PLAYER_SET_WESTEROS_ENVIRONMENT, &MiracastPlayer::setWesterosEnvironment, this);
 			Register(METHOD_MIRACAST_PLAYER_UNSET_WESTEROS_ENVIRONMENT, &MiracastPlayer::unsetWesterosEnvironmentWrapper, this);
+			Register(METHOD_MIRACAST_GET_RTSP_LATENCY_STATS, &MiracastPlayer::getRTSPLatencyStats, this);
+			Register(METHOD_MIRACAST_INJECT_UIBC_EVENTS, &MiracastPlayer::injectUIBCEvents, this);
+			Register(METHOD_MIRACAST_SET_LATENCY_PROFILE, &MiracastPlayer::setLatencyProfile, this);
+			Register(METHOD_MIRACAST_GET_LATENCY_PROFILE, &MiracastPlayer::getLatencyProfile, this);
+			Register(METHOD_MIRACAST_GET_PLAYER_STATISTICS, &MiracastPlayer::getPlayerStatistics, this);
+			Register(METHOD_MIRACAST_SET_PLAYER_STATISTICS_INTERVAL, &MiracastPlayer::setPlayerStatisticsInterval, this);
+			Register(METHOD_MIRACAST_SET_VIDEO_SINK, &MiracastPlayer::setVideoSink, this);
+			Register(METHOD_MIRACAST_GET_VIDEO_SINK, &MiracastPlayer::getVideoSink, this);
+			Register(METHOD_MIRACAST_SET_PIPELINE_MODE, &MiracastPlayer::setPipelineMode, this);
+			Register(METHOD_MIRACAST_GET_PIPELINE_MODE, &MiracastPlayer::getPipelineMode, this);
+			Register(METHOD_MIRACAST_SET_ELEMENT_TRACER, &MiracastPlayer::setElementTracer, this);
+			Register(METHOD_MIRACAST_GET_ELEMENT_LATENCY, &MiracastPlayer::getElementLatency, this);
 
 #ifdef ENABLE_MIRACAST_PLAYER_TEST_NOTIFIER
 			Register(METHOD_MIRACAST_TEST_NOTIFIER, &MiracastPlayer::testNotifier, this);
@@ -200,6 +228,22 @@ namespace WPEFramework
 				strncpy( rtsp_hldr_msgq_data.sink_dev_ip, sink_dev_ip.c_str() , sizeof(rtsp_hldr_msgq_data.sink_dev_ip));
 				rtsp_hldr_msgq_data.sink_dev_ip[sizeof(rtsp_hldr_msgq_data.sink_dev_ip) - 1] = '\0';
 
+				// Optional, the source may advertise a session management port other than 7236
+				if (device_parameters.HasLabel("source_rtsp_port"))
+				{
+					int64_t source_rtsp_port = device_parameters["source_rtsp_port"].Number();
+
+					if ((1 > source_rtsp_port) || (65535 < source_rtsp_port))
+					{
+						MIRACASTLOG_ERROR("Invalid source_rtsp_port [%lld]", static_cast<long long>(source_rtsp_port));
+						response["message"] = "Invalid source_rtsp_port";
+						response["success"] = false;
+						MIRACASTLOG_INFO("Exiting..!!!");
+						return Core::ERROR_BAD_REQUEST;
+					}
+					rtsp_hldr_msgq_data.source_rtsp_port = static_cast<unsigned short>(source_rtsp_port);
+				}
+
 				rtsp_hldr_msgq_data.state = RTSP_START_RECEIVE_MSGS;
 				success = true;
 			}
@@ -730,6 +774,636 @@ namespace WPEFramework
 			returnResponse(success);
 		}
 
+		/**
+		 * @brief This method used to get the RTSP latency histograms per source model.
+		 *
+		 * @param: reset (optional) clears the histograms once they are reported.
+		 * @return Returns the success code of underlying method.
+		 */
+		uint32_t MiracastPlayer::getRTSPLatencyStats(const JsonObject &parameters, JsonObject &response)
+		{
+			std::vector<RTSP_SOURCE_LATENCY_STRUCT> snapshot;
+			RTSP_PARAM_CACHE_COUNTERS_STRUCT cache_counters = {};
+			JsonObject param_cache;
+			JsonArray sources;
+			bool reset = false;
+
+			MIRACASTLOG_INFO("Entering..!!!");
+
+			if (parameters.HasLabel("reset"))
+			{
+				getBoolParameter("reset", reset);
+			}
+
+			if (nullptr == m_miracast_rtsp_obj)
+			{
+				MIRACASTLOG_ERROR("RTSP handler not initialized");
+				returnResponse(false);
+			}
+			m_miracast_rtsp_obj->get_RTSPLatencyStats(snapshot, reset);
+
+			for (size_t source_index = 0; source_index < snapshot.size(); ++source_index)
+			{
+				const RTSP_SOURCE_LATENCY_STRUCT &source_stats = snapshot[source_index];
+				JsonObject source;
+				JsonArray phases;
+
+				for (int phase = RTSP_LATENCY_PHASE_M1_M2; phase < RTSP_LATENCY_PHASE_MAX; ++phase)
+				{
+					const RTSP_LATENCY_HISTOGRAM_STRUCT &histogram = source_stats.phases[phase];
+					JsonObject phase_stats;
+					JsonArray buckets;
+
+					phase_stats["phase"] = MiracastRTSPLatencyStats::get_phase_name(static_cast<RTSP_LATENCY_PHASE>(phase));
+					phase_stats["count"] = histogram.count;
+					phase_stats["min_us"] = histogram.min_us;
+					phase_stats["max_us"] = histogram.max_us;
+					phase_stats["avg_us"] = (0 != histogram.count) ? (histogram.sum_us / histogram.count) : 0;
+
+					for (size_t bucket = 0; bucket < RTSP_LATENCY_BUCKET_COUNT; ++bucket)
+					{
+						JsonObject bucket_stats;
+
+						// le_us of 0 marks the overflow bucket
+						bucket_stats["le_us"] = MiracastRTSPLatencyStats::get_bucket_upper_bound_us(bucket);
+						bucket_stats["count"] = histogram.buckets[bucket];
+						buckets.Add(bucket_stats);
+					}
+					phase_stats["buckets"] = buckets;
+					phases.Add(phase_stats);
+				}
+				source["model"] = source_stats.source_model;
+				source["sessions"] = source_stats.sessions;
+				source["phases"] = phases;
+				sources.Add(source);
+			}
+			response["sources"] = sources;
+
+			m_miracast_rtsp_obj->get_RTSPParamCacheCounters(cache_counters);
+			param_cache["entries"] = cache_counters.entries;
+			param_cache["hits"] = cache_counters.hits;
+			param_cache["misses"] = cache_counters.misses;
+			param_cache["invalidations"] = cache_counters.invalidations;
+			response["param_cache"] = param_cache;
+
+			MIRACASTLOG_INFO("Exiting..!!!");
+			returnResponse(true);
+		}
+
+		static bool parseUIBCEvent(const JsonObject &event_object, UIBC_EVENT_STRUCT &event)
+		{
+			static const struct
+			{
+				const char *name;
+				UIBC_GENERIC_IE_ID generic_ie_id;
+			}
+			generic_events[] = {
+				{ "touch_down", UIBC_GENERIC_IE_TOUCH_DOWN },
+				{ "touch_up", UIBC_GENERIC_IE_TOUCH_UP },
+				{ "touch_move", UIBC_GENERIC_IE_TOUCH_MOVE },
+				{ "key_down", UIBC_GENERIC_IE_KEY_DOWN },
+				{ "key_up", UIBC_GENERIC_IE_KEY_UP },
+				{ "zoom", UIBC_GENERIC_IE_ZOOM },
+				{ "vscroll", UIBC_GENERIC_IE_VERTICAL_SCROLL },
+				{ "hscroll", UIBC_GENERIC_IE_HORIZONTAL_SCROLL },
+				{ "rotate", UIBC_GENERIC_IE_ROTATE }
+			};
+			std::string type = event_object["type"].String();
+			int64_t json_parsed_value = 0;
+
+			memset(&event, 0x00, sizeof(event));
+
+			if ("hidc" == type)
+			{
+				std::string report = event_object["report"].String();
+
+				if ((0 != (report.length() % 2)) || ((UIBC_MAX_HIDC_REPORT_LEN * 2) < report.length()))
+				{
+					return false;
+				}
+				event.category = UIBC_INPUT_CATEGORY_HIDC;
+				getNumberParameterObject(event_object, "input_path", json_parsed_value);
+				event.hidc_input_path = static_cast<uint8_t>(json_parsed_value);
+				getNumberParameterObject(event_object, "hid_type", json_parsed_value);
+				event.hidc_type = static_cast<uint8_t>(json_parsed_value);
+				getNumberParameterObject(event_object, "usage", json_parsed_value);
+				event.hidc_usage = static_cast<uint8_t>(json_parsed_value);
+
+				// HID report as a hex string
+				for (size_t index = 0; index < report.length(); index += 2)
+				{
+					if ((!isxdigit(static_cast<unsigned char>(report[index]))) || (!isxdigit(static_cast<unsigned char>(report[index + 1]))))
+					{
+						return false;
+					}
+					event.hidc_report[event.hidc_report_length++] = static_cast<uint8_t>(std::stoul(report.substr(index, 2), nullptr, 16));
+				}
+				return true;
+			}
+
+			event.category = UIBC_INPUT_CATEGORY_GENERIC;
+			event.generic_ie_id = UIBC_GENERIC_IE_MAX;
+			for (size_t index = 0; index < (sizeof(generic_events) / sizeof(generic_events[0])); ++index)
+			{
+				if (type == generic_events[index].name)
+				{
+					event.generic_ie_id = generic_events[index].generic_ie_id;
+				}
+			}
+
+			switch (event.generic_ie_id)
+			{
+				case UIBC_GENERIC_IE_TOUCH_DOWN:
+				case UIBC_GENERIC_IE_TOUCH_UP:
+				case UIBC_GENERIC_IE_TOUCH_MOVE:
+				{
+					JsonArray pointers = event_object["pointers"].Array();
+					JsonArray::Iterator index(pointers.Elements());
+
+					while ((index.Next() == true) && (UIBC_MAX_POINTERS > event.pointer_count))
+					{
+						JsonObject pointer = index.Current().Object();
+						UIBC_POINTER_STRUCT &pointer_st = event.pointers[event.pointer_count++];
+
+						getNumberParameterObject(pointer, "id", json_parsed_value);
+						pointer_st.id = static_cast<uint8_t>(json_parsed_value);
+						getNumberParameterObject(pointer, "x", json_parsed_value);
+						pointer_st.x = static_cast<uint16_t>(json_parsed_value);
+						getNumberParameterObject(pointer, "y", json_parsed_value);
+						pointer_st.y = static_cast<uint16_t>(json_parsed_value);
+					}
+					return (0 != event.pointer_count);
+				}
+				case UIBC_GENERIC_IE_KEY_DOWN:
+				case UIBC_GENERIC_IE_KEY_UP:
+				{
+					getNumberParameterObject(event_object, "key_code", json_parsed_value);
+					event.key_code1 = static_cast<uint16_t>(json_parsed_value);
+					if (event_object.HasLabel("key_code2"))
+					{
+						getNumberParameterObject(event_object, "key_code2", json_parsed_value);
+						event.key_code2 = static_cast<uint16_t>(json_parsed_value);
+					}
+					return true;
+				}
+				case UIBC_GENERIC_IE_ZOOM:
+				case UIBC_GENERIC_IE_ROTATE:
+				{
+					if (UIBC_GENERIC_IE_ZOOM == event.generic_ie_id)
+					{
+						getNumberParameterObject(event_object, "x", json_parsed_value);
+						event.pointers[0].x = static_cast<uint16_t>(json_parsed_value);
+						getNumberParameterObject(event_object, "y", json_parsed_value);
+						event.pointers[0].y = static_cast<uint16_t>(json_parsed_value);
+					}
+					getNumberParameterObject(event_object, "integer", json_parsed_value);
+					event.integer_part = static_cast<int8_t>(json_parsed_value);
+					getNumberParameterObject(event_object, "fraction", json_parsed_value);
+					event.fraction_part = static_cast<uint8_t>(json_parsed_value);
+					return true;
+				}
+				case UIBC_GENERIC_IE_VERTICAL_SCROLL:
+				case UIBC_GENERIC_IE_HORIZONTAL_SCROLL:
+				{
+					getNumberParameterObject(event_object, "amount", json_parsed_value);
+					event.scroll_amount = static_cast<int16_t>(json_parsed_value);
+					return true;
+				}
+				default:
+					return false;
+			}
+		}
+
+		/**
+		 * @brief This method used to send user input to the source over UIBC.
+		 *
+		 * @param: events list of input events, sent to the source as one batch.
+		 * @return Returns the success code of underlying method.
+		 */
+		uint32_t MiracastPlayer::injectUIBCEvents(const JsonObject &parameters, JsonObject &response)
+		{
+			uint64_t receive_time_us = MiracastCommon::get_monotonic_time_us();
+			UIBC_EVENT_STRUCT events[UIBC_MAX_BATCH_EVENTS];
+			JsonArray event_list;
+			size_t event_count = 0;
+			bool success = false;
+
+			MIRACASTLOG_TRACE("Entering..!!!");
+
+			returnIfParamNotFound(parameters, "events");
+
+			event_list = parameters["events"].Array();
+			if ((0 == event_list.Length()) || (UIBC_MAX_BATCH_EVENTS < event_list.Length()))
+			{
+				MIRACASTLOG_ERROR("Got [%u] UIBC events, expected 1 to %d", event_list.Length(), UIBC_MAX_BATCH_EVENTS);
+				returnResponse(false);
+			}
+
+			JsonArray::Iterator index(event_list.Elements());
+
+			while (index.Next() == true)
+			{
+				if ((Core::JSON::Variant::type::OBJECT != index.Current().Content()) ||
+					(!parseUIBCEvent(index.Current().Object(), events[event_count])))
+				{
+					MIRACASTLOG_ERROR("Invalid UIBC event at [%zu]", event_count);
+					returnResponse(false);
+				}
+				++event_count;
+			}
+
+			if (nullptr == m_miracast_rtsp_obj)
+			{
+				MIRACASTLOG_ERROR("RTSP handler not initialized");
+				returnResponse(false);
+			}
+			success = m_miracast_rtsp_obj->send_UIBCEvents(events, event_count, receive_time_us);
+
+			MIRACASTLOG_TRACE("Exiting..!!!");
+			returnResponse(success);
+		}
+
+		static const char *latency_profile_names[MIRACAST_GSTPLAYER_LATENCY_PROFILE_MAX] = { "gaming", "default", "robust" };
+
+		/**
+		 * @brief This method used to select the latency profile of the player pipeline.
+		 *
+		 * @param: profile gaming, default or robust. Applied to the running session and kept for the next ones.
+		 * @return Returns the success code of underlying method.
+		 */
+		uint32_t MiracastPlayer::setLatencyProfile(const JsonObject &parameters, JsonObject &response)
+		{
+			std::string profile_name = "";
+			bool success = false;
+
+			MIRACASTLOG_INFO("Entering..!!!");
+
+			returnIfParamNotFound(parameters, "profile");
+			getStringParameter("profile", profile_name);
+			std::transform(profile_name.begin(), profile_name.end(), profile_name.begin(), ::tolower);
+
+			if (nullptr == m_miracast_rtsp_obj)
+			{
+				MIRACASTLOG_ERROR("RTSP handler not initialized");
+				returnResponse(false);
+			}
+
+			for (int profile = MIRACAST_GSTPLAYER_LATENCY_PROFILE_GAMING; profile < MIRACAST_GSTPLAYER_LATENCY_PROFILE_MAX; ++profile)
+			{
+				if (profile_name == latency_profile_names[profile])
+				{
+					success = m_miracast_rtsp_obj->set_LatencyProfile(static_cast<eMIRA_GSTPLAYER_LATENCY_PROFILE>(profile));
+					break;
+				}
+			}
+			if (!success)
+			{
+				MIRACASTLOG_ERROR("Unable to set latency profile [%s]", profile_name.c_str());
+			}
+
+			MIRACASTLOG_INFO("Exiting..!!!");
+			returnResponse(success);
+		}
+
+		/**
+		 * @brief This method used to get the latency profile of the player pipeline.
+		 *
+		 * @param: None.
+		 * @return Returns the success code of underlying method.
+		 */
+		uint32_t MiracastPlayer::getLatencyProfile(const JsonObject &parameters, JsonObject &response)
+		{
+			MIRACASTLOG_INFO("Entering..!!!");
+
+			if (nullptr == m_miracast_rtsp_obj)
+			{
+				MIRACASTLOG_ERROR("RTSP handler not initialized");
+				returnResponse(false);
+			}
+			response["profile"] = latency_profile_names[m_miracast_rtsp_obj->get_LatencyProfile()];
+
+			MIRACASTLOG_INFO("Exiting..!!!");
+			returnResponse(true);
+		}
+
+		static const char *video_sink_names[MIRACAST_GSTPLAYER_VIDEO_SINK_MAX] = { "westerossink", "fakesink", "appsink" };
+
+		/**
+		 * @brief This method used to select the video sink of the player pipeline, for profiling without a display.
+		 *
+		 * @param: sink westerossink, fakesink or appsink.
+		 * @param: sync Optional, whether fakesink and appsink render on the clock. Defaults to true.
+		 * @param: software_decode Optional, skip hardware decoders. Defaults to false.
+		 * @return Returns the success code of underlying method. Taken by the next session.
+		 */
+		uint32_t MiracastPlayer::setVideoSink(const JsonObject &parameters, JsonObject &response)
+		{
+			MIRACAST_GSTPLAYER_SINK_CONFIG_STRUCT sink_config = { MIRACAST_GSTPLAYER_VIDEO_SINK_MAX, true, false };
+			std::string sink_name = "";
+			bool success = false;
+
+			MIRACASTLOG_INFO("Entering..!!!");
+
+			returnIfParamNotFound(parameters, "sink");
+			getStringParameter("sink", sink_name);
+			std::transform(sink_name.begin(), sink_name.end(), sink_name.begin(), ::tolower);
+			if (parameters.HasLabel("sync"))
+			{
+				getBoolParameter("sync", sink_config.sync);
+			}
+			if (parameters.HasLabel("software_decode"))
+			{
+				getBoolParameter("software_decode", sink_config.software_decode);
+			}
+
+			if (nullptr == m_miracast_rtsp_obj)
+			{
+				MIRACASTLOG_ERROR("RTSP handler not initialized");
+				returnResponse(false);
+			}
+
+			for (int sink = MIRACAST_GSTPLAYER_VIDEO_SINK_WESTEROS; sink < MIRACAST_GSTPLAYER_VIDEO_SINK_MAX; ++sink)
+			{
+				if (sink_name == video_sink_names[sink])
+				{
+					sink_config.video_sink = static_cast<eMIRA_GSTPLAYER_VIDEO_SINK>(sink);
+					success = m_miracast_rtsp_obj->set_VideoSinkConfig(sink_config);
+					break;
+				}
+			}
+			if (!success)
+			{
+				MIRACASTLOG_ERROR("Unable to set video sink [%s]", sink_name.c_str());
+			}
+
+			MIRACASTLOG_INFO("Exiting..!!!");
+			returnResponse(success);
+		}
+
+		/**
+		 * @brief This method used to get the video sink of the player pipeline.
+		 *
+		 * @param: None.
+		 * @return Returns the success code of underlying method.
+		 */
+		uint32_t MiracastPlayer::getVideoSink(const JsonObject &parameters, JsonObject &response)
+		{
+			MIRACAST_GSTPLAYER_SINK_CONFIG_STRUCT sink_config;
+
+			MIRACASTLOG_INFO("Entering..!!!");
+
+			if (nullptr == m_miracast_rtsp_obj)
+			{
+				MIRACASTLOG_ERROR("RTSP handler not initialized");
+				returnResponse(false);
+			}
+			m_miracast_rtsp_obj->get_VideoSinkConfig(sink_config);
+			response["sink"] = video_sink_names[sink_config.video_sink];
+			response["sync"] = sink_config.sync;
+			response["software_decode"] = sink_config.software_decode;
+
+			MIRACASTLOG_INFO("Exiting..!!!");
+			returnResponse(true);
+		}
+
+		static const char *pipeline_mode_names[] = { "dual", "single" };
+
+		/**
+		 * @brief This method used to select the player pipeline layout.
+		 *
+		 * @param: mode dual (tsparse appsink re-pushed into playbin) or single (one pipeline udpsrc to sinks).
+		 * @return Returns the success code of underlying method. Taken by the next session,
+		 *         /opt/miracast_single_pipeline still forces single on the device.
+		 */
+		uint32_t MiracastPlayer::setPipelineMode(const JsonObject &parameters, JsonObject &response)
+		{
+			std::string mode_name = "";
+			bool success = false;
+
+			MIRACASTLOG_INFO("Entering..!!!");
+
+			returnIfParamNotFound(parameters, "mode");
+			getStringParameter("mode", mode_name);
+			std::transform(mode_name.begin(), mode_name.end(), mode_name.begin(), ::tolower);
+
+			if (nullptr == m_miracast_rtsp_obj)
+			{
+				MIRACASTLOG_ERROR("RTSP handler not initialized");
+				returnResponse(false);
+			}
+
+			for (int mode = MIRACAST_GSTPLAYER_PIPELINE_MODE_DUAL; mode <= MIRACAST_GSTPLAYER_PIPELINE_MODE_SINGLE; ++mode)
+			{
+				if (mode_name == pipeline_mode_names[mode])
+				{
+					success = m_miracast_rtsp_obj->set_PipelineMode(static_cast<eMIRA_GSTPLAYER_PIPELINE_MODE>(mode));
+					break;
+				}
+			}
+			if (!success)
+			{
+				MIRACASTLOG_ERROR("Unable to set pipeline mode [%s]", mode_name.c_str());
+			}
+
+			MIRACASTLOG_INFO("Exiting..!!!");
+			returnResponse(success);
+		}
+
+		/**
+		 * @brief This method used to get the player pipeline layout.
+		 *
+		 * @param: None.
+		 * @return Returns the success code of underlying method.
+		 */
+		uint32_t MiracastPlayer::getPipelineMode(const JsonObject &parameters, JsonObject &response)
+		{
+			MIRACASTLOG_INFO("Entering..!!!");
+
+			if (nullptr == m_miracast_rtsp_obj)
+			{
+				MIRACASTLOG_ERROR("RTSP handler not initialized");
+				returnResponse(false);
+			}
+			response["mode"] = pipeline_mode_names[m_miracast_rtsp_obj->get_PipelineMode()];
+
+			MIRACASTLOG_INFO("Exiting..!!!");
+			returnResponse(true);
+		}
+
+		void MiracastPlayer::playerStatisticsToJson(const MIRACAST_PLAYER_STATISTICS_STRUCT &statistics, JsonObject &json)
+		{
+			json["streaming"] = statistics.streaming;
+			json["duration_ms"] = statistics.duration_ms;
+			json["rendered_frames"] = statistics.rendered_frames;
+			json["dropped_frames"] = statistics.dropped_frames;
+			json["decoder_queue_bytes"] = statistics.decoder_queue_bytes;
+			json["rtp_packets"] = statistics.rtp_packets;
+			json["rtp_lost"] = statistics.rtp_lost;
+			json["rtp_late"] = statistics.rtp_late;
+			json["rtp_duplicates"] = statistics.rtp_duplicates;
+			json["rtp_reordered"] = statistics.rtp_reordered;
+			json["kernel_drops"] = statistics.kernel_drops;
+			json["buffer_pool_size"] = statistics.buffer_pool_size;
+			json["buffer_pool_high_water"] = statistics.buffer_pool_high_water;
+			// Recycled slots out of all received packets, the first pass through a fresh pool counts as misses
+			json["buffer_pool_hit_rate_pct"] = (0 < (statistics.buffer_pool_hits + statistics.buffer_pool_misses)) ?
+								static_cast<uint32_t>((statistics.buffer_pool_hits * 100) / (statistics.buffer_pool_hits + statistics.buffer_pool_misses)) : 0;
+			json["buffer_pool_exhausted"] = statistics.buffer_pool_exhausted;
+			json["bitrate_kbps"] = statistics.bitrate_kbps;
+			json["jitterbuffer_latency_ms"] = statistics.jitterbuffer_latency_ms;
+			json["ingress_to_render_avg_us"] = statistics.ingress_to_render_avg_us;
+			json["time_to_first_packet_us"] = statistics.time_to_first_packet_us;
+			json["time_to_first_frame_us"] = statistics.time_to_first_frame_us;
+			json["pipeline_reused"] = statistics.pipeline_reused;
+			json["pipeline_setup_us"] = statistics.pipeline_setup_us;
+			json["format_switches"] = statistics.format_switches;
+			json["format_switch_gap_us"] = statistics.format_switch_gap_us;
+			json["format_switch_gap_max_us"] = statistics.format_switch_gap_max_us;
+			json["qos_messages"] = statistics.qos_messages;
+			json["qos_jitter_us"] = statistics.qos_jitter_us;
+			// 100 means the pipeline keeps up, lower values that it is too slow
+			json["qos_proportion_pct"] = static_cast<uint32_t>((statistics.qos_proportion * 100.0) + 0.5);
+			json["qos_dropped"] = statistics.qos_dropped;
+			// Continuity errors without matching rtp_lost were already in the stream the source sent
+			json["ts_packets"] = statistics.ts_packets;
+			json["ts_cc_errors"] = statistics.ts_cc_errors;
+			json["ts_sync_losses"] = statistics.ts_sync_losses;
+			json["ts_transport_errors"] = statistics.ts_transport_errors;
+			json["pcr_pid"] = statistics.pcr_pid;
+			json["pcr_jitter_us"] = statistics.pcr_jitter_us;
+			json["pcr_jitter_max_us"] = statistics.pcr_jitter_max_us;
+
+			JsonArray ts_pids;
+			for (unsigned int index = 0; index < statistics.ts_pid_count; ++index)
+			{
+				JsonObject pid_stats;
+				pid_stats["pid"] = statistics.ts_pids[index].pid;
+				pid_stats["packets"] = statistics.ts_pids[index].packets;
+				pid_stats["cc_errors"] = statistics.ts_pids[index].cc_errors;
+				pid_stats["bitrate_kbps"] = statistics.ts_pids[index].bitrate_kbps;
+				ts_pids.Add(pid_stats);
+			}
+			json["ts_pids"] = ts_pids;
+		}
+
+		/**
+		 * @brief This method used to get the statistics of the running, or else the last, streaming session.
+		 *
+		 * @param: None.
+		 * @return Returns the success code of underlying method.
+		 */
+		uint32_t MiracastPlayer::getPlayerStatistics(const JsonObject &parameters, JsonObject &response)
+		{
+			MIRACAST_PLAYER_STATISTICS_STRUCT statistics;
+
+			MIRACASTLOG_TRACE("Entering..!!!");
+
+			if (nullptr == m_miracast_rtsp_obj)
+			{
+				MIRACASTLOG_ERROR("RTSP handler not initialized");
+				returnResponse(false);
+			}
+			m_miracast_rtsp_obj->get_PlayerStatistics(statistics);
+			playerStatisticsToJson(statistics, response);
+			response["interval"] = m_miracast_rtsp_obj->get_PlayerStatisticsInterval();
+
+			MIRACASTLOG_TRACE("Exiting..!!!");
+			returnResponse(true);
+		}
+
+		/**
+		 * @brief This method used to set the interval of the onPlayerStatistics notification.
+		 *
+		 * @param: interval in seconds, 0 disables the notification.
+		 * @return Returns the success code of underlying method.
+		 */
+		uint32_t MiracastPlayer::setPlayerStatisticsInterval(const JsonObject &parameters, JsonObject &response)
+		{
+			int64_t interval = 0;
+
+			MIRACASTLOG_INFO("Entering..!!!");
+
+			returnIfParamNotFound(parameters, "interval");
+			interval = parameters["interval"].Number();
+
+			if ((nullptr == m_miracast_rtsp_obj) || (0 > interval) || (MIRACAST_PLAYER_STATISTICS_MAX_INTERVAL_SEC < interval))
+			{
+				MIRACASTLOG_ERROR("Invalid interval [%lld] or RTSP handler not initialized", static_cast<long long>(interval));
+				returnResponse(false);
+			}
+			m_miracast_rtsp_obj->set_PlayerStatisticsInterval(static_cast<unsigned int>(interval));
+
+			MIRACASTLOG_INFO("Exiting..!!!");
+			returnResponse(true);
+		}
+
+		/**
+		 * @brief This method used to trace the latency of every element in the player pipelines.
+		 *
+		 * @param: enabled Probes on the element pads, taken up by the running session within a second.
+		 * @return Returns the success code of underlying method.
+		 */
+		uint32_t MiracastPlayer::setElementTracer(const JsonObject &parameters, JsonObject &response)
+		{
+			bool enabled = false;
+
+			MIRACASTLOG_INFO("Entering..!!!");
+
+			returnIfParamNotFound(parameters, "enabled");
+			getBoolParameter("enabled", enabled);
+
+			if (nullptr == m_miracast_rtsp_obj)
+			{
+				MIRACASTLOG_ERROR("RTSP handler not initialized");
+				returnResponse(false);
+			}
+			m_miracast_rtsp_obj->set_ElementTracer(enabled);
+
+			MIRACASTLOG_INFO("Exiting..!!!");
+			returnResponse(true);
+		}
+
+		/**
+		 * @brief This method used to get the latency of every traced element, as of the last collector run.
+		 *
+		 * @param: None.
+		 * @return Returns the success code of underlying method.
+		 */
+		uint32_t MiracastPlayer::getElementLatency(const JsonObject &parameters, JsonObject &response)
+		{
+			MIRACAST_PLAYER_ELEMENT_TRACE_STRUCT element_trace;
+			JsonArray elements;
+
+			MIRACASTLOG_TRACE("Entering..!!!");
+
+			if (nullptr == m_miracast_rtsp_obj)
+			{
+				MIRACASTLOG_ERROR("RTSP handler not initialized");
+				returnResponse(false);
+			}
+			m_miracast_rtsp_obj->get_ElementTrace(element_trace);
+			for (unsigned int index = 0; index < element_trace.element_count; ++index)
+			{
+				JsonObject element;
+				element["name"] = std::string(element_trace.elements[index].name);
+				element["buffers_in"] = element_trace.elements[index].buffers_in;
+				element["buffers_out"] = element_trace.elements[index].buffers_out;
+				element["latency_avg_us"] = element_trace.elements[index].latency_avg_us;
+				// Highest of the last collector interval, latency_peak_us of the whole session
+				element["latency_max_us"] = element_trace.elements[index].latency_max_us;
+				element["latency_peak_us"] = element_trace.elements[index].latency_peak_us;
+				element["in_flight"] = element_trace.elements[index].in_flight;
+				element["in_flight_max"] = element_trace.elements[index].in_flight_max;
+				element["level_bytes"] = element_trace.elements[index].level_bytes;
+				elements.Add(element);
+			}
+			response["enabled"] = m_miracast_rtsp_obj->get_ElementTracer();
+			response["elements"] = elements;
+
+			MIRACASTLOG_TRACE("Exiting..!!!");
+			returnResponse(true);
+		}
+
 #ifdef ENABLE_MIRACAST_PLAYER_TEST_NOTIFIER
 		/**
 		 * @brief This method used to stop the client connection.
@@ -928,6 +1602,14 @@ namespace WPEFramework
 			MIRACASTLOG_INFO("Exiting..!!!");
 		}
 
+		void MiracastPlayer::onPlayerStatistics(const MIRACAST_PLAYER_STATISTICS_STRUCT &statistics)
+		{
+			JsonObject params;
+
+			playerStatisticsToJson(statistics, params);
+			sendNotify(EVT_ON_PLAYER_STATISTICS, params);
+		}
+
 		std::string MiracastPlayer::stateDescription(eMIRA_PLAYER_STATES e)
 		{
 			switch (e)
@@ -62,6 +62,18 @@ namespace WPEFramework
             static const string METHOD_MIRACAST_PLAYER_SET_LOG_LEVEL;
             static const string METHOD_MIRACAST_PLAYER_SET_WESTEROS_ENVIRONMENT;
             static const string METHOD_MIRACAST_PLAYER_UNSET_WESTEROS_ENVIRONMENT;
+            static const string METHOD_MIRACAST_GET_RTSP_LATENCY_STATS;
+            static const string METHOD_MIRACAST_INJECT_UIBC_EVENTS;
+            static const string METHOD_MIRACAST_SET_LATENCY_PROFILE;
+            static const string METHOD_MIRACAST_GET_LATENCY_PROFILE;
+            static const string METHOD_MIRACAST_GET_PLAYER_STATISTICS;
+            static const string METHOD_MIRACAST_SET_PLAYER_STATISTICS_INTERVAL;
+            static const string METHOD_MIRACAST_SET_VIDEO_SINK;
+            static const string METHOD_MIRACAST_GET_VIDEO_SINK;
+            static const string METHOD_MIRACAST_SET_PIPELINE_MODE;
+            static const string METHOD_MIRACAST_GET_PIPELINE_MODE;
+            static const string METHOD_MIRACAST_SET_ELEMENT_TRACER;
+            static const string METHOD_MIRACAST_GET_ELEMENT_LATENCY;
 
 #ifdef ENABLE_MIRACAST_PLAYER_TEST_NOTIFIER
             static const string METHOD_MIRACAST_TEST_NOTIFIER;
@@ -76,6 +88,7 @@ namespace WPEFramework
             virtual string Information() const override;
 
             void onStateChange(const std::string& client_mac, const std::string& client_name, eMIRA_PLAYER_STATES player_state, eM_PLAYER_REASON_CODE reason_code ) override;
+            void onPlayerStatistics(const MIRACAST_PLAYER_STATISTICS_STRUCT &statistics) override;
 
             BEGIN_INTERFACE_MAP(MiracastPlayer)
             INTERFACE_ENTRY(PluginHost::IPlugin)
@@ -103,6 +116,19 @@ namespace WPEFramework
             uint32_t setLogging(const JsonObject &parameters, JsonObject &response);
             uint32_t setWesterosEnvironment(const JsonObject &parameters, JsonObject &response);
             uint32_t unsetWesterosEnvironmentWrapper(const JsonObject &parameters, JsonObject &response);
+            uint32_t getRTSPLatencyStats(const JsonObject &parameters, JsonObject &response);
+            uint32_t injectUIBCEvents(const JsonObject &parameters, JsonObject &response);
+            uint32_t setLatencyProfile(const JsonObject &parameters, JsonObject &response);
+            uint32_t getLatencyProfile(const JsonObject &parameters, JsonObject &response);
+            uint32_t getPlayerStatistics(const JsonObject &parameters, JsonObject &response);
+            uint32_t setPlayerStatisticsInterval(const JsonObject &parameters, JsonObject &response);
+            uint32_t setVideoSink(const JsonObject &parameters, JsonObject &response);
+            uint32_t getVideoSink(const JsonObject &parameters, JsonObject &response);
+            uint32_t setPipelineMode(const JsonObject &parameters, JsonObject &response);
+            uint32_t getPipelineMode(const JsonObject &parameters, JsonObject &response);
+            uint32_t setElementTracer(const JsonObject &parameters, JsonObject &response);
+            uint32_t getElementLatency(const JsonObject &parameters, JsonObject &response);
+            void playerStatisticsToJson(const MIRACAST_PLAYER_STATISTICS_STRUCT &statistics, JsonObject &json);
             void unsetWesterosEnvironment(void);
 
             std::string reasonDescription(eM_PLAYER_REASON_CODE);
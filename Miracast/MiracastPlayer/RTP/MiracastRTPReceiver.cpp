@@ -0,0 +1,450 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <algorithm>
+#include <MiracastLogger.h>
+#include <MiracastRTPReceiver.h>
+
+#ifndef SO_RXQ_OVFL
+#define SO_RXQ_OVFL   ( 40 )
+#endif
+
+MiracastRTPReceiver::MiracastRTPReceiver(unsigned int pool_size, unsigned int max_pool_size)
+    : m_socket_fd(-1),
+      m_port(0),
+      m_pool_size(0),
+      m_max_pool_size(std::max(max_pool_size, std::max(pool_size, static_cast<unsigned int>(RTP_RECEIVER_BATCH_SIZE)))),
+      m_reserved_size(0),
+      m_next_slot(0),
+      m_backlog(false),
+      m_sequence_valid(false),
+      m_next_sequence(0),
+      m_pool(new RTP_RECEIVER_POOL_STRUCT)
+{
+    memset(&m_stats, 0x00, sizeof(m_stats));
+    m_pool->slots_in_use.store(0);
+    m_pool->references.store(1);
+
+    grow_pool(std::max(pool_size, static_cast<unsigned int>(RTP_RECEIVER_BATCH_SIZE)));
+
+    memset(m_messages, 0x00, sizeof(m_messages));
+    for (unsigned int index = 0; index < RTP_RECEIVER_BATCH_SIZE; ++index)
+    {
+        m_iovecs[index].iov_len = RTP_RECEIVER_SLOT_SIZE;
+        m_messages[index].msg_hdr.msg_iov = &m_iovecs[index];
+        m_messages[index].msg_hdr.msg_iovlen = 1;
+        m_messages[index].msg_hdr.msg_control = m_control[index];
+    }
+
+    m_wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (-1 == m_wakeup_fd)
+    {
+        MIRACASTLOG_ERROR("eventfd creation error %s", strerror(errno));
+    }
+}
+
+MiracastRTPReceiver::~MiracastRTPReceiver()
+{
+    close();
+    if (-1 != m_wakeup_fd)
+    {
+        ::close(m_wakeup_fd);
+        m_wakeup_fd = -1;
+    }
+    if (0 < m_pool->slots_in_use.load())
+    {
+        MIRACASTLOG_INFO("[%u] RTP slots still held downstream, the pool goes with the last one", m_pool->slots_in_use.load());
+    }
+    release_pool(m_pool);
+    m_pool = nullptr;
+}
+
+void MiracastRTPReceiver::release_pool(RTP_RECEIVER_POOL_STRUCT *pool)
+{
+    if (1 != pool->references.fetch_sub(1, std::memory_order_acq_rel))
+    {
+        return;
+    }
+    for (RTP_RECEIVER_CHUNK_STRUCT &chunk : pool->chunks)
+    {
+        delete[] chunk.slots;
+        delete[] chunk.data;
+    }
+    delete pool;
+}
+
+bool MiracastRTPReceiver::grow_pool(unsigned int pool_size)
+{
+    RTP_RECEIVER_CHUNK_STRUCT chunk = {nullptr, nullptr};
+    unsigned int count = 0;
+
+    pool_size = std::min(pool_size, m_max_pool_size);
+    if (pool_size <= m_pool_size)
+    {
+        return false;
+    }
+    count = pool_size - m_pool_size;
+
+    chunk.data = new uint8_t[static_cast<size_t>(count) * RTP_RECEIVER_SLOT_SIZE];
+    chunk.slots = new RTP_RECEIVER_SLOT_STRUCT[count];
+    for (unsigned int index = 0; index < count; ++index)
+    {
+        chunk.slots[index].pool = m_pool;
+        chunk.slots[index].data = chunk.data + (static_cast<size_t>(index) * RTP_RECEIVER_SLOT_SIZE);
+        chunk.slots[index].in_use.store(false);
+        chunk.slots[index].recycled = false;
+        m_slots.push_back(&chunk.slots[index]);
+    }
+    m_pool->chunks.push_back(chunk);
+    m_pool_size = pool_size;
+    {
+        std::lock_guard<std::mutex> lock(m_stats_mutex);
+        m_stats.pool_size = m_pool_size;
+    }
+    MIRACASTLOG_INFO("RTP receiver pool at [%u] slots, [%u] max", m_pool_size, m_max_pool_size);
+    return true;
+}
+
+void MiracastRTPReceiver::reserve(unsigned int pool_size)
+{
+    m_reserved_size.store(pool_size, std::memory_order_relaxed);
+}
+
+/* Contiguous free slots from where the previous batch ended, downstream releases them roughly in order */
+unsigned int MiracastRTPReceiver::fill_batch(unsigned int max_packets)
+{
+    unsigned int batch = 0;
+
+    while (batch < max_packets)
+    {
+        unsigned int index = (m_next_slot + batch) % m_pool_size;
+
+        if (m_slots[index]->in_use.load(std::memory_order_acquire))
+        {
+            break;
+        }
+        m_batch_slots[batch] = index;
+        m_iovecs[batch].iov_base = m_slots[index]->data;
+        // The kernel shrinks it to what it wrote
+        m_messages[batch].msg_hdr.msg_controllen = sizeof(m_control[batch]);
+        ++batch;
+    }
+    return batch;
+}
+
+bool MiracastRTPReceiver::open(unsigned short port, int rcvbuf_size)
+{
+    struct sockaddr_in addr = {};
+    socklen_t addr_len = sizeof(addr);
+    socklen_t option_len = sizeof(int);
+    int option = 1;
+
+    MIRACASTLOG_TRACE("Entering...");
+
+    close();
+
+    m_socket_fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (-1 == m_socket_fd)
+    {
+        MIRACASTLOG_ERROR("RTP socket creation error %s", strerror(errno));
+        MIRACASTLOG_TRACE("Exiting...");
+        return false;
+    }
+
+    if (0 != setsockopt(m_socket_fd, SOL_SOCKET, SO_REUSEADDR, &option, sizeof(option)))
+    {
+        MIRACASTLOG_WARNING("SO_REUSEADDR failed: %s", strerror(errno));
+    }
+    if (0 != setsockopt(m_socket_fd, SOL_SOCKET, SO_RXQ_OVFL, &option, sizeof(option)))
+    {
+        MIRACASTLOG_WARNING("SO_RXQ_OVFL failed: %s", strerror(errno));
+    }
+
+    // SO_RCVBUFFORCE goes past net.core.rmem_max but needs CAP_NET_ADMIN
+    if ((0 < rcvbuf_size) &&
+        (0 != setsockopt(m_socket_fd, SOL_SOCKET, SO_RCVBUFFORCE, &rcvbuf_size, sizeof(rcvbuf_size))) &&
+        (0 != setsockopt(m_socket_fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf_size, sizeof(rcvbuf_size))))
+    {
+        MIRACASTLOG_WARNING("SO_RCVBUF [%d] failed: %s", rcvbuf_size, strerror(errno));
+    }
+
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (0 != bind(m_socket_fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)))
+    {
+        MIRACASTLOG_ERROR("RTP bind to port [%u] failed: %s", port, strerror(errno));
+        close();
+        MIRACASTLOG_TRACE("Exiting...");
+        return false;
+    }
+    if (0 == getsockname(m_socket_fd, reinterpret_cast<struct sockaddr *>(&addr), &addr_len))
+    {
+        m_port = ntohs(addr.sin_port);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_stats_mutex);
+        memset(&m_stats, 0x00, sizeof(m_stats));
+        m_stats.pool_size = m_pool_size;
+        getsockopt(m_socket_fd, SOL_SOCKET, SO_RCVBUF, &m_stats.rcvbuf_size, &option_len);
+    }
+
+    MIRACASTLOG_INFO("RTP receiver on port [%u], rcvbuf [%d] requested [%d]", m_port, m_stats.rcvbuf_size, rcvbuf_size);
+    MIRACASTLOG_TRACE("Exiting...");
+    return true;
+}
+
+void MiracastRTPReceiver::close(void)
+{
+    if (-1 != m_socket_fd)
+    {
+        ::close(m_socket_fd);
+        m_socket_fd = -1;
+        m_port = 0;
+        m_sequence_valid = false;
+    }
+}
+
+void MiracastRTPReceiver::interrupt(void)
+{
+    uint64_t event_count = 1;
+
+    if ((-1 != m_wakeup_fd) && (sizeof(event_count) != write(m_wakeup_fd, &event_count, sizeof(event_count))))
+    {
+        MIRACASTLOG_WARNING("RTP receiver wake-up failed: %s", strerror(errno));
+    }
+}
+
+void MiracastRTPReceiver::release_slot(void *slot_handle)
+{
+    RTP_RECEIVER_SLOT_STRUCT *slot = static_cast<RTP_RECEIVER_SLOT_STRUCT *>(slot_handle);
+
+    if (nullptr != slot)
+    {
+        RTP_RECEIVER_POOL_STRUCT *pool = slot->pool;
+
+        slot->in_use.store(false, std::memory_order_release);
+        pool->slots_in_use.fetch_sub(1, std::memory_order_relaxed);
+        release_pool(pool);
+    }
+}
+
+bool MiracastRTPReceiver::wait_readable(int wait_ms, unsigned int &syscalls)
+{
+    struct pollfd fds[2] = {{m_socket_fd, POLLIN, 0}, {m_wakeup_fd, POLLIN, 0}};
+    int ready = poll(fds, (-1 != m_wakeup_fd) ? 2 : 1, wait_ms);
+
+    ++syscalls;
+    if (0 >= ready)
+    {
+        return false;
+    }
+    if (fds[1].revents & POLLIN)
+    {
+        uint64_t event_count = 0;
+
+        if (sizeof(event_count) != read(m_wakeup_fd, &event_count, sizeof(event_count)))
+        {
+            MIRACASTLOG_VERBOSE("RTP receiver wake-up read: %s", strerror(errno));
+        }
+        return false;
+    }
+    return (0 != (fds[0].revents & POLLIN));
+}
+
+int MiracastRTPReceiver::receive(RTP_RECEIVER_PACKET_STRUCT *packets, unsigned int max_packets, int wait_ms)
+{
+    unsigned int batch = 0,
+                 delivered = 0,
+                 truncated = 0,
+                 reordered = 0,
+                 syscalls = 0,
+                 hits = 0,
+                 misses = 0,
+                 slots_in_use = 0;
+    uint32_t kernel_drops = 0;
+    bool kernel_drops_valid = false;
+    int received = 0;
+
+    if (-1 == m_socket_fd)
+    {
+        return -1;
+    }
+
+    // Asked for by reserve(), normally once the negotiated bitrate is known
+    grow_pool(m_reserved_size.load(std::memory_order_relaxed));
+
+    max_packets = std::min(max_packets, static_cast<unsigned int>(RTP_RECEIVER_BATCH_SIZE));
+    batch = fill_batch(max_packets);
+    if (0 == batch)
+    {
+        unsigned int first_new_slot = m_pool_size;
+
+        // Downstream holds more than the pool was sized for, growing it beats letting the socket overflow
+        if (grow_pool(m_pool_size + RTP_RECEIVER_POOL_GROW_SIZE))
+        {
+            m_next_slot = first_new_slot;
+            batch = fill_batch(max_packets);
+        }
+    }
+
+    if (0 == batch)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_stats_mutex);
+            m_stats.pool_exhausted++;
+        }
+        // The kernel buffer absorbs the stream meanwhile, stay responsive to interrupt().
+        // Waiting forever backs off as well, a paused session would spin here otherwise
+        struct pollfd wakeup = {m_wakeup_fd, POLLIN, 0};
+        int pool_wait_ms = (0 > wait_ms) ? RTP_RECEIVER_POOL_WAIT_MS : std::min(wait_ms, RTP_RECEIVER_POOL_WAIT_MS);
+
+        if ((-1 != m_wakeup_fd) && (0 < poll(&wakeup, 1, pool_wait_ms)))
+        {
+            uint64_t event_count = 0;
+
+            if (sizeof(event_count) != read(m_wakeup_fd, &event_count, sizeof(event_count)))
+            {
+                MIRACASTLOG_VERBOSE("RTP receiver wake-up read: %s", strerror(errno));
+            }
+        }
+        return 0;
+    }
+
+    // A short batch drained the socket, so wait first instead of a recvmmsg() bound to fail
+    if ((!m_backlog) && (0 != wait_ms) && (!wait_readable(wait_ms, syscalls)))
+    {
+        std::lock_guard<std::mutex> lock(m_stats_mutex);
+        m_stats.syscalls += syscalls;
+        return 0;
+    }
+    received = recvmmsg(m_socket_fd, m_messages, batch, MSG_DONTWAIT, nullptr);
+    ++syscalls;
+    if (-1 == received)
+    {
+        int error = errno;
+
+        m_backlog = false;
+        {
+            std::lock_guard<std::mutex> lock(m_stats_mutex);
+            m_stats.syscalls += syscalls;
+        }
+        if ((EAGAIN == error) || (EWOULDBLOCK == error) || (EINTR == error))
+        {
+            return 0;
+        }
+        MIRACASTLOG_ERROR("recvmmsg failed: %s", strerror(error));
+        return -1;
+    }
+    m_backlog = (static_cast<unsigned int>(received) == batch);
+
+    for (int index = 0; index < received; ++index)
+    {
+        struct msghdr *header = &m_messages[index].msg_hdr;
+
+        for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(header); nullptr != cmsg; cmsg = CMSG_NXTHDR(header, cmsg))
+        {
+            if ((SOL_SOCKET == cmsg->cmsg_level) && (SO_RXQ_OVFL == cmsg->cmsg_type))
+            {
+                memcpy(&kernel_drops, CMSG_DATA(cmsg), sizeof(kernel_drops));
+                kernel_drops_valid = true;
+            }
+        }
+
+        // The slot is left free, the next batch simply reuses it
+        if (header->msg_flags & MSG_TRUNC)
+        {
+            ++truncated;
+            continue;
+        }
+
+        RTP_RECEIVER_SLOT_STRUCT *slot = m_slots[m_batch_slots[index]];
+
+        if (4 <= m_messages[index].msg_len)
+        {
+            uint16_t sequence = static_cast<uint16_t>((slot->data[2] << 8) | slot->data[3]);
+
+            if ((m_sequence_valid) && (0 > static_cast<int16_t>(sequence - m_next_sequence)))
+            {
+                ++reordered;
+            }
+            else
+            {
+                m_next_sequence = static_cast<uint16_t>(sequence + 1);
+                m_sequence_valid = true;
+            }
+        }
+        if (slot->recycled)
+        {
+            ++hits;
+        }
+        else
+        {
+            ++misses;
+            slot->recycled = true;
+        }
+        slot->in_use.store(true, std::memory_order_relaxed);
+        packets[delivered].data = slot->data;
+        packets[delivered].length = m_messages[index].msg_len;
+        packets[delivered].slot_handle = slot;
+        ++delivered;
+    }
+    m_pool->references.fetch_add(delivered, std::memory_order_relaxed);
+    slots_in_use = m_pool->slots_in_use.fetch_add(delivered, std::memory_order_relaxed) + delivered;
+    m_next_slot = (m_next_slot + static_cast<unsigned int>(received)) % m_pool_size;
+
+    {
+        std::lock_guard<std::mutex> lock(m_stats_mutex);
+
+        m_stats.syscalls += syscalls;
+        m_stats.packets += delivered;
+        for (unsigned int index = 0; index < delivered; ++index)
+        {
+            m_stats.bytes += packets[index].length;
+        }
+        m_stats.max_batch = std::max(m_stats.max_batch, static_cast<unsigned int>(received));
+        m_stats.truncated += truncated;
+        m_stats.reordered += reordered;
+        m_stats.pool_hits += hits;
+        m_stats.pool_misses += misses;
+        m_stats.pool_high_water = std::max(m_stats.pool_high_water, slots_in_use);
+        // Cumulative per socket, only sent along once the kernel has dropped something
+        if (kernel_drops_valid)
+        {
+            m_stats.kernel_drops = kernel_drops;
+        }
+    }
+    return static_cast<int>(delivered);
+}
+
+void MiracastRTPReceiver::get_statistics(RTP_RECEIVER_STATS_STRUCT &stats)
+{
+    std::lock_guard<std::mutex> lock(m_stats_mutex);
+
+    stats = m_stats;
+    stats.slots_in_use = m_pool->slots_in_use.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,172 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _MIRACAST_RTP_RECEIVER_H_
+#define _MIRACAST_RTP_RECEIVER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+/* 12 byte RTP header, 7 TS packets and room for header extensions on a 1500 byte MTU */
+#define RTP_RECEIVER_SLOT_SIZE   ( 1536 )
+#define RTP_RECEIVER_BATCH_SIZE   ( 64 )
+/* About 3 MB, half a second of a 40 Mbit/s stream held downstream before the receiver stalls */
+#define RTP_RECEIVER_DFLT_POOL_SIZE   ( 2048 )
+/* 12 MB, the pool never grows past it */
+#define RTP_RECEIVER_MAX_POOL_SIZE   ( 8192 )
+#define RTP_RECEIVER_POOL_GROW_SIZE   ( 256 )
+/* How long receive() backs off when every slot is still held downstream */
+#define RTP_RECEIVER_POOL_WAIT_MS   ( 2 )
+#define RTP_RECEIVER_DFLT_RCVBUF_SIZE   ( 4 * 1024 * 1024 )
+
+typedef struct rtp_receiver_packet_st
+{
+    uint8_t *data;
+    size_t length;
+    /* Hand to MiracastRTPReceiver::release_slot() once the data is no longer used */
+    void *slot_handle;
+} RTP_RECEIVER_PACKET_STRUCT;
+
+typedef struct rtp_receiver_stats_st
+{
+    uint64_t packets;
+    uint64_t bytes;
+    /* poll() and recvmmsg() calls */
+    uint64_t syscalls;
+    unsigned int max_batch;
+    /* Datagrams larger than a slot, dropped */
+    uint64_t truncated;
+    /* RTP sequence number behind the highest one seen so far */
+    uint64_t reordered;
+    /* Datagrams dropped by the kernel on a full socket buffer, from SO_RXQ_OVFL */
+    uint64_t kernel_drops;
+    /* receive() calls that found every slot still held downstream and the pool at its maximum */
+    uint64_t pool_exhausted;
+    unsigned int slots_in_use;
+    /* Slots allocated and the most ever held downstream at once */
+    unsigned int pool_size;
+    unsigned int pool_high_water;
+    /* Datagrams received into a recycled slot, and into one used for the first time */
+    uint64_t pool_hits;
+    uint64_t pool_misses;
+    /* SO_RCVBUF as reported back by the kernel */
+    int rcvbuf_size;
+} RTP_RECEIVER_STATS_STRUCT;
+
+/**
+ * UDP receiver for the Miracast RTP stream.
+ *
+ * Datagrams are read with recvmmsg(), up to RTP_RECEIVER_BATCH_SIZE per
+ * syscall, straight into a pool of fixed size slots. A slot stays owned by the
+ * caller until release_slot(), so the data can be wrapped into downstream
+ * buffers without a copy, and is recycled afterwards. The pool only grows, in
+ * chunks that never move: up to the size asked for with reserve(), and by
+ * RTP_RECEIVER_POOL_GROW_SIZE whenever every slot is held downstream, as long
+ * as it stays within max_pool_size. The socket
+ * buffer is raised with SO_RCVBUFFORCE where permitted, SO_RCVBUF otherwise,
+ * and SO_RXQ_OVFL reports what the kernel still had to drop.
+ *
+ * receive() and interrupt() may be called from different threads,
+ * release_slot() and reserve() from any thread. The pool is shared by the
+ * receiver and the slots held downstream, so a slot can still be released
+ * after the receiver is gone, the last one frees it.
+ */
+class MiracastRTPReceiver
+{
+public:
+    explicit MiracastRTPReceiver(unsigned int pool_size = RTP_RECEIVER_DFLT_POOL_SIZE,
+                                    unsigned int max_pool_size = RTP_RECEIVER_MAX_POOL_SIZE);
+    ~MiracastRTPReceiver();
+
+    /* Binds 0.0.0.0:port, port 0 picks an ephemeral port */
+    bool open(unsigned short port, int rcvbuf_size = RTP_RECEIVER_DFLT_RCVBUF_SIZE);
+    void close(void);
+    unsigned short get_port(void) const { return m_port; }
+
+    /* Waits up to wait_ms for the first datagram, -1 waits until data or interrupt() */
+    int receive(RTP_RECEIVER_PACKET_STRUCT *packets, unsigned int max_packets, int wait_ms);
+    void interrupt(void);
+    static void release_slot(void *slot_handle);
+    /* Applied by the next receive(), the pool is never shrunk */
+    void reserve(unsigned int pool_size);
+
+    void get_statistics(RTP_RECEIVER_STATS_STRUCT &stats);
+
+private:
+    struct rtp_receiver_pool_st;
+
+    typedef struct rtp_receiver_slot_st
+    {
+        struct rtp_receiver_pool_st *pool;
+        uint8_t *data;
+        std::atomic<bool> in_use;
+        /* Only touched by receive() */
+        bool recycled;
+    } RTP_RECEIVER_SLOT_STRUCT;
+
+    typedef struct rtp_receiver_chunk_st
+    {
+        uint8_t *data;
+        RTP_RECEIVER_SLOT_STRUCT *slots;
+    } RTP_RECEIVER_CHUNK_STRUCT;
+
+    typedef struct rtp_receiver_pool_st
+    {
+        std::vector<RTP_RECEIVER_CHUNK_STRUCT> chunks;
+        std::atomic<unsigned int> slots_in_use;
+        /* The receiver and every slot held downstream */
+        std::atomic<unsigned int> references;
+    } RTP_RECEIVER_POOL_STRUCT;
+
+    int m_socket_fd;
+    int m_wakeup_fd;
+    unsigned short m_port;
+    unsigned int m_pool_size;
+    unsigned int m_max_pool_size;
+    std::atomic<unsigned int> m_reserved_size;
+    unsigned int m_next_slot;
+    /* The previous batch filled up, more datagrams are likely queued already */
+    bool m_backlog;
+    bool m_sequence_valid;
+    uint16_t m_next_sequence;
+    RTP_RECEIVER_POOL_STRUCT *m_pool;
+    /* Every slot of every chunk, in the order receive() walks them */
+    std::vector<RTP_RECEIVER_SLOT_STRUCT *> m_slots;
+    std::mutex m_stats_mutex;
+    RTP_RECEIVER_STATS_STRUCT m_stats;
+    /* recvmmsg() vectors, only the slot pointers and lengths change per call */
+    struct mmsghdr m_messages[RTP_RECEIVER_BATCH_SIZE];
+    struct iovec m_iovecs[RTP_RECEIVER_BATCH_SIZE];
+    char m_control[RTP_RECEIVER_BATCH_SIZE][CMSG_SPACE(sizeof(uint32_t))];
+    unsigned int m_batch_slots[RTP_RECEIVER_BATCH_SIZE];
+
+    bool wait_readable(int wait_ms, unsigned int &syscalls);
+    bool grow_pool(unsigned int pool_size);
+    unsigned int fill_batch(unsigned int max_packets);
+    static void release_pool(RTP_RECEIVER_POOL_STRUCT *pool);
+
+    MiracastRTPReceiver(const MiracastRTPReceiver &) = delete;
+    MiracastRTPReceiver &operator=(const MiracastRTPReceiver &) = delete;
+};
+
+#endif
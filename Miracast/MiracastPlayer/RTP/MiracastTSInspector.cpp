@@ -0,0 +1,282 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include <algorithm>
+#include <MiracastTSInspector.h>
+
+/* 27 MHz PCR, its 33 bit base wraps after about 26.5 hours */
+#define TS_INSPECTOR_PCR_TICKS_PER_US   ( 27 )
+#define TS_INSPECTOR_PCR_WRAP   ( (1ULL << 33) * 300 )
+#define TS_INSPECTOR_PCR_MAX_GAP   ( 27000000ULL )
+
+MiracastTSInspector::MiracastTSInspector()
+{
+    reset_locked();
+}
+
+MiracastTSInspector::~MiracastTSInspector()
+{
+}
+
+void MiracastTSInspector::reset(void)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    reset_locked();
+}
+
+void MiracastTSInspector::reset_locked(void)
+{
+    memset(m_pid_index, 0x00, sizeof(m_pid_index));
+    memset(m_pid_states, 0x00, sizeof(m_pid_states));
+    memset(&m_stats, 0x00, sizeof(m_stats));
+    m_synced = false;
+    m_partial_length = 0;
+    m_pcr_valid = false;
+    m_last_pcr = 0;
+    m_last_pcr_arrival_us = 0;
+    m_pcr_jitter_x16 = 0;
+    m_last_arrival_us = 0;
+    m_last_report_us = 0;
+}
+
+/* Offset of the first 0x47 followed by two more a packet apart, as far as the data reaches */
+size_t MiracastTSInspector::find_sync(const uint8_t *data, size_t length)
+{
+    const uint8_t *end = data + length,
+                  *candidate = data;
+
+    while (nullptr != (candidate = static_cast<const uint8_t *>(memchr(candidate, TS_INSPECTOR_SYNC_BYTE, end - candidate))))
+    {
+        size_t remaining = end - candidate;
+
+        if (((remaining <= TS_INSPECTOR_PACKET_SIZE) || (TS_INSPECTOR_SYNC_BYTE == candidate[TS_INSPECTOR_PACKET_SIZE])) &&
+            ((remaining <= 2 * TS_INSPECTOR_PACKET_SIZE) || (TS_INSPECTOR_SYNC_BYTE == candidate[2 * TS_INSPECTOR_PACKET_SIZE])))
+        {
+            return candidate - data;
+        }
+        ++candidate;
+    }
+    return length;
+}
+
+void MiracastTSInspector::inspect(const uint8_t *data, size_t length, uint64_t arrival_us)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (0 == m_last_report_us)
+    {
+        m_last_report_us = arrival_us;
+    }
+    m_last_arrival_us = arrival_us;
+
+    if (0 < m_partial_length)
+    {
+        size_t needed = TS_INSPECTOR_PACKET_SIZE - m_partial_length;
+
+        if (length < needed)
+        {
+            memcpy(m_partial + m_partial_length, data, length);
+            m_partial_length += length;
+            return;
+        }
+        memcpy(m_partial + m_partial_length, data, needed);
+        m_partial_length = 0;
+        data += needed;
+        length -= needed;
+        inspect_packet(m_partial, arrival_us);
+    }
+
+    while (TS_INSPECTOR_PACKET_SIZE <= length)
+    {
+        if (TS_INSPECTOR_SYNC_BYTE != data[0])
+        {
+            size_t offset = 0;
+
+            if (m_synced)
+            {
+                m_stats.sync_losses++;
+                m_synced = false;
+            }
+            offset = find_sync(data, length);
+            m_stats.skipped_bytes += offset;
+            data += offset;
+            length -= offset;
+            if (TS_INSPECTOR_PACKET_SIZE > length)
+            {
+                break;
+            }
+        }
+        m_synced = true;
+        inspect_packet(data, arrival_us);
+        data += TS_INSPECTOR_PACKET_SIZE;
+        length -= TS_INSPECTOR_PACKET_SIZE;
+    }
+
+    // The head of a packet that continues in the next buffer
+    if (0 < length)
+    {
+        if (TS_INSPECTOR_SYNC_BYTE == data[0])
+        {
+            memcpy(m_partial, data, length);
+            m_partial_length = length;
+        }
+        else
+        {
+            m_stats.skipped_bytes += length;
+        }
+    }
+}
+
+void MiracastTSInspector::inspect_packet(const uint8_t *packet, uint64_t arrival_us)
+{
+    uint16_t pid = static_cast<uint16_t>(((packet[1] & 0x1F) << 8) | packet[2]);
+    uint8_t adaptation_field_control = (packet[3] >> 4) & 0x03,
+            continuity_counter = packet[3] & 0x0F,
+            index = 0;
+    bool has_adaptation_field = (0 != (adaptation_field_control & 0x02)) && (0 < packet[4]),
+         discontinuity = has_adaptation_field && (0 != (packet[5] & 0x80));
+
+    if (TS_INSPECTOR_SYNC_BYTE != packet[0])
+    {
+        // Only a reassembled packet can get here unsynced
+        m_stats.sync_losses++;
+        m_synced = false;
+        return;
+    }
+    m_stats.packets++;
+    if (0 != (packet[1] & 0x80))
+    {
+        m_stats.transport_errors++;
+    }
+    if (TS_INSPECTOR_NULL_PID == pid)
+    {
+        return;
+    }
+
+    index = m_pid_index[pid];
+    if (0 == index)
+    {
+        if (TS_INSPECTOR_MAX_PIDS <= m_stats.pid_count)
+        {
+            m_stats.untracked_packets++;
+            return;
+        }
+        index = static_cast<uint8_t>(++m_stats.pid_count);
+        m_pid_index[pid] = index;
+        m_pid_states[index - 1].pid = pid;
+        m_pid_states[index - 1].last_cc = -1;
+    }
+
+    TS_INSPECTOR_PID_STATE_STRUCT &state = m_pid_states[index - 1];
+
+    state.packets++;
+    // The counter only advances with a payload, a single repeat of a packet is allowed
+    if (0 != (adaptation_field_control & 0x01))
+    {
+        if ((0 <= state.last_cc) && (!discontinuity) &&
+            (continuity_counter != ((state.last_cc + 1) & 0x0F)) && (continuity_counter != state.last_cc))
+        {
+            state.cc_errors++;
+            m_stats.cc_errors++;
+        }
+        state.last_cc = static_cast<int8_t>(continuity_counter);
+    }
+    // adaptation_field_length of at least 7 and the PCR flag
+    if ((has_adaptation_field) && (7 <= packet[4]) && (0 != (packet[5] & 0x10)))
+    {
+        inspect_pcr(pid, packet, arrival_us, discontinuity);
+    }
+}
+
+/* Compares how far apart two PCRs are on the 27 MHz clock of the source with how far apart
+ * they arrived here. A steady source on a clean link keeps the difference near zero. */
+void MiracastTSInspector::inspect_pcr(uint16_t pid, const uint8_t *packet, uint64_t arrival_us, bool discontinuity)
+{
+    uint64_t base = (static_cast<uint64_t>(packet[6]) << 25) |
+                    (static_cast<uint64_t>(packet[7]) << 17) |
+                    (static_cast<uint64_t>(packet[8]) << 9) |
+                    (static_cast<uint64_t>(packet[9]) << 1) |
+                    (static_cast<uint64_t>(packet[10]) >> 7),
+             pcr = (base * 300) + ((static_cast<uint64_t>(packet[10] & 0x01) << 8) | packet[11]);
+
+    if (0 == m_stats.pcr_count)
+    {
+        m_stats.pcr_pid = pid;
+    }
+    else if (pid != m_stats.pcr_pid)
+    {
+        return;
+    }
+    m_stats.pcr_count++;
+
+    if ((m_pcr_valid) && (!discontinuity))
+    {
+        uint64_t pcr_delta = (pcr + TS_INSPECTOR_PCR_WRAP - m_last_pcr) % TS_INSPECTOR_PCR_WRAP;
+
+        if (TS_INSPECTOR_PCR_MAX_GAP < pcr_delta)
+        {
+            m_stats.pcr_resets++;
+        }
+        else
+        {
+            int64_t difference = static_cast<int64_t>(arrival_us - m_last_pcr_arrival_us) -
+                                 static_cast<int64_t>(pcr_delta / TS_INSPECTOR_PCR_TICKS_PER_US);
+            uint64_t magnitude = static_cast<uint64_t>((0 > difference) ? -difference : difference);
+
+            m_pcr_jitter_x16 = m_pcr_jitter_x16 + magnitude - (m_pcr_jitter_x16 >> 4);
+            m_stats.pcr_jitter_max_us = std::max(m_stats.pcr_jitter_max_us, magnitude);
+        }
+    }
+    else if (m_pcr_valid)
+    {
+        m_stats.pcr_resets++;
+    }
+    m_last_pcr = pcr;
+    m_last_pcr_arrival_us = arrival_us;
+    m_pcr_valid = true;
+}
+
+void MiracastTSInspector::get_statistics(TS_INSPECTOR_STATS_STRUCT &stats)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint64_t elapsed_us = m_last_arrival_us - m_last_report_us;
+
+    m_stats.pcr_jitter_us = m_pcr_jitter_x16 >> 4;
+    for (unsigned int index = 0; index < m_stats.pid_count; ++index)
+    {
+        TS_INSPECTOR_PID_STATE_STRUCT &state = m_pid_states[index];
+        TS_INSPECTOR_PID_STATS_STRUCT &pid_stats = m_stats.pids[index];
+        uint64_t bytes = state.packets * TS_INSPECTOR_PACKET_SIZE;
+
+        pid_stats.pid = state.pid;
+        pid_stats.packets = state.packets;
+        pid_stats.cc_errors = state.cc_errors;
+        if (0 < elapsed_us)
+        {
+            pid_stats.bitrate_kbps = static_cast<uint32_t>(((bytes - state.bytes_reported) * 8000) / elapsed_us);
+            state.bytes_reported = bytes;
+        }
+    }
+    if (0 < elapsed_us)
+    {
+        m_last_report_us = m_last_arrival_us;
+    }
+    stats = m_stats;
+}
@@ -0,0 +1,121 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _MIRACAST_TS_INSPECTOR_H_
+#define _MIRACAST_TS_INSPECTOR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <mutex>
+
+#define TS_INSPECTOR_PACKET_SIZE   ( 188 )
+#define TS_INSPECTOR_SYNC_BYTE   ( 0x47 )
+#define TS_INSPECTOR_PID_COUNT   ( 8192 )
+#define TS_INSPECTOR_NULL_PID   ( 0x1FFF )
+/* A WFD stream carries PAT, PMT, PCR, one video and one audio PID, the rest are counted as untracked */
+#define TS_INSPECTOR_MAX_PIDS   ( 8 )
+
+typedef struct ts_inspector_pid_stats_st
+{
+    uint16_t pid;
+    uint64_t packets;
+    uint64_t cc_errors;
+    /* Since the previous get_statistics() call */
+    uint32_t bitrate_kbps;
+} TS_INSPECTOR_PID_STATS_STRUCT;
+
+typedef struct ts_inspector_stats_st
+{
+    uint64_t packets;
+    /* Times the packet alignment was lost and searched for again */
+    uint64_t sync_losses;
+    /* Bytes thrown away while searching for the sync byte */
+    uint64_t skipped_bytes;
+    uint64_t cc_errors;
+    uint64_t transport_errors;
+    uint64_t untracked_packets;
+    uint16_t pcr_pid;
+    uint64_t pcr_count;
+    /* PCR discontinuities and jumps of more than a second, the reference is taken again */
+    uint64_t pcr_resets;
+    /* Smoothed and worst |arrival delta - PCR delta| of consecutive PCRs */
+    uint64_t pcr_jitter_us;
+    uint64_t pcr_jitter_max_us;
+    unsigned int pid_count;
+    TS_INSPECTOR_PID_STATS_STRUCT pids[TS_INSPECTOR_MAX_PIDS];
+} TS_INSPECTOR_STATS_STRUCT;
+
+/**
+ * Walks the 188 byte packets of a transport stream as it passes through the
+ * player and keeps per PID continuity counter and PCR timing statistics.
+ *
+ * inspect() takes buffers of any size, a packet split across two buffers is
+ * reassembled. While aligned only the sync byte of each packet is checked, when
+ * that fails memchr() scans for the next 0x47 that is followed by two more
+ * sync bytes a packet apart.
+ *
+ * inspect() is meant for the streaming thread, get_statistics() and reset()
+ * may be called from any other thread.
+ */
+class MiracastTSInspector
+{
+public:
+    MiracastTSInspector();
+    ~MiracastTSInspector();
+
+    void reset(void);
+    void inspect(const uint8_t *data, size_t length, uint64_t arrival_us);
+    void get_statistics(TS_INSPECTOR_STATS_STRUCT &stats);
+
+private:
+    typedef struct ts_inspector_pid_state_st
+    {
+        uint16_t pid;
+        int8_t last_cc;
+        uint64_t packets;
+        uint64_t cc_errors;
+        uint64_t bytes_reported;
+    } TS_INSPECTOR_PID_STATE_STRUCT;
+
+    std::mutex m_mutex;
+    /* PID to 1 based index into m_pid_states, 0 for not tracked yet */
+    uint8_t m_pid_index[TS_INSPECTOR_PID_COUNT];
+    TS_INSPECTOR_PID_STATE_STRUCT m_pid_states[TS_INSPECTOR_MAX_PIDS];
+    TS_INSPECTOR_STATS_STRUCT m_stats;
+    bool m_synced;
+    uint8_t m_partial[TS_INSPECTOR_PACKET_SIZE];
+    size_t m_partial_length;
+    bool m_pcr_valid;
+    uint64_t m_last_pcr;
+    uint64_t m_last_pcr_arrival_us;
+    /* |D| of RFC 3550 style smoothing, scaled by 16 */
+    uint64_t m_pcr_jitter_x16;
+    uint64_t m_last_arrival_us;
+    uint64_t m_last_report_us;
+
+    void inspect_packet(const uint8_t *packet, uint64_t arrival_us);
+    void inspect_pcr(uint16_t pid, const uint8_t *packet, uint64_t arrival_us, bool discontinuity);
+    void reset_locked(void);
+    size_t find_sync(const uint8_t *data, size_t length);
+
+    MiracastTSInspector(const MiracastTSInspector &) = delete;
+    MiracastTSInspector &operator=(const MiracastTSInspector &) = delete;
+};
+
+#endif
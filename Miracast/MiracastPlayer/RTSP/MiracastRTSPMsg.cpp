@@ -187,6 +187,7 @@ void MiracastRTSPMsg::destroyInstance()
 }
 
 MiracastRTSPMsg::MiracastRTSPMsg()
+    : m_uibc(m_latency_stats)
 {
     RTSP_WFD_VIDEO_FMT_STRUCT st_video_fmt = {0};
     RTSP_WFD_AUDIO_FMT_STRUCT st_audio_fmt = { RTSP_UNSUPPORTED_AUDIO_FORMAT , 0 };
@@ -195,7 +196,25 @@ MiracastRTSPMsg::MiracastRTSPMsg()
     MIRACASTLOG_TRACE("Entering...");
     m_tcpSockfd = -1;
     m_epollfd = -1;
+    m_connect_latency_us = 0;
+    m_control_eventfd = -1;
+    m_keep_alive_timerfd = -1;
+    m_rtsp_msg_handler_thread = nullptr;
+    m_controller_thread = nullptr;
+    m_player_notify_handler = nullptr;
     m_streaming_started = false;
+    m_cached_params_applied = false;
+    m_latency_profile = MIRACAST_GSTPLAYER_LATENCY_PROFILE_DEFAULT;
+    m_video_sink_config.video_sink = MIRACAST_GSTPLAYER_VIDEO_SINK_WESTEROS;
+    m_video_sink_config.sync = true;
+    m_video_sink_config.software_decode = false;
+    m_pipeline_mode = MIRACAST_GSTPLAYER_PIPELINE_MODE_DUAL;
+    m_play_request_us = 0;
+    memset(&m_player_statistics, 0x00, sizeof(m_player_statistics));
+    m_player_statistics_interval_sec = 0;
+    m_player_statistics_samples = 0;
+    m_element_tracer = false;
+    memset(&m_element_trace, 0x00, sizeof(m_element_trace));
 
     m_wfd_src_req_timeout = RTSP_REQUEST_RECV_TIMEOUT;
     m_wfd_src_res_timeout = RTSP_RESPONSE_RECV_TIMEOUT;
@@ -224,9 +243,15 @@ MiracastRTSPMsg::MiracastRTSPMsg()
     m_current_sequence_number.clear();
     m_src_dev_ip.clear();
     m_sink_ip.clear();
-    m_getparameter_request.clear();
 
-    set_WFDUIBCCapability("none");
+    m_m3_full_body.clear();
+    m_m3_full_body_mask = 0;
+    memset(&m_wfd_negotiated_video_st , 0x00 , sizeof(RTSP_WFD_VIDEO_FMT_STRUCT));
+    memset(&m_wfd_negotiated_audio_st , 0x00 , sizeof(RTSP_WFD_AUDIO_FMT_STRUCT));
+
+    compile_request_response_templates();
+
+    set_WFDUIBCCapability(RTSP_DFLT_UIBC_CAPABILITY);
     set_WFDDisplayEDID("none");
     set_WFDConnectorType("7");
 
@@ -282,11 +307,63 @@ MiracastRTSPMsg::~MiracastRTSPMsg()
 #endif
 
     Release_SocketAndEpollDescriptor();
+
+    if ( -1 != m_control_eventfd )
+    {
+        close(m_control_eventfd);
+        m_control_eventfd = -1;
+    }
+    if ( -1 != m_keep_alive_timerfd )
+    {
+        close(m_keep_alive_timerfd);
+        m_keep_alive_timerfd = -1;
+    }
+}
+
+/*
+ * Session epoll set: the RTSP socket, the M16 keep-alive timer and the
+ * eventfd signalled for every message posted to the RTSP handler thread.
+ */
+bool MiracastRTSPMsg::add_SessionEventDescriptors(void)
+{
+    int session_fds[RTSP_SESSION_EPOLL_EVENTS] = { m_tcpSockfd, m_keep_alive_timerfd, m_control_eventfd };
+    struct epoll_event event = {0};
+
+    MIRACASTLOG_TRACE("Entering...");
+
+    m_epollfd = epoll_create1(EPOLL_CLOEXEC);
+    if ( -1 == m_epollfd )
+    {
+        MIRACASTLOG_ERROR("epoll_create1 failed: [%s]", strerror(errno));
+        MIRACASTLOG_TRACE("Exiting...");
+        return false;
+    }
+
+    for (int index = 0; index < RTSP_SESSION_EPOLL_EVENTS; ++index)
+    {
+        event.events = EPOLLIN;
+        if (m_tcpSockfd == session_fds[index])
+        {
+            event.events |= EPOLLRDHUP;
+        }
+        event.data.fd = session_fds[index];
+
+        if ( -1 == epoll_ctl(m_epollfd, EPOLL_CTL_ADD, session_fds[index], &event))
+        {
+            MIRACASTLOG_ERROR("epoll_ctl fd[%d] failed: [%s]", session_fds[index], strerror(errno));
+            MIRACASTLOG_TRACE("Exiting...");
+            return false;
+        }
+    }
+    MIRACASTLOG_TRACE("Exiting...");
+    return true;
 }
 
 void MiracastRTSPMsg::Release_SocketAndEpollDescriptor(void)
 {
     MIRACASTLOG_TRACE("Entering...");
+    arm_keep_alive_timer(0);
+    m_uibc.stop();
     if (-1 != m_tcpSockfd)
     {
         shutdown(m_tcpSockfd , SHUT_RDWR);
@@ -301,11 +378,74 @@ void MiracastRTSPMsg::Release_SocketAndEpollDescriptor(void)
     MIRACASTLOG_TRACE("Exiting...");
 }
 
+/*
+ * One-shot M16 deadline, re-armed on every keep-alive. 0 disarms the timer.
+ */
+void MiracastRTSPMsg::arm_keep_alive_timer(int timeout_sec)
+{
+    struct itimerspec timer_spec = {};
+
+    if ( -1 == m_keep_alive_timerfd )
+    {
+        return;
+    }
+
+    timer_spec.it_value.tv_sec = (0 < timeout_sec) ? timeout_sec : 0;
+
+    if ( -1 == timerfd_settime(m_keep_alive_timerfd, 0, &timer_spec, nullptr))
+    {
+        MIRACASTLOG_ERROR("timerfd_settime failed: [%s]", strerror(errno));
+    }
+}
+
+void MiracastRTSPMsg::clear_control_event(void)
+{
+    uint64_t event_count = 0;
+
+    if (( -1 != m_control_eventfd ) &&
+        ( sizeof(event_count) != read(m_control_eventfd, &event_count, sizeof(event_count))) &&
+        ( EAGAIN != errno ))
+    {
+        MIRACASTLOG_ERROR("eventfd read failed: [%s]", strerror(errno));
+    }
+}
+
+// Wakes the handler if it is blocked on the session epoll set
+void MiracastRTSPMsg::signal_control_event(void)
+{
+    uint64_t event_count = 1;
+
+    if (( -1 != m_control_eventfd ) &&
+        ( sizeof(event_count) != write(m_control_eventfd, &event_count, sizeof(event_count))))
+    {
+        MIRACASTLOG_ERROR("eventfd write failed: [%s]", strerror(errno));
+    }
+}
+
+bool MiracastRTSPMsg::create_SessionEventDescriptors(void)
+{
+    m_control_eventfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    m_keep_alive_timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+    if (( -1 == m_control_eventfd ) || ( -1 == m_keep_alive_timerfd ))
+    {
+        MIRACASTLOG_ERROR("Failed to create RTSP event descriptors: [%s]", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
 MiracastError MiracastRTSPMsg::create_RTSPThread(void)
 {
     MiracastError error_code = MIRACAST_FAIL;
     MIRACASTLOG_TRACE("Entering...");
 
+    if (!create_SessionEventDescriptors())
+    {
+        MIRACASTLOG_TRACE("Exiting...");
+        return MIRACAST_FAIL;
+    }
+
     m_rtsp_msg_handler_thread = new MiracastThread( RTSP_HANDLER_THREAD_NAME,
                                                     RTSP_HANDLER_THREAD_STACK,
                                                     RTSP_HANDLER_MSG_COUNT,
@@ -348,6 +488,7 @@ bool MiracastRTSPMsg::set_WFDVideoFormat(RTSP_WFD_VIDEO_FMT_STRUCT st_video_fmt)
                             st_video_fmt.st_h264_codecs.cea_mask,
                             st_video_fmt.st_h264_codecs.vesa_mask,
                             st_video_fmt.st_h264_codecs.hh_mask);
+        update_m3_response_cache();
         MIRACASTLOG_TRACE("Exiting...");
         return false;
     }
@@ -399,6 +540,7 @@ bool MiracastRTSPMsg::set_WFDVideoFormat(RTSP_WFD_VIDEO_FMT_STRUCT st_video_fmt)
     }
 
     MIRACASTLOG_INFO("video format[%s]...\n",m_wfd_video_formats.c_str());
+    update_m3_response_cache();
     MIRACASTLOG_TRACE("Exiting...");
     return true;
 }
@@ -423,6 +565,7 @@ bool MiracastRTSPMsg::set_WFDAudioCodecs( RTSP_WFD_AUDIO_FMT_STRUCT st_audio_fmt
         (RTSP_AC3_UNSUPPORTED_MASK & st_audio_fmt.modes)))
     {
         MIRACASTLOG_ERROR("Invalid audio format/mode[%#08X/%#08X]...\n",st_audio_fmt.modes,st_audio_fmt.modes);
+        update_m3_response_cache();
         MIRACASTLOG_TRACE("Exiting...");
         return false;
     }
@@ -447,6 +590,7 @@ bool MiracastRTSPMsg::set_WFDAudioCodecs( RTSP_WFD_AUDIO_FMT_STRUCT st_audio_fmt
         default:
         {
             MIRACASTLOG_ERROR("unknown audio format[%#08X]...\n",st_audio_fmt.audio_format);
+            update_m3_response_cache();
             MIRACASTLOG_TRACE("Exiting...");
             return false;
         }
@@ -462,6 +606,7 @@ bool MiracastRTSPMsg::set_WFDAudioCodecs( RTSP_WFD_AUDIO_FMT_STRUCT st_audio_fmt
     m_wfd_audio_codecs = audio_format_buffer;
 
     MIRACASTLOG_INFO("audio format[%s]...\n",m_wfd_audio_codecs.c_str());
+    update_m3_response_cache();
     MIRACASTLOG_TRACE("Exiting...");
     return true;
 }
@@ -469,18 +614,21 @@ bool MiracastRTSPMsg::set_WFDAudioCodecs( RTSP_WFD_AUDIO_FMT_STRUCT st_audio_fmt
 bool MiracastRTSPMsg::set_WFDClientRTPPorts(std::string client_rtp_ports)
 {
     m_wfd_client_rtp_ports = client_rtp_ports;
+    update_m3_response_cache();
     return true;
 }
 
 bool MiracastRTSPMsg::set_WFDUIBCCapability(std::string uibc_caps)
 {
     m_wfd_uibc_capability = uibc_caps;
+    update_m3_response_cache();
     return true;
 }
 
 bool MiracastRTSPMsg::set_WFDContentProtection(std::string content_protection)
 {
     m_wfd_content_protection = content_protection;
+    update_m3_response_cache();
     return true;
 }
 
@@ -547,12 +695,14 @@ bool MiracastRTSPMsg::set_WFDSessionNumber(std::string session)
 bool MiracastRTSPMsg::set_WFDDisplayEDID(std::string wfd_display_edid)
 {
     m_wfd_display_edid = wfd_display_edid;
+    update_m3_response_cache();
     return true;
 }
 
 bool MiracastRTSPMsg::set_WFDConnectorType(std::string wfd_connector_type)
 {
     m_wfd_connector_type = wfd_connector_type;
+    update_m3_response_cache();
     return true;
 }
 
@@ -622,7 +772,7 @@ const char* MiracastRTSPMsg::get_parser_field_by_index(RTSP_PARSER_FIELDS parse_
     return "";
 }
 
-std::string MiracastRTSPMsg::get_parser_field_value(RTSP_PARSER_FIELDS parse_field)
+const std::string &MiracastRTSPMsg::get_parser_field_value(RTSP_PARSER_FIELDS parse_field)
 {
     MIRACASTLOG_TRACE("Entering [%#04X]...",parse_field);
 
@@ -631,87 +781,321 @@ std::string MiracastRTSPMsg::get_parser_field_value(RTSP_PARSER_FIELDS parse_fie
         MIRACASTLOG_TRACE("parse_field[%#04X][%x]",parse_field,rtsp_msg_parser_fields[parse_field].member_variable_ptr);
         if ( nullptr != rtsp_msg_parser_fields[parse_field].member_variable_ptr ){
             MIRACASTLOG_TRACE("Exiting...");
-            return (this->*rtsp_msg_parser_fields[parse_field].member_variable_ptr).c_str();
+            return (this->*rtsp_msg_parser_fields[parse_field].member_variable_ptr);
         }
     }
     MIRACASTLOG_TRACE("Exiting...");
-    return "";
+    return empty_string;
 }
 
-std::string MiracastRTSPMsg::get_parser_field_n_value_by_name(std::string request_field_name )
+const std::string &MiracastRTSPMsg::get_wfd_param_value(RTSP_WFD_PARAM_ID param_id)
 {
-    RTSP_PARSER_FIELDS parse_field = static_cast<RTSP_PARSER_FIELDS>(RTSP_PARSER_FIELD_START+1);
-    MIRACASTLOG_TRACE("Entering [%#04X]...",parse_field);
+    RTSP_PARSER_FIELDS parse_field = RTSP_PARSER_FIELD_END;
+
+    switch (param_id)
+    {
+        case RTSP_WFD_PARAM_CONTENT_PROTECTION:
+            parse_field = RTSP_WFD_HDCP_FIELD;
+            break;
+        case RTSP_WFD_PARAM_VIDEO_FORMATS:
+            parse_field = RTSP_WFD_VIDEO_FMT_FIELD;
+            break;
+        case RTSP_WFD_PARAM_AUDIO_CODECS:
+            parse_field = RTSP_WFD_AUDIO_CODEC_FIELD;
+            break;
+        case RTSP_WFD_PARAM_CLIENT_RTP_PORTS:
+            parse_field = RTSP_WFD_CLI_RTP_PORTS_FIELD;
+            break;
+        case RTSP_WFD_PARAM_DISPLAY_EDID:
+            parse_field = RTSP_WFD_DISPLAY_EDID_FIELD;
+            break;
+        case RTSP_WFD_PARAM_UIBC_CAPABILITY:
+            parse_field = RTSP_WFD_UIBC_CAPS_FIELD;
+            break;
+        case RTSP_WFD_PARAM_CONNECTOR_TYPE:
+            parse_field = RTSP_WFD_CONNECTOR_TYPE_FIELD;
+            break;
+        default:
+            // Not a sink capability which can be queried by M3
+            return empty_string;
+    }
+    return get_parser_field_value(parse_field);
+}
+
+void MiracastRTSPMsg::update_m3_response_cache(void)
+{
+    MIRACASTLOG_TRACE("Entering...");
 
-    while ( parse_field < RTSP_PARSER_FIELD_END )
+    m_m3_full_body.clear();
+    m_m3_full_body_mask = 0;
+
+    for (int param_id = RTSP_WFD_PARAM_CONTENT_PROTECTION; param_id < RTSP_WFD_PARAM_MAX; ++param_id)
     {
-        if (0 == (request_field_name.compare(rtsp_msg_parser_fields[parse_field].string_fmt)))
+        const std::string &param_value = get_wfd_param_value(static_cast<RTSP_WFD_PARAM_ID>(param_id));
+        std::string &param_line = m_m3_param_lines[param_id];
+
+        param_line.clear();
+        if (!param_value.empty())
         {
-            MIRACASTLOG_TRACE("Inx[%d]request_field_name[%s]fmt[%s]",
-                                parse_field,
-                                request_field_name.c_str(),
-                                rtsp_msg_parser_fields[parse_field].string_fmt);
+            param_line.append(MiracastRTSPParser::get_wfd_param_name(static_cast<RTSP_WFD_PARAM_ID>(param_id)));
+            param_line.append(": ");
+            param_line.append(param_value);
+            param_line.append(RTSP_CRLF_STR);
+
+            m_m3_full_body.append(param_line);
+            m_m3_full_body_mask |= RTSP_WFD_PARAM_BIT(param_id);
+        }
+    }
+    MIRACASTLOG_VERBOSE("M3 body cached for params[%#08X] length[%zu]", m_m3_full_body_mask, m_m3_full_body.length());
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+static RTSPStringView next_wfd_video_format_token(const RTSPStringView &video_formats, size_t &offset)
+{
+    size_t token_start = 0;
+
+    while ((offset < video_formats.length()) && (' ' == video_formats[offset]))
+    {
+        ++offset;
+    }
+    token_start = offset;
+    while ((offset < video_formats.length()) && (' ' != video_formats[offset]) && (',' != video_formats[offset]))
+    {
+        ++offset;
+    }
+    return video_formats.substr(token_start, offset - token_start);
+}
+
+bool MiracastRTSPMsg::parse_wfd_video_format(const RTSPStringView &video_formats, RTSP_WFD_VIDEO_FMT_STRUCT &st_video_fmt)
+{
+    unsigned long hex_fields[RTSP_WFD_VIDEO_FMT_HEX_FIELDS] = {0};
+    int32_t *max_resolutions[] = { &st_video_fmt.st_h264_codecs.max_hres, &st_video_fmt.st_h264_codecs.max_vres };
+    size_t offset = 0;
+
+    memset(&st_video_fmt , 0x00 , sizeof(RTSP_WFD_VIDEO_FMT_STRUCT));
+
+    for (size_t field = 0; field < RTSP_WFD_VIDEO_FMT_HEX_FIELDS; ++field)
+    {
+        if (!next_wfd_video_format_token(video_formats, offset).to_hex_uint(hex_fields[field]))
+        {
+            return false;
+        }
+    }
+
+    st_video_fmt.native = static_cast<uint8_t>(hex_fields[0]);
+    st_video_fmt.preferred_display_mode_supported = static_cast<uint8_t>(hex_fields[1]);
+    st_video_fmt.st_h264_codecs.profile = static_cast<uint8_t>(hex_fields[2]);
+    st_video_fmt.st_h264_codecs.level = static_cast<uint8_t>(hex_fields[3]);
+    st_video_fmt.st_h264_codecs.cea_mask = static_cast<RTSP_CEA_RESOLUTIONS>(hex_fields[4]);
+    st_video_fmt.st_h264_codecs.vesa_mask = static_cast<RTSP_VESA_RESOLUTIONS>(hex_fields[5]);
+    st_video_fmt.st_h264_codecs.hh_mask = static_cast<RTSP_HH_RESOLUTIONS>(hex_fields[6]);
+    st_video_fmt.st_h264_codecs.latency = static_cast<uint8_t>(hex_fields[7]);
+    st_video_fmt.st_h264_codecs.min_slice = static_cast<uint16_t>(hex_fields[8]);
+    st_video_fmt.st_h264_codecs.slice_encode = static_cast<uint16_t>(hex_fields[9]);
+    st_video_fmt.st_h264_codecs.video_frame_skip_support = (0 != (hex_fields[10] & 0x01));
+    st_video_fmt.st_h264_codecs.max_skip_intervals = static_cast<uint8_t>((hex_fields[10] >> 1) & 0x07);
+    st_video_fmt.st_h264_codecs.video_frame_rate_change_support = (0 != (hex_fields[10] & 0x10));
+
+    // max-hres and max-vres are "none" unless the preferred display mode is used
+    for (size_t index = 0; index < (sizeof(max_resolutions) / sizeof(max_resolutions[0])); ++index)
+    {
+        RTSPStringView token = next_wfd_video_format_token(video_formats, offset);
+        unsigned long resolution = 0;
+
+        if (token.to_hex_uint(resolution))
+        {
+            *max_resolutions[index] = static_cast<int32_t>(resolution);
+        }
+        else
+        {
+            *max_resolutions[index] = -1;
+        }
+    }
+    return true;
+}
+
+bool MiracastRTSPMsg::negotiate_wfd_video_format(const RTSPStringView &video_formats)
+{
+    RTSP_WFD_VIDEO_FMT_STRUCT st_src_video_fmt;
+    const RTSP_H264_CODEC_STRUCT &sink_codecs = m_wfd_video_formats_st.st_h264_codecs;
+    RTSP_H264_CODEC_STRUCT &src_codecs = st_src_video_fmt.st_h264_codecs;
+    uint8_t supported_levels = 0;
+    unsigned int profile = 0,
+                 cea_mask = 0,
+                 vesa_mask = 0,
+                 hh_mask = 0;
+
+    MIRACASTLOG_TRACE("Entering...");
+
+    memset(&m_wfd_negotiated_video_st , 0x00 , sizeof(RTSP_WFD_VIDEO_FMT_STRUCT));
+
+    if (video_formats.trim().equals("none"))
+    {
+        MIRACASTLOG_INFO("Source has not selected any video format");
+        MIRACASTLOG_TRACE("Exiting...");
+        return true;
+    }
+
+    if (!parse_wfd_video_format(video_formats, st_src_video_fmt))
+    {
+        MIRACASTLOG_ERROR("Unable to parse wfd_video_formats[%.*s]",
+                            static_cast<int>(video_formats.length()), video_formats.data());
+        MIRACASTLOG_TRACE("Exiting...");
+        return false;
+    }
+
+    // Sink advertises its highest H.264 level and every lower level is implied
+    for (uint8_t level = sink_codecs.level; 0 != level; level >>= 1)
+    {
+        supported_levels = static_cast<uint8_t>((supported_levels << 1) | 0x01);
+    }
+
+    profile = src_codecs.profile & sink_codecs.profile;
+    cea_mask = src_codecs.cea_mask & sink_codecs.cea_mask;
+    vesa_mask = src_codecs.vesa_mask & sink_codecs.vesa_mask;
+    hh_mask = src_codecs.hh_mask & sink_codecs.hh_mask;
+
+    if ((0 == profile) ||
+        (0 == src_codecs.level) ||
+        (0 != (src_codecs.level & ~supported_levels)) ||
+        (0 == (cea_mask | vesa_mask | hh_mask)))
+    {
+        MIRACASTLOG_ERROR("Video format mismatch profile[%#04X/%#04X] level[%#04X/%#04X] cea[%#08X/%#08X] vesa[%#08X/%#08X] hh[%#08X/%#08X]",
+                            src_codecs.profile, sink_codecs.profile,
+                            src_codecs.level, sink_codecs.level,
+                            src_codecs.cea_mask, sink_codecs.cea_mask,
+                            src_codecs.vesa_mask, sink_codecs.vesa_mask,
+                            src_codecs.hh_mask, sink_codecs.hh_mask);
+        MIRACASTLOG_TRACE("Exiting...");
+        return false;
+    }
+
+    src_codecs.profile = static_cast<uint8_t>(profile);
+    src_codecs.cea_mask = static_cast<RTSP_CEA_RESOLUTIONS>(cea_mask);
+    src_codecs.vesa_mask = static_cast<RTSP_VESA_RESOLUTIONS>(vesa_mask);
+    src_codecs.hh_mask = static_cast<RTSP_HH_RESOLUTIONS>(hh_mask);
+    memcpy(&m_wfd_negotiated_video_st , &st_src_video_fmt , sizeof(RTSP_WFD_VIDEO_FMT_STRUCT));
+
+    MIRACASTLOG_INFO("Negotiated video profile[%#04X] level[%#04X] cea[%#08X] vesa[%#08X] hh[%#08X]",
+                        profile, src_codecs.level, cea_mask, vesa_mask, hh_mask);
+    MIRACASTLOG_TRACE("Exiting...");
+    return true;
+}
+
+/* M4 carries the one "<codec> <modes> <latency>" the source is going to send */
+bool MiracastRTSPMsg::negotiate_wfd_audio_codec(const RTSPStringView &audio_codecs)
+{
+    static const struct
+    {
+        const char *name;
+        RTSP_AUDIO_FORMATS audio_format;
+    }
+    audio_codec_names[] = {
+        { "LPCM", RTSP_LPCM_AUDIO_FORMAT },
+        { "AAC", RTSP_AAC_AUDIO_FORMAT },
+        { "AC3", RTSP_AC3_AUDIO_FORMAT }
+    };
+    size_t offset = 0;
+    RTSPStringView codec_name = next_wfd_video_format_token(audio_codecs, offset);
+    unsigned long modes = 0,
+                  latency = 0;
+
+    MIRACASTLOG_TRACE("Entering...");
+
+    memset(&m_wfd_negotiated_audio_st , 0x00 , sizeof(RTSP_WFD_AUDIO_FMT_STRUCT));
+
+    if ((codec_name.empty()) || (codec_name.equals("none")))
+    {
+        MIRACASTLOG_INFO("Source has not selected any audio codec");
+        MIRACASTLOG_TRACE("Exiting...");
+        return true;
+    }
+
+    for (size_t index = 0; index < (sizeof(audio_codec_names) / sizeof(audio_codec_names[0])); ++index)
+    {
+        if (codec_name.equals_nocase(audio_codec_names[index].name, strlen(audio_codec_names[index].name)))
+        {
+            next_wfd_video_format_token(audio_codecs, offset).to_hex_uint(modes);
+            next_wfd_video_format_token(audio_codecs, offset).to_hex_uint(latency);
+            m_wfd_negotiated_audio_st.audio_format = audio_codec_names[index].audio_format;
+            m_wfd_negotiated_audio_st.modes = static_cast<uint32_t>(modes);
+            m_wfd_negotiated_audio_st.latency = static_cast<uint8_t>(latency);
+            MIRACASTLOG_INFO("Negotiated audio codec[%s] modes[%#08X] latency[%lu]",
+                                audio_codec_names[index].name, m_wfd_negotiated_audio_st.modes, latency);
             MIRACASTLOG_TRACE("Exiting...");
-            return get_parser_field_value(parse_field);
+            return true;
         }
-        parse_field = static_cast<RTSP_PARSER_FIELDS>(parse_field+1);
     }
+    MIRACASTLOG_WARNING("Unknown wfd_audio_codecs[%.*s]",
+                        static_cast<int>(audio_codecs.length()), audio_codecs.data());
     MIRACASTLOG_TRACE("Exiting...");
-    return std::string("");
+    return false;
 }
 
-std::string MiracastRTSPMsg::parse_received_parser_field_value(std::string rtsp_msg_buffer , RTSP_PARSER_FIELDS parse_field )
+void MiracastRTSPMsg::compile_request_response_templates(void)
 {
-    std::string seq_str = "";
-    std::stringstream ss(rtsp_msg_buffer);
-    std::string prefix = "";
-    std::string line;
     MIRACASTLOG_TRACE("Entering...");
-    const char  *given_tag = get_parser_field_by_index(parse_field);
 
-    while (std::getline(ss, line))
+    for (int msg_fmt = RTSP_MSG_FMT_M1_RESPONSE; msg_fmt < RTSP_MSG_FMT_INVALID; ++msg_fmt)
     {
-        if (line.find(given_tag) != std::string::npos)
+        RTSP_MSG_SEGMENTS_STRUCT &builder = m_rtsp_msg_builders[msg_fmt];
+        const char *template_str = get_RequestResponseFormat(static_cast<RTSP_MSG_FMT_SINK2SRC>(msg_fmt));
+        const char *placeholder = nullptr;
+
+        memset(&builder, 0x00, sizeof(builder));
+
+        while ((nullptr != (placeholder = strstr(template_str, "%s"))) &&
+               ((builder.segment_count + 2) < RTSP_MSG_MAX_SEGMENTS))
         {
-            prefix = given_tag;
-            seq_str = line.substr(prefix.length());
-            REMOVE_R(seq_str);
-            REMOVE_N(seq_str);
-            break;
+            if (placeholder != template_str)
+            {
+                builder.segments[builder.segment_count].iov_base = const_cast<char *>(template_str);
+                builder.segments[builder.segment_count].iov_len = placeholder - template_str;
+                ++builder.segment_count;
+            }
+            builder.arg_slots[builder.arg_count++] = builder.segment_count++;
+            template_str = placeholder + 2;
         }
+        if ('\0' != *template_str)
+        {
+            builder.segments[builder.segment_count].iov_base = const_cast<char *>(template_str);
+            builder.segments[builder.segment_count].iov_len = strlen(template_str);
+            ++builder.segment_count;
+        }
+        MIRACASTLOG_VERBOSE("Format[%#04X] segments[%zu] args[%zu]", msg_fmt, builder.segment_count, builder.arg_count);
     }
     MIRACASTLOG_TRACE("Exiting...");
-    return seq_str.c_str();
 }
 
-std::string MiracastRTSPMsg::generate_request_response_msg(RTSP_MSG_FMT_SINK2SRC msg_fmt_needed, std::string received_session_no , std::string append_data1 , RTSP_ERRORCODES error_code )
+bool MiracastRTSPMsg::generate_request_response_msg(RTSP_MSG_FMT_SINK2SRC msg_fmt_needed, const RTSPStringView &received_seq_num , const RTSPStringView &append_data1 , RTSP_MSG_SEGMENTS_STRUCT &rtsp_msg , RTSP_ERRORCODES error_code )
 {
+    RTSPStringView sprintf_args[RTSP_MSG_MAX_SEGMENTS];
+    size_t arg_count = 0;
+
     MIRACASTLOG_TRACE("Entering...");
-    std::vector<const char *> sprintf_args;
-    const char *template_str = get_RequestResponseFormat(msg_fmt_needed);
-    std::string content_buffer = "";
-    std::string unicast_supported = "";
-    std::string content_buffer_len;
-    std::string sequence_number = "";
-    std::string resp_error_string = get_errorcode_string(error_code);
-
-    // Determine the required buffer size using snprintf
+
+    if ((RTSP_MSG_FMT_M1_RESPONSE > msg_fmt_needed) || (RTSP_MSG_FMT_INVALID <= msg_fmt_needed))
+    {
+        MIRACASTLOG_ERROR("!!! INVALID FMT REQUEST[%#04X] !!!",msg_fmt_needed);
+        return false;
+    }
+    rtsp_msg = m_rtsp_msg_builders[msg_fmt_needed];
+
     switch (msg_fmt_needed)
     {
         case RTSP_MSG_FMT_M1_RESPONSE:
         {
-            sprintf_args.push_back(append_data1.c_str());
-            sprintf_args.push_back(received_session_no.c_str());
+            sprintf_args[arg_count++] = append_data1;
+            sprintf_args[arg_count++] = received_seq_num;
         }
         break;
         case RTSP_MSG_FMT_M3_RESPONSE:
         {
-            content_buffer = append_data1;
-            content_buffer_len = std::to_string(content_buffer.length());
-            sprintf_args.push_back(content_buffer_len.c_str());
-            sprintf_args.push_back(received_session_no.c_str());
-            sprintf_args.push_back(content_buffer.c_str());
-            MIRACASTLOG_TRACE("content_buffer - [%s]", content_buffer.c_str());
+            snprintf(rtsp_msg.number_buffer, sizeof(rtsp_msg.number_buffer), "%zu", append_data1.length());
+            sprintf_args[arg_count++] = RTSPStringView(rtsp_msg.number_buffer);
+            sprintf_args[arg_count++] = received_seq_num;
+            sprintf_args[arg_count++] = append_data1;
+            MIRACASTLOG_TRACE("content_buffer - [%.*s]", static_cast<int>(append_data1.length()), append_data1.data());
         }
         break;
         case RTSP_MSG_FMT_M4_RESPONSE:
@@ -720,8 +1104,8 @@ std::string MiracastRTSPMsg::generate_request_response_msg(RTSP_MSG_FMT_SINK2SRC
         case RTSP_MSG_FMT_TRIGGER_METHODS_RESPONSE:
         case RTSP_MSG_FMT_REPORT_ERROR:
         {
-            sprintf_args.push_back(resp_error_string.c_str());
-            sprintf_args.push_back(received_session_no.c_str());
+            sprintf_args[arg_count++] = RTSPStringView(get_errorcode_string(error_code));
+            sprintf_args[arg_count++] = received_seq_num;
         }
         break;
         case RTSP_MSG_FMT_M2_REQUEST:
@@ -731,32 +1115,35 @@ std::string MiracastRTSPMsg::generate_request_response_msg(RTSP_MSG_FMT_SINK2SRC
         case RTSP_MSG_FMT_PLAY_REQUEST:
         case RTSP_MSG_FMT_TEARDOWN_REQUEST:
         {
-            sequence_number = generate_RequestSequenceNumber();
+            const std::string &sequence_number = generate_RequestSequenceNumber();
+
             if (RTSP_MSG_FMT_M2_REQUEST == msg_fmt_needed)
             {
-                sprintf_args.push_back(append_data1.c_str());
+                sprintf_args[arg_count++] = append_data1;
             }
             else
             {
-                sprintf_args.push_back(m_wfd_presentation_URL.c_str());
+                sprintf_args[arg_count++] = RTSPStringView(m_wfd_presentation_URL);
 
                 if (RTSP_MSG_FMT_M6_REQUEST == msg_fmt_needed)
                 {
-                    sprintf_args.push_back(m_wfd_transport_profile.c_str());
+                    sprintf_args[arg_count++] = RTSPStringView(m_wfd_transport_profile);
                     if (true == IsWFDUnicastSupported())
                     {
-                        unicast_supported.append(RTSP_STD_UNICAST_FIELD);
-                        unicast_supported.append(RTSP_SEMI_COLON_STR);
-                        sprintf_args.push_back(unicast_supported.c_str());
+                        sprintf_args[arg_count++] = RTSPStringView(RTSP_STD_UNICAST_FIELD RTSP_SEMI_COLON_STR);
+                    }
+                    else
+                    {
+                        sprintf_args[arg_count++] = RTSPStringView();
                     }
-                    sprintf_args.push_back(m_wfd_streaming_port.c_str());
+                    sprintf_args[arg_count++] = RTSPStringView(m_wfd_streaming_port);
                 }
                 else
                 {
-                    sprintf_args.push_back(m_wfd_session_number.c_str());
+                    sprintf_args[arg_count++] = RTSPStringView(m_wfd_session_number);
                 }
             }
-            sprintf_args.push_back(sequence_number.c_str());
+            sprintf_args[arg_count++] = RTSPStringView(sequence_number);
         }
         break;
         default:
@@ -765,35 +1152,45 @@ std::string MiracastRTSPMsg::generate_request_response_msg(RTSP_MSG_FMT_SINK2SRC
         }
         break;
     }
-    std::string result = "";
-    if (0 != sprintf_args.size())
+
+    if (arg_count != rtsp_msg.arg_count)
     {
-        result = MiracastRTSPMsg::format_string(template_str, sprintf_args);
+        MIRACASTLOG_ERROR("!!! FMT[%#04X] expects [%zu] args, got [%zu] !!!",msg_fmt_needed,rtsp_msg.arg_count,arg_count);
+        MIRACASTLOG_TRACE("Exiting...");
+        return false;
+    }
+
+    for (size_t arg_index = 0; arg_index < arg_count; ++arg_index)
+    {
+        struct iovec &segment = rtsp_msg.segments[rtsp_msg.arg_slots[arg_index]];
+
+        segment.iov_base = const_cast<char *>(sprintf_args[arg_index].data());
+        segment.iov_len = sprintf_args[arg_index].length();
     }
-    MIRACASTLOG_TRACE("!!! Formatted Buffer[%s] !!!",result.c_str());
     MIRACASTLOG_TRACE("Exiting...");
-    return result.c_str();
+    return true;
 }
 
-std::string MiracastRTSPMsg::generate_RequestSequenceNumber(void)
+const std::string &MiracastRTSPMsg::generate_RequestSequenceNumber(void)
 {
     int next_number = std::stoi(m_current_sequence_number.empty() ? "1" : m_current_sequence_number.c_str()) + 1;
     m_current_sequence_number = std::to_string(next_number);
-    return m_current_sequence_number.c_str();
+    return m_current_sequence_number;
 }
 
-bool MiracastRTSPMsg::IsValidSequenceNumber(std::string& received_seq_num)
+bool MiracastRTSPMsg::IsValidSequenceNumber(const RTSPStringView &received_seq_num)
 {
     bool ret = false;
     MIRACASTLOG_TRACE("Entering ...");
-    if (0 == (m_current_sequence_number.compare(received_seq_num)))
+    if (received_seq_num.equals(m_current_sequence_number.c_str(), m_current_sequence_number.length()))
     {
         ret = true;
     }
     else
     {
-        MIRACASTLOG_ERROR("Invalid Sequence Number received [%s] Current is [%s]",
-                            received_seq_num.c_str(),
+        MIRACASTLOG_ERROR("Invalid Sequence Number received [%.*s] Current is [%s]",
+                            static_cast<int>(received_seq_num.length()),
+                            received_seq_num.data(),
                             m_current_sequence_number.c_str());
     }
     MIRACASTLOG_TRACE("Exiting ...");
@@ -829,6 +1226,174 @@ eMIRA_PLAYER_STATES MiracastRTSPMsg::get_state(void)
     return m_current_state;
 }
 
+void MiracastRTSPMsg::get_RTSPLatencyStats(std::vector<RTSP_SOURCE_LATENCY_STRUCT> &snapshot, bool reset)
+{
+    m_latency_stats.get_snapshot(snapshot, reset);
+}
+
+void MiracastRTSPMsg::get_RTSPParamCacheCounters(RTSP_PARAM_CACHE_COUNTERS_STRUCT &counters)
+{
+    m_param_cache.get_counters(counters);
+}
+
+bool MiracastRTSPMsg::send_UIBCEvents(const UIBC_EVENT_STRUCT *events, size_t count, uint64_t receive_time_us)
+{
+    return m_uibc.send_events(events, count, receive_time_us);
+}
+
+bool MiracastRTSPMsg::set_LatencyProfile(eMIRA_GSTPLAYER_LATENCY_PROFILE latency_profile)
+{
+    MIRACASTLOG_TRACE("Entering...");
+    if (MIRACAST_GSTPLAYER_LATENCY_PROFILE_MAX <= latency_profile)
+    {
+        MIRACASTLOG_ERROR("Invalid latency profile [%d]", latency_profile);
+        return false;
+    }
+    m_latency_profile = latency_profile;
+
+    eMIRA_PLAYER_STATES state = get_state();
+    if ((MIRACAST_PLAYER_STATE_PLAYING == state) || (MIRACAST_PLAYER_STATE_PAUSED == state))
+    {
+        RTSP_HLDR_MSGQ_STRUCT rtsp_hldr_msgq_data = {};
+
+        rtsp_hldr_msgq_data.state = RTSP_UPDATE_LATENCY_PROFILE;
+        rtsp_hldr_msgq_data.latency_profile = latency_profile;
+        send_msgto_rtsp_msg_hdler_thread(rtsp_hldr_msgq_data);
+    }
+    MIRACASTLOG_TRACE("Exiting...");
+    return true;
+}
+
+eMIRA_GSTPLAYER_LATENCY_PROFILE MiracastRTSPMsg::get_LatencyProfile(void)
+{
+    return m_latency_profile;
+}
+
+bool MiracastRTSPMsg::set_VideoSinkConfig(const MIRACAST_GSTPLAYER_SINK_CONFIG_STRUCT &sink_config)
+{
+    if (MIRACAST_GSTPLAYER_VIDEO_SINK_MAX <= sink_config.video_sink)
+    {
+        MIRACASTLOG_ERROR("Invalid video sink [%d]", sink_config.video_sink);
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_player_statistics_mutex);
+    m_video_sink_config = sink_config;
+    return true;
+}
+
+void MiracastRTSPMsg::get_VideoSinkConfig(MIRACAST_GSTPLAYER_SINK_CONFIG_STRUCT &sink_config)
+{
+    std::lock_guard<std::mutex> lock(m_player_statistics_mutex);
+    sink_config = m_video_sink_config;
+}
+
+bool MiracastRTSPMsg::set_PipelineMode(eMIRA_GSTPLAYER_PIPELINE_MODE pipeline_mode)
+{
+    if ((MIRACAST_GSTPLAYER_PIPELINE_MODE_DUAL != pipeline_mode) && (MIRACAST_GSTPLAYER_PIPELINE_MODE_SINGLE != pipeline_mode))
+    {
+        MIRACASTLOG_ERROR("Invalid pipeline mode [%d]", pipeline_mode);
+        return false;
+    }
+    m_pipeline_mode = pipeline_mode;
+    return true;
+}
+
+eMIRA_GSTPLAYER_PIPELINE_MODE MiracastRTSPMsg::get_PipelineMode(void)
+{
+    return m_pipeline_mode;
+}
+
+void MiracastRTSPMsg::update_PlayerStatistics(const MIRACAST_PLAYER_STATISTICS_STRUCT &statistics)
+{
+    bool notify = false;
+
+    {
+        std::lock_guard<std::mutex> lock(m_player_statistics_mutex);
+
+        m_player_statistics = statistics;
+        if (0 < m_player_statistics_interval_sec)
+        {
+            // The final numbers of a session always go out
+            notify = ((++m_player_statistics_samples >= m_player_statistics_interval_sec) || (!statistics.streaming));
+            if (notify)
+            {
+                m_player_statistics_samples = 0;
+            }
+        }
+    }
+    if ((notify) && (nullptr != m_player_notify_handler))
+    {
+        m_player_notify_handler->onPlayerStatistics(statistics);
+    }
+}
+
+void MiracastRTSPMsg::get_PlayerStatistics(MIRACAST_PLAYER_STATISTICS_STRUCT &statistics)
+{
+    std::lock_guard<std::mutex> lock(m_player_statistics_mutex);
+    statistics = m_player_statistics;
+}
+
+void MiracastRTSPMsg::set_PlayerStatisticsInterval(unsigned int interval_sec)
+{
+    std::lock_guard<std::mutex> lock(m_player_statistics_mutex);
+    m_player_statistics_interval_sec = interval_sec;
+    m_player_statistics_samples = 0;
+}
+
+unsigned int MiracastRTSPMsg::get_PlayerStatisticsInterval(void)
+{
+    std::lock_guard<std::mutex> lock(m_player_statistics_mutex);
+    return m_player_statistics_interval_sec;
+}
+
+void MiracastRTSPMsg::set_ElementTracer(bool enable)
+{
+    MIRACASTLOG_TRACE("Entering...");
+    {
+        std::lock_guard<std::mutex> lock(m_player_statistics_mutex);
+        m_element_tracer = enable;
+    }
+
+    eMIRA_PLAYER_STATES state = get_state();
+    if ((MIRACAST_PLAYER_STATE_PLAYING == state) || (MIRACAST_PLAYER_STATE_PAUSED == state))
+    {
+        RTSP_HLDR_MSGQ_STRUCT rtsp_hldr_msgq_data = {};
+
+        rtsp_hldr_msgq_data.state = RTSP_UPDATE_ELEMENT_TRACER;
+        rtsp_hldr_msgq_data.element_tracer = enable;
+        send_msgto_rtsp_msg_hdler_thread(rtsp_hldr_msgq_data);
+    }
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+bool MiracastRTSPMsg::get_ElementTracer(void)
+{
+    std::lock_guard<std::mutex> lock(m_player_statistics_mutex);
+    return m_element_tracer;
+}
+
+void MiracastRTSPMsg::update_ElementTrace(const MIRACAST_PLAYER_ELEMENT_TRACE_STRUCT &element_trace)
+{
+    std::lock_guard<std::mutex> lock(m_player_statistics_mutex);
+    m_element_trace = element_trace;
+}
+
+void MiracastRTSPMsg::get_ElementTrace(MIRACAST_PLAYER_ELEMENT_TRACE_STRUCT &element_trace)
+{
+    std::lock_guard<std::mutex> lock(m_player_statistics_mutex);
+    element_trace = m_element_trace;
+}
+
+uint64_t MiracastRTSPMsg::get_PlayRequestTime(void)
+{
+    return m_play_request_us.load();
+}
+
+void MiracastRTSPMsg::record_TimeToFirstFrame(uint64_t elapsed_us)
+{
+    m_latency_stats.record(RTSP_LATENCY_PHASE_PLAY_FIRST_FRAME, elapsed_us);
+}
+
 void MiracastRTSPMsg::store_srcsink_info( std::string client_name,
                                           std::string client_mac,
                                           std::string src_dev_ip,
@@ -839,63 +1404,219 @@ void MiracastRTSPMsg::store_srcsink_info( std::string client_name,
     m_connected_mac_addr = client_mac;
     m_src_dev_ip = src_dev_ip;
     m_sink_ip = sink_ip;
+
+    m_cached_params_applied = false;
+    if (m_param_cache.lookup(client_mac, m_session_params))
+    {
+        m_cached_params_applied = apply_cached_source_params();
+    }
+    else
+    {
+        m_session_params = RTSP_SOURCE_PARAMS_STRUCT();
+        m_session_params.source_mac = client_mac;
+    }
     MIRACASTLOG_TRACE("Exiting...");
 }
 
 /*
- * Wait for data returned by the socket for specified time
+ * Prepare what the last M4 of this source selected, so that the streaming
+ * setup does not have to wait for M4. M4 still overrides all of it.
  */
-bool MiracastRTSPMsg::wait_data_timeout(int m_Sockfd, unsigned int ms)
+bool MiracastRTSPMsg::apply_cached_source_params(void)
 {
-    struct timeval timeout = {0};
-    fd_set readFDSet;
-    bool returnValue = false;
-    int result = 0;
+    MIRACASTLOG_TRACE("Entering...");
 
-    MIRACASTLOG_TRACE("Entering WaitTime[%d]...",ms);
+    if (!negotiate_wfd_video_format(RTSPStringView(m_session_params.video_format)))
+    {
+        MIRACASTLOG_WARNING("Cached video format of [%s] no longer negotiable", m_session_params.source_mac.c_str());
+        m_param_cache.invalidate(m_session_params.source_mac);
+        m_session_params = RTSP_SOURCE_PARAMS_STRUCT();
+        m_session_params.source_mac = m_connected_mac_addr;
+        MIRACASTLOG_TRACE("Exiting...");
+        return false;
+    }
+    negotiate_wfd_audio_codec(RTSPStringView(m_session_params.audio_codec));
 
-    FD_ZERO(&readFDSet);
-    FD_SET(m_Sockfd, &readFDSet);
+    if (!m_session_params.presentation_path.empty())
+    {
+        set_WFDPresentationURL(RTSP_PRESENTATION_URL_SCHEME + m_src_dev_ip + m_session_params.presentation_path);
+    }
+    MIRACASTLOG_INFO("Reusing M4 params of [%s] video[%s] audio[%s] url[%s] rtp_ports[%s]",
+                        m_session_params.source_mac.c_str(),
+                        m_session_params.video_format.c_str(),
+                        m_session_params.audio_codec.c_str(),
+                        m_wfd_presentation_URL.c_str(),
+                        m_session_params.client_rtp_ports.c_str());
+    MIRACASTLOG_TRACE("Exiting...");
+    return true;
+}
 
-    timeout.tv_sec = (ms / 1000);
-    timeout.tv_usec = ((ms % 1000) * 1000);
+/*
+ * Merge the parameters carried by M4 into the session params. Returns false
+ * when any of them differs from what was cached for this source.
+ */
+bool MiracastRTSPMsg::update_session_params(const MiracastRTSPParser &rtsp_msg)
+{
+    const RTSP_WFD_PARAM_ID param_ids[] = { RTSP_WFD_PARAM_VIDEO_FORMATS,
+                                            RTSP_WFD_PARAM_AUDIO_CODECS,
+                                            RTSP_WFD_PARAM_PRESENTATION_URL,
+                                            RTSP_WFD_PARAM_CLIENT_RTP_PORTS };
+    std::string *session_values[] = { &m_session_params.video_format,
+                                      &m_session_params.audio_codec,
+                                      &m_session_params.presentation_path,
+                                      &m_session_params.client_rtp_ports };
+    bool matches = true;
 
-    result = select(m_Sockfd + 1, &readFDSet, nullptr, nullptr, &timeout);
-    if ( -1 == result )
+    for (size_t index = 0; index < (sizeof(param_ids) / sizeof(param_ids[0])); ++index)
     {
-        MIRACASTLOG_ERROR("select() failed: [%s]",strerror(errno));
+        RTSPStringView value = rtsp_msg.get_wfd_param(param_ids[index]).trim();
+
+        if (!rtsp_msg.has_wfd_param(param_ids[index]))
+        {
+            continue;
+        }
+
+        if (RTSP_WFD_PARAM_PRESENTATION_URL == param_ids[index])
+        {
+            // Keep "[:port]/path" of the first URL, the host is the source IP of this session
+            value = value.substr(0, value.find(' '));
+            if (value.starts_with(RTSP_PRESENTATION_URL_SCHEME))
+            {
+                size_t path_pos = strlen(RTSP_PRESENTATION_URL_SCHEME);
+
+                while ((path_pos < value.length()) && (':' != value[path_pos]) && ('/' != value[path_pos]))
+                {
+                    ++path_pos;
+                }
+                value = value.substr(path_pos);
+            }
+            else
+            {
+                value = RTSPStringView();
+            }
+        }
+
+        if (!value.equals(session_values[index]->c_str(), session_values[index]->length()))
+        {
+            matches = false;
+            value.assign_to(*session_values[index]);
+        }
     }
-    else if ( 0 == result )
+    return matches;
+}
+
+/*
+ * Block on the session epoll set until the socket is readable, a message is
+ * posted to the RTSP handler thread or the keep-alive deadline expires.
+ */
+RTSP_STATUS MiracastRTSPMsg::wait_session_event(unsigned int wait_time_ms)
+{
+    struct epoll_event events[RTSP_SESSION_EPOLL_MAX_EVENTS];
+    RTSP_STATUS status = RTSP_TIMEDOUT;
+    bool socket_ready = false,
+         keep_alive_expired = false,
+         uibc_only = false;
+    int timeout = (RTSP_EVENT_WAIT_INDEFINITE == wait_time_ms) ? -1 : static_cast<int>(wait_time_ms),
+        num_ready = 0;
+    uint64_t deadline_us = MiracastCommon::get_monotonic_time_us() + (static_cast<uint64_t>(wait_time_ms) * 1000);
+
+    MIRACASTLOG_TRACE("Entering WaitTime[%d]...",timeout);
+
+    do
     {
-        MIRACASTLOG_VERBOSE("select() timedout");
+        do
+        {
+            num_ready = epoll_wait(m_epollfd, events, RTSP_SESSION_EPOLL_MAX_EVENTS, timeout);
+        }
+        while (( -1 == num_ready ) && ( EINTR == errno ));
+
+        if ( -1 == num_ready )
+        {
+            MIRACASTLOG_ERROR("epoll_wait failed: [%s]", strerror(errno));
+            MIRACASTLOG_TRACE("Exiting...");
+            return RTSP_MSG_FAILURE;
+        }
+
+        for (int index = 0; index < num_ready; ++index)
+        {
+            if (m_control_eventfd == events[index].data.fd)
+            {
+                // Left set until the handler drains its queue, see clear_control_event()
+                status = RTSP_CONTROL_MSG_PENDING;
+            }
+            else if (m_keep_alive_timerfd == events[index].data.fd)
+            {
+                keep_alive_expired = true;
+            }
+            else if (m_tcpSockfd == events[index].data.fd)
+            {
+                socket_ready = true;
+            }
+            else if (m_uibc.get_socket_fd() == events[index].data.fd)
+            {
+                m_uibc.handle_socket_event(events[index].events);
+            }
+        }
+
+        /*
+         * The timerfd is only read once no control message is pending, in whatever
+         * order the batch lists them. Left unread it stays readable, and the wait
+         * after the handler drained its queue reports the M16 deadline.
+         */
+        if ((keep_alive_expired) && (RTSP_CONTROL_MSG_PENDING != status))
+        {
+            uint64_t expirations = 0;
+            if ( sizeof(expirations) != read(m_keep_alive_timerfd, &expirations, sizeof(expirations)))
+            {
+                MIRACASTLOG_VERBOSE("timerfd read: [%s]", strerror(errno));
+            }
+            status = RTSP_KEEP_ALIVE_TIMEDOUT;
+        }
+
+        // UIBC socket events alone do not end the wait, keep waiting for the remaining time
+        uibc_only = ((0 < num_ready) && (RTSP_TIMEDOUT == status) && (!socket_ready));
+        if ((uibc_only) && ( -1 != timeout ))
+        {
+            uint64_t now_us = MiracastCommon::get_monotonic_time_us();
+
+            timeout = (now_us < deadline_us) ? static_cast<int>((deadline_us - now_us + 999) / 1000) : 0;
+            uibc_only = (0 < timeout);
+        }
     }
-    else
+    while (uibc_only);
+
+    // App requests and the M16 deadline win over socket data, which stays queued in the kernel
+    if ((socket_ready) && (RTSP_TIMEDOUT == status))
     {
-        returnValue = FD_ISSET(m_Sockfd, &readFDSet);
+        status = RTSP_MSG_SUCCESS;
     }
-
-    MIRACASTLOG_TRACE("Exiting ret[%d] status[%s]...",returnValue,strerror(errno));
-    return returnValue;
+    MIRACASTLOG_TRACE("Exiting [%d]...",status);
+    return status;
 }
 
-RTSP_STATUS MiracastRTSPMsg::receive_buffer_timedOut(int socket_fd, void *buffer, size_t buffer_len , unsigned int wait_time_ms )
+RTSP_STATUS MiracastRTSPMsg::receive_buffer_timedOut(int socket_fd, void *buffer, size_t buffer_len , size_t &received_length , unsigned int wait_time_ms )
 {
-    int recv_return = -1;
+    ssize_t recv_return = -1;
     RTSP_STATUS status = RTSP_MSG_SUCCESS;
 
     MIRACASTLOG_TRACE("Entering WaitTime[%d]...",wait_time_ms);
 
-    if (!wait_data_timeout(socket_fd, wait_time_ms))
+    received_length = 0;
+
+    status = wait_session_event(wait_time_ms);
+    if (RTSP_MSG_SUCCESS != status)
     {
-        MIRACASTLOG_TRACE("Exiting [TimedOut]...");
-        return RTSP_TIMEDOUT;
+        MIRACASTLOG_TRACE("Exiting [%d]...",status);
+        return status;
     }
-    else
+    recv_return = recv(socket_fd, buffer, buffer_len, 0);
+
+    if (0 == recv_return)
     {
-        recv_return = recv(socket_fd, buffer, buffer_len, 0);
+        MIRACASTLOG_ERROR("connection closed by peer");
+        status = RTSP_MSG_FAILURE;
     }
-
-    if (recv_return <= 0)
+    else if (recv_return < 0)
     {
         if (errno == EAGAIN || errno == EWOULDBLOCK)
         {
@@ -908,27 +1629,137 @@ RTSP_STATUS MiracastRTSPMsg::receive_buffer_timedOut(int socket_fd, void *buffer
             status = RTSP_MSG_FAILURE;
         }
     }
-    MIRACASTLOG_TRACE("received string(%d) - %s", recv_return, buffer);
+    else
+    {
+        received_length = static_cast<size_t>(recv_return);
+        MIRACASTLOG_TRACE("received string(%zd) - %.*s", recv_return, static_cast<int>(recv_return), static_cast<char*>(buffer));
+    }
+    MIRACASTLOG_TRACE("Exiting [%d]...",status);
+    return status;
+}
+
+/*
+ * Returns the next RTSP message from the connection, reading from the socket
+ * only when no complete message is buffered. The message is indexed by
+ * m_rtsp_stream.get_parser() until the next call.
+ */
+RTSP_STATUS MiracastRTSPMsg::receive_rtsp_message(unsigned int wait_time_ms)
+{
+    RTSP_STATUS status = RTSP_MSG_SUCCESS;
+
+    MIRACASTLOG_TRACE("Entering WaitTime[%d]...",wait_time_ms);
+
+    while (true)
+    {
+        RTSP_STREAM_FRAME_STATE frame_state = m_rtsp_stream.next_message();
+        unsigned int current_wait_time = wait_time_ms;
+        size_t available = 0,
+               received_length = 0;
+        char *write_buffer = nullptr;
+
+        if (RTSP_STREAM_FRAME_COMPLETE == frame_state)
+        {
+            status = RTSP_MSG_SUCCESS;
+            break;
+        }
+
+        if (RTSP_STREAM_FRAME_UNTERMINATED == frame_state)
+        {
+            /* Headers without the blank line; wait briefly in case the rest is on the way */
+            current_wait_time = RTSP_UNTERMINATED_MSG_WAIT_TIMEOUT;
+        }
+
+        write_buffer = m_rtsp_stream.get_write_buffer(available);
+        if (nullptr == write_buffer)
+        {
+            MIRACASTLOG_ERROR("RTSP message exceeds [%d] bytes, dropping [%zu] pending bytes",
+                                RTSP_STREAM_BUFFER_MAX_SIZE,
+                                m_rtsp_stream.get_pending_length());
+            m_rtsp_stream.reset();
+            status = RTSP_INVALID_MSG_RECEIVED;
+            break;
+        }
+
+        status = receive_buffer_timedOut(m_tcpSockfd, write_buffer, available, received_length, current_wait_time);
+
+        if (RTSP_MSG_SUCCESS == status)
+        {
+            m_rtsp_stream.commit_write(received_length);
+        }
+        else if ((RTSP_TIMEDOUT == status) && (RTSP_STREAM_FRAME_UNTERMINATED == frame_state))
+        {
+            MIRACASTLOG_VERBOSE("No blank line after [%zu] bytes, handling as one message", m_rtsp_stream.get_pending_length());
+            m_rtsp_stream.take_pending();
+            status = RTSP_MSG_SUCCESS;
+            break;
+        }
+        else
+        {
+            if ((RTSP_TIMEDOUT == status) && (RTSP_STREAM_FRAME_INCOMPLETE == frame_state))
+            {
+                MIRACASTLOG_WARNING("Incomplete RTSP message pending[%zu]", m_rtsp_stream.get_pending_length());
+            }
+            break;
+        }
+    }
     MIRACASTLOG_TRACE("Exiting [%d]...",status);
     return status;
 }
 
-MiracastError MiracastRTSPMsg::initiate_TCP(std::string goIP)
+void MiracastRTSPMsg::set_SocketOptions(void)
+{
+    int optval = 1;
+
+    // RTSP messages are small request/response pairs, do not hold them back for coalescing
+    if ( -1 == setsockopt(m_tcpSockfd, IPPROTO_TCP, TCP_NODELAY, &optval, sizeof(optval)))
+    {
+        MIRACASTLOG_ERROR("Failed to set TCP_NODELAY: %s", strerror(errno));
+    }
+
+    // Detect a source which vanished from the P2P group without closing the session
+    if ( -1 == setsockopt(m_tcpSockfd, SOL_SOCKET, SO_KEEPALIVE, &optval, sizeof(optval)))
+    {
+        MIRACASTLOG_ERROR("Failed to set SO_KEEPALIVE: %s", strerror(errno));
+    }
+    optval = RTSP_TCP_KEEPALIVE_IDLE_SEC;
+    if ( -1 == setsockopt(m_tcpSockfd, IPPROTO_TCP, TCP_KEEPIDLE, &optval, sizeof(optval)))
+    {
+        MIRACASTLOG_ERROR("Failed to set TCP_KEEPIDLE: %s", strerror(errno));
+    }
+    optval = RTSP_TCP_KEEPALIVE_INTERVAL_SEC;
+    if ( -1 == setsockopt(m_tcpSockfd, IPPROTO_TCP, TCP_KEEPINTVL, &optval, sizeof(optval)))
+    {
+        MIRACASTLOG_ERROR("Failed to set TCP_KEEPINTVL: %s", strerror(errno));
+    }
+    optval = RTSP_TCP_KEEPALIVE_PROBE_COUNT;
+    if ( -1 == setsockopt(m_tcpSockfd, IPPROTO_TCP, TCP_KEEPCNT, &optval, sizeof(optval)))
+    {
+        MIRACASTLOG_ERROR("Failed to set TCP_KEEPCNT: %s", strerror(errno));
+    }
+}
+
+/*
+ * Connects to the source RTSP server within SOCKET_DFLT_WAIT_TIMEOUT. The
+ * listener of the source usually comes up shortly after DHCP, so a refused
+ * connect is retried with an exponential backoff starting at a few ms.
+ */
+MiracastError MiracastRTSPMsg::initiate_TCP(std::string goIP, unsigned short port)
 {
     MIRACASTLOG_TRACE("Entering...");
-    MiracastError ret = MIRACAST_FAIL;
-    int r, i, num_ready = 0;
-    size_t addr_size = 0;
-    struct epoll_event events[MAX_EPOLL_EVENTS];
+    RTSP_CONNECT_STATE connect_state = RTSP_CONNECT_STATE_START;
     struct sockaddr_in addr = {0};
-    struct sockaddr_storage str_addr = {0};
+    uint64_t start_time_us = MiracastCommon::get_monotonic_time_us(),
+             start_time_ms = start_time_us / 1000,
+             deadline_ms = start_time_ms + SOCKET_DFLT_WAIT_TIMEOUT,
+             current_time_ms = start_time_ms;
+    unsigned int backoff_ms = RTSP_CONNECT_INITIAL_BACKOFF_MSEC,
+                 attempts = 0;
 
     addr.sin_family = AF_INET;
-    addr.sin_port = htons(7236);
+    addr.sin_port = htons((0 != port) ? port : RTSP_DFLT_SOURCE_PORT);
 
     if (!goIP.empty()){
-        r = inet_pton(AF_INET, goIP.c_str(), &addr.sin_addr);
-        if (r != 1)
+        if (1 != inet_pton(AF_INET, goIP.c_str(), &addr.sin_addr))
         {
             MIRACASTLOG_ERROR("inet_issue");
             return MIRACAST_FAIL;
@@ -938,200 +1769,204 @@ MiracastError MiracastRTSPMsg::initiate_TCP(std::string goIP)
         addr.sin_addr.s_addr = INADDR_ANY;
     }
 
-    memcpy(&str_addr, &addr, sizeof(addr));
-    addr_size = sizeof(addr);
-
-    struct sockaddr_storage in_addr = str_addr;
-
-    unsigned char retry_count = 5;
-    unsigned int current_waittime = SOCKET_DFLT_WAIT_TIMEOUT / retry_count;
-    bool is_connected = false;
+    m_connect_latency_us = 0;
+    Release_SocketAndEpollDescriptor();
 
-    while ( retry_count-- && ( false == is_connected ))
+    while (( RTSP_CONNECT_STATE_CONNECTED != connect_state ) &&
+            ( RTSP_CONNECT_STATE_FAILED != connect_state ))
     {
-        Release_SocketAndEpollDescriptor();
+        current_time_ms = MiracastCommon::get_monotonic_time_us() / 1000;
 
-        m_tcpSockfd = socket(in_addr.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
-        if (m_tcpSockfd < 0)
-        {
-            MIRACASTLOG_ERROR("TCP Socket creation error %s", strerror(errno));
-            continue;
-        }
-        // Set SO_REUSEADDR option
-        int optval = 1;
-        if (setsockopt(m_tcpSockfd, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval)) == -1)
+        switch (connect_state)
         {
-            MIRACASTLOG_ERROR("Failed to set SO_REUSEADDR: %s", strerror(errno));
-            continue;
-        }
-    #if 0
-        /* Bind socket */
-        if (bind(m_tcpSockfd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
-        {
-            MIRACASTLOG_ERROR("TCP Socket bind error %s", strerror(errno));
-            continue;
-        }
-    #endif
-
-        /*---Add socket to epoll---*/
-        m_epollfd = epoll_create(1);
-        struct epoll_event event;
-        event.events = EPOLLIN | EPOLLOUT;
-        event.data.fd = m_tcpSockfd;
-        epoll_ctl(m_epollfd, EPOLL_CTL_ADD, m_tcpSockfd, &event);
-
-        fcntl(m_tcpSockfd, F_SETFL, O_NONBLOCK);
-        MIRACASTLOG_INFO("NON_BLOCKING Socket Enabled...");
-
-        r = connect(m_tcpSockfd, (struct sockaddr *)&in_addr, addr_size);
-        if (r < 0)
-        {
-            if (errno != EINPROGRESS)
-            {
-                MIRACASTLOG_ERROR("Event %s received(%d)", strerror(errno), errno);
-            }
-            else
+            case RTSP_CONNECT_STATE_START:
             {
-                MIRACASTLOG_INFO("WaitingTime[%u] for Socket Connection",current_waittime);
-                // connection in progress
-                if (!wait_data_timeout(m_tcpSockfd, current_waittime ))
+                ++attempts;
+                m_tcpSockfd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+                if (m_tcpSockfd < 0)
                 {
-                    // connection timed out or failed
-                    MIRACASTLOG_ERROR("Socket Connection Timedout %s received(%d)...", strerror(errno), errno);
-                    usleep(500000);
+                    MIRACASTLOG_ERROR("TCP Socket creation error %s", strerror(errno));
+                    connect_state = RTSP_CONNECT_STATE_FAILED;
+                }
+                else if (0 == connect(m_tcpSockfd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)))
+                {
+                    connect_state = RTSP_CONNECT_STATE_CONNECTED;
+                }
+                else if (EINPROGRESS == errno)
+                {
+                    connect_state = RTSP_CONNECT_STATE_IN_PROGRESS;
                 }
                 else
                 {
-                    int error;
+                    MIRACASTLOG_WARNING("connect attempt[%u] failed: %s", attempts, strerror(errno));
+                    connect_state = RTSP_CONNECT_STATE_BACKOFF;
+                }
+            }
+            break;
+            case RTSP_CONNECT_STATE_IN_PROGRESS:
+            {
+                struct pollfd poll_fd = { m_tcpSockfd, POLLOUT, 0 };
+                int poll_status = poll(&poll_fd, 1, (current_time_ms < deadline_ms) ? static_cast<int>(deadline_ms - current_time_ms) : 0);
+
+                if (0 < poll_status)
+                {
+                    int error = 0;
                     socklen_t len = sizeof(error);
-                    if (getsockopt(m_tcpSockfd, SOL_SOCKET, SO_ERROR, &error, &len) == 0 && error == 0)
+
+                    if ((0 == getsockopt(m_tcpSockfd, SOL_SOCKET, SO_ERROR, &error, &len)) && (0 == error))
                     {
-                        // connection successful
-                        // do something with the connected socket
-                        MIRACASTLOG_INFO("Socket Connected Successfully ...");
-                        ret = MIRACAST_OK;
-                        is_connected = true;
+                        connect_state = RTSP_CONNECT_STATE_CONNECTED;
                     }
                     else
                     {
-                        MIRACASTLOG_ERROR("Socket failed to connect %s received(%d)", strerror(errno), errno);
-                        usleep(500000);
+                        MIRACASTLOG_WARNING("connect attempt[%u] failed: %s", attempts, strerror(error));
+                        connect_state = RTSP_CONNECT_STATE_BACKOFF;
                     }
                 }
+                else if (( -1 == poll_status ) && ( EINTR == errno ))
+                {
+                    // Wait again for the remaining time
+                }
+                else
+                {
+                    MIRACASTLOG_ERROR("Socket Connection Timedout after [%u] attempts", attempts);
+                    connect_state = RTSP_CONNECT_STATE_FAILED;
+                }
             }
-        }
-        else
-        {
-            MIRACASTLOG_INFO("Socket Connected Successfully ...");
-            ret = MIRACAST_OK;
-            is_connected = true;
-        }
-    }
-
-    if (is_connected)
-    {
-        /*---Wait for socket connect to complete---*/
-        num_ready = epoll_wait(m_epollfd, events, MAX_EPOLL_EVENTS, 1000 /*timeout*/);
-        for (i = 0; i < num_ready; i++)
-        {
-            if (events[i].events & EPOLLOUT)
+            break;
+            case RTSP_CONNECT_STATE_BACKOFF:
             {
-                MIRACASTLOG_INFO("Socket(%d) %d connected (EPOLLOUT)", i, events[i].data.fd);
-            }
-        }
+                close(m_tcpSockfd);
+                m_tcpSockfd = -1;
 
-        num_ready = epoll_wait(m_epollfd, events, MAX_EPOLL_EVENTS, 1000 /*timeout*/);
-        for (i = 0; i < num_ready; i++)
-        {
-            if (events[i].events & EPOLLOUT)
-            {
-                MIRACASTLOG_INFO("Socket %d got some data via EPOLLOUT", events[i].data.fd);
-                break;
+                if ((current_time_ms + backoff_ms) >= deadline_ms)
+                {
+                    MIRACASTLOG_ERROR("Giving up connect after [%u] attempts", attempts);
+                    connect_state = RTSP_CONNECT_STATE_FAILED;
+                }
+                else
+                {
+                    poll(nullptr, 0, backoff_ms);
+                    backoff_ms = std::min(backoff_ms * 2, static_cast<unsigned int>(RTSP_CONNECT_MAX_BACKOFF_MSEC));
+                    connect_state = RTSP_CONNECT_STATE_START;
+                }
             }
+            break;
+            default:
+            break;
         }
     }
 
-    if ( MIRACAST_FAIL == ret )
+    if ((RTSP_CONNECT_STATE_CONNECTED == connect_state) && (add_SessionEventDescriptors()))
     {
-        Release_SocketAndEpollDescriptor();
+        set_SocketOptions();
+        m_connect_latency_us = MiracastCommon::get_monotonic_time_us() - start_time_us;
+        MIRACASTLOG_INFO("#### MCAST-TRIAGE-OK-RTSP-CONNECT Socket Connected to [%s:%u] in [%u]ms attempts[%u] ####",
+                            goIP.c_str(), ntohs(addr.sin_port), static_cast<unsigned int>(m_connect_latency_us / 1000), attempts);
+        MIRACASTLOG_TRACE("Exiting...");
+        return MIRACAST_OK;
     }
 
+    Release_SocketAndEpollDescriptor();
     MIRACASTLOG_TRACE("Exiting...");
-    return ret;
+    return MIRACAST_FAIL;
 }
 
-RTSP_STATUS MiracastRTSPMsg::send_rstp_msg(int socket_fd, std::string rtsp_response_buffer)
+RTSP_STATUS MiracastRTSPMsg::send_rstp_msg(int socket_fd, const RTSP_MSG_SEGMENTS_STRUCT &rtsp_msg)
 {
-    int read_ret = 0;
-    read_ret = send(socket_fd, rtsp_response_buffer.c_str(), rtsp_response_buffer.length(), 0);
+    struct iovec segments[RTSP_MSG_MAX_SEGMENTS];
+    struct msghdr msg = {};
+    size_t total_length = 0;
 
-    if (0 > read_ret)
+    for (size_t index = 0; index < rtsp_msg.segment_count; ++index)
     {
-        MIRACASTLOG_ERROR("Send Failed (%d)%s", errno, strerror(errno));
-        return RTSP_MSG_FAILURE;
+        segments[index] = rtsp_msg.segments[index];
+        total_length += segments[index].iov_len;
+        MIRACASTLOG_VERBOSE("Segment[%zu] [%.*s]", index, static_cast<int>(segments[index].iov_len), static_cast<const char *>(segments[index].iov_base));
     }
+    msg.msg_iov = segments;
+    msg.msg_iovlen = rtsp_msg.segment_count;
+
+    while (0 < msg.msg_iovlen)
+    {
+        ssize_t sent_length = sendmsg(socket_fd, &msg, MSG_NOSIGNAL);
+
+        if (0 > sent_length)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            if ((EAGAIN == errno) || (EWOULDBLOCK == errno))
+            {
+                struct pollfd poll_fd = { socket_fd, POLLOUT, 0 };
+
+                if (0 < poll(&poll_fd, 1, RTSP_SEND_WAIT_TIMEOUT))
+                {
+                    continue;
+                }
+            }
+            MIRACASTLOG_ERROR("Send Failed (%d)%s", errno, strerror(errno));
+            return RTSP_MSG_FAILURE;
+        }
 
-    MIRACASTLOG_INFO("Sending the RTSP Msg [%d] Data[%s]\n", read_ret, rtsp_response_buffer.c_str());
+        /* Socket is non-blocking, so skip over whatever has gone out already */
+        while ((0 < msg.msg_iovlen) && (static_cast<size_t>(sent_length) >= msg.msg_iov->iov_len))
+        {
+            sent_length -= msg.msg_iov->iov_len;
+            ++msg.msg_iov;
+            --msg.msg_iovlen;
+        }
+        if (0 < msg.msg_iovlen)
+        {
+            msg.msg_iov->iov_base = static_cast<char *>(msg.msg_iov->iov_base) + sent_length;
+            msg.msg_iov->iov_len -= sent_length;
+        }
+    }
+
+    MIRACASTLOG_INFO("Sending the RTSP Msg [%zu] bytes in [%zu] segments\n", total_length, rtsp_msg.segment_count);
     return RTSP_MSG_SUCCESS;
 }
 
-RTSP_STATUS MiracastRTSPMsg::validate_rtsp_setparameter_request( std::string rtsp_msg_buffer )
+RTSP_STATUS MiracastRTSPMsg::validate_rtsp_setparameter_request( const MiracastRTSPParser &rtsp_msg )
 {
     RTSP_STATUS status_code = RTSP_INVALID_MSG_RECEIVED;
 
     MIRACASTLOG_TRACE("Entering...");
 
-    const char  *trigger_method_tag = get_parser_field_by_index(RTSP_TRIGGER_METHOD_FIELD);
-
-    if (rtsp_msg_buffer.find(trigger_method_tag) != std::string::npos)
+    if (rtsp_msg.has_wfd_param(RTSP_WFD_PARAM_TRIGGER_METHOD))
     {
-        status_code = validate_rtsp_trigger_method_request(rtsp_msg_buffer);
+        status_code = validate_rtsp_trigger_method_request(rtsp_msg);
     }
     else
     {
         // Processing M4 request and response back
-        status_code = validate_rtsp_m4_response_back(rtsp_msg_buffer);
+        status_code = validate_rtsp_m4_response_back(rtsp_msg);
     }
     MIRACASTLOG_TRACE("Exiting...");
 
     return status_code;
 }
 
-RTSP_STATUS MiracastRTSPMsg::validate_rtsp_getparameter_request( std::string rtsp_msg_buffer )
+RTSP_STATUS MiracastRTSPMsg::validate_rtsp_getparameter_request( const MiracastRTSPParser &rtsp_msg )
 {
     RTSP_STATUS status_code = RTSP_MSG_FAILURE;
     MIRACASTLOG_TRACE("Entering...");
-    const char *content_txt_tag = get_parser_field_by_index(RTSP_CONTENT_TEXT_FIELD);
 
-    if (rtsp_msg_buffer.find(content_txt_tag) != std::string::npos)
+    if (rtsp_msg.get_header(RTSP_HEADER_CONTENT_TYPE).starts_with(RTSP_CONTENT_TYPE_TEXT_PARAMETERS))
     {
-        status_code = validate_rtsp_m3_response_back(rtsp_msg_buffer);
+        status_code = validate_rtsp_m3_response_back(rtsp_msg);
     }
     else
-    {
-        // It looks get parameter without body. So consider it as keepalive M16
-        std::string seq_str = "";
-        std::stringstream ss(rtsp_msg_buffer);
-        std::string prefix = "";
-        std::string line;
-        const char  *sequence_tag = get_parser_field_by_index(RTSP_SEQUENCE_FIELD);
-
-        while (std::getline(ss, line))
-        {
-            if (line.find(sequence_tag) != std::string::npos)
-            {
-                prefix = sequence_tag;
-                seq_str = line.substr(prefix.length());
-                REMOVE_R(seq_str);
-                REMOVE_N(seq_str);
-                break;
-            }
-        }
-        status_code = send_rtsp_reply_sink2src( RTSP_MSG_FMT_M16_RESPONSE , seq_str );
+    {
+        // It looks get parameter without body. So consider it as keepalive M16
+        status_code = send_rtsp_reply_sink2src( RTSP_MSG_FMT_M16_RESPONSE , rtsp_msg.get_header(RTSP_HEADER_CSEQ) );
         if ( RTSP_MSG_SUCCESS == status_code )
         {
             // Overwriting the SUCCESS status as KEEP-ALIVE-MSG received to handle M16
             status_code = RTSP_KEEP_ALIVE_MSG_RECEIVED;
+            m_latency_stats.end(RTSP_LATENCY_PHASE_KEEP_ALIVE);
+            m_latency_stats.begin(RTSP_LATENCY_PHASE_KEEP_ALIVE);
             MIRACASTLOG_INFO(" !!! RTSP_KEEP_ALIVE_MSG_RECEIVED OK !!!");
         }
     }
@@ -1139,45 +1974,47 @@ RTSP_STATUS MiracastRTSPMsg::validate_rtsp_getparameter_request( std::string rts
     return status_code;
 }
 
-RTSP_STATUS MiracastRTSPMsg::validate_rtsp_options_request( std::string rtsp_msg_buffer )
+RTSP_STATUS MiracastRTSPMsg::validate_rtsp_options_request( const MiracastRTSPParser &rtsp_msg )
 {
-    return validate_rtsp_m1_msg_m2_send_request(rtsp_msg_buffer);
+    return validate_rtsp_m1_msg_m2_send_request(rtsp_msg);
 }
 
-RTSP_STATUS MiracastRTSPMsg::validate_rtsp_generic_request_response( std::string rtsp_msg_buffer )
+RTSP_STATUS MiracastRTSPMsg::validate_rtsp_generic_request_response( const MiracastRTSPParser &rtsp_msg )
 {
     RTSP_STATUS status_code = RTSP_INVALID_MSG_RECEIVED;
+    RTSPStringView received_seq_num = rtsp_msg.get_header(RTSP_HEADER_CSEQ),
+                   rtsp_msg_buffer = rtsp_msg.get_message();
 
     MIRACASTLOG_TRACE("Entering...");
 
-    std::string public_tag = get_parser_field_by_index(RTSP_PUBLIC_FIELD),
-                transport_tag = get_parser_field_by_index(RTSP_TRANSPORT_FIELD),
-                rtsp_version_tag = get_parser_field_by_index(RTSP_VERSION_FIELD);
-    std::string received_seq_num = parse_received_parser_field_value( rtsp_msg_buffer , RTSP_SEQUENCE_FIELD);
-
-    if (rtsp_msg_buffer.find(public_tag) != std::string::npos)
+    if (rtsp_msg.has_header(RTSP_HEADER_PUBLIC))
     {
-        status_code = validate_rtsp_m2_request_ack(rtsp_msg_buffer);
+        status_code = validate_rtsp_m2_request_ack(rtsp_msg);
     }
-    else if (rtsp_msg_buffer.find(transport_tag) != std::string::npos){
-        status_code = validate_rtsp_m6_ack_m7_send_request(rtsp_msg_buffer);
+    else if (rtsp_msg.has_header(RTSP_HEADER_TRANSPORT)){
+        status_code = validate_rtsp_m6_ack_m7_send_request(rtsp_msg);
     }
-    else if (rtsp_msg_buffer.find(get_errorcode_string(RTSP_ERRORCODE_OK)) != std::string::npos)
+    else if ((RTSP_START_LINE_RESPONSE == rtsp_msg.get_start_line_type()) &&
+             (RTSP_STATUS_CODE_OK == rtsp_msg.get_status_code()))
     {
-        status_code = validate_rtsp_trigger_request_ack(rtsp_msg_buffer , received_seq_num );
+        status_code = validate_rtsp_trigger_request_ack(rtsp_msg);
     }
     else
     {
-        if (rtsp_msg_buffer.find(rtsp_version_tag) != std::string::npos)
+        if (RTSP_START_LINE_INVALID != rtsp_msg.get_start_line_type())
         {
-            MIRACASTLOG_WARNING(" !!! Could be RTSP ERROR Reported !!!...",rtsp_msg_buffer.c_str());
+            MIRACASTLOG_WARNING(" !!! Could be RTSP ERROR Reported [%.*s] !!!...",
+                                static_cast<int>(rtsp_msg.get_start_line().length()),
+                                rtsp_msg.get_start_line().data());
             status_code = RTSP_MSG_SUCCESS;
         }
         else
         {
-            MIRACASTLOG_ERROR("!!! [%s] has to be Handled properly CSeq[%s] !!!...",
-                                rtsp_msg_buffer.c_str(),
-                                received_seq_num.c_str());
+            MIRACASTLOG_ERROR("!!! [%.*s] has to be Handled properly CSeq[%.*s] !!!...",
+                                static_cast<int>(rtsp_msg_buffer.length()),
+                                rtsp_msg_buffer.data(),
+                                static_cast<int>(received_seq_num.length()),
+                                received_seq_num.data());
             send_rtsp_reply_sink2src( RTSP_MSG_FMT_REPORT_ERROR , 
                                       received_seq_num, 
                                       RTSP_ERRORCODE_NOT_IMPLEMENTED );
@@ -1189,55 +2026,56 @@ RTSP_STATUS MiracastRTSPMsg::validate_rtsp_generic_request_response( std::string
     return status_code;
 }
 
-RTSP_STATUS MiracastRTSPMsg::validate_rtsp_m1_msg_m2_send_request(std::string rtsp_m1_msg_buffer)
+RTSP_STATUS MiracastRTSPMsg::validate_rtsp_m1_msg_m2_send_request(const MiracastRTSPParser &rtsp_msg)
 {
     RTSP_STATUS status_code = RTSP_INVALID_MSG_RECEIVED;
 
     MIRACASTLOG_TRACE("Entering...");
     
-    std::string m1_msg_resp_sink2src = "";
+    RTSP_MSG_SEGMENTS_STRUCT m1_msg_resp_sink2src;
     MIRACASTLOG_INFO("M1 OPTIONS packet received");
-    std::stringstream ss(rtsp_m1_msg_buffer);
-    std::string prefix = "";
-    std::string req_str;
-    std::string seq_str;
-    std::string line;
-    const char *require_tag = get_parser_field_by_index(RTSP_REQUIRE_FIELD),
-                *sequence_tag = get_parser_field_by_index(RTSP_SEQUENCE_FIELD);
+    RTSPStringView req_str = rtsp_msg.get_header(RTSP_HEADER_REQUIRE),
+                   seq_str = rtsp_msg.get_header(RTSP_HEADER_CSEQ);
 
-    while (std::getline(ss, line))
+    // Latency stats are grouped by the source model, the device name is used if the source does not announce it
+    if (rtsp_msg.has_header(RTSP_HEADER_SERVER))
     {
-        if (line.find(require_tag) != std::string::npos)
-        {
-            prefix = require_tag;
-            req_str = line.substr(prefix.length());
-            REMOVE_R(req_str);
-            REMOVE_N(req_str);
-        }
-        else if (line.find(sequence_tag) != std::string::npos)
-        {
-            prefix = sequence_tag;
-            seq_str = line.substr(prefix.length());
-            REMOVE_R(seq_str);
-            REMOVE_N(seq_str);
-        }
+        m_latency_stats.start_session(rtsp_msg.get_header(RTSP_HEADER_SERVER).trim().to_string());
     }
+    else if (rtsp_msg.has_header(RTSP_HEADER_USER_AGENT))
+    {
+        m_latency_stats.start_session(rtsp_msg.get_header(RTSP_HEADER_USER_AGENT).trim().to_string());
+    }
+    else
+    {
+        m_latency_stats.start_session(m_connected_device_name);
+    }
+    // Measured before the source model is known, counted for it now
+    if (0 < m_connect_latency_us)
+    {
+        m_latency_stats.record(RTSP_LATENCY_PHASE_CONNECT, m_connect_latency_us);
+        m_connect_latency_us = 0;
+    }
+    m_latency_stats.begin(RTSP_LATENCY_PHASE_SESSION_SETUP);
+    m_latency_stats.begin(RTSP_LATENCY_PHASE_M1_M2);
 
-    m1_msg_resp_sink2src = generate_request_response_msg(RTSP_MSG_FMT_M1_RESPONSE, seq_str, req_str);
-
-    MIRACASTLOG_INFO("Sending the M1 response [%s]", m1_msg_resp_sink2src.c_str());
-
-    status_code = send_rstp_msg(m_tcpSockfd, m1_msg_resp_sink2src);
+    if (generate_request_response_msg(RTSP_MSG_FMT_M1_RESPONSE, seq_str, req_str, m1_msg_resp_sink2src))
+    {
+        MIRACASTLOG_INFO("Sending the M1 response");
+        status_code = send_rstp_msg(m_tcpSockfd, m1_msg_resp_sink2src);
+    }
 
     if (RTSP_MSG_SUCCESS == status_code)
     {
-        std::string m2_msg_req_sink2src = "";
+        RTSP_MSG_SEGMENTS_STRUCT m2_msg_req_sink2src;
         MIRACASTLOG_INFO("M1 response sent");
 
-        m2_msg_req_sink2src = generate_request_response_msg(RTSP_MSG_FMT_M2_REQUEST, empty_string, req_str);
-
-        MIRACASTLOG_INFO("Sending the M2 request [%s]",m2_msg_req_sink2src.c_str());
-        status_code = send_rstp_msg(m_tcpSockfd, m2_msg_req_sink2src);
+        status_code = RTSP_MSG_FAILURE;
+        if (generate_request_response_msg(RTSP_MSG_FMT_M2_REQUEST, RTSPStringView(), req_str, m2_msg_req_sink2src))
+        {
+            MIRACASTLOG_INFO("Sending the M2 request");
+            status_code = send_rstp_msg(m_tcpSockfd, m2_msg_req_sink2src);
+        }
         if (RTSP_MSG_SUCCESS == status_code)
         {
             MIRACASTLOG_INFO("M2 request sent");
@@ -1256,85 +2094,45 @@ RTSP_STATUS MiracastRTSPMsg::validate_rtsp_m1_msg_m2_send_request(std::string rt
     return (status_code);
 }
 
-RTSP_STATUS MiracastRTSPMsg::validate_rtsp_m2_request_ack(std::string rtsp_m2_resp_ack_buffer)
+RTSP_STATUS MiracastRTSPMsg::validate_rtsp_m2_request_ack(const MiracastRTSPParser &rtsp_msg)
 {
     RTSP_STATUS status_code = RTSP_INVALID_MSG_RECEIVED;
+    RTSPStringView public_str = rtsp_msg.get_header(RTSP_HEADER_PUBLIC),
+                   seq_str = rtsp_msg.get_header(RTSP_HEADER_CSEQ);
 
     MIRACASTLOG_TRACE("Entering...");
-    std::stringstream ss(rtsp_m2_resp_ack_buffer);
-    std::string prefix = "";
-    std::string public_str;
-    std::string seq_str;
-    std::string line;
-    const char *public_tag = get_parser_field_by_index(RTSP_PUBLIC_FIELD),
-                *sequence_tag = get_parser_field_by_index(RTSP_SEQUENCE_FIELD);
-    bool    foundSequence = false;
-    int processedBytes = 0,
-        totalLen = rtsp_m2_resp_ack_buffer.length();
-
-    while (std::getline(ss, line,'\n'))
-    {
-        if (line.find("GET_PARAMETER") == 0)
-        {
-            // Stop processing when "GET_PARAMETER" is found at the beginning of a line
-            break;
-        }
-        else
-        {
-            processedBytes += line.length() + 1; // Add 1 for '\n'
-            if (line.find(public_tag) != std::string::npos)
-            {
-                prefix = public_tag;
-                public_str = line.substr(prefix.length());
-                REMOVE_R(public_str);
-                REMOVE_N(public_str);
-                //ss.get();
-                //processedBytes += 2; // Skip next '\r\n' line
-                //break;
-            }
-            else if (( false == foundSequence) &&(line.find(sequence_tag) != std::string::npos))
-            {
-                prefix = sequence_tag;
-                seq_str = line.substr(prefix.length());
-                REMOVE_R(seq_str);
-                REMOVE_N(seq_str);
-                foundSequence = true;
-            }
-        }
-    }
 
     if ( true == IsValidSequenceNumber(seq_str))
     {
-        std::vector<std::string> requiredFields;
+        bool allRequiredFieldsPresent = true;
 
         for ( RTSP_PARSER_FIELDS parser_field = static_cast<RTSP_PARSER_FIELDS>(RTSP_M2_RESPONSE_VALIDATE_MARKER_START + 1);
               RTSP_M2_RESPONSE_VALIDATE_MARKER_END > parser_field; 
               parser_field = static_cast<RTSP_PARSER_FIELDS>(parser_field + 1) )
         {
-            requiredFields.push_back(get_parser_field_by_index(parser_field));
-            MIRACASTLOG_TRACE("[%s] stored as requiredFields for M2 response validation\n",get_parser_field_by_index(parser_field));
-        }
-
-        bool allRequiredFieldsPresent = true;
+            const char *requiredField = get_parser_field_by_index(parser_field);
 
-        for (const std::string& requiredField : requiredFields) {
-            if (public_str.find(requiredField) == std::string::npos)
+            if (RTSPStringView::npos == public_str.find(requiredField))
             {
                 allRequiredFieldsPresent = false;
-                MIRACASTLOG_ERROR("!!!! [%s] not present in the M2 Response[%s] !!!",
-                                    requiredField.c_str(),
-                                    public_str.c_str());
+                MIRACASTLOG_ERROR("!!!! [%s] not present in the M2 Response[%.*s] !!!",
+                                    requiredField,
+                                    static_cast<int>(public_str.length()),
+                                    public_str.data());
                 break;
             }
         }
 
         if (allRequiredFieldsPresent){
             status_code = RTSP_MSG_SUCCESS;
+            m_latency_stats.end(RTSP_LATENCY_PHASE_M1_M2);
+            // M3 includes the source's turnaround, not just our handling of it
+            m_latency_stats.begin(RTSP_LATENCY_PHASE_M3);
             MIRACASTLOG_VERBOSE("[M2 ack OK]");
         }
     }
     else{
-        MIRACASTLOG_ERROR("Invalid Sequence Number[%s] in M2 Response\n",seq_str.c_str());
+        MIRACASTLOG_ERROR("Invalid Sequence Number[%.*s] in M2 Response\n",static_cast<int>(seq_str.length()),seq_str.data());
     }
 
     if (  RTSP_MSG_SUCCESS != status_code )
@@ -1342,74 +2140,61 @@ RTSP_STATUS MiracastRTSPMsg::validate_rtsp_m2_request_ack(std::string rtsp_m2_re
         send_rtsp_reply_sink2src( RTSP_MSG_FMT_REPORT_ERROR , seq_str, RTSP_ERRORCODE_BAD_REQUEST );
     }
 
-    MIRACASTLOG_INFO("#### totalLen[%d] and processedBytes[%d] ####", totalLen,processedBytes);
-
-    if ( 0 >= ( totalLen - processedBytes))
-    {
-        MIRACASTLOG_INFO("#### [M2-ack] only Received ####");
-    }
-    else
-    {
-        std::string m3_request_buffer = rtsp_m2_resp_ack_buffer.substr(processedBytes, totalLen - processedBytes);
-        MIRACASTLOG_INFO("#### [M2-ack + M3 Req] Received M3[%s]  ####", m3_request_buffer.c_str());
-        status_code = validate_rtsp_receive_buffer_handling(m3_request_buffer);
-        MIRACASTLOG_INFO("#### Response[%#04X] ####", status_code);
-    }
     set_wait_timeout(m_wfd_src_req_timeout);
     MIRACASTLOG_TRACE("Exiting...");
     return (status_code);
 }
 
-RTSP_STATUS MiracastRTSPMsg::validate_rtsp_m3_response_back(std::string rtsp_m3_msg_buffer)
+RTSP_STATUS MiracastRTSPMsg::validate_rtsp_m3_response_back(const MiracastRTSPParser &rtsp_msg)
 {
     RTSP_STATUS status_code = RTSP_INVALID_MSG_RECEIVED;
     MIRACASTLOG_TRACE("Entering...");
     MIRACASTLOG_INFO("M3 request received");
 
-    std::string content_buffer = "";
-    std::string m3_msg_resp_sink2src = "";
-    std::string seq_str = "";
-    std::stringstream ss(rtsp_m3_msg_buffer);
-    std::string prefix = "";
-    std::string line;
-    std::string actual_parser_field = "",
-                parser_field_value = "";
-    const char  *sequence_tag = get_parser_field_by_index(RTSP_SEQUENCE_FIELD);
+    RTSP_MSG_SEGMENTS_STRUCT m3_msg_resp_sink2src;
+    const std::string *content_buffer = &m_m3_full_body;
+    unsigned int requested_mask = 0;
 
-    while (std::getline(ss, line))
+    for (size_t param_index = 0; param_index < rtsp_msg.get_body_param_count(); ++param_index)
     {
-        if (line.find(sequence_tag) != std::string::npos)
+        RTSP_WFD_PARAM_ID param_id = rtsp_msg.get_body_param(param_index).param_id;
+
+        if (RTSP_WFD_PARAM_UNKNOWN != param_id)
         {
-            prefix = sequence_tag;
-            seq_str = line.substr(prefix.length());
-            REMOVE_R(seq_str);
-            REMOVE_N(seq_str);
+            requested_mask |= RTSP_WFD_PARAM_BIT(param_id);
         }
-        else if (line.find("wfd") != std::string::npos)
+    }
+
+    // Serve the cached body as is when the source asks for every capability we have
+    if (m_m3_full_body_mask != (requested_mask & m_m3_full_body_mask))
+    {
+        unsigned int appended_mask = 0;
+
+        m_m3_response_body.clear();
+        for (size_t param_index = 0; param_index < rtsp_msg.get_body_param_count(); ++param_index)
         {
-            REMOVE_R(line);
-            REMOVE_N(line);
-            parser_field_value = get_parser_field_n_value_by_name(line);
-            if (!parser_field_value.empty())
+            RTSP_WFD_PARAM_ID param_id = rtsp_msg.get_body_param(param_index).param_id;
+
+            if ((RTSP_WFD_PARAM_UNKNOWN != param_id) && (0 == (appended_mask & RTSP_WFD_PARAM_BIT(param_id))))
             {
-                content_buffer.append(line);
-                content_buffer.append(": ");
-                content_buffer.append(parser_field_value);
-                content_buffer.append(RTSP_CRLF_STR);
+                m_m3_response_body.append(m_m3_param_lines[param_id]);
+                appended_mask |= RTSP_WFD_PARAM_BIT(param_id);
             }
-            parser_field_value.clear();
-            actual_parser_field.clear();
         }
+        content_buffer = &m_m3_response_body;
     }
 
-    m3_msg_resp_sink2src = generate_request_response_msg(RTSP_MSG_FMT_M3_RESPONSE, seq_str, content_buffer);
-
-    MIRACASTLOG_VERBOSE("%s", m3_msg_resp_sink2src.c_str());
-
-    status_code = send_rstp_msg(m_tcpSockfd, m3_msg_resp_sink2src);
+    if (generate_request_response_msg(RTSP_MSG_FMT_M3_RESPONSE,
+                                      rtsp_msg.get_header(RTSP_HEADER_CSEQ),
+                                      RTSPStringView(*content_buffer),
+                                      m3_msg_resp_sink2src))
+    {
+        status_code = send_rstp_msg(m_tcpSockfd, m3_msg_resp_sink2src);
+    }
 
     if (RTSP_MSG_SUCCESS == status_code)
     {
+        m_latency_stats.end(RTSP_LATENCY_PHASE_M3);
         MIRACASTLOG_INFO("Sending the M3 response");
     }
     else
@@ -1420,46 +2205,84 @@ RTSP_STATUS MiracastRTSPMsg::validate_rtsp_m3_response_back(std::string rtsp_m3_
     return (status_code);
 }
 
-RTSP_STATUS MiracastRTSPMsg::validate_rtsp_m4_response_back(std::string rtsp_m4_msg_buffer)
+RTSP_STATUS MiracastRTSPMsg::validate_rtsp_m4_response_back(const MiracastRTSPParser &rtsp_msg)
 {
     RTSP_STATUS status_code = RTSP_INVALID_MSG_RECEIVED;
+    RTSP_ERRORCODES error_code = RTSP_ERRORCODE_OK;
     MIRACASTLOG_TRACE("Entering...");
 
-    std::string m4_msg_resp_sink2src = "";
-    std::string seq_str = "";
-    std::string url = "";
-    std::stringstream ss(rtsp_m4_msg_buffer);
-    std::string prefix = "";
-    std::string line;
-    const char  *sequence_tag = get_parser_field_by_index(RTSP_SEQUENCE_FIELD),
-                *url_tag = get_parser_field_by_index(RTSP_WFD_STREAMING_URL_FIELD);
+    RTSP_MSG_SEGMENTS_STRUCT m4_msg_resp_sink2src;
+    // After M7 a new format is switched to by the running player, no M5 follows it
+    bool renegotiation = (0 != m_play_request_us);
 
-    while (std::getline(ss, line))
+    if (renegotiation)
     {
-        if (line.find(sequence_tag) != std::string::npos)
-        {
-            prefix = sequence_tag;
-            seq_str = line.substr(prefix.length());
-            REMOVE_R(seq_str);
-            REMOVE_N(seq_str);
-        }
-        else if (line.find(url_tag) != std::string::npos)
-        {
-            prefix = url_tag;
-            std::size_t url_start_pos = line.find(prefix) + prefix.length();
-            std::size_t url_end_pos = line.find(RTSP_SPACE_STR, url_start_pos);
-            url = line.substr(url_start_pos, url_end_pos - url_start_pos);
-            set_WFDPresentationURL(url);
-        }
+        MIRACASTLOG_INFO("Mid-session M4, the player renegotiates without a restart");
+    }
+    else
+    {
+        m_latency_stats.begin(RTSP_LATENCY_PHASE_M4_M5);
     }
 
-    m4_msg_resp_sink2src = generate_request_response_msg( RTSP_MSG_FMT_M4_RESPONSE,seq_str,empty_string);
+    RTSPStringView video_formats = rtsp_msg.get_wfd_param(RTSP_WFD_PARAM_VIDEO_FORMATS).trim();
+    bool cached_video_format = ((m_cached_params_applied) &&
+                                (video_formats.equals(m_session_params.video_format.c_str(), m_session_params.video_format.length())));
 
-    MIRACASTLOG_INFO("Sending the M4 response");
-    status_code = send_rstp_msg(m_tcpSockfd, m4_msg_resp_sink2src);
-    if (RTSP_MSG_SUCCESS == status_code)
+    // Reject the selected format here, before any player resources are set up for it.
+    // The format cached for this source has already been negotiated by store_srcsink_info()
+    if ((rtsp_msg.has_wfd_param(RTSP_WFD_PARAM_VIDEO_FORMATS)) &&
+        (!cached_video_format) &&
+        (!negotiate_wfd_video_format(video_formats)))
+    {
+        error_code = RTSP_ERRORCODE_NOT_ACCEPTABLE;
+    }
+    else if (rtsp_msg.has_wfd_param(RTSP_WFD_PARAM_PRESENTATION_URL))
+    {
+        RTSPStringView url = rtsp_msg.get_wfd_param(RTSP_WFD_PARAM_PRESENTATION_URL);
+        std::string presentation_url = url.substr(0, url.find(' ')).to_string();
+        set_WFDPresentationURL(presentation_url);
+    }
+    if ((RTSP_ERRORCODE_OK == error_code) && (rtsp_msg.has_wfd_param(RTSP_WFD_PARAM_AUDIO_CODECS)))
+    {
+        // An audio codec we can't name only loses the audio part of the pre-warm, the decoder still autoplugs
+        negotiate_wfd_audio_codec(rtsp_msg.get_wfd_param(RTSP_WFD_PARAM_AUDIO_CODECS).trim());
+    }
+
+    if (generate_request_response_msg( RTSP_MSG_FMT_M4_RESPONSE,rtsp_msg.get_header(RTSP_HEADER_CSEQ),RTSPStringView(),m4_msg_resp_sink2src,error_code))
+    {
+        MIRACASTLOG_INFO("Sending the M4 response");
+        status_code = send_rstp_msg(m_tcpSockfd, m4_msg_resp_sink2src);
+    }
+    if (RTSP_ERRORCODE_OK != error_code)
+    {
+        MIRACASTLOG_ERROR("M4 rejected as video format is not supported");
+        m_param_cache.invalidate(m_connected_mac_addr);
+        m_cached_params_applied = false;
+        status_code = RTSP_INVALID_MSG_RECEIVED;
+    }
+    else if (RTSP_MSG_SUCCESS == status_code)
     {
         MIRACASTLOG_INFO("M4 response sent");
+        if (rtsp_msg.has_wfd_param(RTSP_WFD_PARAM_UIBC_CAPABILITY))
+        {
+            m_uibc.update_capability(rtsp_msg.get_wfd_param(RTSP_WFD_PARAM_UIBC_CAPABILITY));
+        }
+        if (rtsp_msg.has_wfd_param(RTSP_WFD_PARAM_UIBC_SETTING))
+        {
+            m_uibc.update_setting(rtsp_msg.get_wfd_param(RTSP_WFD_PARAM_UIBC_SETTING).trim().equals("enable"));
+        }
+        if (m_uibc.is_enabled())
+        {
+            m_uibc.start(m_epollfd, m_src_dev_ip);
+        }
+        if ((!update_session_params(rtsp_msg)) && (m_cached_params_applied))
+        {
+            MIRACASTLOG_INFO("M4 differs from the params cached for [%s]", m_connected_mac_addr.c_str());
+            m_param_cache.invalidate(m_connected_mac_addr);
+            m_cached_params_applied = false;
+        }
+        m_param_cache.store(m_session_params);
+        prewarm_player();
     }
     else
     {
@@ -1469,39 +2292,29 @@ RTSP_STATUS MiracastRTSPMsg::validate_rtsp_m4_response_back(std::string rtsp_m4_
     return (status_code);
 }
 
-RTSP_STATUS MiracastRTSPMsg::validate_rtsp_m5_msg_m6_send_request(std::string rtsp_m5_msg_buffer)
+RTSP_STATUS MiracastRTSPMsg::validate_rtsp_m5_msg_m6_send_request(const MiracastRTSPParser &rtsp_msg)
 {
     RTSP_STATUS status_code = RTSP_INVALID_MSG_RECEIVED;
     MIRACASTLOG_TRACE("Entering...");
 
-    std::string m5_msg_resp_sink2src = "";
-    std::string seq_str = "";
-    std::stringstream ss(rtsp_m5_msg_buffer);
-    std::string prefix = "";
-    std::string line;
-    const char  *sequence_tag = get_parser_field_by_index(RTSP_SEQUENCE_FIELD);
+    RTSP_MSG_SEGMENTS_STRUCT m5_msg_resp_sink2src;
 
-    while (std::getline(ss, line))
+    m_latency_stats.end(RTSP_LATENCY_PHASE_M4_M5);
+
+    if (generate_request_response_msg(RTSP_MSG_FMT_M5_RESPONSE, rtsp_msg.get_header(RTSP_HEADER_CSEQ), RTSPStringView(), m5_msg_resp_sink2src))
     {
-        if (line.find(sequence_tag) != std::string::npos)
-        {
-            prefix = sequence_tag;
-            seq_str = line.substr(prefix.length());
-            REMOVE_R(seq_str);
-            REMOVE_N(seq_str);
-            break;
-        }
+        MIRACASTLOG_INFO("Sending the M5 response");
+        status_code = send_rstp_msg(m_tcpSockfd, m5_msg_resp_sink2src);
     }
-
-    m5_msg_resp_sink2src = generate_request_response_msg(RTSP_MSG_FMT_M5_RESPONSE, seq_str, empty_string);
-
-    MIRACASTLOG_INFO("Sending the M5 response");
-    status_code = send_rstp_msg(m_tcpSockfd, m5_msg_resp_sink2src);
     if (RTSP_MSG_SUCCESS == status_code)
     {
         MIRACASTLOG_INFO("M5 Response has sent");
 
         status_code = send_rtsp_reply_sink2src(RTSP_MSG_FMT_M6_REQUEST);
+        if (RTSP_MSG_SUCCESS == status_code)
+        {
+            m_latency_stats.begin(RTSP_LATENCY_PHASE_M6_M7);
+        }
         set_wait_timeout(m_wfd_src_res_timeout);
     }
     else
@@ -1512,54 +2325,91 @@ RTSP_STATUS MiracastRTSPMsg::validate_rtsp_m5_msg_m6_send_request(std::string rt
     return (status_code);
 }
 
-RTSP_STATUS MiracastRTSPMsg::validate_rtsp_m6_ack_m7_send_request(std::string rtsp_m6_ack_buffer)
+RTSP_STATUS MiracastRTSPMsg::validate_rtsp_m6_ack_m7_send_request(const MiracastRTSPParser &rtsp_msg)
 {
     RTSP_STATUS status_code = RTSP_INVALID_MSG_RECEIVED;
-
-    std::stringstream ss(rtsp_m6_ack_buffer);
-    std::string line;
+    RTSPStringView session_line = rtsp_msg.get_header(RTSP_HEADER_SESSION),
+                   transport_line = rtsp_msg.get_header(RTSP_HEADER_TRANSPORT);
     std::string session_number = "",
                 clientPortValue = "";
     int timeoutValue = -1;
-    const char  *session_tag = get_parser_field_by_index(RTSP_SESSION_FIELD);
 
     MIRACASTLOG_TRACE("Entering...");
 
-    while (std::getline(ss, line))
+    if (rtsp_msg.has_header(RTSP_HEADER_SESSION))
     {
-        if (line.find(session_tag) != std::string::npos) {
-            std::regex sessionRegex("Session: ([0-9a-fA-F]+)(?:;timeout=([0-9]+))?");
-            std::smatch match;
-            if (std::regex_search(line, match, sessionRegex) && match.size() == 3) {
-                session_number = match[1];
-                MIRACASTLOG_TRACE("Session Number[%s]\n",session_number.c_str());
-                if (match.size() > 2 && match[2].matched)
-                {
-                    timeoutValue = std::stoi(match[2]);
-                    MIRACASTLOG_INFO("timeoutValue[%d] in M6 ACK\n",timeoutValue);
-                }
-                else
-                {
-                    timeoutValue = RTSP_DFLT_KEEP_ALIVE_WAIT_TIMEOUT_SEC;
-                    MIRACASTLOG_ERROR("Failed to obtain timeout from [%s] and configured the default value[%d]\n",
-                                        line.c_str(),
-                                        timeoutValue);
-                }
+        // Session: <hex-id>[;timeout=<seconds>]
+        size_t session_end = session_line.find(';');
+        RTSPStringView session_id = session_line.substr(0, session_end).trim();
+        bool valid_session = !session_id.empty();
+
+        for (size_t pos = 0; valid_session && (pos < session_id.length()); ++pos)
+        {
+            valid_session = (0 != isxdigit(static_cast<unsigned char>(session_id[pos])));
+        }
+
+        if (valid_session)
+        {
+            size_t timeout_pos = session_line.find(RTSP_SESSION_TIMEOUT_FIELD);
+            unsigned long session_timeout = 0;
+
+            session_id.assign_to(session_number);
+            MIRACASTLOG_TRACE("Session Number[%s]\n",session_number.c_str());
+
+            RTSPStringView timeout_str = session_line.substr(timeout_pos + strlen(RTSP_SESSION_TIMEOUT_FIELD));
+
+            timeout_str = timeout_str.substr(0, timeout_str.find(';')).trim();
+            if ((RTSPStringView::npos != timeout_pos) && (timeout_str.to_uint(session_timeout)))
+            {
+                timeoutValue = static_cast<int>(session_timeout);
+                MIRACASTLOG_INFO("timeoutValue[%d] in M6 ACK\n",timeoutValue);
             }
-            else{
-                MIRACASTLOG_ERROR("Failed to obtain Session and Timeout from [%s]\n",line.c_str());
+            else
+            {
+                timeoutValue = RTSP_DFLT_KEEP_ALIVE_WAIT_TIMEOUT_SEC;
+                MIRACASTLOG_ERROR("Failed to obtain timeout from [%.*s] and configured the default value[%d]\n",
+                                    static_cast<int>(session_line.length()),
+                                    session_line.data(),
+                                    timeoutValue);
             }
         }
+        else{
+            MIRACASTLOG_ERROR("Failed to obtain Session and Timeout from [%.*s]\n",
+                                static_cast<int>(session_line.length()),
+                                session_line.data());
+        }
+    }
+
+    if (rtsp_msg.has_header(RTSP_HEADER_TRANSPORT))
+    {
+        // client_port=<port>[-<port>]
+        size_t client_port_pos = transport_line.find(RTSP_CLIENT_PORT_FIELD);
+
+        if (RTSPStringView::npos != client_port_pos)
+        {
+            RTSPStringView port_range = transport_line.substr(client_port_pos + strlen(RTSP_CLIENT_PORT_FIELD));
+            size_t port_len = 0;
 
-        if (line.find("client_port=") != std::string::npos) {
-            std::regex clientPortRegex("client_port=([0-9]+(?:-[0-9]+)?)");
-            std::smatch match;
-            if (std::regex_search(line, match, clientPortRegex) && match.size() > 1) {
-                clientPortValue = match[1];
+            while ((port_len < port_range.length()) &&
+                   (isdigit(static_cast<unsigned char>(port_range[port_len])) ||
+                   ((0 < port_len) && ('-' == port_range[port_len]))))
+            {
+                ++port_len;
+            }
+            if ((0 < port_len) && ('-' == port_range[port_len - 1]))
+            {
+                --port_len;
+            }
+
+            if (0 < port_len)
+            {
+                port_range.substr(0, port_len).assign_to(clientPortValue);
                 MIRACASTLOG_TRACE("clientPortValue[%s]\n",clientPortValue.c_str());
             }
             else{
-                MIRACASTLOG_ERROR("Failed to obtain client port from [%s]\n",line.c_str());
+                MIRACASTLOG_ERROR("Failed to obtain client port from [%.*s]\n",
+                                    static_cast<int>(transport_line.length()),
+                                    transport_line.data());
             }
         }
     }
@@ -1578,6 +2428,11 @@ RTSP_STATUS MiracastRTSPMsg::validate_rtsp_m6_ack_m7_send_request(std::string rt
     if (!clientPortValue.empty())
     {
         status_code = send_rtsp_reply_sink2src(RTSP_MSG_FMT_M7_REQUEST);
+        if (RTSP_MSG_SUCCESS == status_code)
+        {
+            // Time to first frame counts from here
+            m_play_request_us = MiracastCommon::get_monotonic_time_us();
+        }
         set_wait_timeout(m_wfd_src_res_timeout);
     }
     else
@@ -1588,15 +2443,18 @@ RTSP_STATUS MiracastRTSPMsg::validate_rtsp_m6_ack_m7_send_request(std::string rt
     return (status_code);
 }
 
-RTSP_STATUS MiracastRTSPMsg::validate_rtsp_trigger_request_ack(std::string rtsp_trigger_req_ack_buffer , std::string received_seq_num )
+RTSP_STATUS MiracastRTSPMsg::validate_rtsp_trigger_request_ack(const MiracastRTSPParser &rtsp_msg)
 {
     RTSP_STATUS status_code = RTSP_MSG_FAILURE;
+    RTSPStringView received_seq_num = rtsp_msg.get_header(RTSP_HEADER_CSEQ);
     MIRACASTLOG_TRACE("Entering...");
 
     if ( false == IsValidSequenceNumber(received_seq_num))
     {
         send_rtsp_reply_sink2src( RTSP_MSG_FMT_REPORT_ERROR , received_seq_num, RTSP_ERRORCODE_BAD_REQUEST );
-        MIRACASTLOG_ERROR("Invalid Sequence Number in trigger[%s]",rtsp_trigger_req_ack_buffer.c_str());
+        MIRACASTLOG_ERROR("Invalid Sequence Number in trigger[%.*s]",
+                            static_cast<int>(rtsp_msg.get_start_line().length()),
+                            rtsp_msg.get_start_line().data());
     }
     else
     {
@@ -1604,6 +2462,9 @@ RTSP_STATUS MiracastRTSPMsg::validate_rtsp_trigger_request_ack(std::string rtsp_
         {
             // It denotes response for M7 has received.
             status_code = RTSP_M1_M7_MSG_EXCHANGE_RECEIVED;
+            m_latency_stats.end(RTSP_LATENCY_PHASE_M6_M7);
+            m_latency_stats.end(RTSP_LATENCY_PHASE_SESSION_SETUP);
+            m_latency_stats.begin(RTSP_LATENCY_PHASE_KEEP_ALIVE);
         }
         else
         {
@@ -1614,46 +2475,54 @@ RTSP_STATUS MiracastRTSPMsg::validate_rtsp_trigger_request_ack(std::string rtsp_
     return status_code;
 }
 
-RTSP_STATUS MiracastRTSPMsg::validate_rtsp_trigger_method_request(std::string rtsp_msg_buffer)
+RTSP_STATUS MiracastRTSPMsg::validate_rtsp_trigger_method_request(const MiracastRTSPParser &rtsp_msg)
 {
     RTSP_STATUS status_code = RTSP_MSG_FAILURE,
                 sub_status_code = RTSP_MSG_FAILURE;
-    const char  *setup_tag = get_parser_field_by_index(RTSP_SETUP_FIELD),
-                *teardown_tag = get_parser_field_by_index(RTSP_TEARDOWN_FIELD),
-                *play_tag = get_parser_field_by_index(RTSP_PLAY_FIELD),
-                *pause_tag = get_parser_field_by_index(RTSP_PAUSE_FIELD);
+    RTSP_METHOD trigger_method = MiracastRTSPParser::get_method_by_name(rtsp_msg.get_wfd_param(RTSP_WFD_PARAM_TRIGGER_METHOD));
 
     MIRACASTLOG_TRACE("Entering ...");
     
-    if (rtsp_msg_buffer.find(setup_tag) != std::string::npos)
+    if (RTSP_METHOD_SETUP == trigger_method)
     {
-        status_code = validate_rtsp_m5_msg_m6_send_request(rtsp_msg_buffer);
+        status_code = validate_rtsp_m5_msg_m6_send_request(rtsp_msg);
     }
     else
     {
-        std::string received_seq_num = parse_received_parser_field_value(rtsp_msg_buffer , RTSP_SEQUENCE_FIELD);
+        RTSPStringView received_seq_num = rtsp_msg.get_header(RTSP_HEADER_CSEQ);
         RTSP_ERRORCODES error_code = RTSP_ERRORCODE_OK;
+        eCONTROLLER_FW_STATES sink2src_request = RTSP_INVALID_ACTION;
         bool sink2src_resp_needed = true;
 
-        if (rtsp_msg_buffer.find(teardown_tag) != std::string::npos)
+        if (RTSP_METHOD_TEARDOWN == trigger_method)
         {
             sub_status_code = RTSP_MSG_TEARDOWN_REQUEST;
             MIRACASTLOG_INFO("TEARDOWN request from Source received");
         }
-        else if (rtsp_msg_buffer.find(play_tag) != std::string::npos)
+        else if (RTSP_METHOD_PLAY == trigger_method)
         {
             MIRACASTLOG_INFO("PLAY request from Source received");
+            sub_status_code = RTSP_MSG_SUCCESS;
             if ( MIRACAST_PLAYER_STATE_PLAYING == get_state())
             {
                 error_code = RTSP_ERRORCODE_METHOD_NOT_VALID;
             }
+            else
+            {
+                sink2src_request = RTSP_PLAY_FROM_SINK2SRC;
+            }
         }
-        else if (rtsp_msg_buffer.find(pause_tag) != std::string::npos)
+        else if (RTSP_METHOD_PAUSE == trigger_method)
         {
             MIRACASTLOG_INFO("PAUSE request from Source received");
+            sub_status_code = RTSP_MSG_SUCCESS;
             if ( MIRACAST_PLAYER_STATE_PAUSED == get_state()){
                 error_code = RTSP_ERRORCODE_METHOD_NOT_VALID;
             }
+            else
+            {
+                sink2src_request = RTSP_PAUSE_FROM_SINK2SRC;
+            }
         }
         else{
             sink2src_resp_needed = false;
@@ -1669,107 +2538,48 @@ RTSP_STATUS MiracastRTSPMsg::validate_rtsp_trigger_method_request(std::string rt
                 status_code = sub_status_code;
             }
         }
+
+        // The source only triggers PLAY/PAUSE, the sink has to follow up with the request itself
+        if (( RTSP_MSG_SUCCESS == status_code ) && ( RTSP_INVALID_ACTION != sink2src_request ))
+        {
+            status_code = rtsp_sink2src_request_msg_handling(sink2src_request);
+            if ( RTSP_MSG_SUCCESS == status_code )
+            {
+                set_state((RTSP_PLAY_FROM_SINK2SRC == sink2src_request) ? MIRACAST_PLAYER_STATE_PLAYING : MIRACAST_PLAYER_STATE_PAUSED );
+            }
+        }
     }
     MIRACASTLOG_TRACE("Exiting ...");
     return status_code;
 }
 
-RTSP_STATUS MiracastRTSPMsg::validate_rtsp_receive_buffer_handling(std::string rtsp_msg_buffer)
+RTSP_STATUS MiracastRTSPMsg::validate_rtsp_receive_buffer_handling(const MiracastRTSPParser &rtsp_msg)
 {
-    MIRACASTLOG_TRACE("Entering...");
-    const char  *options_tag = get_parser_field_by_index(RTSP_OPTIONS_REQ_FIELD),
-                *get_parameter_tag = get_parser_field_by_index(RTSP_GET_PARAMETER_FIELD),
-                *set_parameter_tag = get_parser_field_by_index(RTSP_SET_PARAMETER_FIELD),
-                *content_txt_tag = get_parser_field_by_index(RTSP_CONTENT_TEXT_FIELD);
     RTSP_STATUS status_code = RTSP_MSG_FAILURE;
 
-    std::stringstream ss(rtsp_msg_buffer);
-    std::string first_line = "";
-
     MIRACASTLOG_TRACE("Entering...");
-    if (std::getline(ss, first_line))
-    {
-        if ((first_line.find(get_parameter_tag) != std::string::npos) ||
-            (!m_getparameter_request.empty()))
-        {
-            std::string common_get_parameter_buffer = "";
-            int returnvalue = 0;
-
-            if (( rtsp_msg_buffer.find(content_txt_tag) == std::string::npos ) &&
-                ( m_getparameter_request.empty() ))
-            {
-                common_get_parameter_buffer = rtsp_msg_buffer;
-            }
-            else
-            {
-                m_getparameter_request += rtsp_msg_buffer;
-                returnvalue = validateGetParameterContentLength(m_getparameter_request);
-
-                if ( 0 == returnvalue )
-                {
-                    common_get_parameter_buffer = m_getparameter_request;
-                }
-            }
 
-            if ( 0 <= returnvalue )
-            {
-                if ( 0 == returnvalue )
-                {
-                    MIRACASTLOG_INFO("#### COMPLETE GET_PARAM_REQ [%s] TO BE HANDLE ####",common_get_parameter_buffer.c_str());
-                    if ( false == m_getparameter_response_sent )
-                    {
-                        status_code = validate_rtsp_getparameter_request(common_get_parameter_buffer);
-                    }
-                    else
-                    {
-                        MIRACASTLOG_INFO("#### SKIPPING [%s]. ALREADY RTSP MSG RESPONDED  ####",rtsp_msg_buffer.c_str());
-                        status_code = RTSP_MSG_SUCCESS;
-                    }
-                }
-                else
-                {
-                    MIRACASTLOG_ERROR("#### ActualContentLength is greater than expected[%s] ####",m_getparameter_request.c_str());
-                    //std::string received_seq_num = parse_received_parser_field_value( m_getparameter_request , RTSP_SEQUENCE_FIELD);
-                    //send_rtsp_reply_sink2src( RTSP_MSG_FMT_REPORT_ERROR , received_seq_num, RTSP_ERRORCODE_NOT_IMPLEMENTED );
-                    //status_code = RTSP_METHOD_NOT_SUPPORTED;
-                }
-                m_getparameter_request.clear();
-                m_getparameter_response_sent = false;
-            }
-            else
-            {
-                MIRACASTLOG_INFO("#### CURRENT GET_PARAM_REQ [%s], WAITING FOR COMPLETE DATA ####",
-                                    m_getparameter_request.c_str());
-                if ( false == m_getparameter_response_sent )
-                {
-                    status_code = validate_rtsp_getparameter_request(m_getparameter_request);
-                    m_getparameter_response_sent = true;
-                }
-                else
-                {
-                    MIRACASTLOG_INFO("#### SKIPPING [%s]. ALREADY RTSP MSG RESPONDED  ####",rtsp_msg_buffer.c_str());
-                    status_code = RTSP_MSG_SUCCESS;
-                }
-            }
-        }
-        else if (first_line.find(options_tag) != std::string::npos)
-        {
-            status_code = validate_rtsp_options_request(rtsp_msg_buffer);
-        }
-        else if (first_line.find(set_parameter_tag) != std::string::npos)
-        {
-            status_code = validate_rtsp_setparameter_request(rtsp_msg_buffer);
-        }
-        else
-        {
-            status_code = validate_rtsp_generic_request_response(rtsp_msg_buffer);
-        }
+    if (RTSP_METHOD_GET_PARAMETER == rtsp_msg.get_method())
+    {
+        status_code = validate_rtsp_getparameter_request(rtsp_msg);
+    }
+    else if (RTSP_METHOD_OPTIONS == rtsp_msg.get_method())
+    {
+        status_code = validate_rtsp_options_request(rtsp_msg);
+    }
+    else if (RTSP_METHOD_SET_PARAMETER == rtsp_msg.get_method())
+    {
+        status_code = validate_rtsp_setparameter_request(rtsp_msg);
+    }
+    else
+    {
+        status_code = validate_rtsp_generic_request_response(rtsp_msg);
     }
     MIRACASTLOG_TRACE("Exiting [%#04X]...",status_code);
     return status_code;
 }
 
-RTSP_STATUS MiracastRTSPMsg::send_rtsp_reply_sink2src( RTSP_MSG_FMT_SINK2SRC req_fmt , std::string received_seq_num , RTSP_ERRORCODES error_code )
+RTSP_STATUS MiracastRTSPMsg::send_rtsp_reply_sink2src( RTSP_MSG_FMT_SINK2SRC req_fmt , const RTSPStringView &received_seq_num , RTSP_ERRORCODES error_code )
 {
     RTSP_STATUS status_code = RTSP_MSG_FAILURE;
     
@@ -1786,11 +2596,13 @@ RTSP_STATUS MiracastRTSPMsg::send_rtsp_reply_sink2src( RTSP_MSG_FMT_SINK2SRC req
         case RTSP_MSG_FMT_REPORT_ERROR:
         case RTSP_MSG_FMT_TRIGGER_METHODS_RESPONSE:
         {
-            std::string rtsp_request_buffer = "";
-            rtsp_request_buffer = generate_request_response_msg(req_fmt, received_seq_num , empty_string , error_code );
+            RTSP_MSG_SEGMENTS_STRUCT rtsp_request_buffer;
 
-            MIRACASTLOG_INFO("Sending the RTSP Msg for [%#04X] format\n",req_fmt);
-            status_code = send_rstp_msg(m_tcpSockfd, rtsp_request_buffer);
+            if (generate_request_response_msg(req_fmt, received_seq_num , RTSPStringView() , rtsp_request_buffer , error_code ))
+            {
+                MIRACASTLOG_INFO("Sending the RTSP Msg for [%#04X] format\n",req_fmt);
+                status_code = send_rstp_msg(m_tcpSockfd, rtsp_request_buffer);
+            }
             if (RTSP_MSG_SUCCESS == status_code)
             {
                 MIRACASTLOG_VERBOSE("RTSP Msg has sent");
@@ -1812,9 +2624,9 @@ RTSP_STATUS MiracastRTSPMsg::send_rtsp_reply_sink2src( RTSP_MSG_FMT_SINK2SRC req
     return status_code;
 }
 
-RTSP_STATUS MiracastRTSPMsg::validate_rtsp_post_m1_m7_xchange(std::string rtsp_post_m1_m7_xchange_buffer)
+RTSP_STATUS MiracastRTSPMsg::validate_rtsp_post_m1_m7_xchange(const MiracastRTSPParser &rtsp_msg)
 {
-    return validate_rtsp_receive_buffer_handling(rtsp_post_m1_m7_xchange_buffer);
+    return validate_rtsp_receive_buffer_handling(rtsp_msg);
 }
 
 RTSP_STATUS MiracastRTSPMsg::rtsp_sink2src_request_msg_handling(eCONTROLLER_FW_STATES action_id)
@@ -1870,37 +2682,6 @@ RTSP_STATUS MiracastRTSPMsg::rtsp_sink2src_request_msg_handling(eCONTROLLER_FW_S
     return status_code;
 }
 
-int MiracastRTSPMsg::validateGetParameterContentLength(std::string& input)
-{
-    size_t  contentLengthPos = input.find("Content-Length: "),
-            doubleNewlinePos = input.find("\r\n\r\n"),
-            actualContentLength = 0;
-    int     returnvalue = -1;
-
-    // Calculate the actual content length
-    if (doubleNewlinePos != std::string::npos)
-    {
-        // Calculate the length of the content after the double newline
-        actualContentLength = input.length() - (doubleNewlinePos + 4); // Adding 4 to include both newline characters
-    }
-
-    if (contentLengthPos != std::string::npos)
-    {
-        // Extract the content length value
-        size_t  valueStart = contentLengthPos + strlen("Content-Length: "),
-                valueEnd = input.find("\r\n", valueStart);
-
-        if (valueEnd != std::string::npos)
-        {
-            std::string lengthStr = input.substr(valueStart, valueEnd - valueStart);
-            size_t expectedLength = std::stoul(lengthStr);
-            returnvalue = actualContentLength - expectedLength;
-        }
-    }
-    // Content-Length not found or invalid format
-    return returnvalue;
-}
-
 MiracastError MiracastRTSPMsg::start_streaming( VIDEO_RECT_STRUCT video_rect )
 {
     MIRACASTLOG_TRACE("Entering...");
@@ -1909,6 +2690,7 @@ MiracastError MiracastRTSPMsg::start_streaming( VIDEO_RECT_STRUCT video_rect )
     std::ifstream mcgstfile(mcastfile);
     std::string opt_flag_buffer = MiracastCommon::parse_opt_flag("/opt/miracast_skip_firstframe_callback");
 
+    m_play_request_us = 0;
     if (!opt_flag_buffer.empty())
     {
         MIRACASTLOG_INFO("#### updating state as PLAYING ####");
@@ -1945,7 +2727,14 @@ MiracastError MiracastRTSPMsg::start_streaming( VIDEO_RECT_STRUCT video_rect )
         else
         {
             MiracastGstPlayer *MiracastGstPlayerObj = MiracastGstPlayer::getInstance();
+            MIRACAST_GSTPLAYER_SINK_CONFIG_STRUCT sink_config;
+
+            get_VideoSinkConfig( sink_config );
             MiracastGstPlayerObj->setVideoRectangle( video_rect );
+            MiracastGstPlayerObj->setLatencyProfile( m_latency_profile );
+            MiracastGstPlayerObj->setVideoSinkConfig( sink_config );
+            MiracastGstPlayerObj->setPipelineMode( m_pipeline_mode );
+            MiracastGstPlayerObj->setElementTracer( get_ElementTracer() );
             MiracastGstPlayerObj->launch(m_sink_ip, m_wfd_streaming_port ,this);
         }
     }
@@ -1954,6 +2743,21 @@ MiracastError MiracastRTSPMsg::start_streaming( VIDEO_RECT_STRUCT video_rect )
     return MIRACAST_OK;
 }
 
+/*
+ * Hand the negotiated format to the player, which prepares its decode chain
+ * with it while the M5-M7 exchange is still going on. A mid-session M4 gets
+ * here as well, the running player then switches to the new format in place.
+ */
+void MiracastRTSPMsg::prewarm_player(void)
+{
+    MIRACASTLOG_TRACE("Entering...");
+    if (m_streaming_started)
+    {
+        MiracastGstPlayer::getInstance()->setNegotiatedFormat(m_wfd_negotiated_video_st, m_wfd_negotiated_audio_st);
+    }
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
 MiracastError MiracastRTSPMsg::stop_streaming( eMIRA_PLAYER_STATES state )
 {
     MIRACASTLOG_TRACE("Entering...");
@@ -1994,12 +2798,11 @@ MiracastError MiracastRTSPMsg::updateVideoRectangle( VIDEO_RECT_STRUCT videorect
 
 void MiracastRTSPMsg::RTSPMessageHandler_Thread(void *args)
 {
-    char rtsp_message_socket[4096] = {0};
+    const MiracastRTSPParser &rtsp_msg = m_rtsp_stream.get_parser();
     RTSP_HLDR_MSGQ_STRUCT rtsp_message_data = {};
     VIDEO_RECT_STRUCT     video_rect_st = {0};
     RTSP_STATUS status_code = RTSP_TIMEDOUT;
     eM_PLAYER_REASON_CODE reason = MIRACAST_PLAYER_REASON_CODE_RTSP_ERROR;
-    std::string rtsp_msg_buffer;
     std::string client_mac = "",
                 client_name = "",
                 go_ip_addr = "";
@@ -2049,7 +2852,7 @@ void MiracastRTSPMsg::RTSPMessageHandler_Thread(void *args)
 
             set_state( MIRACAST_PLAYER_STATE_INITIATED , true );
 
-            if (MIRACAST_OK != initiate_TCP(rtsp_message_data.source_dev_ip))
+            if (MIRACAST_OK != initiate_TCP(rtsp_message_data.source_dev_ip, rtsp_message_data.source_rtsp_port))
             {
                 set_state( MIRACAST_PLAYER_STATE_STOPPED , true , MIRACAST_PLAYER_REASON_CODE_RTSP_ERROR );
                 continue;
@@ -2065,47 +2868,64 @@ void MiracastRTSPMsg::RTSPMessageHandler_Thread(void *args)
 
         set_wait_timeout(m_wfd_src_req_timeout);
 
-        memset(&rtsp_message_socket, 0x00, sizeof(rtsp_message_socket));
-
-        m_getparameter_response_sent = false;
+        m_rtsp_stream.reset();
 
         start_streaming(video_rect_st);
-
-        while (( status_code = receive_buffer_timedOut( m_tcpSockfd, rtsp_message_socket, sizeof(rtsp_message_socket),get_wait_timeout())) &&
-                ( status_code == RTSP_MSG_SUCCESS ))
+        if (m_cached_params_applied)
         {
-            rtsp_msg_buffer.clear();
-            rtsp_msg_buffer = rtsp_message_socket;
+            // What this source selected last time is the best guess until its M4 arrives
+            prewarm_player();
+        }
 
-            MIRACASTLOG_INFO("#### [M1-M7] RTSP SockMsg Received [%s] ####", rtsp_msg_buffer.c_str());
-            status_code = validate_rtsp_receive_buffer_handling(rtsp_msg_buffer);
-            MIRACASTLOG_INFO("#### [M1-M7] RTSP Response[%#04X] ####", status_code);
+        while (true)
+        {
+            status_code = receive_rtsp_message(get_wait_timeout());
 
-            if ((RTSP_MSG_SUCCESS != status_code) || 
-                (RTSP_M1_M7_MSG_EXCHANGE_RECEIVED == status_code))
+            if (RTSP_CONTROL_MSG_PENDING == status_code)
             {
-                break;
-            }
-            memset(&rtsp_message_socket, 0x00, sizeof(rtsp_message_socket));
+                status_code = RTSP_MSG_SUCCESS;
+                clear_control_event();
 
-            if (true == m_rtsp_msg_handler_thread->receive_message(&rtsp_message_data, sizeof(rtsp_message_data), THREAD_RECV_MSG_WAIT_IMMEDIATE))
-            {
-                if (( RTSP_SELF_ABORT == rtsp_message_data.state ) ||
-                    ( RTSP_TEARDOWN_FROM_SINK2SRC == rtsp_message_data.state ))
+                while (( RTSP_MSG_SUCCESS == status_code ) &&
+                        ( true == m_rtsp_msg_handler_thread->receive_message(&rtsp_message_data, sizeof(rtsp_message_data), THREAD_RECV_MSG_WAIT_IMMEDIATE)))
                 {
-                    MIRACASTLOG_WARNING("TEARDOWN Initiated during M1-M7 exchange[%#04X]\n", rtsp_message_data.state);
-                    status_code = RTSP_MSG_TEARDOWN_REQUEST;
-                    if ( RTSP_SELF_ABORT == rtsp_message_data.state )
+                    if (( RTSP_SELF_ABORT == rtsp_message_data.state ) ||
+                        ( RTSP_TEARDOWN_FROM_SINK2SRC == rtsp_message_data.state ))
                     {
-                        rtsp_msg_hldr_running_state = false;
+                        MIRACASTLOG_WARNING("TEARDOWN Initiated during M1-M7 exchange[%#04X]\n", rtsp_message_data.state);
+                        status_code = RTSP_MSG_TEARDOWN_REQUEST;
+                        if ( RTSP_SELF_ABORT == rtsp_message_data.state )
+                        {
+                            rtsp_msg_hldr_running_state = false;
+                        }
+                        rtsp_sink2src_request_msg_handling(RTSP_TEARDOWN_FROM_SINK2SRC);
+                    }
+                    else
+                    {
+                        MIRACASTLOG_WARNING("Yet to Handle RTSP Msg Action[%#04X]\n", rtsp_message_data.state);
                     }
-                    rtsp_sink2src_request_msg_handling(RTSP_TEARDOWN_FROM_SINK2SRC);
-                    break;
                 }
-                else
+                if ( RTSP_MSG_SUCCESS != status_code )
                 {
-                    MIRACASTLOG_WARNING("Yet to Handle RTSP Msg Action[%#04X]\n", rtsp_message_data.state);
+                    break;
                 }
+                continue;
+            }
+            else if ( RTSP_MSG_SUCCESS != status_code )
+            {
+                break;
+            }
+
+            MIRACASTLOG_INFO("#### [M1-M7] RTSP SockMsg Received [%.*s] ####",
+                                static_cast<int>(rtsp_msg.get_message_length()),
+                                rtsp_msg.get_message().data());
+            status_code = validate_rtsp_receive_buffer_handling(rtsp_msg);
+            MIRACASTLOG_INFO("#### [M1-M7] RTSP Response[%#04X] ####", status_code);
+
+            if ((RTSP_MSG_SUCCESS != status_code) || 
+                (RTSP_M1_M7_MSG_EXCHANGE_RECEIVED == status_code))
+            {
+                break;
             }
         }
 
@@ -2157,43 +2977,35 @@ void MiracastRTSPMsg::RTSPMessageHandler_Thread(void *args)
         }
 
         RTSP_STATUS socket_state;
-        struct timespec start_time, current_time;
-        int elapsed_seconds = 0;
 
         reason = MIRACAST_PLAYER_REASON_CODE_SRC_DEV_REQ_TO_STOP;
 
-        clock_gettime(CLOCK_REALTIME, &start_time);
+        if (true == start_monitor_keep_alive_msg)
+        {
+            arm_keep_alive_timer(m_wfd_src_session_timeout);
+        }
 
         while (true == start_monitor_keep_alive_msg)
         {
-            clock_gettime(CLOCK_REALTIME, &current_time);
-
-            elapsed_seconds = current_time.tv_sec - start_time.tv_sec;
-            if (elapsed_seconds > m_wfd_src_session_timeout)
+            socket_state = receive_rtsp_message(RTSP_EVENT_WAIT_INDEFINITE);
+            if (RTSP_KEEP_ALIVE_TIMEDOUT == socket_state)
             {
-                MIRACASTLOG_INFO("#### MCAST-TRIAGE-NOK RTSP M16 TIMEOUT[%d] ELAPSED[%d] ####",m_wfd_src_session_timeout,elapsed_seconds);
+                MIRACASTLOG_INFO("#### MCAST-TRIAGE-NOK RTSP M16 TIMEOUT[%d] ####",m_wfd_src_session_timeout);
                 set_state(MIRACAST_PLAYER_STATE_STOPPED , true , reason );
                 break;
             }
-
-            memset(&rtsp_message_socket, 0x00, sizeof(rtsp_message_socket));
-            socket_state = receive_buffer_timedOut( m_tcpSockfd,
-                                                    rtsp_message_socket,
-                                                    sizeof(rtsp_message_socket),
-                                                    RTSP_KEEP_ALIVE_POLL_WAIT_TIMEOUT );
-            if (RTSP_MSG_SUCCESS == socket_state)
+            else if (RTSP_MSG_SUCCESS == socket_state)
             {
-                rtsp_msg_buffer.clear();
-                rtsp_msg_buffer = rtsp_message_socket;
-
-                MIRACASTLOG_INFO("#### [POST_M1-M7] RTSP SockMsg Received [%s] ####", rtsp_msg_buffer.c_str());
-                status_code = validate_rtsp_post_m1_m7_xchange(rtsp_msg_buffer);
+                MIRACASTLOG_INFO("#### [POST_M1-M7] RTSP SockMsg Received [%.*s] ####",
+                                    static_cast<int>(rtsp_msg.get_message_length()),
+                                    rtsp_msg.get_message().data());
+                status_code = validate_rtsp_post_m1_m7_xchange(rtsp_msg);
                 MIRACASTLOG_INFO("#### [POST_M1-M7] RTSP Response[%#04X] ####",status_code);
 
                 if ( RTSP_KEEP_ALIVE_MSG_RECEIVED == status_code )
                 {
                     // Refresh the Keep Alive Time
-                    clock_gettime(CLOCK_REALTIME, &start_time);
+                    arm_keep_alive_timer(m_wfd_src_session_timeout);
                     MIRACASTLOG_INFO("#### [POST_M1-M7] REFRESHING KEEP ALIVE TIME ####");
                 }
                 else if (((RTSP_MSG_TEARDOWN_REQUEST == status_code)||
@@ -2224,8 +3036,14 @@ void MiracastRTSPMsg::RTSPMessageHandler_Thread(void *args)
                 break;
             }
 
-            MIRACASTLOG_TRACE("Waiting for Event .....");
-            if (true == m_rtsp_msg_handler_thread->receive_message(&rtsp_message_data, sizeof(rtsp_message_data), 1))
+            if (RTSP_CONTROL_MSG_PENDING != socket_state)
+            {
+                continue;
+            }
+
+            clear_control_event();
+            while ((true == start_monitor_keep_alive_msg) &&
+                    (true == m_rtsp_msg_handler_thread->receive_message(&rtsp_message_data, sizeof(rtsp_message_data), THREAD_RECV_MSG_WAIT_IMMEDIATE)))
             {
                 MIRACASTLOG_INFO("Received Action[%#04X]\n", rtsp_message_data.state);
                 switch (rtsp_message_data.state)
@@ -2311,6 +3129,24 @@ void MiracastRTSPMsg::RTSPMessageHandler_Thread(void *args)
                         updateVideoRectangle(videorect);
                     }
                     break;
+                    case RTSP_UPDATE_LATENCY_PROFILE:
+                    {
+                        MIRACASTLOG_INFO("!!! RTSP_UPDATE_LATENCY_PROFILE[%d] !!!",rtsp_message_data.latency_profile);
+                        if (m_streaming_started)
+                        {
+                            MiracastGstPlayer::getInstance()->setLatencyProfile(rtsp_message_data.latency_profile);
+                        }
+                    }
+                    break;
+                    case RTSP_UPDATE_ELEMENT_TRACER:
+                    {
+                        MIRACASTLOG_INFO("!!! RTSP_UPDATE_ELEMENT_TRACER[%d] !!!",rtsp_message_data.element_tracer);
+                        if (m_streaming_started)
+                        {
+                            MiracastGstPlayer::getInstance()->setElementTracer(rtsp_message_data.element_tracer);
+                        }
+                    }
+                    break;
                     case RTSP_NOTIFY_GSTPLAYER_STATE:
                     {
                         eMIRA_PLAYER_STATES state = MIRACAST_PLAYER_STATE_IDLE;
@@ -2369,6 +3205,7 @@ void MiracastRTSPMsg::send_msgto_rtsp_msg_hdler_thread(RTSP_HLDR_MSGQ_STRUCT rts
     if (nullptr != m_rtsp_msg_handler_thread)
     {
         m_rtsp_msg_handler_thread->send_message(&rtsp_hldr_msgq_data, RTSP_HANDLER_MSGQ_SIZE);
+        signal_control_event();
     }
     MIRACASTLOG_TRACE("Exiting...");
 }
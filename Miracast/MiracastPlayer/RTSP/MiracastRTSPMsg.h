@@ -21,17 +21,44 @@
 #define _MIRACAST_RTSP_MSG_H_
 
 #include <MiracastCommon.h>
+#include <MiracastRTSPParser.h>
+#include <MiracastRTSPStats.h>
+#include <MiracastRTSPParamCache.h>
+#include <MiracastUIBC.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
 #include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <poll.h>
+#include <netinet/tcp.h>
+#include <mutex>
+#include <atomic>
 
-#define MAX_EPOLL_EVENTS 64
 #define RTSP_REQUEST_RECV_TIMEOUT   ( 6 * ONE_SECOND_IN_MILLISEC )
 #define RTSP_RESPONSE_RECV_TIMEOUT  ( 5 * ONE_SECOND_IN_MILLISEC )
 #define SOCKET_DFLT_WAIT_TIMEOUT    ( 10 * ONE_SECOND_IN_MILLISEC )
 #define RTSP_DFLT_KEEP_ALIVE_WAIT_TIMEOUT_SEC   ( 60 )
-#define RTSP_KEEP_ALIVE_POLL_WAIT_TIMEOUT   ( ONE_SECOND_IN_MILLISEC )
+#define RTSP_DFLT_SOURCE_PORT   ( 7236 )
+#define RTSP_CONNECT_INITIAL_BACKOFF_MSEC   ( 20 )
+#define RTSP_CONNECT_MAX_BACKOFF_MSEC   ( 640 )
+#define RTSP_TCP_KEEPALIVE_IDLE_SEC   ( 10 )
+#define RTSP_TCP_KEEPALIVE_INTERVAL_SEC   ( 5 )
+#define RTSP_TCP_KEEPALIVE_PROBE_COUNT   ( 3 )
+#define RTSP_EVENT_WAIT_INDEFINITE   ( static_cast<unsigned int>(-1) )
+#define RTSP_SESSION_EPOLL_EVENTS   ( 3 )
+/* Session descriptors plus the UIBC socket */
+#define RTSP_SESSION_EPOLL_MAX_EVENTS   ( RTSP_SESSION_EPOLL_EVENTS + 1 )
+#define RTSP_UNTERMINATED_MSG_WAIT_TIMEOUT   ( 100 )
+#define RTSP_SEND_WAIT_TIMEOUT   ( ONE_SECOND_IN_MILLISEC )
+
+#define RTSP_MSG_MAX_SEGMENTS   ( 16 )
+#define RTSP_WFD_PARAM_BIT(param_id)   ( 1U << (param_id) )
+/* native, preferred, profile, level, cea, vesa, hh, latency, min_slice, slice_enc, frame_ctl */
+#define RTSP_WFD_VIDEO_FMT_HEX_FIELDS   ( 11 )
 #define RTSP_KEEP_ALIVE_WAIT_TIMEOUT_OFFSET_SEC   ( 20 )
 #define RTSP_REQ_RESP_RECV_TIMEOUT_OFFSET_MSEC   ( 10 * ONE_SECOND_IN_MILLISEC )
 
@@ -44,7 +71,11 @@ typedef enum rtsp_status_e
     RTSP_M1_M7_MSG_EXCHANGE_RECEIVED,
     RTSP_KEEP_ALIVE_MSG_RECEIVED,
     RTSP_TIMEDOUT,
-    RTSP_METHOD_NOT_SUPPORTED
+    RTSP_METHOD_NOT_SUPPORTED,
+    /* Message posted to the RTSP handler thread while waiting on the socket */
+    RTSP_CONTROL_MSG_PENDING,
+    /* No M16 keep-alive within the session timeout */
+    RTSP_KEEP_ALIVE_TIMEDOUT
 } RTSP_STATUS;
 
 /* Default values*/
@@ -52,6 +83,7 @@ typedef enum rtsp_status_e
 #define RTSP_DFLT_VIDEO_FORMATS "00 00 03 10 0001ffff 1fffffff 00001fff 00 0000 0000 10 none none"
 #define RTSP_DFLT_AUDIO_FORMATS "AAC 00000007 00"
 #define RTSP_DFLT_TRANSPORT_PROFILE "RTP/AVP/UDP"
+#define RTSP_DFLT_UIBC_CAPABILITY "input_category_list=GENERIC, HIDC;generic_cap_list=Keyboard, Mouse, SingleTouch, MultiTouch;hidc_cap_list=Keyboard/USB, Mouse/USB, RemoteControl/Infrared;port=none"
 #define RTSP_DFLT_STREAMING_PORT "1990"
 #define RTSP_STD_UNICAST_FIELD "unicast"
 #define RTSP_DFLT_CLIENT_RTP_PORTS RTSP_DFLT_TRANSPORT_PROFILE RTSP_SEMI_COLON_STR RTSP_STD_UNICAST_FIELD RTSP_SPACE_STR RTSP_DFLT_STREAMING_PORT RTSP_SPACE_STR "0 mode=play"
@@ -60,9 +92,23 @@ typedef enum rtsp_status_e
 #define RTSP_DOUBLE_QUOTE_STR "\""
 #define RTSP_SPACE_STR SPACE_CHAR
 #define RTSP_SEMI_COLON_STR ";"
+#define RTSP_CONTENT_TYPE_TEXT_PARAMETERS "text/parameters"
+#define RTSP_SESSION_TIMEOUT_FIELD "timeout="
+#define RTSP_CLIENT_PORT_FIELD "client_port="
+#define RTSP_PRESENTATION_URL_SCHEME "rtsp://"
+#define RTSP_STATUS_CODE_OK (200)
 
 class MiracastRTSPMsg;
 
+typedef enum rtsp_connect_state_e
+{
+    RTSP_CONNECT_STATE_START = 0x00,
+    RTSP_CONNECT_STATE_IN_PROGRESS,
+    RTSP_CONNECT_STATE_BACKOFF,
+    RTSP_CONNECT_STATE_CONNECTED,
+    RTSP_CONNECT_STATE_FAILED
+} RTSP_CONNECT_STATE;
+
 typedef enum rtsp_parser_fields_e
 {
     RTSP_PARSER_FIELD_START  = 0x00,
@@ -183,6 +229,21 @@ typedef struct rtsp_msg_fmt_template_st
     const char *template_name;
 } RTSP_MSG_FMT_TEMPLATE;
 
+/*
+ * RTSP message as a list of segments for sendmsg(). Literal segments point
+ * into the static templates and each %s of the template is an argument slot
+ * which is patched per message, so nothing is copied to build a message.
+ */
+typedef struct rtsp_msg_segments_st
+{
+    struct iovec segments[RTSP_MSG_MAX_SEGMENTS];
+    size_t segment_count;
+    size_t arg_slots[RTSP_MSG_MAX_SEGMENTS];
+    size_t arg_count;
+    /* Backing store for numeric arguments such as Content-Length */
+    char number_buffer[24];
+} RTSP_MSG_SEGMENTS_STRUCT;
+
 typedef struct rtsp_errorcode_template
 {
     RTSP_ERRORCODES rtsp_errorcode_e;
@@ -348,7 +409,7 @@ typedef enum rtsp_ac3_modes_e
 }
 RTSP_AC3_MODES;
 
-#pragma pack(1)
+#pragma pack(push, 1)
 typedef struct rtsp_H264_codecs_st
 {
     uint8_t profile;
@@ -369,7 +430,6 @@ typedef struct rtsp_H264_codecs_st
 }
 RTSP_H264_CODEC_STRUCT;
 
-#pragma pack(1)
 typedef struct rtsp_wfd_video_format_st
 {
     uint8_t native;
@@ -378,7 +438,6 @@ typedef struct rtsp_wfd_video_format_st
 }
 RTSP_WFD_VIDEO_FMT_STRUCT;
 
-#pragma pack(1)
 typedef struct rtsp_wfd_audio_format_st
 {
     RTSP_AUDIO_FORMATS audio_format;
@@ -386,6 +445,7 @@ typedef struct rtsp_wfd_audio_format_st
     uint8_t latency;
 }
 RTSP_WFD_AUDIO_FMT_STRUCT;
+#pragma pack(pop)
 
 class MiracastRTSPMsg
 {
@@ -414,9 +474,36 @@ public:
     bool set_WFDRequestResponseTimeout( unsigned int request_timeout , unsigned int response_timeout );
 
     eMIRA_PLAYER_STATES get_state(void);
+    void get_RTSPLatencyStats(std::vector<RTSP_SOURCE_LATENCY_STRUCT> &snapshot, bool reset);
+    void get_RTSPParamCacheCounters(RTSP_PARAM_CACHE_COUNTERS_STRUCT &counters);
+    bool send_UIBCEvents(const UIBC_EVENT_STRUCT *events, size_t count, uint64_t receive_time_us);
+    /* Kept across sessions, pushed to the running player while streaming */
+    bool set_LatencyProfile(eMIRA_GSTPLAYER_LATENCY_PROFILE latency_profile);
+    eMIRA_GSTPLAYER_LATENCY_PROFILE get_LatencyProfile(void);
+    /* Kept across sessions, the player picks it up on the next launch */
+    bool set_VideoSinkConfig(const MIRACAST_GSTPLAYER_SINK_CONFIG_STRUCT &sink_config);
+    void get_VideoSinkConfig(MIRACAST_GSTPLAYER_SINK_CONFIG_STRUCT &sink_config);
+    /* Kept across sessions, the player picks it up on the next launch */
+    bool set_PipelineMode(eMIRA_GSTPLAYER_PIPELINE_MODE pipeline_mode);
+    eMIRA_GSTPLAYER_PIPELINE_MODE get_PipelineMode(void);
+    /* Published by the player once per collector interval, kept after the session ends */
+    void update_PlayerStatistics(const MIRACAST_PLAYER_STATISTICS_STRUCT &statistics);
+    void get_PlayerStatistics(MIRACAST_PLAYER_STATISTICS_STRUCT &statistics);
+    /* Seconds between onPlayerStatistics notifications, 0 disables them */
+    void set_PlayerStatisticsInterval(unsigned int interval_sec);
+    unsigned int get_PlayerStatisticsInterval(void);
+    /* Kept across sessions, switched on and off in the running player as well */
+    void set_ElementTracer(bool enable);
+    bool get_ElementTracer(void);
+    /* Published by the player with the statistics while tracing, kept after the session ends */
+    void update_ElementTrace(const MIRACAST_PLAYER_ELEMENT_TRACE_STRUCT &element_trace);
+    void get_ElementTrace(MIRACAST_PLAYER_ELEMENT_TRACE_STRUCT &element_trace);
+    /* Monotonic time the M7 PLAY went out, 0 until then */
+    uint64_t get_PlayRequestTime(void);
+    void record_TimeToFirstFrame(uint64_t elapsed_us);
 
     void send_msgto_rtsp_msg_hdler_thread(RTSP_HLDR_MSGQ_STRUCT rtsp_hldr_msgq_data);
-    MiracastError initiate_TCP(std::string goIP);
+    MiracastError initiate_TCP(std::string goIP, unsigned short port = RTSP_DFLT_SOURCE_PORT);
     MiracastError start_streaming( VIDEO_RECT_STRUCT video_rect );
     MiracastError stop_streaming( eMIRA_PLAYER_STATES state );
     void RTSPMessageHandler_Thread(void *args);
@@ -429,39 +516,48 @@ public:
     MiracastThread  *m_test_notifier_thread;
 #endif /* ENABLE_MIRACAST_PLAYER_TEST_NOTIFIER */
 
-    static std::string format_string(const char *fmt, const std::vector<const char *> &args)
-    {
-        std::string result = fmt;
-        size_t arg_index = 0;
-        size_t arg_count = args.size();
-        while (arg_index < arg_count)
-        {
-            size_t found = result.find("%s");
-            if (found != std::string::npos)
-            {
-                result.replace(found, 2, args[arg_index]);
-            }
-            ++arg_index;
-        }
-        return result;
-    };
+protected:
+    /* Session event handling, reachable by a subclass running without the handler thread */
+    MiracastRTSPMsg();
+    virtual ~MiracastRTSPMsg();
+    bool create_SessionEventDescriptors(void);
+    void signal_control_event(void);
+    void arm_keep_alive_timer(int timeout_sec);
+    void clear_control_event(void);
+    RTSP_STATUS wait_session_event(unsigned int wait_time_ms);
 
 private:
     static MiracastRTSPMsg *m_rtsp_msg_obj;
-    MiracastRTSPMsg();
-    virtual ~MiracastRTSPMsg();
     MiracastRTSPMsg &operator=(const MiracastRTSPMsg &) = delete;
     MiracastRTSPMsg(const MiracastRTSPMsg &) = delete;
 
     int m_tcpSockfd;
     int m_epollfd;
+    int m_control_eventfd;
+    int m_keep_alive_timerfd;
     unsigned int m_wfd_src_req_timeout;
     unsigned int m_wfd_src_res_timeout;
     unsigned int m_current_wait_time_ms;
+    uint64_t m_connect_latency_us;
     int m_wfd_src_session_timeout;
     eMIRA_PLAYER_STATES m_current_state;
 
     bool m_streaming_started;
+    /* Set from the JSON-RPC thread, taken by start_streaming() on the RTSP thread */
+    std::atomic<eMIRA_GSTPLAYER_LATENCY_PROFILE> m_latency_profile;
+    /* Under m_player_statistics_mutex, set from the JSON-RPC thread */
+    MIRACAST_GSTPLAYER_SINK_CONFIG_STRUCT m_video_sink_config;
+    /* Set from the JSON-RPC thread like the latency profile */
+    std::atomic<eMIRA_GSTPLAYER_PIPELINE_MODE> m_pipeline_mode;
+    std::atomic<uint64_t> m_play_request_us;
+
+    std::mutex m_player_statistics_mutex;
+    MIRACAST_PLAYER_STATISTICS_STRUCT m_player_statistics;
+    unsigned int m_player_statistics_interval_sec;
+    unsigned int m_player_statistics_samples;
+    /* Under m_player_statistics_mutex as well */
+    bool m_element_tracer;
+    MIRACAST_PLAYER_ELEMENT_TRACE_STRUCT m_element_trace;
 
     std::string m_connected_mac_addr;
     std::string m_connected_device_name;
@@ -485,10 +581,25 @@ private:
     std::string m_current_sequence_number;
     std::string m_src_dev_ip;
     std::string m_sink_ip;
-    std::string m_getparameter_request;
-    bool m_getparameter_response_sent{false};
+    MiracastRTSPStreamBuffer m_rtsp_stream;
+    RTSP_MSG_SEGMENTS_STRUCT m_rtsp_msg_builders[RTSP_MSG_FMT_INVALID];
     RTSP_WFD_VIDEO_FMT_STRUCT   m_wfd_video_formats_st;
     RTSP_WFD_AUDIO_FMT_STRUCT   m_wfd_audio_formats_st;
+    /* Video format selected by the source in M4, masks already intersected with ours */
+    RTSP_WFD_VIDEO_FMT_STRUCT   m_wfd_negotiated_video_st;
+    /* Audio codec selected by the source in M4, audio_format 0 for none */
+    RTSP_WFD_AUDIO_FMT_STRUCT   m_wfd_negotiated_audio_st;
+    /* "name: value\r\n" line of every sink capability, rebuilt only when a capability changes */
+    std::string m_m3_param_lines[RTSP_WFD_PARAM_MAX];
+    std::string m_m3_full_body;
+    unsigned int m_m3_full_body_mask;
+    std::string m_m3_response_body;
+    MiracastRTSPLatencyStats m_latency_stats;
+    MiracastRTSPParamCache m_param_cache;
+    /* M4 parameters of the connected source, seeded from the cache and updated by M4 */
+    RTSP_SOURCE_PARAMS_STRUCT m_session_params;
+    bool m_cached_params_applied;
+    MiracastUIBC m_uibc;
 
     static RTSP_MSG_FMT_TEMPLATE rtsp_msg_fmt_template[];
     static RTSP_ERRORCODE_TEMPLATE rtsp_msg_error_codes[];
@@ -501,47 +612,55 @@ private:
 
     void set_state( eMIRA_PLAYER_STATES state , bool send_notification = false , eM_PLAYER_REASON_CODE reason_code = MIRACAST_PLAYER_REASON_CODE_SUCCESS );
     void store_srcsink_info( std::string client_name, std::string client_mac, std::string src_dev_ip, std::string sink_ip);
+    bool apply_cached_source_params(void);
+    bool update_session_params(const MiracastRTSPParser &rtsp_msg);
 
     MiracastError create_RTSPThread(void);
+    bool add_SessionEventDescriptors(void);
+    void set_SocketOptions(void);
     void Release_SocketAndEpollDescriptor(void);
 
-    RTSP_STATUS validate_rtsp_m1_msg_m2_send_request(std::string rtsp_m1_msg_buffer);
-    RTSP_STATUS validate_rtsp_m2_request_ack(std::string rtsp_m1_response_ack_buffer);
-    RTSP_STATUS validate_rtsp_m3_response_back(std::string rtsp_m3_msg_buffer);
-    RTSP_STATUS validate_rtsp_m4_response_back(std::string rtsp_m4_msg_buffer);
-    RTSP_STATUS validate_rtsp_m5_msg_m6_send_request(std::string rtsp_m5_msg_buffer);
-    RTSP_STATUS validate_rtsp_m6_ack_m7_send_request(std::string rtsp_m6_ack_buffer);
-    RTSP_STATUS validate_rtsp_trigger_request_ack(std::string rtsp_trigger_req_ack_buffer , std::string received_seq_num );
-    RTSP_STATUS validate_rtsp_post_m1_m7_xchange(std::string rtsp_post_m1_m7_xchange_buffer);
+    RTSP_STATUS validate_rtsp_m1_msg_m2_send_request(const MiracastRTSPParser &rtsp_msg);
+    RTSP_STATUS validate_rtsp_m2_request_ack(const MiracastRTSPParser &rtsp_msg);
+    RTSP_STATUS validate_rtsp_m3_response_back(const MiracastRTSPParser &rtsp_msg);
+    RTSP_STATUS validate_rtsp_m4_response_back(const MiracastRTSPParser &rtsp_msg);
+    RTSP_STATUS validate_rtsp_m5_msg_m6_send_request(const MiracastRTSPParser &rtsp_msg);
+    RTSP_STATUS validate_rtsp_m6_ack_m7_send_request(const MiracastRTSPParser &rtsp_msg);
+    RTSP_STATUS validate_rtsp_trigger_request_ack(const MiracastRTSPParser &rtsp_msg);
+    RTSP_STATUS validate_rtsp_post_m1_m7_xchange(const MiracastRTSPParser &rtsp_msg);
     RTSP_STATUS rtsp_sink2src_request_msg_handling(eCONTROLLER_FW_STATES state);
 
-    RTSP_STATUS validate_rtsp_receive_buffer_handling(std::string rtsp_msg_buffer);
-    RTSP_STATUS validate_rtsp_generic_request_response( std::string rtsp_msg_buffer );
-    RTSP_STATUS validate_rtsp_options_request( std::string rtsp_msg_buffer );
-    RTSP_STATUS validate_rtsp_getparameter_request( std::string rtsp_msg_buffer );
-    RTSP_STATUS validate_rtsp_setparameter_request( std::string rtsp_msg_buffer );
-    RTSP_STATUS validate_rtsp_trigger_method_request(std::string rtsp_msg_buffer);
-    RTSP_STATUS send_rtsp_reply_sink2src( RTSP_MSG_FMT_SINK2SRC req_fmt , std::string received_seq_num = "" , RTSP_ERRORCODES error_code = RTSP_ERRORCODE_OK );
+    RTSP_STATUS validate_rtsp_receive_buffer_handling(const MiracastRTSPParser &rtsp_msg);
+    RTSP_STATUS validate_rtsp_generic_request_response(const MiracastRTSPParser &rtsp_msg);
+    RTSP_STATUS validate_rtsp_options_request(const MiracastRTSPParser &rtsp_msg);
+    RTSP_STATUS validate_rtsp_getparameter_request(const MiracastRTSPParser &rtsp_msg);
+    RTSP_STATUS validate_rtsp_setparameter_request(const MiracastRTSPParser &rtsp_msg);
+    RTSP_STATUS validate_rtsp_trigger_method_request(const MiracastRTSPParser &rtsp_msg);
+    RTSP_STATUS send_rtsp_reply_sink2src( RTSP_MSG_FMT_SINK2SRC req_fmt , const RTSPStringView &received_seq_num = RTSPStringView() , RTSP_ERRORCODES error_code = RTSP_ERRORCODE_OK );
 
     const char *get_RequestResponseFormat(RTSP_MSG_FMT_SINK2SRC format_type);
     const char* get_errorcode_string(RTSP_ERRORCODES error_code);
     const char* get_parser_field_by_index(RTSP_PARSER_FIELDS parse_field);
-    std::string get_parser_field_value(RTSP_PARSER_FIELDS parse_field);
-    std::string get_parser_field_n_value_by_name(std::string request_field_name );
-    std::string parse_received_parser_field_value(std::string rtsp_msg_buffer , RTSP_PARSER_FIELDS parse_field );
-
-    std::string generate_request_response_msg(RTSP_MSG_FMT_SINK2SRC msg_fmt_needed, std::string received_session_no , std::string append_data1 , RTSP_ERRORCODES error_code = RTSP_ERRORCODE_OK );
-    bool IsValidSequenceNumber(std::string& receivedSequenceNum);
+    const std::string &get_parser_field_value(RTSP_PARSER_FIELDS parse_field);
+    const std::string &get_wfd_param_value(RTSP_WFD_PARAM_ID param_id);
+
+    void compile_request_response_templates(void);
+    void update_m3_response_cache(void);
+    bool negotiate_wfd_video_format(const RTSPStringView &video_formats);
+    bool negotiate_wfd_audio_codec(const RTSPStringView &audio_codecs);
+    void prewarm_player(void);
+    static bool parse_wfd_video_format(const RTSPStringView &video_formats, RTSP_WFD_VIDEO_FMT_STRUCT &st_video_fmt);
+    bool generate_request_response_msg(RTSP_MSG_FMT_SINK2SRC msg_fmt_needed, const RTSPStringView &received_seq_num , const RTSPStringView &append_data1 , RTSP_MSG_SEGMENTS_STRUCT &rtsp_msg , RTSP_ERRORCODES error_code = RTSP_ERRORCODE_OK );
+    bool IsValidSequenceNumber(const RTSPStringView &receivedSequenceNum);
     std::string get_RequestSequenceNumber(void);
-    std::string generate_RequestSequenceNumber(void);
+    const std::string &generate_RequestSequenceNumber(void);
 
     bool set_wait_timeout(unsigned int waittime_ms);
     unsigned int get_wait_timeout(void);
 
-    RTSP_STATUS receive_buffer_timedOut(int sockfd, void *buffer, size_t buffer_len , unsigned int wait_time_ms = RTSP_REQUEST_RECV_TIMEOUT );
-    bool wait_data_timeout(int m_Sockfd, unsigned int ms);
-    RTSP_STATUS send_rstp_msg(int sockfd, std::string rtsp_response_buffer);
+    RTSP_STATUS receive_buffer_timedOut(int sockfd, void *buffer, size_t buffer_len , size_t &received_length , unsigned int wait_time_ms = RTSP_REQUEST_RECV_TIMEOUT );
+    RTSP_STATUS receive_rtsp_message(unsigned int wait_time_ms);
+    RTSP_STATUS send_rstp_msg(int sockfd, const RTSP_MSG_SEGMENTS_STRUCT &rtsp_msg);
     MiracastError updateVideoRectangle( VIDEO_RECT_STRUCT videorect );
-    int validateGetParameterContentLength(std::string& input);
 };
 #endif
\ No newline at end of file
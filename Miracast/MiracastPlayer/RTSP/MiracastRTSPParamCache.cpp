@@ -0,0 +1,104 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <MiracastCommon.h>
+#include <MiracastRTSPParamCache.h>
+
+MiracastRTSPParamCache::MiracastRTSPParamCache()
+{
+    m_hits = 0;
+    m_misses = 0;
+    m_invalidations = 0;
+}
+
+size_t MiracastRTSPParamCache::find_source(const std::string &source_mac) const
+{
+    size_t index = 0;
+
+    while ((index < m_sources.size()) && (source_mac != m_sources[index].source_mac))
+    {
+        ++index;
+    }
+    return index;
+}
+
+bool MiracastRTSPParamCache::lookup(const std::string &source_mac, RTSP_SOURCE_PARAMS_STRUCT &params)
+{
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+    size_t index = find_source(source_mac);
+
+    if (source_mac.empty() || (m_sources.size() == index))
+    {
+        ++m_misses;
+        return false;
+    }
+
+    params = m_sources[index];
+    if (0 != index)
+    {
+        m_sources.erase(m_sources.begin() + index);
+        m_sources.insert(m_sources.begin(), params);
+    }
+    ++m_hits;
+    return true;
+}
+
+void MiracastRTSPParamCache::store(const RTSP_SOURCE_PARAMS_STRUCT &params)
+{
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+    size_t index = find_source(params.source_mac);
+
+    if (params.source_mac.empty())
+    {
+        return;
+    }
+
+    if (m_sources.size() != index)
+    {
+        m_sources.erase(m_sources.begin() + index);
+    }
+    else if (RTSP_PARAM_CACHE_MAX_SOURCES <= m_sources.size())
+    {
+        MIRACASTLOG_INFO("Dropping cached params of [%s]", m_sources.back().source_mac.c_str());
+        m_sources.pop_back();
+    }
+    m_sources.insert(m_sources.begin(), params);
+}
+
+void MiracastRTSPParamCache::invalidate(const std::string &source_mac)
+{
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+    size_t index = find_source(source_mac);
+
+    if (m_sources.size() != index)
+    {
+        m_sources.erase(m_sources.begin() + index);
+        ++m_invalidations;
+    }
+}
+
+void MiracastRTSPParamCache::get_counters(RTSP_PARAM_CACHE_COUNTERS_STRUCT &counters)
+{
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+
+    counters.entries = static_cast<uint32_t>(m_sources.size());
+    counters.hits = m_hits;
+    counters.misses = m_misses;
+    counters.invalidations = m_invalidations;
+}
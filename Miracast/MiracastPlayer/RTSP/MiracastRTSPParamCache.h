@@ -0,0 +1,74 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _MIRACAST_RTSP_PARAM_CACHE_H_
+#define _MIRACAST_RTSP_PARAM_CACHE_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <mutex>
+
+#define RTSP_PARAM_CACHE_MAX_SOURCES   ( 8 )
+
+typedef struct rtsp_source_params_st
+{
+    std::string source_mac;
+    /* wfd_video_formats and wfd_audio_codecs as selected by the source in M4 */
+    std::string video_format;
+    std::string audio_codec;
+    /* wfd_presentation_URL with the host stripped, e.g. "/wfd1.0/streamid=0" */
+    std::string presentation_path;
+    std::string client_rtp_ports;
+} RTSP_SOURCE_PARAMS_STRUCT;
+
+typedef struct rtsp_param_cache_counters_st
+{
+    uint32_t entries;
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t invalidations;
+} RTSP_PARAM_CACHE_COUNTERS_STRUCT;
+
+/**
+ * Last successful M4 parameters of the most recently connected sources, keyed
+ * by source MAC. The least recently used source is dropped once full.
+ */
+class MiracastRTSPParamCache
+{
+public:
+    MiracastRTSPParamCache();
+
+    bool lookup(const std::string &source_mac, RTSP_SOURCE_PARAMS_STRUCT &params);
+    void store(const RTSP_SOURCE_PARAMS_STRUCT &params);
+    void invalidate(const std::string &source_mac);
+    void get_counters(RTSP_PARAM_CACHE_COUNTERS_STRUCT &counters);
+
+private:
+    std::mutex m_cache_mutex;
+    /* Most recently used first */
+    std::vector<RTSP_SOURCE_PARAMS_STRUCT> m_sources;
+    uint32_t m_hits;
+    uint32_t m_misses;
+    uint32_t m_invalidations;
+
+    size_t find_source(const std::string &source_mac) const;
+};
+
+#endif
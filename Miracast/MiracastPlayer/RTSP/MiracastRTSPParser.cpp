@@ -0,0 +1,632 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ctype.h>
+#include <strings.h>
+#include <MiracastRTSPParser.h>
+
+#define RTSP_VERSION_PREFIX "RTSP/"
+#define RTSP_VERSION_STR "RTSP/1.0"
+
+const size_t RTSPStringView::npos;
+
+bool RTSPStringView::equals(const char *str, size_t len) const
+{
+    return ((len == m_length) && ((0 == len) || (0 == memcmp(m_data, str, len))));
+}
+
+bool RTSPStringView::equals_nocase(const char *str, size_t len) const
+{
+    return ((len == m_length) && ((0 == len) || (0 == strncasecmp(m_data, str, len))));
+}
+
+bool RTSPStringView::starts_with(const char *prefix) const
+{
+    size_t prefix_len = strlen(prefix);
+    return ((prefix_len <= m_length) && (0 == memcmp(m_data, prefix, prefix_len)));
+}
+
+size_t RTSPStringView::find(char ch, size_t from) const
+{
+    if (from >= m_length)
+    {
+        return npos;
+    }
+    const void *found = memchr(m_data + from, ch, m_length - from);
+    return (nullptr != found) ? static_cast<size_t>(static_cast<const char *>(found) - m_data) : npos;
+}
+
+size_t RTSPStringView::find(const char *needle, size_t from) const
+{
+    size_t needle_len = strlen(needle);
+
+    if ((0 == needle_len) || (from >= m_length) || (needle_len > (m_length - from)))
+    {
+        return npos;
+    }
+
+    size_t last = m_length - needle_len;
+    for (size_t pos = from; pos <= last; ++pos)
+    {
+        pos = find(needle[0], pos);
+        if ((npos == pos) || (pos > last))
+        {
+            break;
+        }
+        if (0 == memcmp(m_data + pos, needle, needle_len))
+        {
+            return pos;
+        }
+    }
+    return npos;
+}
+
+RTSPStringView RTSPStringView::substr(size_t pos, size_t len) const
+{
+    if (pos >= m_length)
+    {
+        return RTSPStringView(m_data + m_length, 0);
+    }
+    if ((npos == len) || (len > (m_length - pos)))
+    {
+        len = m_length - pos;
+    }
+    return RTSPStringView(m_data + pos, len);
+}
+
+RTSPStringView RTSPStringView::trim(void) const
+{
+    size_t start = 0,
+           end = m_length;
+
+    while ((start < end) && isspace(static_cast<unsigned char>(m_data[start])))
+    {
+        ++start;
+    }
+    while ((end > start) && isspace(static_cast<unsigned char>(m_data[end - 1])))
+    {
+        --end;
+    }
+    return RTSPStringView(m_data + start, end - start);
+}
+
+bool RTSPStringView::to_uint(unsigned long &value) const
+{
+    unsigned long result = 0;
+
+    if (0 == m_length)
+    {
+        return false;
+    }
+    for (size_t pos = 0; pos < m_length; ++pos)
+    {
+        if (!isdigit(static_cast<unsigned char>(m_data[pos])))
+        {
+            return false;
+        }
+        result = (result * 10) + static_cast<unsigned long>(m_data[pos] - '0');
+    }
+    value = result;
+    return true;
+}
+
+bool RTSPStringView::to_hex_uint(unsigned long &value) const
+{
+    unsigned long result = 0;
+
+    if ((0 == m_length) || ((sizeof(unsigned long) * 2) < m_length))
+    {
+        return false;
+    }
+    for (size_t pos = 0; pos < m_length; ++pos)
+    {
+        unsigned char ch = static_cast<unsigned char>(m_data[pos]);
+
+        if (!isxdigit(ch))
+        {
+            return false;
+        }
+        result = (result << 4) | static_cast<unsigned long>(isdigit(ch) ? (ch - '0') : (tolower(ch) - 'a' + 10));
+    }
+    value = result;
+    return true;
+}
+
+MiracastRTSPParser::MiracastRTSPParser()
+{
+    reset();
+}
+
+void MiracastRTSPParser::reset(void)
+{
+    m_start_line_type = RTSP_START_LINE_INVALID;
+    m_method = RTSP_METHOD_UNKNOWN;
+    m_start_line = RTSPStringView();
+    m_request_uri = RTSPStringView();
+    m_status_code = 0;
+
+    for (int header_id = 0; header_id < RTSP_HEADER_MAX; ++header_id)
+    {
+        m_headers[header_id] = RTSPStringView();
+        m_header_present[header_id] = false;
+    }
+    m_has_content_length = false;
+    m_content_length = 0;
+
+    m_body = RTSPStringView();
+    m_body_param_count = 0;
+    for (int param_id = 0; param_id < RTSP_WFD_PARAM_MAX; ++param_id)
+    {
+        m_wfd_param_slots[param_id] = -1;
+    }
+
+    m_message = nullptr;
+    m_message_length = 0;
+    m_header_complete = false;
+    m_body_complete = false;
+}
+
+RTSPStringView MiracastRTSPParser::next_line(const char *buffer, size_t length, size_t &offset)
+{
+    const char *line_start = buffer + offset;
+    size_t remaining = length - offset;
+    const char *line_end = static_cast<const char *>(memchr(line_start, '\n', remaining));
+    size_t line_len = (nullptr != line_end) ? static_cast<size_t>(line_end - line_start) : remaining;
+
+    offset += (nullptr != line_end) ? (line_len + 1) : line_len;
+
+    if ((0 < line_len) && ('\r' == line_start[line_len - 1]))
+    {
+        --line_len;
+    }
+    return RTSPStringView(line_start, line_len);
+}
+
+bool MiracastRTSPParser::parse(const char *buffer, size_t length)
+{
+    RTSPStringView line;
+    size_t offset = 0;
+
+    reset();
+
+    if (nullptr == buffer)
+    {
+        return false;
+    }
+    m_message = buffer;
+
+    /* Tolerate stray CRLFs in front of the start line */
+    do
+    {
+        if (offset >= length)
+        {
+            m_message_length = offset;
+            return false;
+        }
+        line = next_line(buffer, length, offset);
+    }
+    while (line.empty());
+
+    if (!parse_start_line(line))
+    {
+        m_message_length = offset;
+        return false;
+    }
+
+    while (offset < length)
+    {
+        size_t line_offset = offset;
+
+        line = next_line(buffer, length, offset);
+        if (line.empty())
+        {
+            m_header_complete = true;
+            break;
+        }
+        /* Some sources pipeline the next message without the blank line */
+        if (is_start_line(line))
+        {
+            offset = line_offset;
+            break;
+        }
+        parse_header_line(line);
+    }
+
+    m_body_complete = ((false == m_has_content_length) || (0 == m_content_length));
+
+    if ((true == m_header_complete) && (0 < m_content_length))
+    {
+        size_t available = length - offset,
+               body_len = (available < m_content_length) ? available : m_content_length;
+
+        m_body = RTSPStringView(buffer + offset, body_len);
+        m_body_complete = (available >= m_content_length);
+        offset += body_len;
+        parse_body();
+    }
+    m_message_length = offset;
+    return true;
+}
+
+bool MiracastRTSPParser::is_start_line(const RTSPStringView &line)
+{
+    if (line.starts_with(RTSP_VERSION_STR " "))
+    {
+        return true;
+    }
+
+    size_t method_end = line.find(' ');
+    size_t version_len = strlen(" " RTSP_VERSION_STR);
+
+    return ((RTSPStringView::npos != method_end) &&
+            (0 < method_end) &&
+            (':' != line[method_end - 1]) &&
+            (line.length() > version_len) &&
+            (line.substr(line.length() - version_len).equals(" " RTSP_VERSION_STR)));
+}
+
+bool MiracastRTSPParser::parse_start_line(const RTSPStringView &line)
+{
+    size_t first_space = line.find(' ');
+
+    m_start_line = line;
+
+    if (RTSPStringView::npos == first_space)
+    {
+        return false;
+    }
+
+    if (line.starts_with(RTSP_VERSION_PREFIX))
+    {
+        unsigned long status_code = 0;
+        size_t code_end = line.find(' ', first_space + 1);
+        RTSPStringView status = line.substr(first_space + 1, (RTSPStringView::npos == code_end) ? RTSPStringView::npos : code_end - first_space - 1);
+
+        if (!status.to_uint(status_code))
+        {
+            return false;
+        }
+        m_status_code = static_cast<unsigned int>(status_code);
+        m_start_line_type = RTSP_START_LINE_RESPONSE;
+        return true;
+    }
+
+    size_t second_space = line.find(' ', first_space + 1);
+
+    if ((RTSPStringView::npos == second_space) ||
+        (!line.substr(second_space + 1).starts_with(RTSP_VERSION_PREFIX)))
+    {
+        return false;
+    }
+    m_method = get_method_by_name(line.substr(0, first_space));
+    m_request_uri = line.substr(first_space + 1, second_space - first_space - 1);
+    m_start_line_type = RTSP_START_LINE_REQUEST;
+    return true;
+}
+
+void MiracastRTSPParser::parse_header_line(const RTSPStringView &line)
+{
+    size_t colon = line.find(':');
+
+    if (RTSPStringView::npos == colon)
+    {
+        return;
+    }
+
+    RTSP_HEADER_ID header_id = get_header_by_name(line.substr(0, colon).trim());
+
+    if ((RTSP_HEADER_MAX == header_id) || (m_header_present[header_id]))
+    {
+        return;
+    }
+    m_headers[header_id] = line.substr(colon + 1).trim();
+    m_header_present[header_id] = true;
+
+    if (RTSP_HEADER_CONTENT_LENGTH == header_id)
+    {
+        m_has_content_length = m_headers[header_id].to_uint(m_content_length);
+    }
+}
+
+void MiracastRTSPParser::parse_body(void)
+{
+    size_t offset = 0;
+
+    while ((offset < m_body.length()) && (m_body_param_count < RTSP_PARSER_MAX_BODY_PARAMS))
+    {
+        RTSPStringView line = next_line(m_body.data(), m_body.length(), offset).trim();
+
+        if (line.empty())
+        {
+            continue;
+        }
+
+        RTSP_BODY_PARAM_STRUCT &param = m_body_params[m_body_param_count];
+        size_t colon = line.find(':');
+
+        if (RTSPStringView::npos == colon)
+        {
+            param.name = line;
+            param.value = RTSPStringView();
+        }
+        else
+        {
+            param.name = line.substr(0, colon).trim();
+            param.value = line.substr(colon + 1).trim();
+        }
+        param.param_id = get_wfd_param_by_name(param.name);
+
+        if ((RTSP_WFD_PARAM_UNKNOWN != param.param_id) && (-1 == m_wfd_param_slots[param.param_id]))
+        {
+            m_wfd_param_slots[param.param_id] = static_cast<int>(m_body_param_count);
+        }
+        ++m_body_param_count;
+    }
+}
+
+bool MiracastRTSPParser::has_header(RTSP_HEADER_ID header_id) const
+{
+    return ((RTSP_HEADER_MAX > header_id) && (m_header_present[header_id]));
+}
+
+RTSPStringView MiracastRTSPParser::get_header(RTSP_HEADER_ID header_id) const
+{
+    return (has_header(header_id)) ? m_headers[header_id] : RTSPStringView();
+}
+
+bool MiracastRTSPParser::has_wfd_param(RTSP_WFD_PARAM_ID param_id) const
+{
+    return ((RTSP_WFD_PARAM_MAX > param_id) && (-1 != m_wfd_param_slots[param_id]));
+}
+
+RTSPStringView MiracastRTSPParser::get_wfd_param(RTSP_WFD_PARAM_ID param_id) const
+{
+    return (has_wfd_param(param_id)) ? m_body_params[m_wfd_param_slots[param_id]].value : RTSPStringView();
+}
+
+#define RTSP_NAME_MATCHES(view, literal) ((view).equals(literal, sizeof(literal) - 1))
+#define RTSP_NAME_MATCHES_NOCASE(view, literal) ((view).equals_nocase(literal, sizeof(literal) - 1))
+
+RTSP_METHOD MiracastRTSPParser::get_method_by_name(const RTSPStringView &name)
+{
+    switch (name.length())
+    {
+        case 4:
+            if (RTSP_NAME_MATCHES(name, "PLAY")) return RTSP_METHOD_PLAY;
+            break;
+        case 5:
+            if (RTSP_NAME_MATCHES(name, "SETUP")) return RTSP_METHOD_SETUP;
+            if (RTSP_NAME_MATCHES(name, "PAUSE")) return RTSP_METHOD_PAUSE;
+            break;
+        case 7:
+            if (RTSP_NAME_MATCHES(name, "OPTIONS")) return RTSP_METHOD_OPTIONS;
+            break;
+        case 8:
+            if (RTSP_NAME_MATCHES(name, "TEARDOWN")) return RTSP_METHOD_TEARDOWN;
+            break;
+        case 13:
+            if (RTSP_NAME_MATCHES(name, "GET_PARAMETER")) return RTSP_METHOD_GET_PARAMETER;
+            if (RTSP_NAME_MATCHES(name, "SET_PARAMETER")) return RTSP_METHOD_SET_PARAMETER;
+            break;
+        default:
+            break;
+    }
+    return RTSP_METHOD_UNKNOWN;
+}
+
+RTSP_HEADER_ID MiracastRTSPParser::get_header_by_name(const RTSPStringView &name)
+{
+    switch (name.length())
+    {
+        case 4:
+            if (RTSP_NAME_MATCHES_NOCASE(name, "CSeq")) return RTSP_HEADER_CSEQ;
+            break;
+        case 6:
+            if (RTSP_NAME_MATCHES_NOCASE(name, "Public")) return RTSP_HEADER_PUBLIC;
+            if (RTSP_NAME_MATCHES_NOCASE(name, "Server")) return RTSP_HEADER_SERVER;
+            break;
+        case 7:
+            if (RTSP_NAME_MATCHES_NOCASE(name, "Session")) return RTSP_HEADER_SESSION;
+            if (RTSP_NAME_MATCHES_NOCASE(name, "Require")) return RTSP_HEADER_REQUIRE;
+            break;
+        case 9:
+            if (RTSP_NAME_MATCHES_NOCASE(name, "Transport")) return RTSP_HEADER_TRANSPORT;
+            break;
+        case 10:
+            if (RTSP_NAME_MATCHES_NOCASE(name, "User-Agent")) return RTSP_HEADER_USER_AGENT;
+            break;
+        case 12:
+            if (RTSP_NAME_MATCHES_NOCASE(name, "Content-Type")) return RTSP_HEADER_CONTENT_TYPE;
+            break;
+        case 14:
+            if (RTSP_NAME_MATCHES_NOCASE(name, "Content-Length")) return RTSP_HEADER_CONTENT_LENGTH;
+            break;
+        default:
+            break;
+    }
+    return RTSP_HEADER_MAX;
+}
+
+RTSP_WFD_PARAM_ID MiracastRTSPParser::get_wfd_param_by_name(const RTSPStringView &name)
+{
+    if (!name.starts_with("wfd_"))
+    {
+        return RTSP_WFD_PARAM_UNKNOWN;
+    }
+
+    switch (name.length())
+    {
+        case 16:
+            if (RTSP_NAME_MATCHES(name, "wfd_audio_codecs")) return RTSP_WFD_PARAM_AUDIO_CODECS;
+            if (RTSP_NAME_MATCHES(name, "wfd_display_edid")) return RTSP_WFD_PARAM_DISPLAY_EDID;
+            if (RTSP_NAME_MATCHES(name, "wfd_uibc_setting")) return RTSP_WFD_PARAM_UIBC_SETTING;
+            break;
+        case 17:
+            if (RTSP_NAME_MATCHES(name, "wfd_video_formats")) return RTSP_WFD_PARAM_VIDEO_FORMATS;
+            break;
+        case 18:
+            if (RTSP_NAME_MATCHES(name, "wfd_connector_type")) return RTSP_WFD_PARAM_CONNECTOR_TYPE;
+            if (RTSP_NAME_MATCHES(name, "wfd_trigger_method")) return RTSP_WFD_PARAM_TRIGGER_METHOD;
+            break;
+        case 19:
+            if (RTSP_NAME_MATCHES(name, "wfd_uibc_capability")) return RTSP_WFD_PARAM_UIBC_CAPABILITY;
+            break;
+        case 20:
+            if (RTSP_NAME_MATCHES(name, "wfd_client_rtp_ports")) return RTSP_WFD_PARAM_CLIENT_RTP_PORTS;
+            if (RTSP_NAME_MATCHES(name, "wfd_presentation_URL")) return RTSP_WFD_PARAM_PRESENTATION_URL;
+            break;
+        case 22:
+            if (RTSP_NAME_MATCHES(name, "wfd_content_protection")) return RTSP_WFD_PARAM_CONTENT_PROTECTION;
+            break;
+        default:
+            break;
+    }
+    return RTSP_WFD_PARAM_UNKNOWN;
+}
+
+const char *MiracastRTSPParser::get_wfd_param_name(RTSP_WFD_PARAM_ID param_id)
+{
+    static const char *wfd_param_names[RTSP_WFD_PARAM_MAX] = {
+        "wfd_content_protection",
+        "wfd_video_formats",
+        "wfd_audio_codecs",
+        "wfd_client_rtp_ports",
+        "wfd_display_edid",
+        "wfd_uibc_capability",
+        "wfd_connector_type",
+        "wfd_presentation_URL",
+        "wfd_trigger_method",
+        "wfd_uibc_setting"
+    };
+
+    return (RTSP_WFD_PARAM_MAX > param_id) ? wfd_param_names[param_id] : "";
+}
+
+MiracastRTSPStreamBuffer::MiracastRTSPStreamBuffer()
+    : m_buffer(RTSP_STREAM_BUFFER_INITIAL_SIZE),
+      m_read_offset(0),
+      m_write_offset(0)
+{
+}
+
+void MiracastRTSPStreamBuffer::reset(void)
+{
+    m_read_offset = 0;
+    m_write_offset = 0;
+    m_parser.reset();
+}
+
+char *MiracastRTSPStreamBuffer::get_write_buffer(size_t &available)
+{
+    size_t pending = m_write_offset - m_read_offset;
+
+    if ((m_buffer.size() - m_write_offset) < RTSP_STREAM_BUFFER_MIN_READ_SIZE)
+    {
+        /* Drop the messages already handed over before growing */
+        if (0 < m_read_offset)
+        {
+            memmove(m_buffer.data(), m_buffer.data() + m_read_offset, pending);
+            m_read_offset = 0;
+            m_write_offset = pending;
+        }
+        if (((m_buffer.size() - m_write_offset) < RTSP_STREAM_BUFFER_MIN_READ_SIZE) &&
+            (RTSP_STREAM_BUFFER_MAX_SIZE > m_buffer.size()))
+        {
+            size_t new_size = m_buffer.size() * 2;
+
+            m_buffer.resize((RTSP_STREAM_BUFFER_MAX_SIZE < new_size) ? RTSP_STREAM_BUFFER_MAX_SIZE : new_size);
+        }
+    }
+    else if ((0 < m_read_offset) && (0 == pending))
+    {
+        m_read_offset = 0;
+        m_write_offset = 0;
+    }
+
+    available = m_buffer.size() - m_write_offset;
+    return (0 < available) ? (m_buffer.data() + m_write_offset) : nullptr;
+}
+
+void MiracastRTSPStreamBuffer::commit_write(size_t length)
+{
+    m_write_offset += length;
+    if (m_write_offset > m_buffer.size())
+    {
+        m_write_offset = m_buffer.size();
+    }
+}
+
+RTSP_STREAM_FRAME_STATE MiracastRTSPStreamBuffer::next_message(void)
+{
+    while (m_read_offset < m_write_offset)
+    {
+        const char *data = m_buffer.data() + m_read_offset;
+        size_t pending = m_write_offset - m_read_offset;
+        bool ends_with_newline = ('\n' == data[pending - 1]);
+        bool valid_start_line = m_parser.parse(data, pending);
+        size_t message_length = m_parser.get_message_length();
+
+        if (false == valid_start_line)
+        {
+            if (m_parser.get_start_line().empty())
+            {
+                /* Only stray CRLFs left */
+                m_read_offset += message_length;
+                continue;
+            }
+            if ((message_length >= pending) && (false == ends_with_newline))
+            {
+                return RTSP_STREAM_FRAME_INCOMPLETE;
+            }
+            /* Hand the malformed line over so that it gets rejected */
+            m_read_offset += message_length;
+            return RTSP_STREAM_FRAME_COMPLETE;
+        }
+
+        if (m_parser.is_header_complete())
+        {
+            if (false == m_parser.is_body_complete())
+            {
+                return RTSP_STREAM_FRAME_INCOMPLETE;
+            }
+        }
+        else if (message_length >= pending)
+        {
+            return ends_with_newline ? RTSP_STREAM_FRAME_UNTERMINATED : RTSP_STREAM_FRAME_INCOMPLETE;
+        }
+        /* else the next start line follows without a blank line */
+
+        m_read_offset += message_length;
+        return RTSP_STREAM_FRAME_COMPLETE;
+    }
+    return RTSP_STREAM_FRAME_EMPTY;
+}
+
+bool MiracastRTSPStreamBuffer::take_pending(void)
+{
+    size_t pending = m_write_offset - m_read_offset;
+
+    if (0 == pending)
+    {
+        return false;
+    }
+    m_parser.parse(m_buffer.data() + m_read_offset, pending);
+    m_read_offset = m_write_offset;
+    return true;
+}
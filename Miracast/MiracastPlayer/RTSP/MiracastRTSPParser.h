@@ -0,0 +1,256 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _MIRACAST_RTSP_PARSER_H_
+#define _MIRACAST_RTSP_PARSER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#define RTSP_PARSER_MAX_BODY_PARAMS (32)
+#define RTSP_STREAM_BUFFER_INITIAL_SIZE (4096)
+#define RTSP_STREAM_BUFFER_MIN_READ_SIZE (1024)
+#define RTSP_STREAM_BUFFER_MAX_SIZE (64 * 1024)
+
+/**
+ * Non-owning view of a character range inside an RTSP receive buffer.
+ * The plugin is built as C++11, so this stands in for std::string_view.
+ */
+class RTSPStringView
+{
+public:
+    static const size_t npos = static_cast<size_t>(-1);
+
+    RTSPStringView() : m_data(nullptr), m_length(0) {}
+    RTSPStringView(const char *data, size_t length) : m_data(data), m_length(length) {}
+    explicit RTSPStringView(const char *str) : m_data(str), m_length((nullptr != str) ? strlen(str) : 0) {}
+    explicit RTSPStringView(const std::string &str) : m_data(str.data()), m_length(str.length()) {}
+
+    const char *data(void) const { return m_data; }
+    size_t length(void) const { return m_length; }
+    bool empty(void) const { return (0 == m_length); }
+    char operator[](size_t pos) const { return m_data[pos]; }
+
+    bool equals(const char *str, size_t len) const;
+    bool equals(const char *str) const { return equals(str, strlen(str)); }
+    bool equals_nocase(const char *str, size_t len) const;
+    bool starts_with(const char *prefix) const;
+    size_t find(char ch, size_t from = 0) const;
+    size_t find(const char *needle, size_t from = 0) const;
+    RTSPStringView substr(size_t pos, size_t len = npos) const;
+    RTSPStringView trim(void) const;
+    bool to_uint(unsigned long &value) const;
+    bool to_hex_uint(unsigned long &value) const;
+
+    std::string to_string(void) const { return (nullptr != m_data) ? std::string(m_data, m_length) : std::string(); }
+    /* Reuses the capacity of out instead of constructing a new string */
+    void assign_to(std::string &out) const { out.assign((nullptr != m_data) ? m_data : "", m_length); }
+
+private:
+    const char *m_data;
+    size_t m_length;
+};
+
+typedef enum rtsp_start_line_type_e
+{
+    RTSP_START_LINE_INVALID = 0x00,
+    RTSP_START_LINE_REQUEST,
+    RTSP_START_LINE_RESPONSE
+}
+RTSP_START_LINE_TYPE;
+
+typedef enum rtsp_method_e
+{
+    RTSP_METHOD_UNKNOWN = 0x00,
+    RTSP_METHOD_OPTIONS,
+    RTSP_METHOD_GET_PARAMETER,
+    RTSP_METHOD_SET_PARAMETER,
+    RTSP_METHOD_SETUP,
+    RTSP_METHOD_PLAY,
+    RTSP_METHOD_PAUSE,
+    RTSP_METHOD_TEARDOWN
+}
+RTSP_METHOD;
+
+typedef enum rtsp_header_id_e
+{
+    RTSP_HEADER_CSEQ = 0x00,
+    RTSP_HEADER_CONTENT_LENGTH,
+    RTSP_HEADER_CONTENT_TYPE,
+    RTSP_HEADER_SESSION,
+    RTSP_HEADER_PUBLIC,
+    RTSP_HEADER_REQUIRE,
+    RTSP_HEADER_TRANSPORT,
+    RTSP_HEADER_SERVER,
+    RTSP_HEADER_USER_AGENT,
+    RTSP_HEADER_MAX
+}
+RTSP_HEADER_ID;
+
+typedef enum rtsp_wfd_param_id_e
+{
+    RTSP_WFD_PARAM_CONTENT_PROTECTION = 0x00,
+    RTSP_WFD_PARAM_VIDEO_FORMATS,
+    RTSP_WFD_PARAM_AUDIO_CODECS,
+    RTSP_WFD_PARAM_CLIENT_RTP_PORTS,
+    RTSP_WFD_PARAM_DISPLAY_EDID,
+    RTSP_WFD_PARAM_UIBC_CAPABILITY,
+    RTSP_WFD_PARAM_CONNECTOR_TYPE,
+    RTSP_WFD_PARAM_PRESENTATION_URL,
+    RTSP_WFD_PARAM_TRIGGER_METHOD,
+    RTSP_WFD_PARAM_UIBC_SETTING,
+    RTSP_WFD_PARAM_MAX,
+    RTSP_WFD_PARAM_UNKNOWN = RTSP_WFD_PARAM_MAX
+}
+RTSP_WFD_PARAM_ID;
+
+typedef struct rtsp_body_param_st
+{
+    RTSP_WFD_PARAM_ID param_id;
+    RTSPStringView name;
+    RTSPStringView value;
+}
+RTSP_BODY_PARAM_STRUCT;
+
+/**
+ * Single pass tokenizer for one RTSP message.
+ *
+ * The start line, the headers and the text/parameters body are indexed as
+ * views into the caller's buffer, so the buffer must outlive the parser.
+ * Well known headers and wfd_* parameters are kept in fixed slots and can be
+ * looked up without scanning the message again.
+ */
+class MiracastRTSPParser
+{
+public:
+    MiracastRTSPParser();
+
+    bool parse(const char *buffer, size_t length);
+    void reset(void);
+
+    RTSP_START_LINE_TYPE get_start_line_type(void) const { return m_start_line_type; }
+    RTSP_METHOD get_method(void) const { return m_method; }
+    RTSPStringView get_start_line(void) const { return m_start_line; }
+    RTSPStringView get_request_uri(void) const { return m_request_uri; }
+    unsigned int get_status_code(void) const { return m_status_code; }
+
+    bool has_header(RTSP_HEADER_ID header_id) const;
+    RTSPStringView get_header(RTSP_HEADER_ID header_id) const;
+
+    bool has_content_length(void) const { return m_has_content_length; }
+    unsigned long get_content_length(void) const { return m_content_length; }
+    RTSPStringView get_body(void) const { return m_body; }
+
+    bool has_wfd_param(RTSP_WFD_PARAM_ID param_id) const;
+    RTSPStringView get_wfd_param(RTSP_WFD_PARAM_ID param_id) const;
+    size_t get_body_param_count(void) const { return m_body_param_count; }
+    const RTSP_BODY_PARAM_STRUCT &get_body_param(size_t index) const { return m_body_params[index]; }
+
+    /* Bytes of the input that belong to this message */
+    size_t get_message_length(void) const { return m_message_length; }
+    RTSPStringView get_message(void) const { return RTSPStringView(m_message, m_message_length); }
+    /* Blank line terminating the header block was seen */
+    bool is_header_complete(void) const { return m_header_complete; }
+    /* Whole Content-Length body is present in the input */
+    bool is_body_complete(void) const { return m_body_complete; }
+
+    static RTSP_METHOD get_method_by_name(const RTSPStringView &name);
+    static RTSP_WFD_PARAM_ID get_wfd_param_by_name(const RTSPStringView &name);
+    static const char *get_wfd_param_name(RTSP_WFD_PARAM_ID param_id);
+    static bool is_start_line(const RTSPStringView &line);
+
+private:
+    RTSP_START_LINE_TYPE m_start_line_type;
+    RTSP_METHOD m_method;
+    RTSPStringView m_start_line;
+    RTSPStringView m_request_uri;
+    unsigned int m_status_code;
+
+    RTSPStringView m_headers[RTSP_HEADER_MAX];
+    bool m_header_present[RTSP_HEADER_MAX];
+    bool m_has_content_length;
+    unsigned long m_content_length;
+
+    RTSPStringView m_body;
+    RTSP_BODY_PARAM_STRUCT m_body_params[RTSP_PARSER_MAX_BODY_PARAMS];
+    size_t m_body_param_count;
+    int m_wfd_param_slots[RTSP_WFD_PARAM_MAX];
+
+    const char *m_message;
+    size_t m_message_length;
+    bool m_header_complete;
+    bool m_body_complete;
+
+    bool parse_start_line(const RTSPStringView &line);
+    void parse_header_line(const RTSPStringView &line);
+    void parse_body(void);
+
+    static RTSP_HEADER_ID get_header_by_name(const RTSPStringView &name);
+    static RTSPStringView next_line(const char *buffer, size_t length, size_t &offset);
+};
+
+typedef enum rtsp_stream_frame_state_e
+{
+    RTSP_STREAM_FRAME_EMPTY = 0x00,
+    /* A whole message is available */
+    RTSP_STREAM_FRAME_COMPLETE,
+    /* Header lines without the terminating blank line, may be all the source sends */
+    RTSP_STREAM_FRAME_UNTERMINATED,
+    /* Partial line or Content-Length body still missing */
+    RTSP_STREAM_FRAME_INCOMPLETE
+}
+RTSP_STREAM_FRAME_STATE;
+
+/**
+ * Per connection receive buffer which frames the TCP byte stream into RTSP
+ * messages using the header terminator and Content-Length, so a single read
+ * can yield zero, one or several messages.
+ *
+ * The message returned by next_message()/take_pending() is indexed by
+ * get_parser() and stays valid until the next get_write_buffer() call.
+ */
+class MiracastRTSPStreamBuffer
+{
+public:
+    MiracastRTSPStreamBuffer();
+
+    void reset(void);
+
+    /* Free space for the next recv(); nullptr once RTSP_STREAM_BUFFER_MAX_SIZE is exhausted */
+    char *get_write_buffer(size_t &available);
+    void commit_write(size_t length);
+
+    RTSP_STREAM_FRAME_STATE next_message(void);
+    /* Hands over whatever is pending as one message */
+    bool take_pending(void);
+
+    size_t get_pending_length(void) const { return m_write_offset - m_read_offset; }
+    const MiracastRTSPParser &get_parser(void) const { return m_parser; }
+
+private:
+    std::vector<char> m_buffer;
+    size_t m_read_offset;
+    size_t m_write_offset;
+    MiracastRTSPParser m_parser;
+};
+
+#endif
@@ -0,0 +1,193 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include <MiracastCommon.h>
+#include <MiracastRTSPStats.h>
+
+/* Upper bounds in microseconds; from sub-ms message handling up to the M16 interval */
+static const uint64_t rtsp_latency_bucket_bounds_us[RTSP_LATENCY_BUCKET_COUNT] = {
+    250ULL,
+    1000ULL,
+    5000ULL,
+    10000ULL,
+    25000ULL,
+    50000ULL,
+    100000ULL,
+    250000ULL,
+    500000ULL,
+    1000000ULL,
+    2500000ULL,
+    5000000ULL,
+    10000000ULL,
+    30000000ULL,
+    60000000ULL,
+    0ULL
+};
+
+static const char *rtsp_latency_phase_names[RTSP_LATENCY_PHASE_MAX] = {
+    "M1_M2",
+    "M3",
+    "M4_M5",
+    "M6_M7",
+    "SESSION_SETUP",
+    "KEEP_ALIVE",
+    "UIBC_INPUT",
+    "PLAY_FIRST_FRAME",
+    "CONNECT"
+};
+
+MiracastRTSPLatencyStats::MiracastRTSPLatencyStats()
+{
+    m_current_source = RTSP_LATENCY_MAX_SOURCE_MODELS;
+    memset(m_phase_start_us, 0x00, sizeof(m_phase_start_us));
+}
+
+const char *MiracastRTSPLatencyStats::get_phase_name(RTSP_LATENCY_PHASE phase)
+{
+    return (RTSP_LATENCY_PHASE_MAX > phase) ? rtsp_latency_phase_names[phase] : "";
+}
+
+uint64_t MiracastRTSPLatencyStats::get_bucket_upper_bound_us(size_t bucket)
+{
+    return (RTSP_LATENCY_BUCKET_COUNT > bucket) ? rtsp_latency_bucket_bounds_us[bucket] : 0;
+}
+
+size_t MiracastRTSPLatencyStats::get_source_index(const std::string &source_model)
+{
+    const std::string &model = (source_model.empty()) ? std::string(RTSP_LATENCY_UNKNOWN_SOURCE_MODEL) : source_model;
+    RTSP_SOURCE_LATENCY_STRUCT new_source;
+
+    for (size_t index = 0; index < m_sources.size(); ++index)
+    {
+        if (model == m_sources[index].source_model)
+        {
+            return index;
+        }
+    }
+
+    // The last slot collects every model once the table is full
+    if ((RTSP_LATENCY_MAX_SOURCE_MODELS - 1) <= m_sources.size())
+    {
+        if (RTSP_LATENCY_MAX_SOURCE_MODELS == m_sources.size())
+        {
+            return (RTSP_LATENCY_MAX_SOURCE_MODELS - 1);
+        }
+        new_source.source_model = RTSP_LATENCY_OTHER_SOURCE_MODEL;
+    }
+    else
+    {
+        new_source.source_model = model;
+    }
+    new_source.sessions = 0;
+    memset(new_source.phases, 0x00, sizeof(new_source.phases));
+    m_sources.push_back(new_source);
+
+    return (m_sources.size() - 1);
+}
+
+void MiracastRTSPLatencyStats::start_session(const std::string &source_model)
+{
+    std::lock_guard<std::mutex> lock(m_stats_mutex);
+
+    m_current_source = get_source_index(source_model);
+    ++m_sources[m_current_source].sessions;
+    memset(m_phase_start_us, 0x00, sizeof(m_phase_start_us));
+
+    MIRACASTLOG_VERBOSE("Latency stats for source model[%s]", m_sources[m_current_source].source_model.c_str());
+}
+
+void MiracastRTSPLatencyStats::begin(RTSP_LATENCY_PHASE phase)
+{
+    if (RTSP_LATENCY_PHASE_MAX > phase)
+    {
+        m_phase_start_us[phase] = MiracastCommon::get_monotonic_time_us();
+    }
+}
+
+void MiracastRTSPLatencyStats::end(RTSP_LATENCY_PHASE phase)
+{
+    uint64_t elapsed_us = 0;
+
+    if ((RTSP_LATENCY_PHASE_MAX <= phase) || (0 == m_phase_start_us[phase]))
+    {
+        return;
+    }
+    elapsed_us = MiracastCommon::get_monotonic_time_us() - m_phase_start_us[phase];
+    m_phase_start_us[phase] = 0;
+
+    record(phase, elapsed_us);
+}
+
+void MiracastRTSPLatencyStats::record(RTSP_LATENCY_PHASE phase, uint64_t elapsed_us)
+{
+    size_t bucket = 0;
+
+    if (RTSP_LATENCY_PHASE_MAX <= phase)
+    {
+        return;
+    }
+
+    while (((RTSP_LATENCY_BUCKET_COUNT - 1) > bucket) && (elapsed_us > rtsp_latency_bucket_bounds_us[bucket]))
+    {
+        ++bucket;
+    }
+
+    std::lock_guard<std::mutex> lock(m_stats_mutex);
+
+    if (m_sources.size() <= m_current_source)
+    {
+        return;
+    }
+
+    RTSP_LATENCY_HISTOGRAM_STRUCT &histogram = m_sources[m_current_source].phases[phase];
+
+    ++histogram.buckets[bucket];
+    if ((0 == histogram.count) || (elapsed_us < histogram.min_us))
+    {
+        histogram.min_us = elapsed_us;
+    }
+    if (elapsed_us > histogram.max_us)
+    {
+        histogram.max_us = elapsed_us;
+    }
+    ++histogram.count;
+    histogram.sum_us += elapsed_us;
+
+    MIRACASTLOG_VERBOSE("[%s] phase[%s] took [%llu]us",
+                        m_sources[m_current_source].source_model.c_str(),
+                        rtsp_latency_phase_names[phase],
+                        static_cast<unsigned long long>(elapsed_us));
+}
+
+void MiracastRTSPLatencyStats::get_snapshot(std::vector<RTSP_SOURCE_LATENCY_STRUCT> &snapshot, bool reset)
+{
+    std::lock_guard<std::mutex> lock(m_stats_mutex);
+
+    snapshot = m_sources;
+
+    if (reset)
+    {
+        for (size_t index = 0; index < m_sources.size(); ++index)
+        {
+            m_sources[index].sessions = 0;
+            memset(m_sources[index].phases, 0x00, sizeof(m_sources[index].phases));
+        }
+    }
+}
@@ -0,0 +1,104 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _MIRACAST_RTSP_STATS_H_
+#define _MIRACAST_RTSP_STATS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <mutex>
+
+#define RTSP_LATENCY_BUCKET_COUNT   ( 16 )
+#define RTSP_LATENCY_MAX_SOURCE_MODELS   ( 16 )
+#define RTSP_LATENCY_OTHER_SOURCE_MODEL   "other"
+#define RTSP_LATENCY_UNKNOWN_SOURCE_MODEL   "unknown"
+
+typedef enum rtsp_latency_phase_e
+{
+    /* M1 OPTIONS received until the M2 response is validated */
+    RTSP_LATENCY_PHASE_M1_M2 = 0x00,
+    /* M2 response validated until the M3 GET_PARAMETER response is sent */
+    RTSP_LATENCY_PHASE_M3,
+    /* M4 SET_PARAMETER received until the M5 SETUP trigger arrives */
+    RTSP_LATENCY_PHASE_M4_M5,
+    /* M6 SETUP sent until the M7 PLAY response arrives */
+    RTSP_LATENCY_PHASE_M6_M7,
+    /* M1 received until the M7 response */
+    RTSP_LATENCY_PHASE_SESSION_SETUP,
+    /* Interval between M16 keep-alives */
+    RTSP_LATENCY_PHASE_KEEP_ALIVE,
+    /* UIBC input request received until its packet is written to the socket */
+    RTSP_LATENCY_PHASE_UIBC_INPUT,
+    /* M7 PLAY sent until the first video frame is shown */
+    RTSP_LATENCY_PHASE_PLAY_FIRST_FRAME,
+    /* TCP connect to the source, retries included, until the socket is set up */
+    RTSP_LATENCY_PHASE_CONNECT,
+    RTSP_LATENCY_PHASE_MAX
+} RTSP_LATENCY_PHASE;
+
+typedef struct rtsp_latency_histogram_st
+{
+    uint32_t buckets[RTSP_LATENCY_BUCKET_COUNT];
+    uint32_t count;
+    uint64_t sum_us;
+    uint64_t min_us;
+    uint64_t max_us;
+} RTSP_LATENCY_HISTOGRAM_STRUCT;
+
+typedef struct rtsp_source_latency_st
+{
+    std::string source_model;
+    uint32_t sessions;
+    RTSP_LATENCY_HISTOGRAM_STRUCT phases[RTSP_LATENCY_PHASE_MAX];
+} RTSP_SOURCE_LATENCY_STRUCT;
+
+/**
+ * Fixed bucket histograms of the WFD session phases, kept per source model.
+ *
+ * begin()/end() are called from the RTSP handler thread only, record() and
+ * the snapshot can be used from any thread.
+ */
+class MiracastRTSPLatencyStats
+{
+public:
+    MiracastRTSPLatencyStats();
+
+    void start_session(const std::string &source_model);
+    void begin(RTSP_LATENCY_PHASE phase);
+    void end(RTSP_LATENCY_PHASE phase);
+    /* Adds a sample measured by the caller, can be called from any thread */
+    void record(RTSP_LATENCY_PHASE phase, uint64_t elapsed_us);
+    void get_snapshot(std::vector<RTSP_SOURCE_LATENCY_STRUCT> &snapshot, bool reset = false);
+
+    static const char *get_phase_name(RTSP_LATENCY_PHASE phase);
+    /* Upper bound of a bucket in microseconds, 0 for the last (unbounded) bucket */
+    static uint64_t get_bucket_upper_bound_us(size_t bucket);
+
+private:
+    std::mutex m_stats_mutex;
+    std::vector<RTSP_SOURCE_LATENCY_STRUCT> m_sources;
+    size_t m_current_source;
+    uint64_t m_phase_start_us[RTSP_LATENCY_PHASE_MAX];
+
+    size_t get_source_index(const std::string &source_model);
+};
+
+#endif
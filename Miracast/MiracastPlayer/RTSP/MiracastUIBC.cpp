@@ -0,0 +1,591 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <algorithm>
+#include <MiracastCommon.h>
+#include <MiracastUIBC.h>
+
+/* Version 0, no timestamp, input category and the packet length */
+#define UIBC_HEADER_LEN   ( 4 )
+#define UIBC_GENERIC_IE_HEADER_LEN   ( 3 )
+#define UIBC_HIDC_HEADER_LEN   ( 5 )
+#define UIBC_MAX_PACKET_LEN   ( UIBC_HEADER_LEN + UIBC_HIDC_HEADER_LEN + UIBC_MAX_HIDC_REPORT_LEN )
+#define UIBC_SCROLL_DIRECTION_BIT   ( 0x2000 )
+#define UIBC_SCROLL_AMOUNT_MASK   ( 0x1FFF )
+#define UIBC_POINTER_CAPS   ( UIBC_GENERIC_CAP_MOUSE | UIBC_GENERIC_CAP_SINGLE_TOUCH | UIBC_GENERIC_CAP_MULTI_TOUCH )
+
+static const char *uibc_generic_cap_names[] = {
+    "Keyboard",
+    "Mouse",
+    "SingleTouch",
+    "MultiTouch",
+    "Joystick",
+    "Camera",
+    "Gesture",
+    "RemoteControl"
+};
+
+static uint8_t *put_uint16(uint8_t *buffer, uint16_t value)
+{
+    buffer[0] = static_cast<uint8_t>(value >> 8);
+    buffer[1] = static_cast<uint8_t>(value & 0xFF);
+    return (buffer + 2);
+}
+
+MiracastUIBC::MiracastUIBC(MiracastRTSPLatencyStats &latency_stats)
+    : m_latency_stats(latency_stats)
+{
+    m_socket_fd = -1;
+    m_epoll_fd = -1;
+    m_connected = false;
+    m_enabled = false;
+    m_source_port = 0;
+    m_input_categories = 0;
+    m_generic_caps = 0;
+    m_pending_offset = 0;
+}
+
+MiracastUIBC::~MiracastUIBC()
+{
+    stop();
+}
+
+/*
+ * input_category_list=GENERIC, HIDC;generic_cap_list=Keyboard, Mouse;hidc_cap_list=none;port=<tcp-port>
+ */
+bool MiracastUIBC::update_capability(const RTSPStringView &capability)
+{
+    std::lock_guard<std::mutex> lock(m_uibc_mutex);
+    RTSPStringView remaining = capability.trim();
+    unsigned long port = 0;
+
+    m_input_categories = 0;
+    m_generic_caps = 0;
+    m_source_port = 0;
+
+    if (remaining.equals("none"))
+    {
+        MIRACASTLOG_INFO("Source does not support UIBC");
+        return true;
+    }
+
+    while (!remaining.empty())
+    {
+        size_t end = remaining.find(';');
+        RTSPStringView field = remaining.substr(0, end).trim();
+        size_t equal_pos = field.find('=');
+        RTSPStringView name = field.substr(0, equal_pos).trim(),
+                       values = (RTSPStringView::npos != equal_pos) ? field.substr(equal_pos + 1).trim() : RTSPStringView();
+
+        remaining = (RTSPStringView::npos != end) ? remaining.substr(end + 1) : RTSPStringView();
+
+        if (name.equals("port"))
+        {
+            if (values.to_uint(port) && (0 < port) && (0xFFFF >= port))
+            {
+                m_source_port = static_cast<unsigned short>(port);
+            }
+            continue;
+        }
+
+        while (!values.empty())
+        {
+            size_t comma = values.find(',');
+            RTSPStringView value = values.substr(0, comma).trim();
+
+            values = (RTSPStringView::npos != comma) ? values.substr(comma + 1) : RTSPStringView();
+
+            if (name.equals("input_category_list"))
+            {
+                if (value.equals("GENERIC"))
+                {
+                    m_input_categories |= (1 << UIBC_INPUT_CATEGORY_GENERIC);
+                }
+                else if (value.equals("HIDC"))
+                {
+                    m_input_categories |= (1 << UIBC_INPUT_CATEGORY_HIDC);
+                }
+            }
+            else if (name.equals("generic_cap_list"))
+            {
+                for (size_t index = 0; index < (sizeof(uibc_generic_cap_names) / sizeof(uibc_generic_cap_names[0])); ++index)
+                {
+                    if (value.equals(uibc_generic_cap_names[index]))
+                    {
+                        m_generic_caps |= (1 << index);
+                    }
+                }
+            }
+        }
+    }
+
+    MIRACASTLOG_INFO("UIBC categories[%#x] generic caps[%#x] port[%u]", m_input_categories, m_generic_caps, m_source_port);
+    return ((0 != m_input_categories) && (0 != m_source_port));
+}
+
+void MiracastUIBC::update_setting(bool enable)
+{
+    std::lock_guard<std::mutex> lock(m_uibc_mutex);
+
+    MIRACASTLOG_INFO("UIBC %s by source", enable ? "enabled" : "disabled");
+    m_enabled = enable;
+    if (!enable)
+    {
+        close_socket();
+    }
+}
+
+bool MiracastUIBC::is_enabled(void)
+{
+    std::lock_guard<std::mutex> lock(m_uibc_mutex);
+
+    return ((m_enabled) && (0 != m_source_port) && (0 != m_input_categories));
+}
+
+bool MiracastUIBC::start(int epoll_fd, const std::string &source_ip)
+{
+    std::lock_guard<std::mutex> lock(m_uibc_mutex);
+    struct sockaddr_in addr = {0};
+    struct epoll_event event = {0};
+    int no_delay = 1;
+
+    MIRACASTLOG_TRACE("Entering...");
+
+    if (-1 != m_socket_fd)
+    {
+        MIRACASTLOG_TRACE("Exiting...");
+        return true;
+    }
+    if ((!m_enabled) || (0 == m_source_port) || (0 == m_input_categories))
+    {
+        MIRACASTLOG_TRACE("Exiting...");
+        return false;
+    }
+
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(m_source_port);
+    if (1 != inet_pton(AF_INET, source_ip.c_str(), &addr.sin_addr))
+    {
+        MIRACASTLOG_ERROR("Invalid source IP[%s]", source_ip.c_str());
+        MIRACASTLOG_TRACE("Exiting...");
+        return false;
+    }
+
+    m_socket_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (-1 == m_socket_fd)
+    {
+        MIRACASTLOG_ERROR("UIBC socket creation error %s", strerror(errno));
+        MIRACASTLOG_TRACE("Exiting...");
+        return false;
+    }
+
+    // Every batch is a complete set of packets, Nagle would only hold it back
+    if (0 != setsockopt(m_socket_fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay)))
+    {
+        MIRACASTLOG_WARNING("TCP_NODELAY failed: %s", strerror(errno));
+    }
+
+    if (0 == connect(m_socket_fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)))
+    {
+        m_connected = true;
+    }
+    else if (EINPROGRESS != errno)
+    {
+        MIRACASTLOG_ERROR("UIBC connect to [%s:%u] failed: %s", source_ip.c_str(), m_source_port, strerror(errno));
+        close_socket();
+        MIRACASTLOG_TRACE("Exiting...");
+        return false;
+    }
+
+    // EPOLLOUT reports the connect completion, it is dropped again once connected and drained
+    event.events = EPOLLRDHUP | ((m_connected) ? 0U : static_cast<uint32_t>(EPOLLOUT));
+    event.data.fd = m_socket_fd;
+    if (-1 == epoll_ctl(epoll_fd, EPOLL_CTL_ADD, m_socket_fd, &event))
+    {
+        MIRACASTLOG_ERROR("epoll_ctl fd[%d] failed: [%s]", m_socket_fd, strerror(errno));
+        close_socket();
+        MIRACASTLOG_TRACE("Exiting...");
+        return false;
+    }
+    m_epoll_fd = epoll_fd;
+
+    MIRACASTLOG_INFO("UIBC %s [%s:%u]", (m_connected) ? "connected to" : "connecting to", source_ip.c_str(), m_source_port);
+    MIRACASTLOG_TRACE("Exiting...");
+    return true;
+}
+
+void MiracastUIBC::stop(void)
+{
+    std::lock_guard<std::mutex> lock(m_uibc_mutex);
+
+    close_socket();
+    m_enabled = false;
+    m_source_port = 0;
+    m_input_categories = 0;
+    m_generic_caps = 0;
+}
+
+void MiracastUIBC::close_socket(void)
+{
+    if (-1 != m_socket_fd)
+    {
+        if ((-1 != m_epoll_fd) && (-1 == epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, m_socket_fd, nullptr)))
+        {
+            MIRACASTLOG_VERBOSE("epoll_ctl DEL fd[%d]: [%s]", m_socket_fd, strerror(errno));
+        }
+        close(m_socket_fd);
+        m_socket_fd = -1;
+    }
+    m_epoll_fd = -1;
+    m_connected = false;
+    m_pending.clear();
+    m_pending_offset = 0;
+    m_pending_batches.clear();
+}
+
+void MiracastUIBC::update_epoll_events(void)
+{
+    struct epoll_event event = {0};
+
+    if ((-1 == m_epoll_fd) || (-1 == m_socket_fd))
+    {
+        return;
+    }
+
+    event.events = EPOLLRDHUP | (((!m_connected) || (m_pending_offset < m_pending.size())) ? static_cast<uint32_t>(EPOLLOUT) : 0U);
+    event.data.fd = m_socket_fd;
+    if (-1 == epoll_ctl(m_epoll_fd, EPOLL_CTL_MOD, m_socket_fd, &event))
+    {
+        MIRACASTLOG_ERROR("epoll_ctl fd[%d] failed: [%s]", m_socket_fd, strerror(errno));
+    }
+}
+
+bool MiracastUIBC::flush_pending(void)
+{
+    uint64_t now_us = 0;
+
+    while (m_pending_offset < m_pending.size())
+    {
+        ssize_t sent = send(m_socket_fd,
+                            m_pending.data() + m_pending_offset,
+                            m_pending.size() - m_pending_offset,
+                            MSG_DONTWAIT | MSG_NOSIGNAL);
+
+        if (0 < sent)
+        {
+            m_pending_offset += static_cast<size_t>(sent);
+        }
+        else if ((-1 == sent) && (EINTR == errno))
+        {
+            continue;
+        }
+        else if ((-1 == sent) && ((EAGAIN == errno) || (EWOULDBLOCK == errno)))
+        {
+            break;
+        }
+        else
+        {
+            MIRACASTLOG_ERROR("UIBC send failed: %s", strerror(errno));
+            return false;
+        }
+    }
+
+    now_us = MiracastCommon::get_monotonic_time_us();
+    while ((!m_pending_batches.empty()) && (m_pending_batches.front().end_offset <= m_pending_offset))
+    {
+        m_latency_stats.record(RTSP_LATENCY_PHASE_UIBC_INPUT, now_us - m_pending_batches.front().receive_time_us);
+        m_pending_batches.pop_front();
+    }
+
+    if (0 != m_pending_offset)
+    {
+        m_pending.erase(0, m_pending_offset);
+        for (size_t index = 0; index < m_pending_batches.size(); ++index)
+        {
+            m_pending_batches[index].end_offset -= m_pending_offset;
+        }
+        m_pending_offset = 0;
+    }
+    return true;
+}
+
+void MiracastUIBC::handle_socket_event(uint32_t events)
+{
+    std::lock_guard<std::mutex> lock(m_uibc_mutex);
+
+    if (-1 == m_socket_fd)
+    {
+        return;
+    }
+
+    if (0 != (events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)))
+    {
+        MIRACASTLOG_WARNING("UIBC %s by source[%#x]", (m_connected) ? "closed" : "connection refused", events);
+        close_socket();
+        return;
+    }
+
+    if (0 != (events & EPOLLOUT))
+    {
+        if (!m_connected)
+        {
+            int error = 0;
+            socklen_t len = sizeof(error);
+
+            if ((0 != getsockopt(m_socket_fd, SOL_SOCKET, SO_ERROR, &error, &len)) || (0 != error))
+            {
+                MIRACASTLOG_ERROR("UIBC connect failed: %s", strerror(error));
+                close_socket();
+                return;
+            }
+            m_connected = true;
+            MIRACASTLOG_INFO("UIBC connected");
+        }
+
+        if (!flush_pending())
+        {
+            close_socket();
+            return;
+        }
+        update_epoll_events();
+    }
+}
+
+bool MiracastUIBC::is_event_allowed(const UIBC_EVENT_STRUCT &event) const
+{
+    if ((UIBC_INPUT_CATEGORY_MAX <= event.category) || (0 == (m_input_categories & (1 << event.category))))
+    {
+        return false;
+    }
+    if (UIBC_INPUT_CATEGORY_HIDC == event.category)
+    {
+        return true;
+    }
+
+    switch (event.generic_ie_id)
+    {
+        case UIBC_GENERIC_IE_KEY_DOWN:
+        case UIBC_GENERIC_IE_KEY_UP:
+            return (0 != (m_generic_caps & (UIBC_GENERIC_CAP_KEYBOARD | UIBC_GENERIC_CAP_REMOTE_CONTROL)));
+        case UIBC_GENERIC_IE_TOUCH_DOWN:
+        case UIBC_GENERIC_IE_TOUCH_UP:
+        case UIBC_GENERIC_IE_TOUCH_MOVE:
+            if (1 < event.pointer_count)
+            {
+                return (0 != (m_generic_caps & UIBC_GENERIC_CAP_MULTI_TOUCH));
+            }
+            return (0 != (m_generic_caps & UIBC_POINTER_CAPS));
+        case UIBC_GENERIC_IE_ZOOM:
+        case UIBC_GENERIC_IE_VERTICAL_SCROLL:
+        case UIBC_GENERIC_IE_HORIZONTAL_SCROLL:
+        case UIBC_GENERIC_IE_ROTATE:
+            return (0 != (m_generic_caps & UIBC_POINTER_CAPS));
+        default:
+            return false;
+    }
+}
+
+/*
+ * One UIBC packet: 4 byte header, then a Generic Input IE or a HIDC report.
+ * Returns the packet length, 0 if the event is invalid or does not fit.
+ */
+size_t MiracastUIBC::encode_event(const UIBC_EVENT_STRUCT &event, uint8_t *buffer, size_t buffer_len)
+{
+    uint8_t *body = buffer + UIBC_HEADER_LEN,
+            *describe = body + UIBC_GENERIC_IE_HEADER_LEN,
+            *cursor = describe;
+    size_t packet_len = 0;
+
+    if (UIBC_MAX_PACKET_LEN > buffer_len)
+    {
+        return 0;
+    }
+
+    if (UIBC_INPUT_CATEGORY_HIDC == event.category)
+    {
+        if (UIBC_MAX_HIDC_REPORT_LEN < event.hidc_report_length)
+        {
+            return 0;
+        }
+        body[0] = event.hidc_input_path;
+        body[1] = event.hidc_type;
+        body[2] = event.hidc_usage;
+        put_uint16(body + 3, event.hidc_report_length);
+        memcpy(body + UIBC_HIDC_HEADER_LEN, event.hidc_report, event.hidc_report_length);
+        packet_len = UIBC_HEADER_LEN + UIBC_HIDC_HEADER_LEN + event.hidc_report_length;
+    }
+    else if (UIBC_INPUT_CATEGORY_GENERIC == event.category)
+    {
+        switch (event.generic_ie_id)
+        {
+            case UIBC_GENERIC_IE_TOUCH_DOWN:
+            case UIBC_GENERIC_IE_TOUCH_UP:
+            case UIBC_GENERIC_IE_TOUCH_MOVE:
+            {
+                if ((0 == event.pointer_count) || (UIBC_MAX_POINTERS < event.pointer_count))
+                {
+                    return 0;
+                }
+                *cursor++ = event.pointer_count;
+                for (uint8_t index = 0; index < event.pointer_count; ++index)
+                {
+                    *cursor++ = event.pointers[index].id;
+                    cursor = put_uint16(cursor, event.pointers[index].x);
+                    cursor = put_uint16(cursor, event.pointers[index].y);
+                }
+            }
+            break;
+            case UIBC_GENERIC_IE_KEY_DOWN:
+            case UIBC_GENERIC_IE_KEY_UP:
+            {
+                *cursor++ = 0x00;
+                cursor = put_uint16(cursor, event.key_code1);
+                cursor = put_uint16(cursor, event.key_code2);
+            }
+            break;
+            case UIBC_GENERIC_IE_ZOOM:
+            {
+                cursor = put_uint16(cursor, event.pointers[0].x);
+                cursor = put_uint16(cursor, event.pointers[0].y);
+                *cursor++ = static_cast<uint8_t>(event.integer_part);
+                *cursor++ = event.fraction_part;
+            }
+            break;
+            case UIBC_GENERIC_IE_VERTICAL_SCROLL:
+            case UIBC_GENERIC_IE_HORIZONTAL_SCROLL:
+            {
+                // Pixel units, direction bit set for up/left, 13 bit magnitude
+                int amount = event.scroll_amount;
+                uint16_t scroll = (0 > amount) ? UIBC_SCROLL_DIRECTION_BIT : 0;
+
+                amount = (0 > amount) ? -amount : amount;
+                scroll |= static_cast<uint16_t>(std::min(amount, UIBC_SCROLL_AMOUNT_MASK));
+                cursor = put_uint16(cursor, scroll);
+            }
+            break;
+            case UIBC_GENERIC_IE_ROTATE:
+            {
+                *cursor++ = static_cast<uint8_t>(event.integer_part);
+                *cursor++ = event.fraction_part;
+            }
+            break;
+            default:
+                return 0;
+        }
+        body[0] = static_cast<uint8_t>(event.generic_ie_id);
+        put_uint16(body + 1, static_cast<uint16_t>(cursor - describe));
+        packet_len = static_cast<size_t>(cursor - buffer);
+    }
+    else
+    {
+        return 0;
+    }
+
+    buffer[0] = 0x00;
+    buffer[1] = static_cast<uint8_t>(event.category & 0x0F);
+    put_uint16(buffer + 2, static_cast<uint16_t>(packet_len));
+    return packet_len;
+}
+
+bool MiracastUIBC::send_events(const UIBC_EVENT_STRUCT *events, size_t count, uint64_t receive_time_us)
+{
+    uint8_t batch[UIBC_MAX_BATCH_EVENTS * UIBC_MAX_PACKET_LEN];
+    size_t batch_len = 0,
+           sent_len = 0;
+
+    if ((nullptr == events) || (0 == count) || (UIBC_MAX_BATCH_EVENTS < count))
+    {
+        MIRACASTLOG_ERROR("Invalid UIBC batch of [%zu] events", count);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_uibc_mutex);
+
+    if ((!m_enabled) || (-1 == m_socket_fd))
+    {
+        MIRACASTLOG_WARNING("UIBC is not active");
+        return false;
+    }
+
+    for (size_t index = 0; index < count; ++index)
+    {
+        size_t packet_len = 0;
+
+        if (is_event_allowed(events[index]))
+        {
+            packet_len = encode_event(events[index], batch + batch_len, sizeof(batch) - batch_len);
+        }
+        if (0 == packet_len)
+        {
+            MIRACASTLOG_ERROR("UIBC event[%zu] category[%d] id[%d] not supported by the source",
+                                index, events[index].category, events[index].generic_ie_id);
+            return false;
+        }
+        batch_len += packet_len;
+    }
+
+    // Written right away unless older input is still queued or the connect is in progress
+    if ((m_connected) && (m_pending_offset == m_pending.size()))
+    {
+        ssize_t sent = -1;
+
+        do
+        {
+            sent = send(m_socket_fd, batch, batch_len, MSG_DONTWAIT | MSG_NOSIGNAL);
+        }
+        while ((-1 == sent) && (EINTR == errno));
+
+        if (static_cast<ssize_t>(batch_len) == sent)
+        {
+            m_latency_stats.record(RTSP_LATENCY_PHASE_UIBC_INPUT, MiracastCommon::get_monotonic_time_us() - receive_time_us);
+            return true;
+        }
+        if ((-1 == sent) && (EAGAIN != errno) && (EWOULDBLOCK != errno))
+        {
+            MIRACASTLOG_ERROR("UIBC send failed: %s", strerror(errno));
+            close_socket();
+            return false;
+        }
+        sent_len = (0 < sent) ? static_cast<size_t>(sent) : 0;
+    }
+
+    // A partly written batch has to be completed to keep the packet framing intact
+    if ((0 == sent_len) && (UIBC_MAX_PENDING_BYTES < (m_pending.size() - m_pending_offset + batch_len)))
+    {
+        MIRACASTLOG_WARNING("UIBC backlog full, dropping [%zu] events", count);
+        return false;
+    }
+
+    UIBC_PENDING_BATCH_STRUCT pending_batch;
+
+    m_pending.append(reinterpret_cast<const char *>(batch) + sent_len, batch_len - sent_len);
+    pending_batch.end_offset = m_pending.size();
+    pending_batch.receive_time_us = receive_time_us;
+    m_pending_batches.push_back(pending_batch);
+    update_epoll_events();
+    return true;
+}
@@ -0,0 +1,165 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _MIRACAST_UIBC_H_
+#define _MIRACAST_UIBC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <deque>
+#include <mutex>
+#include <MiracastRTSPParser.h>
+#include <MiracastRTSPStats.h>
+
+#define UIBC_MAX_POINTERS   ( 10 )
+#define UIBC_MAX_HIDC_REPORT_LEN   ( 64 )
+#define UIBC_MAX_BATCH_EVENTS   ( 32 )
+/* Unsent input is stale long before this is reached */
+#define UIBC_MAX_PENDING_BYTES   ( 16 * 1024 )
+
+typedef enum uibc_input_category_e
+{
+    UIBC_INPUT_CATEGORY_GENERIC = 0x00,
+    UIBC_INPUT_CATEGORY_HIDC = 0x01,
+    UIBC_INPUT_CATEGORY_MAX
+}
+UIBC_INPUT_CATEGORY;
+
+typedef enum uibc_generic_ie_id_e
+{
+    UIBC_GENERIC_IE_TOUCH_DOWN = 0x00,
+    UIBC_GENERIC_IE_TOUCH_UP,
+    UIBC_GENERIC_IE_TOUCH_MOVE,
+    UIBC_GENERIC_IE_KEY_DOWN,
+    UIBC_GENERIC_IE_KEY_UP,
+    UIBC_GENERIC_IE_ZOOM,
+    UIBC_GENERIC_IE_VERTICAL_SCROLL,
+    UIBC_GENERIC_IE_HORIZONTAL_SCROLL,
+    UIBC_GENERIC_IE_ROTATE,
+    UIBC_GENERIC_IE_MAX
+}
+UIBC_GENERIC_IE_ID;
+
+typedef enum uibc_generic_cap_e
+{
+    UIBC_GENERIC_CAP_KEYBOARD = ( 1 << 0 ),
+    UIBC_GENERIC_CAP_MOUSE = ( 1 << 1 ),
+    UIBC_GENERIC_CAP_SINGLE_TOUCH = ( 1 << 2 ),
+    UIBC_GENERIC_CAP_MULTI_TOUCH = ( 1 << 3 ),
+    UIBC_GENERIC_CAP_JOYSTICK = ( 1 << 4 ),
+    UIBC_GENERIC_CAP_CAMERA = ( 1 << 5 ),
+    UIBC_GENERIC_CAP_GESTURE = ( 1 << 6 ),
+    UIBC_GENERIC_CAP_REMOTE_CONTROL = ( 1 << 7 )
+}
+UIBC_GENERIC_CAP;
+
+typedef struct uibc_pointer_st
+{
+    uint8_t id;
+    /* In the resolution of the negotiated video format */
+    uint16_t x;
+    uint16_t y;
+}
+UIBC_POINTER_STRUCT;
+
+typedef struct uibc_event_st
+{
+    UIBC_INPUT_CATEGORY category;
+    UIBC_GENERIC_IE_ID generic_ie_id;
+    /* TOUCH_DOWN/UP/MOVE, pointers[0] is the zoom center for ZOOM */
+    uint8_t pointer_count;
+    UIBC_POINTER_STRUCT pointers[UIBC_MAX_POINTERS];
+    /* KEY_DOWN/UP */
+    uint16_t key_code1;
+    uint16_t key_code2;
+    /* Signed scroll amount in pixels, positive scrolls down/right */
+    int16_t scroll_amount;
+    /* ZOOM factor and ROTATE angle in radians as integer and 1/256 fraction parts */
+    int8_t integer_part;
+    uint8_t fraction_part;
+    /* HIDC */
+    uint8_t hidc_input_path;
+    uint8_t hidc_type;
+    uint8_t hidc_usage;
+    uint16_t hidc_report_length;
+    uint8_t hidc_report[UIBC_MAX_HIDC_REPORT_LEN];
+}
+UIBC_EVENT_STRUCT;
+
+/**
+ * Sink side of the WFD User Input Back Channel.
+ *
+ * The source announces its UIBC TCP port and the accepted input categories in
+ * M4 (wfd_uibc_capability, wfd_uibc_setting). The sink then connects without
+ * blocking and the socket joins the RTSP session epoll set. Injected events
+ * are encoded as one batch and written straight from the calling thread.
+ * Anything the socket does not take is flushed by the RTSP handler on EPOLLOUT.
+ */
+class MiracastUIBC
+{
+public:
+    explicit MiracastUIBC(MiracastRTSPLatencyStats &latency_stats);
+    ~MiracastUIBC();
+
+    /* wfd_uibc_capability and wfd_uibc_setting sent by the source */
+    bool update_capability(const RTSPStringView &capability);
+    void update_setting(bool enable);
+    bool is_enabled(void);
+
+    /* Called by the RTSP handler thread with its session epoll set */
+    bool start(int epoll_fd, const std::string &source_ip);
+    void stop(void);
+    int get_socket_fd(void) const { return m_socket_fd; }
+    void handle_socket_event(uint32_t events);
+
+    /* receive_time_us is when the request reached the sink, for the input-to-send latency */
+    bool send_events(const UIBC_EVENT_STRUCT *events, size_t count, uint64_t receive_time_us);
+
+    static size_t encode_event(const UIBC_EVENT_STRUCT &event, uint8_t *buffer, size_t buffer_len);
+
+private:
+    typedef struct uibc_pending_batch_st
+    {
+        /* Offset in m_pending just past the last byte of the batch */
+        size_t end_offset;
+        uint64_t receive_time_us;
+    }
+    UIBC_PENDING_BATCH_STRUCT;
+
+    std::mutex m_uibc_mutex;
+    MiracastRTSPLatencyStats &m_latency_stats;
+    int m_socket_fd;
+    int m_epoll_fd;
+    bool m_connected;
+    bool m_enabled;
+    unsigned short m_source_port;
+    unsigned int m_input_categories;
+    unsigned int m_generic_caps;
+    std::string m_pending;
+    size_t m_pending_offset;
+    std::deque<UIBC_PENDING_BATCH_STRUCT> m_pending_batches;
+
+    bool is_event_allowed(const UIBC_EVENT_STRUCT &event) const;
+    void close_socket(void);
+    void update_epoll_events(void);
+    bool flush_pending(void);
+};
+
+#endif
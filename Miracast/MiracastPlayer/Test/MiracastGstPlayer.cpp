@@ -69,6 +69,36 @@ bool MiracastGstPlayer::setVideoRectangle( VIDEO_RECT_STRUCT video_rect , bool a
 	return true;
 }
 
+bool MiracastGstPlayer::setLatencyProfile(eMIRA_GSTPLAYER_LATENCY_PROFILE latency_profile)
+{
+	if (MIRACAST_GSTPLAYER_LATENCY_PROFILE_MAX <= latency_profile)
+	{
+		return false;
+	}
+	m_latency_profile = latency_profile;
+	return true;
+}
+
+bool MiracastGstPlayer::setVideoSinkConfig(const MIRACAST_GSTPLAYER_SINK_CONFIG_STRUCT &sink_config)
+{
+	if (MIRACAST_GSTPLAYER_VIDEO_SINK_MAX <= sink_config.video_sink)
+	{
+		return false;
+	}
+	m_sink_config = sink_config;
+	return true;
+}
+
+void MiracastGstPlayer::setPipelineMode(eMIRA_GSTPLAYER_PIPELINE_MODE pipeline_mode)
+{
+	m_pipeline_mode = pipeline_mode;
+}
+
+void MiracastGstPlayer::setElementTracer(bool enable)
+{
+	m_element_tracer = enable;
+}
+
 bool MiracastGstPlayer::launch(std::string& localip , std::string& streaming_port, MiracastRTSPMsg *rtsp_instance)
 {
 	if ( nullptr != rtsp_instance )
@@ -79,6 +109,11 @@ bool MiracastGstPlayer::launch(std::string& localip , std::string& streaming_por
 	return true;
 }
 
+bool MiracastGstPlayer::setNegotiatedFormat(const RTSP_WFD_VIDEO_FMT_STRUCT &video_format, const RTSP_WFD_AUDIO_FMT_STRUCT &audio_format)
+{
+	return true;
+}
+
 bool MiracastGstPlayer::pause()
 {
 	return true;
@@ -0,0 +1,826 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Runs MiracastGstPlayer headless, with a fakesink or appsink in place of
+ * westerossink, and streams a synthetic WFD source into it over loopback RTP.
+ * Reports the frames per second reaching the sink, the CPU time of the player
+ * as a share of one core and the ingress to sink and to render latency the
+ * player measures itself.
+ *
+ * The stream is H.264 Constrained Baseline the player decodes like any other:
+ * IDR pictures of I_PCM macroblocks, so they cost no encoder to produce, and
+ * P pictures of skipped macroblocks in between. Filler NAL units bring every
+ * access unit up to the bitrate. One PES per access unit, PCR on its own PID
+ * and the PID layout of the WFD spec, seven TS packets per RTP packet spread
+ * over the frame interval. There is no audio stream.
+ *
+ *   MiracastGstPlayerBenchmark [-s fakesink|appsink] [-y] [-w] [-d seconds] [-f fps] [-r WxH]
+ *                              [-g gop] [-b Mbit/s] [-p port] [-m single|dual] [-l gaming|default|robust] [-v]
+ *
+ * -y renders on the clock, -w skips hardware decoders.
+ */
+
+#include <unistd.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MiracastLogger.h"
+#include "MiracastRTSPMsg.h"
+#include "MiracastGstPlayer.h"
+
+#define BENCHMARK_DFLT_DURATION_SEC   ( 10 )
+#define BENCHMARK_DFLT_FPS   ( 30 )
+#define BENCHMARK_DFLT_WIDTH   ( 640 )
+#define BENCHMARK_DFLT_HEIGHT   ( 480 )
+#define BENCHMARK_DFLT_GOP   ( 30 )
+#define BENCHMARK_DFLT_BITRATE_MBPS   ( 8 )
+#define BENCHMARK_DFLT_PORT   ( 1990 )
+#define BENCHMARK_FIRST_FRAME_TIMEOUT_MSEC   ( 10000 )
+#define BENCHMARK_PSI_INTERVAL_US   ( 100000 )
+/* Presentation time ahead of the PCR, about what WFD sources leave the sink */
+#define BENCHMARK_PTS_OFFSET_MS   ( 100 )
+#define BENCHMARK_TS_PER_RTP   ( 7 )
+#define BENCHMARK_RTP_HEADER_LEN   ( 12 )
+#define BENCHMARK_RTP_PAYLOAD_TYPE_MP2T   ( 33 )
+#define BENCHMARK_SNDBUF_SIZE   ( 4 * 1024 * 1024 )
+#define BENCHMARK_PROGRAM_NUMBER   ( 0x0001 )
+#define BENCHMARK_PAT_PID   ( 0x0000 )
+#define BENCHMARK_PMT_PID   ( 0x0100 )
+#define BENCHMARK_PCR_PID   ( 0x1000 )
+#define BENCHMARK_VIDEO_PID   ( 0x1011 )
+/* MaxFS of level 4, the level the SPS signals */
+#define BENCHMARK_MAX_FRAME_MBS   ( 8192 )
+/* log2_max_frame_num_minus4 is 0 */
+#define BENCHMARK_MAX_FRAME_NUM   ( 16 )
+/* IDR pictures with different content, idr_pic_id alternates between them */
+#define BENCHMARK_IDR_VARIANTS   ( 4 )
+#define BENCHMARK_PCM_BYTES_PER_MB   ( 256 + 128 )
+
+typedef struct benchmark_config_st
+{
+    MIRACAST_GSTPLAYER_SINK_CONFIG_STRUCT sink_config;
+    eMIRA_GSTPLAYER_PIPELINE_MODE pipeline_mode;
+    eMIRA_GSTPLAYER_LATENCY_PROFILE latency_profile;
+    unsigned int duration_sec;
+    unsigned int fps;
+    unsigned int width;
+    unsigned int height;
+    unsigned int gop;
+    unsigned int bitrate_mbps;
+    unsigned short port;
+} BENCHMARK_CONFIG_STRUCT;
+
+typedef struct benchmark_bit_writer_st
+{
+    std::vector<uint8_t> rbsp;
+    uint8_t current;
+    unsigned int bit_count;
+} BENCHMARK_BIT_WRITER_STRUCT;
+
+/* Coded once up front, the sender only stitches them together */
+typedef struct benchmark_stream_st
+{
+    std::vector<uint8_t> parameter_sets;
+    std::vector<uint8_t> idr_slices[BENCHMARK_IDR_VARIANTS];
+    std::vector<uint8_t> p_slices[BENCHMARK_MAX_FRAME_NUM];
+} BENCHMARK_STREAM_STRUCT;
+
+typedef struct benchmark_sender_st
+{
+    int socket_fd;
+    struct sockaddr_in destination;
+    uint16_t sequence;
+    uint8_t pat_cc;
+    uint8_t pmt_cc;
+    uint8_t video_cc;
+    uint64_t frames;
+    uint64_t rtp_packets;
+    uint64_t bytes;
+    uint64_t send_errors;
+    std::atomic<uint64_t> first_packet_us;
+    /* CPU time of the sender thread, taken off the process time */
+    std::atomic<uint64_t> cpu_us;
+} BENCHMARK_SENDER_STRUCT;
+
+static uint64_t get_process_cpu_time_us(void)
+{
+    struct rusage usage;
+
+    getrusage(RUSAGE_SELF, &usage);
+    return (static_cast<uint64_t>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000ULL) +
+           static_cast<uint64_t>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+static uint64_t get_thread_cpu_time_us(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return (static_cast<uint64_t>(now.tv_sec) * 1000000ULL) + (now.tv_nsec / 1000);
+}
+
+static void sleep_until_us(uint64_t wakeup_us)
+{
+    struct timespec wakeup;
+
+    wakeup.tv_sec = static_cast<time_t>(wakeup_us / 1000000ULL);
+    wakeup.tv_nsec = static_cast<long>((wakeup_us % 1000000ULL) * 1000);
+    while (EINTR == clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeup, nullptr));
+}
+
+static void put_bits(BENCHMARK_BIT_WRITER_STRUCT &writer, uint32_t value, unsigned int count)
+{
+    while (0 < count--)
+    {
+        writer.current = static_cast<uint8_t>((writer.current << 1) | ((value >> count) & 0x01));
+        if (8 == ++writer.bit_count)
+        {
+            writer.rbsp.push_back(writer.current);
+            writer.current = 0;
+            writer.bit_count = 0;
+        }
+    }
+}
+
+/* ue(v) */
+static void put_ue(BENCHMARK_BIT_WRITER_STRUCT &writer, uint32_t value)
+{
+    uint32_t code = value + 1;
+    unsigned int length = 0;
+
+    for (uint32_t rest = code; 1 < rest; rest >>= 1)
+    {
+        ++length;
+    }
+    put_bits(writer, 0, length);
+    put_bits(writer, code, length + 1);
+}
+
+/* se(v) */
+static void put_se(BENCHMARK_BIT_WRITER_STRUCT &writer, int32_t value)
+{
+    put_ue(writer, (0 < value) ? static_cast<uint32_t>(2 * value - 1) : static_cast<uint32_t>(-2 * value));
+}
+
+/* rbsp_trailing_bits() with the stop bit, pcm_alignment_zero_bit without */
+static void align_bits(BENCHMARK_BIT_WRITER_STRUCT &writer, bool stop_bit)
+{
+    if (stop_bit)
+    {
+        put_bits(writer, 1, 1);
+    }
+    while (0 != writer.bit_count)
+    {
+        put_bits(writer, 0, 1);
+    }
+}
+
+/* Annex B start code, NAL header and the RBSP with emulation prevention bytes */
+static void append_nal(std::vector<uint8_t> &stream, uint8_t nal_header, const std::vector<uint8_t> &rbsp)
+{
+    const uint8_t start_code[] = { 0x00, 0x00, 0x00, 0x01 };
+    unsigned int zeros = 0;
+
+    stream.insert(stream.end(), start_code, start_code + sizeof(start_code));
+    stream.push_back(nal_header);
+    for (uint8_t byte : rbsp)
+    {
+        if ((2 <= zeros) && (0x03 >= byte))
+        {
+            stream.push_back(0x03);
+            zeros = 0;
+        }
+        stream.push_back(byte);
+        zeros = (0x00 == byte) ? zeros + 1 : 0;
+    }
+}
+
+static void build_parameter_sets(const BENCHMARK_CONFIG_STRUCT &config, std::vector<uint8_t> &stream)
+{
+    BENCHMARK_BIT_WRITER_STRUCT sps = {},
+                                pps = {};
+
+    put_bits(sps, 66, 8);                       // profile_idc, Baseline
+    put_bits(sps, 0xC0, 8);                     // constraint_set0/1_flag, Constrained Baseline
+    put_bits(sps, 40, 8);                       // level_idc
+    put_ue(sps, 0);                             // seq_parameter_set_id
+    put_ue(sps, 0);                             // log2_max_frame_num_minus4
+    put_ue(sps, 2);                             // pic_order_cnt_type, output in decoding order
+    put_ue(sps, 1);                             // max_num_ref_frames
+    put_bits(sps, 0, 1);                        // gaps_in_frame_num_value_allowed_flag
+    put_ue(sps, (config.width / 16) - 1);       // pic_width_in_mbs_minus1
+    put_ue(sps, (config.height / 16) - 1);      // pic_height_in_map_units_minus1
+    put_bits(sps, 1, 1);                        // frame_mbs_only_flag
+    put_bits(sps, 1, 1);                        // direct_8x8_inference_flag
+    put_bits(sps, 0, 1);                        // frame_cropping_flag
+    put_bits(sps, 0, 1);                        // vui_parameters_present_flag
+    align_bits(sps, true);
+    append_nal(stream, 0x67, sps.rbsp);
+
+    put_ue(pps, 0);                             // pic_parameter_set_id
+    put_ue(pps, 0);                             // seq_parameter_set_id
+    put_bits(pps, 0, 1);                        // entropy_coding_mode_flag, CAVLC
+    put_bits(pps, 0, 1);                        // bottom_field_pic_order_in_frame_present_flag
+    put_ue(pps, 0);                             // num_slice_groups_minus1
+    put_ue(pps, 0);                             // num_ref_idx_l0_default_active_minus1
+    put_ue(pps, 0);                             // num_ref_idx_l1_default_active_minus1
+    put_bits(pps, 0, 1);                        // weighted_pred_flag
+    put_bits(pps, 0, 2);                        // weighted_bipred_idc
+    put_se(pps, 0);                             // pic_init_qp_minus26
+    put_se(pps, 0);                             // pic_init_qs_minus26
+    put_se(pps, 0);                             // chroma_qp_index_offset
+    put_bits(pps, 0, 1);                        // deblocking_filter_control_present_flag
+    put_bits(pps, 0, 1);                        // constrained_intra_pred_flag
+    put_bits(pps, 0, 1);                        // redundant_pic_cnt_present_flag
+    align_bits(pps, true);
+    append_nal(stream, 0x68, pps.rbsp);
+}
+
+/* Every macroblock I_PCM, a diagonal gradient that moves with the variant */
+static void build_idr_slice(const BENCHMARK_CONFIG_STRUCT &config, unsigned int variant, std::vector<uint8_t> &stream)
+{
+    BENCHMARK_BIT_WRITER_STRUCT slice = {};
+    unsigned int mb_width = config.width / 16,
+                 mb_height = config.height / 16;
+
+    slice.rbsp.reserve((mb_width * mb_height * (BENCHMARK_PCM_BYTES_PER_MB + 1)) + 16);
+    put_ue(slice, 0);                           // first_mb_in_slice
+    put_ue(slice, 7);                           // slice_type, I for the whole picture
+    put_ue(slice, 0);                           // pic_parameter_set_id
+    put_bits(slice, 0, 4);                      // frame_num
+    put_ue(slice, variant & 0x01);              // idr_pic_id, differs between consecutive IDRs
+    put_bits(slice, 0, 1);                      // no_output_of_prior_pics_flag
+    put_bits(slice, 0, 1);                      // long_term_reference_flag
+    put_se(slice, 0);                           // slice_qp_delta
+
+    for (unsigned int mb_y = 0; mb_y < mb_height; ++mb_y)
+    {
+        for (unsigned int mb_x = 0; mb_x < mb_width; ++mb_x)
+        {
+            put_ue(slice, 25);                  // mb_type, I_PCM
+            align_bits(slice, false);
+            for (unsigned int index = 0; index < 256; ++index)
+            {
+                unsigned int x = (mb_x * 16) + (index % 16),
+                             y = (mb_y * 16) + (index / 16);
+
+                // Kept away from 0, which early decoders reject as a PCM sample
+                slice.rbsp.push_back(static_cast<uint8_t>(16 + ((x + y + (variant * 64)) % 220)));
+            }
+            slice.rbsp.insert(slice.rbsp.end(), 128, 128);
+        }
+    }
+    align_bits(slice, true);
+    append_nal(stream, 0x65, slice.rbsp);
+}
+
+/* Every macroblock skipped, the picture is a copy of the previous one */
+static void build_p_slice(const BENCHMARK_CONFIG_STRUCT &config, unsigned int frame_num, std::vector<uint8_t> &stream)
+{
+    BENCHMARK_BIT_WRITER_STRUCT slice = {};
+
+    put_ue(slice, 0);                           // first_mb_in_slice
+    put_ue(slice, 5);                           // slice_type, P for the whole picture
+    put_ue(slice, 0);                           // pic_parameter_set_id
+    put_bits(slice, frame_num, 4);              // frame_num
+    put_bits(slice, 0, 1);                      // num_ref_idx_active_override_flag
+    put_bits(slice, 0, 1);                      // ref_pic_list_modification_flag_l0
+    put_bits(slice, 0, 1);                      // adaptive_ref_pic_marking_mode_flag
+    put_se(slice, 0);                           // slice_qp_delta
+    put_ue(slice, (config.width / 16) * (config.height / 16)); // mb_skip_run
+    align_bits(slice, true);
+    append_nal(stream, 0x41, slice.rbsp);
+}
+
+static void build_stream(const BENCHMARK_CONFIG_STRUCT &config, BENCHMARK_STREAM_STRUCT &stream)
+{
+    build_parameter_sets(config, stream.parameter_sets);
+    for (unsigned int variant = 0; variant < BENCHMARK_IDR_VARIANTS; ++variant)
+    {
+        build_idr_slice(config, variant, stream.idr_slices[variant]);
+    }
+    for (unsigned int frame_num = 1; frame_num < BENCHMARK_MAX_FRAME_NUM; ++frame_num)
+    {
+        build_p_slice(config, frame_num, stream.p_slices[frame_num]);
+    }
+    // frame_num 0 after a wrap, not only on an IDR
+    build_p_slice(config, 0, stream.p_slices[0]);
+}
+
+/* Access unit delimiter, the picture and filler data up to the share of the bitrate */
+static void build_access_unit(const BENCHMARK_CONFIG_STRUCT &config, const BENCHMARK_STREAM_STRUCT &stream,
+                              uint64_t frame, std::vector<uint8_t> &access_unit)
+{
+    const uint8_t delimiter[] = { 0x00, 0x00, 0x00, 0x01, 0x09, 0x50 };
+    size_t target_size = (static_cast<size_t>(config.bitrate_mbps) * 1000000 / 8) / config.fps;
+    unsigned int gop_index = static_cast<unsigned int>(frame % config.gop);
+
+    access_unit.assign(delimiter, delimiter + sizeof(delimiter));
+    if (0 == gop_index)
+    {
+        const std::vector<uint8_t> &idr = stream.idr_slices[(frame / config.gop) % BENCHMARK_IDR_VARIANTS];
+
+        access_unit.insert(access_unit.end(), stream.parameter_sets.begin(), stream.parameter_sets.end());
+        access_unit.insert(access_unit.end(), idr.begin(), idr.end());
+    }
+    else
+    {
+        const std::vector<uint8_t> &p_slice = stream.p_slices[gop_index % BENCHMARK_MAX_FRAME_NUM];
+
+        access_unit.insert(access_unit.end(), p_slice.begin(), p_slice.end());
+    }
+    if (access_unit.size() + 6 < target_size)
+    {
+        const uint8_t filler_header[] = { 0x00, 0x00, 0x00, 0x01, 0x0C };
+
+        access_unit.insert(access_unit.end(), filler_header, filler_header + sizeof(filler_header));
+        access_unit.insert(access_unit.end(), target_size - access_unit.size() - 1, 0xFF);
+        access_unit.push_back(0x80);
+    }
+}
+
+static uint32_t mpegts_crc32(const uint8_t *data, size_t length)
+{
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (size_t index = 0; index < length; ++index)
+    {
+        crc ^= static_cast<uint32_t>(data[index]) << 24;
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc & 0x80000000) ? ((crc << 1) ^ 0x04C11DB7) : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+static uint8_t *append_ts_packet(std::vector<uint8_t> &ts, uint16_t pid, bool unit_start, uint8_t adaptation_field_control, uint8_t &cc)
+{
+    size_t offset = ts.size();
+    uint8_t *packet = nullptr;
+
+    ts.resize(offset + TS_INSPECTOR_PACKET_SIZE, 0xFF);
+    packet = &ts[offset];
+    packet[0] = TS_INSPECTOR_SYNC_BYTE;
+    packet[1] = static_cast<uint8_t>((unit_start ? 0x40 : 0x00) | ((pid >> 8) & 0x1F));
+    packet[2] = static_cast<uint8_t>(pid & 0xFF);
+    packet[3] = static_cast<uint8_t>((adaptation_field_control << 4) | (cc & 0x0F));
+    // The counter only advances with a payload
+    if (0 != (adaptation_field_control & 0x01))
+    {
+        cc = static_cast<uint8_t>((cc + 1) & 0x0F);
+    }
+    return packet;
+}
+
+static void append_psi(std::vector<uint8_t> &ts, uint16_t pid, uint8_t &cc, const uint8_t *section, size_t length)
+{
+    uint8_t *packet = append_ts_packet(ts, pid, true, 0x01, cc);
+    uint8_t *table = packet + 5;
+    uint32_t crc = 0;
+
+    packet[4] = 0x00;
+    memcpy(table, section, length);
+    table[1] = static_cast<uint8_t>(0xB0 | (((length + 1) >> 8) & 0x0F));
+    table[2] = static_cast<uint8_t>((length + 1) & 0xFF);
+    crc = mpegts_crc32(table, length);
+    table[length] = static_cast<uint8_t>(crc >> 24);
+    table[length + 1] = static_cast<uint8_t>(crc >> 16);
+    table[length + 2] = static_cast<uint8_t>(crc >> 8);
+    table[length + 3] = static_cast<uint8_t>(crc);
+}
+
+static void append_program_tables(std::vector<uint8_t> &ts, BENCHMARK_SENDER_STRUCT &sender)
+{
+    const uint8_t pat[] = { 0x00, 0x00, 0x00,
+                            0x00, 0x01, 0xC1, 0x00, 0x00,
+                            (BENCHMARK_PROGRAM_NUMBER >> 8), (BENCHMARK_PROGRAM_NUMBER & 0xFF),
+                            (0xE0 | (BENCHMARK_PMT_PID >> 8)), (BENCHMARK_PMT_PID & 0xFF) };
+    const uint8_t pmt[] = { 0x02, 0x00, 0x00,
+                            (BENCHMARK_PROGRAM_NUMBER >> 8), (BENCHMARK_PROGRAM_NUMBER & 0xFF), 0xC1, 0x00, 0x00,
+                            (0xE0 | (BENCHMARK_PCR_PID >> 8)), (BENCHMARK_PCR_PID & 0xFF),
+                            0xF0, 0x00,
+                            0x1B, (0xE0 | (BENCHMARK_VIDEO_PID >> 8)), (BENCHMARK_VIDEO_PID & 0xFF), 0xF0, 0x00 };
+
+    append_psi(ts, BENCHMARK_PAT_PID, sender.pat_cc, pat, sizeof(pat));
+    append_psi(ts, BENCHMARK_PMT_PID, sender.pmt_cc, pmt, sizeof(pmt));
+}
+
+/* Adaptation field only, so the counter of the PCR PID stays where it is */
+static void append_pcr(std::vector<uint8_t> &ts, uint64_t pcr_27mhz)
+{
+    uint8_t cc = 0;
+    uint8_t *packet = append_ts_packet(ts, BENCHMARK_PCR_PID, false, 0x02, cc);
+    uint64_t base = pcr_27mhz / 300,
+             extension = pcr_27mhz % 300;
+
+    packet[4] = TS_INSPECTOR_PACKET_SIZE - 5;
+    packet[5] = 0x10;
+    packet[6] = static_cast<uint8_t>(base >> 25);
+    packet[7] = static_cast<uint8_t>(base >> 17);
+    packet[8] = static_cast<uint8_t>(base >> 9);
+    packet[9] = static_cast<uint8_t>(base >> 1);
+    packet[10] = static_cast<uint8_t>(((base & 0x01) << 7) | 0x7E | ((extension >> 8) & 0x01));
+    packet[11] = static_cast<uint8_t>(extension & 0xFF);
+}
+
+/* One unbounded video PES, the last packet padded through its adaptation field */
+static void append_pes(std::vector<uint8_t> &ts, BENCHMARK_SENDER_STRUCT &sender, const std::vector<uint8_t> &access_unit, uint64_t pts_90khz)
+{
+    uint8_t header[14] = { 0x00, 0x00, 0x01, 0xE0, 0x00, 0x00, 0x80, 0x80, 0x05 };
+    size_t header_offset = 0,
+           payload_offset = 0,
+           remaining = sizeof(header) + access_unit.size();
+
+    header[9] = static_cast<uint8_t>(0x21 | ((pts_90khz >> 29) & 0x0E));
+    header[10] = static_cast<uint8_t>(pts_90khz >> 22);
+    header[11] = static_cast<uint8_t>(0x01 | ((pts_90khz >> 14) & 0xFE));
+    header[12] = static_cast<uint8_t>(pts_90khz >> 7);
+    header[13] = static_cast<uint8_t>(0x01 | ((pts_90khz << 1) & 0xFE));
+
+    while (0 < remaining)
+    {
+        bool unit_start = (0 == header_offset) && (0 == payload_offset);
+        size_t chunk = std::min<size_t>(remaining, TS_INSPECTOR_PACKET_SIZE - 4);
+        uint8_t *packet = append_ts_packet(ts, BENCHMARK_VIDEO_PID, unit_start, (chunk < TS_INSPECTOR_PACKET_SIZE - 4) ? 0x03 : 0x01, sender.video_cc);
+        uint8_t *payload = packet + TS_INSPECTOR_PACKET_SIZE - chunk;
+
+        if (chunk < TS_INSPECTOR_PACKET_SIZE - 4)
+        {
+            // adaptation_field_length, then the flags and 0xFF stuffing when there is room for them
+            packet[4] = static_cast<uint8_t>(TS_INSPECTOR_PACKET_SIZE - 5 - chunk);
+            if (0 < packet[4])
+            {
+                packet[5] = 0x00;
+            }
+        }
+        remaining -= chunk;
+        while (0 < chunk)
+        {
+            size_t length = 0;
+
+            if (header_offset < sizeof(header))
+            {
+                length = std::min(chunk, sizeof(header) - header_offset);
+                memcpy(payload, header + header_offset, length);
+                header_offset += length;
+            }
+            else
+            {
+                length = chunk;
+                memcpy(payload, &access_unit[payload_offset], length);
+                payload_offset += length;
+            }
+            payload += length;
+            chunk -= length;
+        }
+    }
+}
+
+static void send_rtp(BENCHMARK_SENDER_STRUCT &sender, const uint8_t *ts, size_t length, uint32_t rtp_timestamp)
+{
+    uint8_t packet[BENCHMARK_RTP_HEADER_LEN + (BENCHMARK_TS_PER_RTP * TS_INSPECTOR_PACKET_SIZE)];
+
+    packet[0] = 0x80;
+    packet[1] = BENCHMARK_RTP_PAYLOAD_TYPE_MP2T;
+    packet[2] = static_cast<uint8_t>(sender.sequence >> 8);
+    packet[3] = static_cast<uint8_t>(sender.sequence);
+    packet[4] = static_cast<uint8_t>(rtp_timestamp >> 24);
+    packet[5] = static_cast<uint8_t>(rtp_timestamp >> 16);
+    packet[6] = static_cast<uint8_t>(rtp_timestamp >> 8);
+    packet[7] = static_cast<uint8_t>(rtp_timestamp);
+    packet[8] = 0x4D;
+    packet[9] = 0x43;
+    packet[10] = 0x53;
+    packet[11] = 0x54;
+    memcpy(packet + BENCHMARK_RTP_HEADER_LEN, ts, length);
+    sender.sequence++;
+
+    if (0 > sendto(sender.socket_fd, packet, BENCHMARK_RTP_HEADER_LEN + length, 0,
+                    reinterpret_cast<const struct sockaddr *>(&sender.destination), sizeof(sender.destination)))
+    {
+        sender.send_errors++;
+        return;
+    }
+    if (0 == sender.rtp_packets++)
+    {
+        sender.first_packet_us = MiracastCommon::get_monotonic_time_us();
+    }
+    sender.bytes += length;
+}
+
+/* A frame every 1/fps, its RTP packets spread over the interval as a rate controlled source would */
+static void sender_thread(const BENCHMARK_CONFIG_STRUCT &config, const BENCHMARK_STREAM_STRUCT &stream,
+                          BENCHMARK_SENDER_STRUCT &sender, std::atomic<bool> &running)
+{
+    uint64_t frame_count = static_cast<uint64_t>(config.duration_sec) * config.fps,
+             interval_us = 1000000ULL / config.fps,
+             start_us = MiracastCommon::get_monotonic_time_us(),
+             next_psi_us = 0;
+    std::vector<uint8_t> access_unit,
+                         ts;
+
+    for (uint64_t frame = 0; (running) && (frame < frame_count); ++frame)
+    {
+        uint64_t stream_us = frame * interval_us;
+        uint32_t rtp_timestamp = static_cast<uint32_t>((stream_us * 9) / 100);
+        size_t rtp_count = 0;
+
+        sleep_until_us(start_us + stream_us);
+        ts.clear();
+        if (stream_us >= next_psi_us)
+        {
+            append_program_tables(ts, sender);
+            next_psi_us += BENCHMARK_PSI_INTERVAL_US;
+        }
+        append_pcr(ts, stream_us * 27);
+        build_access_unit(config, stream, frame, access_unit);
+        append_pes(ts, sender, access_unit, ((stream_us * 9) / 100) + (BENCHMARK_PTS_OFFSET_MS * 90));
+
+        rtp_count = (ts.size() + (BENCHMARK_TS_PER_RTP * TS_INSPECTOR_PACKET_SIZE) - 1) / (BENCHMARK_TS_PER_RTP * TS_INSPECTOR_PACKET_SIZE);
+        for (size_t index = 0; index < rtp_count; ++index)
+        {
+            size_t offset = index * BENCHMARK_TS_PER_RTP * TS_INSPECTOR_PACKET_SIZE;
+
+            if (0 < index)
+            {
+                sleep_until_us(start_us + stream_us + ((index * interval_us) / rtp_count));
+            }
+            send_rtp(sender, &ts[offset], std::min<size_t>(ts.size() - offset, BENCHMARK_TS_PER_RTP * TS_INSPECTOR_PACKET_SIZE), rtp_timestamp);
+        }
+        sender.frames++;
+        sender.cpu_us = get_thread_cpu_time_us();
+    }
+}
+
+static bool parse_resolution(const char *value, BENCHMARK_CONFIG_STRUCT &config)
+{
+    unsigned int width = 0,
+                 height = 0;
+
+    if ((2 != sscanf(value, "%ux%u", &width, &height)) || (16 > width) || (16 > height))
+    {
+        return false;
+    }
+    // Whole macroblocks, there is no cropping in the SPS
+    config.width = width & ~0x0Fu;
+    config.height = height & ~0x0Fu;
+    return (BENCHMARK_MAX_FRAME_MBS >= (config.width / 16) * (config.height / 16));
+}
+
+int main(int argc, char **argv)
+{
+    BENCHMARK_CONFIG_STRUCT config = { { MIRACAST_GSTPLAYER_VIDEO_SINK_FAKESINK, false, false },
+                                        MIRACAST_GSTPLAYER_PIPELINE_MODE_DUAL, MIRACAST_GSTPLAYER_LATENCY_PROFILE_DEFAULT,
+                                        BENCHMARK_DFLT_DURATION_SEC, BENCHMARK_DFLT_FPS, BENCHMARK_DFLT_WIDTH, BENCHMARK_DFLT_HEIGHT,
+                                        BENCHMARK_DFLT_GOP, BENCHMARK_DFLT_BITRATE_MBPS, BENCHMARK_DFLT_PORT };
+    const char *profile_names[MIRACAST_GSTPLAYER_LATENCY_PROFILE_MAX] = { "gaming", "default", "robust" };
+    BENCHMARK_STREAM_STRUCT stream;
+    BENCHMARK_SENDER_STRUCT sender;
+    RTSP_WFD_VIDEO_FMT_STRUCT video_format = {};
+    RTSP_WFD_AUDIO_FMT_STRUCT audio_format = {};
+    MIRACAST_GSTPLAYER_LATENCY_STRUCT latency_start = {},
+                                      latency_end = {};
+    MIRACAST_PLAYER_STATISTICS_STRUCT statistics = {};
+    MiracastGstPlayer *player = nullptr;
+    std::atomic<bool> running(true);
+    std::thread sender_tid;
+    std::string local_ip = "127.0.0.1",
+                port;
+    uint64_t first_frame_us = 0,
+             window_start_us = 0,
+             window_end_us = 0,
+             cpu_start_us = 0,
+             cpu_end_us = 0,
+             sender_cpu_start_us = 0,
+             sender_cpu_end_us = 0,
+             window_frames = 0;
+    bool verbose = false,
+         usage = false;
+    int option = 0;
+
+    while (-1 != (option = getopt(argc, argv, "s:ywd:f:r:g:b:p:m:l:v")))
+    {
+        switch (option)
+        {
+            case 's':
+            {
+                if (0 == strcmp(optarg, "fakesink"))
+                {
+                    config.sink_config.video_sink = MIRACAST_GSTPLAYER_VIDEO_SINK_FAKESINK;
+                }
+                else if (0 == strcmp(optarg, "appsink"))
+                {
+                    config.sink_config.video_sink = MIRACAST_GSTPLAYER_VIDEO_SINK_APPSINK;
+                }
+                else
+                {
+                    usage = true;
+                }
+                break;
+            }
+            case 'y': config.sink_config.sync = true; break;
+            case 'w': config.sink_config.software_decode = true; break;
+            case 'd': config.duration_sec = static_cast<unsigned int>(std::max(1, atoi(optarg))); break;
+            case 'f': config.fps = static_cast<unsigned int>(std::max(1, atoi(optarg))); break;
+            case 'r': usage = !parse_resolution(optarg, config); break;
+            case 'g': config.gop = static_cast<unsigned int>(std::max(1, atoi(optarg))); break;
+            case 'b': config.bitrate_mbps = static_cast<unsigned int>(std::max(0, atoi(optarg))); break;
+            case 'p': config.port = static_cast<unsigned short>(atoi(optarg)); break;
+            case 'm':
+            {
+                if (0 == strcmp(optarg, "single"))
+                {
+                    config.pipeline_mode = MIRACAST_GSTPLAYER_PIPELINE_MODE_SINGLE;
+                }
+                else if (0 != strcmp(optarg, "dual"))
+                {
+                    usage = true;
+                }
+                break;
+            }
+            case 'l':
+            {
+                usage = true;
+                for (int profile = MIRACAST_GSTPLAYER_LATENCY_PROFILE_GAMING; profile < MIRACAST_GSTPLAYER_LATENCY_PROFILE_MAX; ++profile)
+                {
+                    if (0 == strcmp(optarg, profile_names[profile]))
+                    {
+                        config.latency_profile = static_cast<eMIRA_GSTPLAYER_LATENCY_PROFILE>(profile);
+                        usage = false;
+                    }
+                }
+                break;
+            }
+            case 'v': verbose = true; break;
+            default: usage = true; break;
+        }
+    }
+    if (usage)
+    {
+        fprintf(stderr, "usage: %s [-s fakesink|appsink] [-y] [-w] [-d seconds] [-f fps] [-r WxH] [-g gop] [-b Mbit/s] [-p port] "
+                        "[-m single|dual] [-l gaming|default|robust] [-v]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    MIRACAST::logger_init("MiracastGstPlayerBenchmark");
+    MIRACAST::set_loglevel(verbose ? MIRACAST::INFO_LEVEL : MIRACAST::ERROR_LEVEL);
+
+    build_stream(config, stream);
+    printf("%s sync %d software decode %d, %s pipeline, %s profile\n",
+            (MIRACAST_GSTPLAYER_VIDEO_SINK_APPSINK == config.sink_config.video_sink) ? "appsink" : "fakesink",
+            config.sink_config.sync, config.sink_config.software_decode,
+            (MIRACAST_GSTPLAYER_PIPELINE_MODE_SINGLE == config.pipeline_mode) ? "single" : "dual",
+            profile_names[config.latency_profile]);
+    printf("%ux%u at %u fps for %u s, gop %u, %u Mbit/s, IDR %zu bytes\n",
+            config.width, config.height, config.fps, config.duration_sec, config.gop, config.bitrate_mbps,
+            stream.parameter_sets.size() + stream.idr_slices[0].size());
+
+    sender.socket_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (0 > sender.socket_fd)
+    {
+        fprintf(stderr, "socket: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    int sndbuf_size = BENCHMARK_SNDBUF_SIZE;
+    setsockopt(sender.socket_fd, SOL_SOCKET, SO_SNDBUF, &sndbuf_size, sizeof(sndbuf_size));
+    memset(&sender.destination, 0x00, sizeof(sender.destination));
+    sender.destination.sin_family = AF_INET;
+    sender.destination.sin_port = htons(config.port);
+    inet_pton(AF_INET, local_ip.c_str(), &sender.destination.sin_addr);
+    sender.sequence = 0;
+    sender.pat_cc = 0;
+    sender.pmt_cc = 0;
+    sender.video_cc = 0;
+    sender.frames = 0;
+    sender.rtp_packets = 0;
+    sender.bytes = 0;
+    sender.send_errors = 0;
+    sender.first_packet_us = 0;
+    sender.cpu_us = 0;
+
+    player = MiracastGstPlayer::getInstance();
+    player->setPipelineMode(config.pipeline_mode);
+    player->setLatencyProfile(config.latency_profile);
+    player->setVideoSinkConfig(config.sink_config);
+    port = std::to_string(config.port);
+    if (!player->launch(local_ip, port, nullptr))
+    {
+        fprintf(stderr, "Unable to launch the player\n");
+        MiracastGstPlayer::destroyInstance();
+        close(sender.socket_fd);
+        return EXIT_FAILURE;
+    }
+    // What M4 would have settled on, so that the decode chain is built from it
+    video_format.st_h264_codecs.profile = RTSP_PROFILE_BMP_CBP_SUPPORTED;
+    video_format.st_h264_codecs.level = RTSP_H264_LEVEL_4_BITMAP;
+    video_format.st_h264_codecs.max_hres = static_cast<int32_t>(config.width);
+    video_format.st_h264_codecs.max_vres = static_cast<int32_t>(config.height);
+    player->setNegotiatedFormat(video_format, audio_format);
+
+    sender_tid = std::thread(sender_thread, std::cref(config), std::cref(stream), std::ref(sender), std::ref(running));
+
+    // The window starts with the first frame, the time to it is reported on its own
+    for (unsigned int waited_ms = 0; waited_ms < BENCHMARK_FIRST_FRAME_TIMEOUT_MSEC; ++waited_ms)
+    {
+        player->getLatencyStatistics(latency_start);
+        if (0 < latency_start.frames)
+        {
+            first_frame_us = MiracastCommon::get_monotonic_time_us();
+            break;
+        }
+        usleep(1000);
+    }
+    if (0 < first_frame_us)
+    {
+        window_start_us = first_frame_us;
+        cpu_start_us = get_process_cpu_time_us();
+        sender_cpu_start_us = sender.cpu_us;
+    }
+    else
+    {
+        running = false;
+    }
+    sender_tid.join();
+
+    if (0 < first_frame_us)
+    {
+        player->getLatencyStatistics(latency_end);
+        window_end_us = MiracastCommon::get_monotonic_time_us();
+        cpu_end_us = get_process_cpu_time_us();
+        sender_cpu_end_us = sender.cpu_us;
+    }
+    player->getPlayerStatistics(statistics);
+    MiracastGstPlayer::destroyInstance();
+    close(sender.socket_fd);
+
+    printf("sent %llu frames, %llu RTP packets, %.1f MB, %llu send errors\n",
+            static_cast<unsigned long long>(sender.frames),
+            static_cast<unsigned long long>(sender.rtp_packets),
+            sender.bytes / (1024.0 * 1024.0),
+            static_cast<unsigned long long>(sender.send_errors));
+    if (0 == first_frame_us)
+    {
+        printf("no frame reached the sink within %u ms\n", BENCHMARK_FIRST_FRAME_TIMEOUT_MSEC);
+        return EXIT_FAILURE;
+    }
+
+    uint64_t window_us = std::max<uint64_t>(1, window_end_us - window_start_us),
+             player_cpu_us = (cpu_end_us - cpu_start_us) - std::min(cpu_end_us - cpu_start_us, sender_cpu_end_us - sender_cpu_start_us);
+
+    window_frames = latency_end.frames - latency_start.frames;
+    printf("first frame %.1f ms after the first packet\n",
+            (first_frame_us > sender.first_packet_us) ? (first_frame_us - sender.first_packet_us) / 1000.0 : 0.0);
+    printf("fps %.2f, %llu frames into the sink in %.2f s, rendered %llu, dropped %llu\n",
+            (window_frames * 1000000.0) / window_us,
+            static_cast<unsigned long long>(window_frames),
+            window_us / 1000000.0,
+            static_cast<unsigned long long>(statistics.rendered_frames),
+            static_cast<unsigned long long>(statistics.dropped_frames));
+    printf("cpu %.1f ms, %.1f%% of one core, sender excluded\n",
+            player_cpu_us / 1000.0,
+            (100.0 * player_cpu_us) / window_us);
+    if (0 < window_frames)
+    {
+        printf("latency ingress to sink avg %.2f ms, ingress to render avg %.2f ms, max %.2f ms / %.2f ms over the run\n",
+                (latency_end.ingress_to_sink_sum_us - latency_start.ingress_to_sink_sum_us) / (1000.0 * window_frames),
+                (latency_end.ingress_to_render_sum_us - latency_start.ingress_to_render_sum_us) / (1000.0 * window_frames),
+                latency_end.ingress_to_sink_max_us / 1000.0,
+                latency_end.ingress_to_render_max_us / 1000.0);
+    }
+    printf("rtp lost %llu, late %llu, kernel drops %llu, ts cc errors %llu, qos dropped %llu\n",
+            static_cast<unsigned long long>(statistics.rtp_lost),
+            static_cast<unsigned long long>(statistics.rtp_late),
+            static_cast<unsigned long long>(statistics.kernel_drops),
+            static_cast<unsigned long long>(statistics.ts_cc_errors),
+            static_cast<unsigned long long>(statistics.qos_dropped));
+    return (0 < window_frames) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
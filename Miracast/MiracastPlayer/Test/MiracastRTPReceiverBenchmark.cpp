@@ -0,0 +1,441 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Streams RTP sized datagrams over 127.0.0.1 and compares two receivers:
+ *
+ *   recvmmsg  MiracastRTPReceiver, batched into the slot pool with a tuned rcvbuf
+ *   recvmsg   what udpsrc does, poll() and one recvmsg() per datagram on the
+ *             default socket buffer
+ *
+ * Like a WFD source, the sender emits every video frame as one burst, -f 0
+ * spreads the datagrams evenly instead. -s/-S make the receiving thread stall
+ * periodically to stand in for the CPU spikes that overflow the socket buffer
+ * on the box.
+ *
+ *   MiracastRTPReceiverBenchmark [-r Mbit/s, 0 unthrottled] [-d seconds] [-f frames/s] [-l datagram bytes]
+ *                                [-s stall ms] [-S stall interval ms] [-b rcvbuf bytes]
+ *                                [-m recvmmsg|recvmsg] [-v]
+ */
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include "MiracastLogger.h"
+#include "MiracastCommon.h"
+#include "MiracastRTPReceiver.h"
+
+#ifndef SO_RXQ_OVFL
+#define SO_RXQ_OVFL   ( 40 )
+#endif
+
+#define BENCHMARK_DFLT_RATE_MBPS   ( 40 )
+#define BENCHMARK_DFLT_DURATION_SEC   ( 5 )
+#define BENCHMARK_DFLT_FRAME_RATE   ( 60 )
+/* RTP header and 7 TS packets */
+#define BENCHMARK_DFLT_DATAGRAM_LEN   ( 12 + 7 * 188 )
+#define BENCHMARK_SEND_BATCH   ( 32 )
+#define BENCHMARK_DRAIN_IDLE_MSEC   ( 200 )
+
+typedef struct benchmark_config_st
+{
+    unsigned int rate_mbps;
+    unsigned int duration_sec;
+    unsigned int frame_rate;
+    unsigned int datagram_len;
+    unsigned int stall_ms;
+    unsigned int stall_interval_ms;
+    int rcvbuf_size;
+} BENCHMARK_CONFIG_STRUCT;
+
+typedef struct benchmark_result_st
+{
+    uint64_t sent;
+    uint64_t received;
+    uint64_t sequence_gaps;
+    uint64_t kernel_drops;
+    uint64_t syscalls;
+    uint64_t receiver_cpu_us;
+    uint64_t pool_exhausted;
+    int rcvbuf_size;
+} BENCHMARK_RESULT_STRUCT;
+
+static uint64_t get_thread_cpu_time_us(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return (static_cast<uint64_t>(now.tv_sec) * 1000000ULL) + (now.tv_nsec / 1000);
+}
+
+static void send_stream(unsigned short port, const BENCHMARK_CONFIG_STRUCT &config, uint64_t &sent)
+{
+    struct sockaddr_in addr = {0};
+    struct mmsghdr messages[BENCHMARK_SEND_BATCH];
+    struct iovec iovecs[BENCHMARK_SEND_BATCH];
+    uint8_t datagrams[BENCHMARK_SEND_BATCH][RTP_RECEIVER_SLOT_SIZE];
+    uint64_t start_us = MiracastCommon::get_monotonic_time_us(),
+             end_us = start_us + (config.duration_sec * 1000000ULL);
+    double packets_per_us = (static_cast<double>(config.rate_mbps) / 8.0) / config.datagram_len;
+    uint64_t frame_us = (0 < config.frame_rate) ? (1000000ULL / config.frame_rate) : 0;
+    uint16_t sequence = 0;
+    int socket_fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    sent = 0;
+    if (-1 == socket_fd)
+    {
+        fprintf(stderr, "sender socket: %s\n", strerror(errno));
+        return;
+    }
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    memset(datagrams, 0x47, sizeof(datagrams));
+    memset(messages, 0x00, sizeof(messages));
+    for (unsigned int index = 0; index < BENCHMARK_SEND_BATCH; ++index)
+    {
+        // RTP v2, MP2T payload type
+        datagrams[index][0] = 0x80;
+        datagrams[index][1] = 33;
+        iovecs[index].iov_base = datagrams[index];
+        iovecs[index].iov_len = config.datagram_len;
+        messages[index].msg_hdr.msg_name = &addr;
+        messages[index].msg_hdr.msg_namelen = sizeof(addr);
+        messages[index].msg_hdr.msg_iov = &iovecs[index];
+        messages[index].msg_hdr.msg_iovlen = 1;
+    }
+
+    for (uint64_t now_us = start_us; now_us < end_us; now_us = MiracastCommon::get_monotonic_time_us())
+    {
+        unsigned int batch = BENCHMARK_SEND_BATCH;
+
+        if (0 < config.rate_mbps)
+        {
+            uint64_t elapsed_us = now_us - start_us;
+            // Everything up to the end of the current frame is due at its start
+            uint64_t due = static_cast<uint64_t>(((0 < frame_us) ? (((elapsed_us / frame_us) + 1) * frame_us) : elapsed_us) * packets_per_us);
+
+            if (due <= sent)
+            {
+                usleep((0 < frame_us) ? static_cast<useconds_t>(frame_us - (elapsed_us % frame_us)) : 100);
+                continue;
+            }
+            batch = static_cast<unsigned int>(std::min<uint64_t>(due - sent, BENCHMARK_SEND_BATCH));
+        }
+        for (unsigned int index = 0; index < batch; ++index, ++sequence)
+        {
+            datagrams[index][2] = static_cast<uint8_t>(sequence >> 8);
+            datagrams[index][3] = static_cast<uint8_t>(sequence & 0xFF);
+        }
+
+        int count = sendmmsg(socket_fd, messages, batch, 0);
+
+        if (0 < count)
+        {
+            sent += count;
+            // Unsent datagrams go again with the next batch under their old sequence numbers
+            sequence = static_cast<uint16_t>(sequence - (batch - count));
+        }
+        else
+        {
+            sequence = static_cast<uint16_t>(sequence - batch);
+        }
+    }
+    close(socket_fd);
+}
+
+class ReceiverStall
+{
+public:
+    explicit ReceiverStall(const BENCHMARK_CONFIG_STRUCT &config)
+        : m_stall_ms(config.stall_ms), m_interval_ms(config.stall_interval_ms),
+          m_next_stall_us(MiracastCommon::get_monotonic_time_us() + (config.stall_interval_ms * 1000ULL)) {}
+
+    void check(void)
+    {
+        if ((0 == m_stall_ms) || (0 == m_interval_ms) || (MiracastCommon::get_monotonic_time_us() < m_next_stall_us))
+        {
+            return;
+        }
+        usleep(m_stall_ms * 1000);
+        m_next_stall_us = MiracastCommon::get_monotonic_time_us() + (m_interval_ms * 1000ULL);
+    }
+
+private:
+    unsigned int m_stall_ms;
+    unsigned int m_interval_ms;
+    uint64_t m_next_stall_us;
+};
+
+static void count_sequence(const uint8_t *data, size_t length, bool &first, uint16_t &expected, uint64_t &gaps)
+{
+    uint16_t sequence = 0;
+
+    if (4 > length)
+    {
+        return;
+    }
+    sequence = static_cast<uint16_t>((data[2] << 8) | data[3]);
+    if ((!first) && (sequence != expected))
+    {
+        gaps += static_cast<uint16_t>(sequence - expected);
+    }
+    first = false;
+    expected = static_cast<uint16_t>(sequence + 1);
+}
+
+static bool run_recvmmsg(const BENCHMARK_CONFIG_STRUCT &config, BENCHMARK_RESULT_STRUCT &result)
+{
+    MiracastRTPReceiver receiver;
+    RTP_RECEIVER_PACKET_STRUCT packets[RTP_RECEIVER_BATCH_SIZE];
+    RTP_RECEIVER_STATS_STRUCT stats;
+    std::atomic<bool> sending(true);
+    ReceiverStall stall(config);
+    uint64_t cpu_start_us = 0,
+             idle_since_us = 0;
+    uint16_t expected = 0;
+    bool first = true;
+
+    if (!receiver.open(0, config.rcvbuf_size))
+    {
+        return false;
+    }
+    std::thread sender([&]() { send_stream(receiver.get_port(), config, result.sent); sending = false; });
+
+    cpu_start_us = get_thread_cpu_time_us();
+    while (true)
+    {
+        int count = receiver.receive(packets, RTP_RECEIVER_BATCH_SIZE, 10);
+
+        if (0 < count)
+        {
+            for (int index = 0; index < count; ++index)
+            {
+                count_sequence(packets[index].data, packets[index].length, first, expected, result.sequence_gaps);
+                MiracastRTPReceiver::release_slot(packets[index].slot_handle);
+            }
+            result.received += count;
+            idle_since_us = 0;
+            stall.check();
+        }
+        else if (!sending)
+        {
+            uint64_t now_us = MiracastCommon::get_monotonic_time_us();
+
+            if (0 == idle_since_us)
+            {
+                idle_since_us = now_us;
+            }
+            else if ((now_us - idle_since_us) >= (BENCHMARK_DRAIN_IDLE_MSEC * 1000ULL))
+            {
+                break;
+            }
+        }
+    }
+    result.receiver_cpu_us = get_thread_cpu_time_us() - cpu_start_us;
+    sender.join();
+
+    receiver.get_statistics(stats);
+    result.kernel_drops = stats.kernel_drops;
+    result.syscalls = stats.syscalls;
+    result.pool_exhausted = stats.pool_exhausted;
+    result.rcvbuf_size = stats.rcvbuf_size;
+    return true;
+}
+
+static bool run_recvmsg(const BENCHMARK_CONFIG_STRUCT &config, BENCHMARK_RESULT_STRUCT &result)
+{
+    struct sockaddr_in addr = {0};
+    socklen_t addr_len = sizeof(addr);
+    socklen_t option_len = sizeof(result.rcvbuf_size);
+    uint8_t datagram[RTP_RECEIVER_SLOT_SIZE];
+    char control[CMSG_SPACE(sizeof(uint32_t))];
+    std::atomic<bool> sending(true);
+    ReceiverStall stall(config);
+    uint64_t cpu_start_us = 0,
+             idle_since_us = 0;
+    uint16_t expected = 0;
+    bool first = true;
+    int option = 1;
+    int socket_fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+
+    if (-1 == socket_fd)
+    {
+        return false;
+    }
+    setsockopt(socket_fd, SOL_SOCKET, SO_RXQ_OVFL, &option, sizeof(option));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if ((0 != bind(socket_fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr))) ||
+        (0 != getsockname(socket_fd, reinterpret_cast<struct sockaddr *>(&addr), &addr_len)))
+    {
+        close(socket_fd);
+        return false;
+    }
+    getsockopt(socket_fd, SOL_SOCKET, SO_RCVBUF, &result.rcvbuf_size, &option_len);
+    std::thread sender([&]() { send_stream(ntohs(addr.sin_port), config, result.sent); sending = false; });
+
+    cpu_start_us = get_thread_cpu_time_us();
+    while (true)
+    {
+        struct pollfd fds = {socket_fd, POLLIN, 0};
+        struct iovec iov = {datagram, sizeof(datagram)};
+        struct msghdr header;
+        ssize_t length = 0;
+
+        result.syscalls++;
+        if (0 < poll(&fds, 1, 10))
+        {
+            memset(&header, 0x00, sizeof(header));
+            header.msg_iov = &iov;
+            header.msg_iovlen = 1;
+            header.msg_control = control;
+            header.msg_controllen = sizeof(control);
+
+            result.syscalls++;
+            length = recvmsg(socket_fd, &header, 0);
+            if (0 < length)
+            {
+                for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&header); nullptr != cmsg; cmsg = CMSG_NXTHDR(&header, cmsg))
+                {
+                    if ((SOL_SOCKET == cmsg->cmsg_level) && (SO_RXQ_OVFL == cmsg->cmsg_type))
+                    {
+                        uint32_t drops = 0;
+
+                        memcpy(&drops, CMSG_DATA(cmsg), sizeof(drops));
+                        result.kernel_drops = drops;
+                    }
+                }
+                count_sequence(datagram, static_cast<size_t>(length), first, expected, result.sequence_gaps);
+                result.received++;
+                idle_since_us = 0;
+                stall.check();
+                continue;
+            }
+        }
+        if (!sending)
+        {
+            uint64_t now_us = MiracastCommon::get_monotonic_time_us();
+
+            if (0 == idle_since_us)
+            {
+                idle_since_us = now_us;
+            }
+            else if ((now_us - idle_since_us) >= (BENCHMARK_DRAIN_IDLE_MSEC * 1000ULL))
+            {
+                break;
+            }
+        }
+    }
+    result.receiver_cpu_us = get_thread_cpu_time_us() - cpu_start_us;
+    sender.join();
+    close(socket_fd);
+    return true;
+}
+
+static void print_result(const char *name, const BENCHMARK_RESULT_STRUCT &result, unsigned int duration_sec, unsigned int datagram_len)
+{
+    uint64_t lost = (result.sent > result.received) ? (result.sent - result.received) : 0;
+
+    printf("%-9s sent %8llu received %8llu lost %7llu (%6.3f%%) gaps %7llu kernel drops %7llu\n",
+            name,
+            static_cast<unsigned long long>(result.sent),
+            static_cast<unsigned long long>(result.received),
+            static_cast<unsigned long long>(lost),
+            result.sent ? (100.0 * lost) / result.sent : 0.0,
+            static_cast<unsigned long long>(result.sequence_gaps),
+            static_cast<unsigned long long>(result.kernel_drops));
+    printf("%-9s %7.1f Mbit/s, %9llu syscalls (%5.1f datagrams/syscall), cpu %7.1f us per 1000 datagrams, rcvbuf %d, pool stalls %llu\n",
+            "",
+            (result.received * datagram_len * 8.0) / (duration_sec * 1000000.0),
+            static_cast<unsigned long long>(result.syscalls),
+            result.syscalls ? static_cast<double>(result.received) / result.syscalls : 0.0,
+            result.received ? (1000.0 * result.receiver_cpu_us) / result.received : 0.0,
+            result.rcvbuf_size,
+            static_cast<unsigned long long>(result.pool_exhausted));
+}
+
+int main(int argc, char **argv)
+{
+    BENCHMARK_CONFIG_STRUCT config = { BENCHMARK_DFLT_RATE_MBPS, BENCHMARK_DFLT_DURATION_SEC, BENCHMARK_DFLT_FRAME_RATE, BENCHMARK_DFLT_DATAGRAM_LEN,
+                                       0, 0, RTP_RECEIVER_DFLT_RCVBUF_SIZE };
+    std::string mode = "";
+    bool verbose = false,
+         success = true;
+    int option = 0;
+
+    while (-1 != (option = getopt(argc, argv, "r:d:f:l:s:S:b:m:v")))
+    {
+        switch (option)
+        {
+            case 'r': config.rate_mbps = static_cast<unsigned int>(atoi(optarg)); break;
+            case 'd': config.duration_sec = static_cast<unsigned int>(std::max(1, atoi(optarg))); break;
+            case 'f': config.frame_rate = static_cast<unsigned int>(atoi(optarg)); break;
+            case 'l': config.datagram_len = std::min(static_cast<unsigned int>(std::max(4, atoi(optarg))), static_cast<unsigned int>(RTP_RECEIVER_SLOT_SIZE)); break;
+            case 's': config.stall_ms = static_cast<unsigned int>(atoi(optarg)); break;
+            case 'S': config.stall_interval_ms = static_cast<unsigned int>(atoi(optarg)); break;
+            case 'b': config.rcvbuf_size = atoi(optarg); break;
+            case 'm': mode = optarg; break;
+            case 'v': verbose = true; break;
+            default:
+            {
+                fprintf(stderr, "usage: %s [-r Mbit/s, 0 unthrottled] [-d seconds] [-f frames/s] [-l datagram bytes] [-s stall ms] [-S stall interval ms] [-b rcvbuf bytes] [-m recvmmsg|recvmsg] [-v]\n", argv[0]);
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    MIRACAST::logger_init("MiracastRTPReceiverBenchmark");
+    MIRACAST::set_loglevel(verbose ? MIRACAST::INFO_LEVEL : MIRACAST::ERROR_LEVEL);
+
+    printf("%u Mbit/s for %u s, %u frames/s, %u byte datagrams, stall %u ms every %u ms\n",
+            config.rate_mbps, config.duration_sec, config.frame_rate, config.datagram_len, config.stall_ms, config.stall_interval_ms);
+
+    if ((mode.empty()) || ("recvmsg" == mode))
+    {
+        BENCHMARK_RESULT_STRUCT result;
+
+        memset(&result, 0x00, sizeof(result));
+        success = run_recvmsg(config, result) && success;
+        print_result("recvmsg", result, config.duration_sec, config.datagram_len);
+    }
+    if ((mode.empty()) || ("recvmmsg" == mode))
+    {
+        BENCHMARK_RESULT_STRUCT result;
+
+        memset(&result, 0x00, sizeof(result));
+        success = run_recvmmsg(config, result) && success;
+        print_result("recvmmsg", result, config.duration_sec, config.datagram_len);
+    }
+
+    MIRACAST::logger_deinit();
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,370 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Drives MiracastRTSPMsg through back to back WFD sessions against the
+ * loopback source simulator and reports the session setup latency
+ * percentiles, the CPU time of the sink side per session and RSS growth.
+ * With -u every session also injects UIBC key events once the back channel
+ * is up and reports how long send_UIBCEvents() takes.
+ *
+ *   MiracastRTSPBenchmark [-n sessions] [-w warmup] [-k keep-alives]
+ *                         [-i keep-alive interval ms] [-d response delay ms]
+ *                         [-t pause,play,...] [-p port] [-m source MACs] [-u UIBC events] [-v]
+ *
+ * Every session ends with a TEARDOWN trigger from the source, sent after the
+ * keep-alives and the -t triggers.
+ */
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "MiracastLogger.h"
+#include "MiracastRTSPMsg.h"
+#include "MiracastWFDSourceSimulator.h"
+
+#define BENCHMARK_DFLT_SESSIONS   ( 1000 )
+#define BENCHMARK_DFLT_WARMUP_SESSIONS   ( 10 )
+#define BENCHMARK_DFLT_KEEP_ALIVE_INTERVAL_MSEC   ( 100 )
+#define BENCHMARK_SESSION_STOP_TIMEOUT_SEC   ( 30 )
+#define BENCHMARK_UIBC_START_TIMEOUT_MSEC   ( 5000 )
+
+class BenchmarkNotifier : public MiracastPlayerNotifier
+{
+public:
+    BenchmarkNotifier() : m_stopped(false), m_stopped_us(0), m_reason(MIRACAST_PLAYER_REASON_CODE_SUCCESS) {}
+
+    void onStateChange(const std::string& client_mac, const std::string& client_name, eMIRA_PLAYER_STATES player_state, eM_PLAYER_REASON_CODE reason_code) override
+    {
+        if (MIRACAST_PLAYER_STATE_STOPPED == player_state)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopped = true;
+            m_stopped_us = MiracastCommon::get_monotonic_time_us();
+            m_reason = reason_code;
+            m_condition.notify_all();
+        }
+    }
+
+    void reset(void)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopped = false;
+        m_stopped_us = 0;
+    }
+
+    bool wait_stopped(unsigned int timeout_sec, uint64_t &stopped_us, eM_PLAYER_REASON_CODE &reason)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        if (!m_condition.wait_for(lock, std::chrono::seconds(timeout_sec), [this] { return m_stopped; }))
+        {
+            return false;
+        }
+        stopped_us = m_stopped_us;
+        reason = m_reason;
+        return true;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stopped;
+    uint64_t m_stopped_us;
+    eM_PLAYER_REASON_CODE m_reason;
+};
+
+static uint64_t get_process_cpu_time_us(void)
+{
+    struct rusage usage;
+
+    getrusage(RUSAGE_SELF, &usage);
+    return (static_cast<uint64_t>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000ULL) +
+           static_cast<uint64_t>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+static long get_rss_kb(void)
+{
+    std::string rss = MiracastCommon::parse_opt_flag("/proc/self/statm");
+    long total_pages = 0,
+         resident_pages = 0;
+
+    if (2 != sscanf(rss.c_str(), "%ld %ld", &total_pages, &resident_pages))
+    {
+        return -1;
+    }
+    return resident_pages * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+static uint64_t get_percentile(const std::vector<uint64_t> &sorted, double percentile)
+{
+    size_t index = 0;
+
+    if (sorted.empty())
+    {
+        return 0;
+    }
+    index = static_cast<size_t>((percentile / 100.0) * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+/* Key down/up pairs, retried until the sink has connected the UIBC socket */
+static bool inject_uibc_events(MiracastRTSPMsg *rtsp_msg, unsigned int count, std::vector<uint64_t> &inject_us)
+{
+    uint64_t deadline_us = MiracastCommon::get_monotonic_time_us() + (BENCHMARK_UIBC_START_TIMEOUT_MSEC * 1000ULL);
+    UIBC_EVENT_STRUCT event;
+
+    memset(&event, 0x00, sizeof(event));
+    event.category = UIBC_INPUT_CATEGORY_GENERIC;
+    event.key_code1 = 0x0D;
+
+    for (unsigned int index = 0; index < count;)
+    {
+        uint64_t start_us = MiracastCommon::get_monotonic_time_us();
+
+        event.generic_ie_id = (0 == (index % 2)) ? UIBC_GENERIC_IE_KEY_DOWN : UIBC_GENERIC_IE_KEY_UP;
+        if (rtsp_msg->send_UIBCEvents(&event, 1, start_us))
+        {
+            inject_us.push_back(MiracastCommon::get_monotonic_time_us() - start_us);
+            ++index;
+        }
+        else if (start_us >= deadline_us)
+        {
+            return false;
+        }
+        else
+        {
+            usleep(1000);
+        }
+    }
+    return true;
+}
+
+static void print_distribution(const char *name, std::vector<uint64_t> &samples)
+{
+    uint64_t total = 0;
+
+    std::sort(samples.begin(), samples.end());
+    for (size_t index = 0; index < samples.size(); ++index)
+    {
+        total += samples[index];
+    }
+    printf("%-16s min %8.3f  p50 %8.3f  p90 %8.3f  p99 %8.3f  max %8.3f  avg %8.3f ms\n",
+            name,
+            samples.empty() ? 0.0 : samples.front() / 1000.0,
+            get_percentile(samples, 50) / 1000.0,
+            get_percentile(samples, 90) / 1000.0,
+            get_percentile(samples, 99) / 1000.0,
+            samples.empty() ? 0.0 : samples.back() / 1000.0,
+            samples.empty() ? 0.0 : (static_cast<double>(total) / samples.size()) / 1000.0);
+}
+
+int main(int argc, char **argv)
+{
+    WFD_SOURCE_SIM_CONFIG_STRUCT config;
+    MiracastWFDSourceSimulator simulator;
+    BenchmarkNotifier notifier;
+    MiracastError error_code = MIRACAST_OK;
+    MiracastRTSPMsg *rtsp_msg = nullptr;
+    std::vector<uint64_t> setup_us,
+                          session_us,
+                          uibc_inject_us;
+    unsigned int sessions = BENCHMARK_DFLT_SESSIONS,
+                 warmup = BENCHMARK_DFLT_WARMUP_SESSIONS,
+                 source_count = 1,
+                 uibc_events = 0,
+                 failures = 0;
+    RTSP_PARAM_CACHE_COUNTERS_STRUCT cache_counters = {};
+    unsigned short port = 0;
+    uint64_t source_cpu_us = 0,
+             cpu_start_us = 0,
+             wall_start_us = 0;
+    long rss_start_kb = 0;
+    bool verbose = false;
+    int option = 0;
+
+    MiracastWFDSourceSimulator::get_default_config(config);
+    config.keep_alive_interval_ms = BENCHMARK_DFLT_KEEP_ALIVE_INTERVAL_MSEC;
+    config.wait_for_sink_teardown = false;
+
+    while (-1 != (option = getopt(argc, argv, "n:w:k:i:d:t:p:m:u:v")))
+    {
+        switch (option)
+        {
+            case 'n': sessions = static_cast<unsigned int>(atoi(optarg)); break;
+            case 'w': warmup = static_cast<unsigned int>(atoi(optarg)); break;
+            case 'k': config.keep_alive_count = static_cast<unsigned int>(atoi(optarg)); break;
+            case 'i': config.keep_alive_interval_ms = static_cast<unsigned int>(atoi(optarg)); break;
+            case 'd': config.response_delay_ms = static_cast<unsigned int>(atoi(optarg)); break;
+            case 't':
+            {
+                std::stringstream triggers(optarg);
+                std::string trigger;
+
+                while (std::getline(triggers, trigger, ','))
+                {
+                    if ("pause" == trigger)
+                    {
+                        config.triggers.push_back(WFD_SOURCE_SIM_TRIGGER_PAUSE);
+                    }
+                    else if ("play" == trigger)
+                    {
+                        config.triggers.push_back(WFD_SOURCE_SIM_TRIGGER_PLAY);
+                    }
+                }
+            }
+            break;
+            case 'p': port = static_cast<unsigned short>(atoi(optarg)); break;
+            case 'm': source_count = std::max(1, atoi(optarg)); break;
+            case 'u': uibc_events = static_cast<unsigned int>(atoi(optarg)); break;
+            case 'v': verbose = true; break;
+            default:
+            {
+                fprintf(stderr, "usage: %s [-n sessions] [-w warmup] [-k keep-alives] [-i keep-alive interval ms] [-d response delay ms] [-t pause,play,...] [-p port] [-m source MACs] [-u UIBC events] [-v]\n", argv[0]);
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    config.triggers.push_back(WFD_SOURCE_SIM_TRIGGER_TEARDOWN);
+    config.uibc_packets = uibc_events;
+
+    MIRACAST::logger_init("MiracastRTSPBenchmark");
+    MIRACAST::set_loglevel(verbose ? MIRACAST::INFO_LEVEL : MIRACAST::ERROR_LEVEL);
+
+    if (!simulator.start(port))
+    {
+        fprintf(stderr, "Failed to start the WFD source simulator\n");
+        return EXIT_FAILURE;
+    }
+
+    rtsp_msg = MiracastRTSPMsg::getInstance(error_code, &notifier);
+    if (nullptr == rtsp_msg)
+    {
+        fprintf(stderr, "Failed to create the RTSP handler [%d]\n", error_code);
+        return EXIT_FAILURE;
+    }
+
+    setup_us.reserve(sessions);
+    session_us.reserve(sessions);
+
+    for (unsigned int index = 0; index < (warmup + sessions); ++index)
+    {
+        WFD_SOURCE_SIM_RESULT_STRUCT result;
+        RTSP_HLDR_MSGQ_STRUCT rtsp_hldr_msgq_data;
+        eM_PLAYER_REASON_CODE reason = MIRACAST_PLAYER_REASON_CODE_SUCCESS;
+        uint64_t start_us = 0,
+                 stopped_us = 0;
+        bool stopped = false,
+             uibc_injected = true;
+
+        if (warmup == index)
+        {
+            rss_start_kb = get_rss_kb();
+            uibc_inject_us.clear();
+            source_cpu_us = 0;
+            cpu_start_us = get_process_cpu_time_us();
+            wall_start_us = MiracastCommon::get_monotonic_time_us();
+        }
+
+        memset(&rtsp_hldr_msgq_data, 0x00, sizeof(rtsp_hldr_msgq_data));
+        strncpy(rtsp_hldr_msgq_data.source_dev_ip, WFD_SOURCE_SIM_LOOPBACK_IP, sizeof(rtsp_hldr_msgq_data.source_dev_ip) - 1);
+        strncpy(rtsp_hldr_msgq_data.sink_dev_ip, WFD_SOURCE_SIM_LOOPBACK_IP, sizeof(rtsp_hldr_msgq_data.sink_dev_ip) - 1);
+        // Cycling through more MACs than the param cache holds makes every session a cache miss
+        snprintf(rtsp_hldr_msgq_data.source_dev_mac, sizeof(rtsp_hldr_msgq_data.source_dev_mac), "02:00:00:00:%02x:%02x",
+                 ((index % source_count) >> 8) & 0xFF, (index % source_count) & 0xFF);
+        strncpy(rtsp_hldr_msgq_data.source_dev_name, "Benchmark", sizeof(rtsp_hldr_msgq_data.source_dev_name) - 1);
+        rtsp_hldr_msgq_data.videorect.width = 1920;
+        rtsp_hldr_msgq_data.videorect.height = 1080;
+        rtsp_hldr_msgq_data.source_rtsp_port = simulator.get_port();
+        rtsp_hldr_msgq_data.state = RTSP_START_RECEIVE_MSGS;
+
+        notifier.reset();
+        std::thread source_thread([&simulator, &config, &result]() { simulator.run_session(config, result); });
+
+        start_us = MiracastCommon::get_monotonic_time_us();
+        rtsp_msg->send_msgto_rtsp_msg_hdler_thread(rtsp_hldr_msgq_data);
+
+        if (0 < uibc_events)
+        {
+            uibc_injected = inject_uibc_events(rtsp_msg, uibc_events, uibc_inject_us);
+        }
+        stopped = notifier.wait_stopped(BENCHMARK_SESSION_STOP_TIMEOUT_SEC, stopped_us, reason);
+        source_thread.join();
+
+        if ((!stopped) || (WFD_SOURCE_SIM_OK != result.status) ||
+            (MIRACAST_PLAYER_REASON_CODE_SRC_DEV_REQ_TO_STOP != reason) || (0 == result.play_response_us) ||
+            (!uibc_injected) || (uibc_events != result.uibc_packets_received))
+        {
+            ++failures;
+            fprintf(stderr, "session[%u] failed: source[%s] stopped[%d] reason[%#x]\n",
+                    index,
+                    MiracastWFDSourceSimulator::get_status_name(result.status),
+                    stopped,
+                    reason);
+            if (!stopped)
+            {
+                break;
+            }
+            continue;
+        }
+
+        if (warmup <= index)
+        {
+            setup_us.push_back(result.play_response_us - start_us);
+            session_us.push_back(stopped_us - start_us);
+            source_cpu_us += result.cpu_time_us;
+        }
+    }
+
+    uint64_t sink_cpu_us = get_process_cpu_time_us() - cpu_start_us - source_cpu_us;
+    uint64_t wall_us = MiracastCommon::get_monotonic_time_us() - wall_start_us;
+    long rss_end_kb = get_rss_kb();
+    size_t measured = setup_us.size();
+
+    printf("sessions %zu measured, %u warm-up, %u failed, %u keep-alives each, wall %.3f s\n",
+            measured, warmup, failures, config.keep_alive_count, wall_us / 1000000.0);
+    print_distribution("session setup", setup_us);
+    print_distribution("session", session_us);
+    if (0 < uibc_events)
+    {
+        print_distribution("uibc inject", uibc_inject_us);
+    }
+    printf("sink cpu/session %.1f us, source cpu/session %.1f us\n",
+            measured ? static_cast<double>(sink_cpu_us) / measured : 0.0,
+            measured ? static_cast<double>(source_cpu_us) / measured : 0.0);
+    printf("rss %ld kB -> %ld kB (%+ld kB)\n", rss_start_kb, rss_end_kb, rss_end_kb - rss_start_kb);
+    rtsp_msg->get_RTSPParamCacheCounters(cache_counters);
+    printf("param cache %u sources, %u hits, %u misses, %u invalidations\n",
+            cache_counters.entries, cache_counters.hits, cache_counters.misses, cache_counters.invalidations);
+
+    MiracastRTSPMsg::destroyInstance();
+    simulator.stop();
+    MIRACAST::logger_deinit();
+
+    return (0 == failures) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
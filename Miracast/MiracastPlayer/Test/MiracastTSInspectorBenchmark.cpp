@@ -0,0 +1,290 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Builds a WFD like transport stream in memory (PAT, PMT, video with PCR and
+ * audio), cuts it into buffers and runs MiracastTSInspector over it, then
+ * reports the inspector CPU time as a share of the stream duration along with
+ * the continuity, sync and PCR figures it found against what was injected.
+ *
+ *   MiracastTSInspectorBenchmark [-r Mbit/s] [-d seconds] [-b buffer bytes] [-c cc error every N video packets]
+ *                                [-s junk bytes every N buffers] [-j arrival jitter us] [-v]
+ */
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <vector>
+#include "MiracastLogger.h"
+#include "MiracastTSInspector.h"
+
+#define BENCHMARK_DFLT_RATE_MBPS   ( 40 )
+#define BENCHMARK_DFLT_DURATION_SEC   ( 10 )
+/* 7 TS packets, one RTP payload */
+#define BENCHMARK_DFLT_BUFFER_LEN   ( 7 * TS_INSPECTOR_PACKET_SIZE )
+#define BENCHMARK_PAT_PID   ( 0x0000 )
+#define BENCHMARK_PMT_PID   ( 0x0100 )
+#define BENCHMARK_VIDEO_PID   ( 0x1011 )
+#define BENCHMARK_AUDIO_PID   ( 0x1100 )
+#define BENCHMARK_PSI_INTERVAL_US   ( 100000 )
+#define BENCHMARK_PCR_INTERVAL_US   ( 30000 )
+/* One packet in twenty is audio */
+#define BENCHMARK_AUDIO_SHARE   ( 20 )
+#define BENCHMARK_JUNK_LEN   ( 5 )
+#define BENCHMARK_ROUNDS   ( 5 )
+
+typedef struct benchmark_config_st
+{
+    unsigned int rate_mbps;
+    unsigned int duration_sec;
+    unsigned int buffer_len;
+    unsigned int cc_error_interval;
+    unsigned int junk_interval;
+    unsigned int jitter_us;
+} BENCHMARK_CONFIG_STRUCT;
+
+typedef struct benchmark_buffer_st
+{
+    size_t offset;
+    size_t length;
+    uint64_t arrival_us;
+} BENCHMARK_BUFFER_STRUCT;
+
+static uint64_t get_thread_cpu_time_us(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return (static_cast<uint64_t>(now.tv_sec) * 1000000ULL) + (now.tv_nsec / 1000);
+}
+
+static void write_packet(std::vector<uint8_t> &stream, uint16_t pid, uint8_t &cc, const uint64_t *pcr_27mhz)
+{
+    size_t offset = stream.size();
+    uint8_t *packet = nullptr;
+
+    stream.resize(offset + TS_INSPECTOR_PACKET_SIZE, 0xFF);
+    packet = &stream[offset];
+    packet[0] = TS_INSPECTOR_SYNC_BYTE;
+    packet[1] = static_cast<uint8_t>((pid >> 8) & 0x1F);
+    packet[2] = static_cast<uint8_t>(pid & 0xFF);
+    if (pcr_27mhz)
+    {
+        uint64_t base = *pcr_27mhz / 300,
+                 extension = *pcr_27mhz % 300;
+
+        // Adaptation field with a PCR, then payload
+        packet[3] = static_cast<uint8_t>(0x30 | (cc & 0x0F));
+        packet[4] = 7;
+        packet[5] = 0x10;
+        packet[6] = static_cast<uint8_t>(base >> 25);
+        packet[7] = static_cast<uint8_t>(base >> 17);
+        packet[8] = static_cast<uint8_t>(base >> 9);
+        packet[9] = static_cast<uint8_t>(base >> 1);
+        packet[10] = static_cast<uint8_t>(((base & 0x01) << 7) | 0x7E | ((extension >> 8) & 0x01));
+        packet[11] = static_cast<uint8_t>(extension & 0xFF);
+    }
+    else
+    {
+        packet[3] = static_cast<uint8_t>(0x10 | (cc & 0x0F));
+    }
+    cc = static_cast<uint8_t>((cc + 1) & 0x0F);
+}
+
+/* Also hands back how many continuity errors and sync losses were injected */
+static void build_stream(const BENCHMARK_CONFIG_STRUCT &config, std::vector<uint8_t> &stream,
+                         std::vector<BENCHMARK_BUFFER_STRUCT> &buffers, uint64_t &cc_errors, uint64_t &sync_losses)
+{
+    double packet_us = (TS_INSPECTOR_PACKET_SIZE * 8.0) / config.rate_mbps;
+    uint64_t packet_count = static_cast<uint64_t>((config.duration_sec * 1000000.0) / packet_us),
+             next_psi_us = 0,
+             next_pcr_us = 0,
+             video_packets = 0;
+    uint8_t pat_cc = 0,
+            pmt_cc = 0,
+            video_cc = 0,
+            audio_cc = 0;
+    std::vector<uint64_t> packet_times;
+
+    cc_errors = 0;
+    sync_losses = 0;
+    stream.reserve(packet_count * TS_INSPECTOR_PACKET_SIZE);
+    packet_times.reserve(packet_count);
+    srand(1);
+
+    for (uint64_t index = 0; index < packet_count; ++index)
+    {
+        uint64_t now_us = static_cast<uint64_t>(index * packet_us);
+
+        if (now_us >= next_psi_us)
+        {
+            write_packet(stream, BENCHMARK_PAT_PID, pat_cc, nullptr);
+            write_packet(stream, BENCHMARK_PMT_PID, pmt_cc, nullptr);
+            packet_times.push_back(now_us);
+            packet_times.push_back(now_us);
+            next_psi_us += BENCHMARK_PSI_INTERVAL_US;
+            continue;
+        }
+        if (0 == (index % BENCHMARK_AUDIO_SHARE))
+        {
+            write_packet(stream, BENCHMARK_AUDIO_PID, audio_cc, nullptr);
+        }
+        else
+        {
+            uint64_t pcr_27mhz = now_us * 27;
+
+            if ((0 < config.cc_error_interval) && (0 == (++video_packets % config.cc_error_interval)))
+            {
+                // A lost packet as seen by the receiver
+                video_cc = static_cast<uint8_t>((video_cc + 1) & 0x0F);
+                cc_errors++;
+            }
+            write_packet(stream, BENCHMARK_VIDEO_PID, video_cc, (now_us >= next_pcr_us) ? &pcr_27mhz : nullptr);
+            if (now_us >= next_pcr_us)
+            {
+                next_pcr_us += BENCHMARK_PCR_INTERVAL_US;
+            }
+        }
+        packet_times.push_back(now_us);
+    }
+
+    // Cut into buffers, each arriving with the time of its last packet plus the network jitter
+    std::vector<uint8_t> with_junk;
+    size_t offset = 0;
+    unsigned int buffer_index = 0;
+
+    with_junk.reserve(stream.size() + (stream.size() / config.buffer_len + 1) * BENCHMARK_JUNK_LEN);
+    while (offset < stream.size())
+    {
+        BENCHMARK_BUFFER_STRUCT buffer;
+        size_t length = std::min<size_t>(config.buffer_len, stream.size() - offset);
+        size_t last_packet = (offset + length - 1) / TS_INSPECTOR_PACKET_SIZE;
+
+        buffer.offset = with_junk.size();
+        if ((0 < config.junk_interval) && (0 < buffer_index) && (0 == (buffer_index % config.junk_interval)))
+        {
+            with_junk.insert(with_junk.end(), BENCHMARK_JUNK_LEN, 0x00);
+            sync_losses++;
+        }
+        with_junk.insert(with_junk.end(), stream.begin() + offset, stream.begin() + offset + length);
+        buffer.length = with_junk.size() - buffer.offset;
+        buffer.arrival_us = 1 + packet_times[std::min(last_packet, packet_times.size() - 1)] +
+                            ((0 < config.jitter_us) ? static_cast<uint64_t>(rand() % (config.jitter_us + 1)) : 0);
+        buffers.push_back(buffer);
+        offset += length;
+        buffer_index++;
+    }
+    stream.swap(with_junk);
+}
+
+int main(int argc, char **argv)
+{
+    BENCHMARK_CONFIG_STRUCT config = { BENCHMARK_DFLT_RATE_MBPS, BENCHMARK_DFLT_DURATION_SEC, BENCHMARK_DFLT_BUFFER_LEN, 0, 0, 0 };
+    std::vector<uint8_t> stream;
+    std::vector<BENCHMARK_BUFFER_STRUCT> buffers;
+    TS_INSPECTOR_STATS_STRUCT stats;
+    uint64_t cc_errors = 0,
+             sync_losses = 0,
+             best_cpu_us = 0;
+    bool verbose = false,
+         success = true;
+    int option = 0;
+
+    while (-1 != (option = getopt(argc, argv, "r:d:b:c:s:j:v")))
+    {
+        switch (option)
+        {
+            case 'r': config.rate_mbps = static_cast<unsigned int>(std::max(1, atoi(optarg))); break;
+            case 'd': config.duration_sec = static_cast<unsigned int>(std::max(1, atoi(optarg))); break;
+            case 'b': config.buffer_len = static_cast<unsigned int>(std::max(1, atoi(optarg))); break;
+            case 'c': config.cc_error_interval = static_cast<unsigned int>(atoi(optarg)); break;
+            case 's': config.junk_interval = static_cast<unsigned int>(atoi(optarg)); break;
+            case 'j': config.jitter_us = static_cast<unsigned int>(atoi(optarg)); break;
+            case 'v': verbose = true; break;
+            default:
+            {
+                fprintf(stderr, "usage: %s [-r Mbit/s] [-d seconds] [-b buffer bytes] [-c cc error every N video packets] [-s junk bytes every N buffers] [-j arrival jitter us] [-v]\n", argv[0]);
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    MIRACAST::logger_init("MiracastTSInspectorBenchmark");
+    MIRACAST::set_loglevel(verbose ? MIRACAST::INFO_LEVEL : MIRACAST::ERROR_LEVEL);
+
+    build_stream(config, stream, buffers, cc_errors, sync_losses);
+    printf("%u Mbit/s for %u s, %zu buffers of %u bytes, %llu cc errors and %llu sync losses injected, jitter up to %u us\n",
+            config.rate_mbps, config.duration_sec, buffers.size(), config.buffer_len,
+            static_cast<unsigned long long>(cc_errors), static_cast<unsigned long long>(sync_losses), config.jitter_us);
+
+    // Best of a few rounds, the first one also pays for faulting the stream in
+    for (unsigned int round = 0; round < BENCHMARK_ROUNDS; ++round)
+    {
+        MiracastTSInspector inspector;
+        uint64_t cpu_start_us = get_thread_cpu_time_us(),
+                 cpu_us = 0;
+
+        for (size_t index = 0; index < buffers.size(); ++index)
+        {
+            inspector.inspect(&stream[buffers[index].offset], buffers[index].length, buffers[index].arrival_us);
+        }
+        cpu_us = get_thread_cpu_time_us() - cpu_start_us;
+        best_cpu_us = (0 == round) ? cpu_us : std::min(best_cpu_us, cpu_us);
+        inspector.get_statistics(stats);
+    }
+
+    printf("cpu %.1f ms for %u s of stream, %.3f%% of one core, %.1f ns per packet\n",
+            best_cpu_us / 1000.0,
+            config.duration_sec,
+            (100.0 * best_cpu_us) / (config.duration_sec * 1000000.0),
+            stats.packets ? (1000.0 * best_cpu_us) / stats.packets : 0.0);
+    printf("packets %llu, cc errors %llu, sync losses %llu, skipped bytes %llu, untracked %llu\n",
+            static_cast<unsigned long long>(stats.packets),
+            static_cast<unsigned long long>(stats.cc_errors),
+            static_cast<unsigned long long>(stats.sync_losses),
+            static_cast<unsigned long long>(stats.skipped_bytes),
+            static_cast<unsigned long long>(stats.untracked_packets));
+    printf("pcr pid 0x%04x, %llu pcrs, %llu resets, jitter %llu us, max %llu us\n",
+            stats.pcr_pid,
+            static_cast<unsigned long long>(stats.pcr_count),
+            static_cast<unsigned long long>(stats.pcr_resets),
+            static_cast<unsigned long long>(stats.pcr_jitter_us),
+            static_cast<unsigned long long>(stats.pcr_jitter_max_us));
+    for (unsigned int index = 0; index < stats.pid_count; ++index)
+    {
+        printf("  pid 0x%04x packets %9llu cc errors %6llu %7u kbit/s\n",
+                stats.pids[index].pid,
+                static_cast<unsigned long long>(stats.pids[index].packets),
+                static_cast<unsigned long long>(stats.pids[index].cc_errors),
+                stats.pids[index].bitrate_kbps);
+    }
+
+    if ((cc_errors != stats.cc_errors) || (sync_losses != stats.sync_losses))
+    {
+        printf("MISMATCH: expected %llu cc errors and %llu sync losses\n",
+                static_cast<unsigned long long>(cc_errors), static_cast<unsigned long long>(sync_losses));
+        success = false;
+    }
+
+    MIRACAST::logger_deinit();
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,767 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <MiracastCommon.h>
+#include "MiracastWFDSourceSimulator.h"
+
+#define WFD_SOURCE_SIM_STATUS_CODE_OK   ( 200 )
+#define WFD_SOURCE_SIM_URI   "rtsp://localhost/wfd1.0"
+#define WFD_SOURCE_SIM_PUBLIC_HEADER   "Public: org.wfa.wfd1.0, SETUP, TEARDOWN, PLAY, PAUSE, GET_PARAMETER, SET_PARAMETER\r\n"
+#define WFD_SOURCE_SIM_SERVER_PORTS   "19000-19001"
+#define WFD_SOURCE_SIM_M3_BODY   "wfd_video_formats\r\nwfd_audio_codecs\r\nwfd_client_rtp_ports\r\nwfd_content_protection\r\nwfd_uibc_capability\r\n"
+#define WFD_SOURCE_SIM_UIBC_HEADER_LEN   ( 4 )
+
+static uint64_t get_thread_cpu_time_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (static_cast<uint64_t>(ts.tv_sec) * 1000000ULL) + (static_cast<uint64_t>(ts.tv_nsec) / 1000ULL);
+}
+
+static void sleep_msec(unsigned int delay_ms)
+{
+    if (0 < delay_ms)
+    {
+        usleep(delay_ms * 1000);
+    }
+}
+
+static int listen_loopback(unsigned short port, unsigned short &bound_port)
+{
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    int optval = 1;
+    int listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if (-1 == listen_fd)
+    {
+        MIRACASTLOG_ERROR("socket failed: [%s]", strerror(errno));
+        return -1;
+    }
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval));
+
+    memset(&addr, 0x00, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if ((0 != bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr))) ||
+        (0 != listen(listen_fd, 1)) ||
+        (0 != getsockname(listen_fd, (struct sockaddr *)&addr, &addr_len)))
+    {
+        MIRACASTLOG_ERROR("Failed to listen on port[%u]: [%s]", port, strerror(errno));
+        close(listen_fd);
+        return -1;
+    }
+    bound_port = ntohs(addr.sin_port);
+    return listen_fd;
+}
+
+MiracastWFDSourceSimulator::MiracastWFDSourceSimulator()
+{
+    m_listen_fd = -1;
+    m_session_fd = -1;
+    m_uibc_listen_fd = -1;
+    m_port = 0;
+    m_uibc_port = 0;
+    m_cseq = 0;
+}
+
+MiracastWFDSourceSimulator::~MiracastWFDSourceSimulator()
+{
+    stop();
+}
+
+void MiracastWFDSourceSimulator::get_default_config(WFD_SOURCE_SIM_CONFIG_STRUCT &config)
+{
+    config.server_name = WFD_SOURCE_SIM_DFLT_SERVER_NAME;
+    config.video_format = WFD_SOURCE_SIM_DFLT_VIDEO_FORMAT;
+    config.audio_codec = WFD_SOURCE_SIM_DFLT_AUDIO_CODEC;
+    config.accept_timeout_ms = WFD_SOURCE_SIM_DFLT_ACCEPT_TIMEOUT_MSEC;
+    config.response_timeout_ms = WFD_SOURCE_SIM_DFLT_RESPONSE_TIMEOUT_MSEC;
+    config.m1_delay_ms = 0;
+    config.request_delay_ms = 0;
+    config.response_delay_ms = 0;
+    config.session_timeout_sec = WFD_SOURCE_SIM_DFLT_SESSION_TIMEOUT_SEC;
+    config.keep_alive_count = 0;
+    config.keep_alive_interval_ms = 1000;
+    config.triggers.clear();
+    config.wait_for_sink_teardown = true;
+    config.sink_teardown_timeout_ms = WFD_SOURCE_SIM_DFLT_RESPONSE_TIMEOUT_MSEC;
+    config.uibc_packets = 0;
+}
+
+const char *MiracastWFDSourceSimulator::get_status_name(WFD_SOURCE_SIM_STATUS status)
+{
+    switch (status)
+    {
+        case WFD_SOURCE_SIM_OK: return "OK";
+        case WFD_SOURCE_SIM_SOCKET_ERROR: return "SOCKET_ERROR";
+        case WFD_SOURCE_SIM_ACCEPT_TIMEOUT: return "ACCEPT_TIMEOUT";
+        case WFD_SOURCE_SIM_RESPONSE_TIMEOUT: return "RESPONSE_TIMEOUT";
+        case WFD_SOURCE_SIM_UNEXPECTED_MSG: return "UNEXPECTED_MSG";
+        case WFD_SOURCE_SIM_ERROR_STATUS_RECEIVED: return "ERROR_STATUS_RECEIVED";
+        case WFD_SOURCE_SIM_SINK_CLOSED: return "SINK_CLOSED";
+        default: break;
+    }
+    return "UNKNOWN";
+}
+
+bool MiracastWFDSourceSimulator::start(unsigned short port)
+{
+    stop();
+
+    m_listen_fd = listen_loopback(port, m_port);
+    // UIBC is only offered in M4 when a session asks for it, the listener is kept ready
+    m_uibc_listen_fd = listen_loopback(0, m_uibc_port);
+    if ((-1 == m_listen_fd) || (-1 == m_uibc_listen_fd))
+    {
+        stop();
+        return false;
+    }
+    MIRACASTLOG_INFO("WFD source simulator listening on [%s:%u] UIBC port[%u]", WFD_SOURCE_SIM_LOOPBACK_IP, m_port, m_uibc_port);
+    return true;
+}
+
+void MiracastWFDSourceSimulator::stop(void)
+{
+    close_session();
+    if (-1 != m_listen_fd)
+    {
+        close(m_listen_fd);
+        m_listen_fd = -1;
+    }
+    if (-1 != m_uibc_listen_fd)
+    {
+        close(m_uibc_listen_fd);
+        m_uibc_listen_fd = -1;
+    }
+    m_port = 0;
+    m_uibc_port = 0;
+}
+
+WFD_SOURCE_SIM_STATUS MiracastWFDSourceSimulator::accept_session(unsigned int timeout_ms)
+{
+    struct pollfd listen_poll;
+    int optval = 1;
+
+    listen_poll.fd = m_listen_fd;
+    listen_poll.events = POLLIN;
+    listen_poll.revents = 0;
+
+    if (-1 == m_listen_fd)
+    {
+        return WFD_SOURCE_SIM_SOCKET_ERROR;
+    }
+    if (0 >= poll(&listen_poll, 1, static_cast<int>(timeout_ms)))
+    {
+        return WFD_SOURCE_SIM_ACCEPT_TIMEOUT;
+    }
+
+    m_session_fd = accept4(m_listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (-1 == m_session_fd)
+    {
+        MIRACASTLOG_ERROR("accept failed: [%s]", strerror(errno));
+        return WFD_SOURCE_SIM_SOCKET_ERROR;
+    }
+    setsockopt(m_session_fd, IPPROTO_TCP, TCP_NODELAY, &optval, sizeof(optval));
+
+    m_stream.reset();
+    m_cseq = 0;
+    m_client_port.clear();
+    return WFD_SOURCE_SIM_OK;
+}
+
+void MiracastWFDSourceSimulator::close_session(void)
+{
+    if (-1 != m_session_fd)
+    {
+        close(m_session_fd);
+        m_session_fd = -1;
+    }
+}
+
+WFD_SOURCE_SIM_STATUS MiracastWFDSourceSimulator::send_buffer(void)
+{
+    size_t sent_length = 0;
+
+    while (sent_length < m_send_buffer.length())
+    {
+        ssize_t sent = send(m_session_fd, m_send_buffer.data() + sent_length, m_send_buffer.length() - sent_length, MSG_NOSIGNAL);
+
+        if (0 > sent)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            return WFD_SOURCE_SIM_SINK_CLOSED;
+        }
+        sent_length += static_cast<size_t>(sent);
+    }
+    return WFD_SOURCE_SIM_OK;
+}
+
+WFD_SOURCE_SIM_STATUS MiracastWFDSourceSimulator::receive_message(unsigned int timeout_ms)
+{
+    uint64_t deadline_us = MiracastCommon::get_monotonic_time_us() + (static_cast<uint64_t>(timeout_ms) * 1000ULL);
+
+    while (true)
+    {
+        RTSP_STREAM_FRAME_STATE frame_state = m_stream.next_message();
+        struct pollfd session_poll;
+        uint64_t now_us = MiracastCommon::get_monotonic_time_us();
+        size_t available = 0;
+        char *write_buffer = nullptr;
+        ssize_t received = 0;
+
+        if (RTSP_STREAM_FRAME_COMPLETE == frame_state)
+        {
+            return WFD_SOURCE_SIM_OK;
+        }
+        if (now_us >= deadline_us)
+        {
+            if ((RTSP_STREAM_FRAME_UNTERMINATED == frame_state) && (m_stream.take_pending()))
+            {
+                return WFD_SOURCE_SIM_OK;
+            }
+            return WFD_SOURCE_SIM_RESPONSE_TIMEOUT;
+        }
+
+        session_poll.fd = m_session_fd;
+        session_poll.events = POLLIN;
+        session_poll.revents = 0;
+        int poll_ret = poll(&session_poll, 1, static_cast<int>((deadline_us - now_us + 999) / 1000));
+
+        if ((0 == poll_ret) || ((0 > poll_ret) && (EINTR == errno)))
+        {
+            continue;
+        }
+        if (0 > poll_ret)
+        {
+            return WFD_SOURCE_SIM_SOCKET_ERROR;
+        }
+
+        write_buffer = m_stream.get_write_buffer(available);
+        if (nullptr == write_buffer)
+        {
+            return WFD_SOURCE_SIM_UNEXPECTED_MSG;
+        }
+        received = recv(m_session_fd, write_buffer, available, 0);
+        if (0 < received)
+        {
+            m_stream.commit_write(static_cast<size_t>(received));
+        }
+        else if ((0 > received) && ((EINTR == errno) || (EAGAIN == errno)))
+        {
+            continue;
+        }
+        else
+        {
+            return WFD_SOURCE_SIM_SINK_CLOSED;
+        }
+    }
+}
+
+WFD_SOURCE_SIM_STATUS MiracastWFDSourceSimulator::send_request(const char *method,
+                                                               const char *uri,
+                                                               const char *headers,
+                                                               const std::string &body,
+                                                               unsigned int &cseq)
+{
+    cseq = ++m_cseq;
+
+    m_send_buffer.assign(method).append(" ").append(uri).append(" RTSP/1.0\r\nCSeq: ");
+    m_send_buffer.append(std::to_string(cseq)).append("\r\n").append(headers);
+    if (!body.empty())
+    {
+        m_send_buffer.append("Content-Type: text/parameters\r\nContent-Length: ");
+        m_send_buffer.append(std::to_string(body.length())).append("\r\n");
+    }
+    m_send_buffer.append("\r\n").append(body);
+
+    return send_buffer();
+}
+
+WFD_SOURCE_SIM_STATUS MiracastWFDSourceSimulator::send_response(const RTSPStringView &cseq, const std::string &headers, unsigned int delay_ms)
+{
+    sleep_msec(delay_ms);
+
+    m_send_buffer.assign("RTSP/1.0 200 OK\r\nCSeq: ");
+    m_send_buffer.append(cseq.data(), cseq.length()).append("\r\n").append(headers).append("\r\n");
+
+    return send_buffer();
+}
+
+WFD_SOURCE_SIM_STATUS MiracastWFDSourceSimulator::handle_sink_request(const WFD_SOURCE_SIM_CONFIG_STRUCT &config, WFD_SOURCE_SIM_RESULT_STRUCT &result)
+{
+    const MiracastRTSPParser &sink_msg = m_stream.get_parser();
+    RTSPStringView cseq = sink_msg.get_header(RTSP_HEADER_CSEQ);
+    std::string session_header = "Session: " WFD_SOURCE_SIM_DFLT_SESSION_ID ";timeout=" + std::to_string(config.session_timeout_sec) + "\r\n";
+    WFD_SOURCE_SIM_STATUS status = WFD_SOURCE_SIM_OK;
+
+    switch (sink_msg.get_method())
+    {
+        case RTSP_METHOD_OPTIONS:
+        {
+            status = send_response(cseq, WFD_SOURCE_SIM_PUBLIC_HEADER, config.response_delay_ms);
+        }
+        break;
+        case RTSP_METHOD_SETUP:
+        {
+            RTSPStringView transport = sink_msg.get_header(RTSP_HEADER_TRANSPORT);
+            size_t client_port_pos = transport.find("client_port=");
+
+            if (RTSPStringView::npos == client_port_pos)
+            {
+                return WFD_SOURCE_SIM_UNEXPECTED_MSG;
+            }
+            transport.substr(client_port_pos).assign_to(m_client_port);
+            status = send_response(cseq,
+                                   session_header + "Transport: RTP/AVP/UDP;unicast;" + m_client_port + ";server_port=" WFD_SOURCE_SIM_SERVER_PORTS "\r\n",
+                                   config.response_delay_ms);
+        }
+        break;
+        case RTSP_METHOD_PLAY:
+        {
+            status = send_response(cseq, session_header + "Range: npt=now-\r\n", config.response_delay_ms);
+            if ((WFD_SOURCE_SIM_OK == status) && (0 == result.play_response_us))
+            {
+                result.play_response_us = MiracastCommon::get_monotonic_time_us();
+            }
+        }
+        break;
+        case RTSP_METHOD_PAUSE:
+        case RTSP_METHOD_GET_PARAMETER:
+        case RTSP_METHOD_SET_PARAMETER:
+        {
+            status = send_response(cseq, session_header, config.response_delay_ms);
+        }
+        break;
+        case RTSP_METHOD_TEARDOWN:
+        {
+            // The sink closes right after TEARDOWN, so the response may not make it
+            send_response(cseq, session_header, 0);
+            result.sink_teardown_received = true;
+            status = WFD_SOURCE_SIM_SINK_CLOSED;
+        }
+        break;
+        default:
+        {
+            MIRACASTLOG_ERROR("Unexpected request [%.*s]",
+                                static_cast<int>(sink_msg.get_start_line().length()),
+                                sink_msg.get_start_line().data());
+            status = WFD_SOURCE_SIM_UNEXPECTED_MSG;
+        }
+        break;
+    }
+    return status;
+}
+
+WFD_SOURCE_SIM_STATUS MiracastWFDSourceSimulator::wait_response(unsigned int cseq, const WFD_SOURCE_SIM_CONFIG_STRUCT &config, WFD_SOURCE_SIM_RESULT_STRUCT &result)
+{
+    const MiracastRTSPParser &sink_msg = m_stream.get_parser();
+    WFD_SOURCE_SIM_STATUS status = WFD_SOURCE_SIM_OK;
+    unsigned long received_cseq = 0;
+
+    while (WFD_SOURCE_SIM_OK == (status = receive_message(config.response_timeout_ms)))
+    {
+        if (RTSP_START_LINE_REQUEST == sink_msg.get_start_line_type())
+        {
+            status = handle_sink_request(config, result);
+            if (WFD_SOURCE_SIM_OK != status)
+            {
+                break;
+            }
+            continue;
+        }
+
+        if ((!sink_msg.get_header(RTSP_HEADER_CSEQ).to_uint(received_cseq)) || (cseq != received_cseq))
+        {
+            MIRACASTLOG_ERROR("Expected CSeq[%u] got [%.*s]",
+                                cseq,
+                                static_cast<int>(sink_msg.get_start_line().length()),
+                                sink_msg.get_start_line().data());
+            status = WFD_SOURCE_SIM_UNEXPECTED_MSG;
+        }
+        else if (WFD_SOURCE_SIM_STATUS_CODE_OK != sink_msg.get_status_code())
+        {
+            MIRACASTLOG_ERROR("Sink replied [%.*s] to CSeq[%u]",
+                                static_cast<int>(sink_msg.get_start_line().length()),
+                                sink_msg.get_start_line().data(),
+                                cseq);
+            status = WFD_SOURCE_SIM_ERROR_STATUS_RECEIVED;
+        }
+        break;
+    }
+    return status;
+}
+
+WFD_SOURCE_SIM_STATUS MiracastWFDSourceSimulator::wait_request(RTSP_METHOD method, const WFD_SOURCE_SIM_CONFIG_STRUCT &config, WFD_SOURCE_SIM_RESULT_STRUCT &result)
+{
+    const MiracastRTSPParser &sink_msg = m_stream.get_parser();
+    WFD_SOURCE_SIM_STATUS status = WFD_SOURCE_SIM_OK;
+
+    while (WFD_SOURCE_SIM_OK == (status = receive_message(config.response_timeout_ms)))
+    {
+        if (RTSP_START_LINE_REQUEST != sink_msg.get_start_line_type())
+        {
+            MIRACASTLOG_WARNING("Ignoring [%.*s] while waiting for a request",
+                                static_cast<int>(sink_msg.get_start_line().length()),
+                                sink_msg.get_start_line().data());
+            continue;
+        }
+
+        RTSP_METHOD received_method = sink_msg.get_method();
+
+        status = handle_sink_request(config, result);
+        if ((WFD_SOURCE_SIM_OK != status) || (method == received_method))
+        {
+            break;
+        }
+    }
+    return status;
+}
+
+WFD_SOURCE_SIM_STATUS MiracastWFDSourceSimulator::service_sink(unsigned int duration_ms, const WFD_SOURCE_SIM_CONFIG_STRUCT &config, WFD_SOURCE_SIM_RESULT_STRUCT &result)
+{
+    uint64_t deadline_us = MiracastCommon::get_monotonic_time_us() + (static_cast<uint64_t>(duration_ms) * 1000ULL);
+    WFD_SOURCE_SIM_STATUS status = WFD_SOURCE_SIM_OK;
+
+    while (true)
+    {
+        uint64_t now_us = MiracastCommon::get_monotonic_time_us();
+
+        if (now_us >= deadline_us)
+        {
+            break;
+        }
+        status = receive_message(static_cast<unsigned int>((deadline_us - now_us + 999) / 1000));
+        if (WFD_SOURCE_SIM_RESPONSE_TIMEOUT == status)
+        {
+            status = WFD_SOURCE_SIM_OK;
+            break;
+        }
+        if (WFD_SOURCE_SIM_OK != status)
+        {
+            break;
+        }
+        if (RTSP_START_LINE_REQUEST == m_stream.get_parser().get_start_line_type())
+        {
+            status = handle_sink_request(config, result);
+            if (WFD_SOURCE_SIM_OK != status)
+            {
+                break;
+            }
+        }
+    }
+    return status;
+}
+
+WFD_SOURCE_SIM_STATUS MiracastWFDSourceSimulator::run_m1_m7(const WFD_SOURCE_SIM_CONFIG_STRUCT &config, WFD_SOURCE_SIM_RESULT_STRUCT &result)
+{
+    const MiracastRTSPParser &sink_msg = m_stream.get_parser();
+    std::string headers = "Require: org.wfa.wfd1.0\r\nServer: " + config.server_name + "\r\n";
+    std::string body;
+    unsigned int cseq = 0;
+    WFD_SOURCE_SIM_STATUS status = WFD_SOURCE_SIM_OK;
+
+    // M1 and M2
+    sleep_msec(config.m1_delay_ms);
+    status = send_request("OPTIONS", "*", headers.c_str(), body, cseq);
+    if (WFD_SOURCE_SIM_OK == status)
+    {
+        status = wait_response(cseq, config, result);
+    }
+    if (WFD_SOURCE_SIM_OK == status)
+    {
+        status = wait_request(RTSP_METHOD_OPTIONS, config, result);
+    }
+
+    // M3
+    if (WFD_SOURCE_SIM_OK == status)
+    {
+        sleep_msec(config.request_delay_ms);
+        status = send_request("GET_PARAMETER", WFD_SOURCE_SIM_URI, "", WFD_SOURCE_SIM_M3_BODY, cseq);
+    }
+    if (WFD_SOURCE_SIM_OK == status)
+    {
+        status = wait_response(cseq, config, result);
+    }
+    if ((WFD_SOURCE_SIM_OK == status) &&
+        ((!sink_msg.has_wfd_param(RTSP_WFD_PARAM_VIDEO_FORMATS)) || (!sink_msg.has_wfd_param(RTSP_WFD_PARAM_CLIENT_RTP_PORTS))))
+    {
+        MIRACASTLOG_ERROR("M3 response misses wfd_video_formats/wfd_client_rtp_ports");
+        status = WFD_SOURCE_SIM_UNEXPECTED_MSG;
+    }
+
+    // M4
+    if (WFD_SOURCE_SIM_OK == status)
+    {
+        body = "wfd_video_formats: " + config.video_format + "\r\n";
+        body += "wfd_audio_codecs: " + config.audio_codec + "\r\n";
+        body += "wfd_presentation_URL: " WFD_SOURCE_SIM_PRESENTATION_URL " none\r\n";
+        body += "wfd_client_rtp_ports: " + sink_msg.get_wfd_param(RTSP_WFD_PARAM_CLIENT_RTP_PORTS).to_string() + "\r\n";
+        if (0 < config.uibc_packets)
+        {
+            body += "wfd_uibc_capability: input_category_list=GENERIC, HIDC;generic_cap_list=Keyboard, Mouse, SingleTouch;hidc_cap_list=none;port=" +
+                    std::to_string(m_uibc_port) + "\r\n";
+            body += "wfd_uibc_setting: enable\r\n";
+        }
+
+        sleep_msec(config.request_delay_ms);
+        status = send_request("SET_PARAMETER", WFD_SOURCE_SIM_URI, "", body, cseq);
+    }
+    if (WFD_SOURCE_SIM_OK == status)
+    {
+        status = wait_response(cseq, config, result);
+    }
+
+    // M5, the sink follows up with M6 SETUP and M7 PLAY
+    if (WFD_SOURCE_SIM_OK == status)
+    {
+        sleep_msec(config.request_delay_ms);
+        status = send_request("SET_PARAMETER", WFD_SOURCE_SIM_URI, "", "wfd_trigger_method: SETUP\r\n", cseq);
+    }
+    if (WFD_SOURCE_SIM_OK == status)
+    {
+        status = wait_response(cseq, config, result);
+    }
+    if (WFD_SOURCE_SIM_OK == status)
+    {
+        status = wait_request(RTSP_METHOD_SETUP, config, result);
+    }
+    if (WFD_SOURCE_SIM_OK == status)
+    {
+        status = wait_request(RTSP_METHOD_PLAY, config, result);
+    }
+    return status;
+}
+
+WFD_SOURCE_SIM_STATUS MiracastWFDSourceSimulator::receive_uibc(const WFD_SOURCE_SIM_CONFIG_STRUCT &config, WFD_SOURCE_SIM_RESULT_STRUCT &result)
+{
+    struct pollfd uibc_poll;
+    uint8_t buffer[4096];
+    size_t buffer_len = 0;
+    uint64_t deadline_us = MiracastCommon::get_monotonic_time_us() + (static_cast<uint64_t>(config.response_timeout_ms) * 1000);
+    WFD_SOURCE_SIM_STATUS status = WFD_SOURCE_SIM_OK;
+    int uibc_fd = -1;
+
+    uibc_poll.fd = m_uibc_listen_fd;
+    uibc_poll.events = POLLIN;
+    uibc_poll.revents = 0;
+    if (0 >= poll(&uibc_poll, 1, static_cast<int>(config.accept_timeout_ms)))
+    {
+        MIRACASTLOG_ERROR("Sink did not connect to the UIBC port[%u]", m_uibc_port);
+        return WFD_SOURCE_SIM_ACCEPT_TIMEOUT;
+    }
+    uibc_fd = accept4(m_uibc_listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (-1 == uibc_fd)
+    {
+        MIRACASTLOG_ERROR("UIBC accept failed: [%s]", strerror(errno));
+        return WFD_SOURCE_SIM_SOCKET_ERROR;
+    }
+
+    while (result.uibc_packets_received < config.uibc_packets)
+    {
+        uint64_t now_us = MiracastCommon::get_monotonic_time_us();
+        ssize_t received = 0;
+
+        // Count every complete packet by the length in its header
+        while (WFD_SOURCE_SIM_UIBC_HEADER_LEN <= buffer_len)
+        {
+            size_t packet_len = (static_cast<size_t>(buffer[2]) << 8) | buffer[3];
+
+            if (WFD_SOURCE_SIM_UIBC_HEADER_LEN > packet_len)
+            {
+                MIRACASTLOG_ERROR("Invalid UIBC packet length[%zu]", packet_len);
+                close(uibc_fd);
+                return WFD_SOURCE_SIM_UNEXPECTED_MSG;
+            }
+            if (packet_len > buffer_len)
+            {
+                break;
+            }
+            memmove(buffer, buffer + packet_len, buffer_len - packet_len);
+            buffer_len -= packet_len;
+            ++result.uibc_packets_received;
+        }
+        if (result.uibc_packets_received >= config.uibc_packets)
+        {
+            break;
+        }
+        if (now_us >= deadline_us)
+        {
+            status = WFD_SOURCE_SIM_RESPONSE_TIMEOUT;
+            break;
+        }
+
+        uibc_poll.fd = uibc_fd;
+        uibc_poll.revents = 0;
+        if (0 >= poll(&uibc_poll, 1, static_cast<int>((deadline_us - now_us + 999) / 1000)))
+        {
+            continue;
+        }
+        received = recv(uibc_fd, buffer + buffer_len, sizeof(buffer) - buffer_len, 0);
+        if ((0 > received) && (EINTR == errno))
+        {
+            continue;
+        }
+        if (0 >= received)
+        {
+            status = WFD_SOURCE_SIM_SINK_CLOSED;
+            break;
+        }
+        buffer_len += static_cast<size_t>(received);
+    }
+    close(uibc_fd);
+
+    if (WFD_SOURCE_SIM_OK != status)
+    {
+        MIRACASTLOG_ERROR("Received [%u] of [%u] UIBC packets", result.uibc_packets_received, config.uibc_packets);
+    }
+    return status;
+}
+
+WFD_SOURCE_SIM_STATUS MiracastWFDSourceSimulator::run_session(const WFD_SOURCE_SIM_CONFIG_STRUCT &config, WFD_SOURCE_SIM_RESULT_STRUCT &result)
+{
+    uint64_t cpu_start_us = get_thread_cpu_time_us();
+    const char *session_header = "Session: " WFD_SOURCE_SIM_DFLT_SESSION_ID "\r\n";
+    WFD_SOURCE_SIM_STATUS status = WFD_SOURCE_SIM_OK;
+    bool expect_close = false;
+    unsigned int cseq = 0;
+
+    result.status = WFD_SOURCE_SIM_OK;
+    result.connected_us = 0;
+    result.play_response_us = 0;
+    result.session_end_us = 0;
+    result.keep_alives_acked = 0;
+    result.triggers_acked = 0;
+    result.sink_teardown_received = false;
+    result.uibc_packets_received = 0;
+    result.cpu_time_us = 0;
+
+    status = accept_session(config.accept_timeout_ms);
+    if (WFD_SOURCE_SIM_OK == status)
+    {
+        result.connected_us = MiracastCommon::get_monotonic_time_us();
+        status = run_m1_m7(config, result);
+    }
+    if ((WFD_SOURCE_SIM_OK == status) && (0 < config.uibc_packets))
+    {
+        status = receive_uibc(config, result);
+    }
+
+    // M16 keep-alives
+    for (unsigned int index = 0; (WFD_SOURCE_SIM_OK == status) && (index < config.keep_alive_count); ++index)
+    {
+        status = service_sink(config.keep_alive_interval_ms, config, result);
+        if (WFD_SOURCE_SIM_OK == status)
+        {
+            status = send_request("GET_PARAMETER", WFD_SOURCE_SIM_URI, session_header, "", cseq);
+        }
+        if (WFD_SOURCE_SIM_OK == status)
+        {
+            status = wait_response(cseq, config, result);
+        }
+        if (WFD_SOURCE_SIM_OK == status)
+        {
+            ++result.keep_alives_acked;
+        }
+    }
+
+    for (size_t index = 0; (WFD_SOURCE_SIM_OK == status) && (!expect_close) && (index < config.triggers.size()); ++index)
+    {
+        std::string body = "wfd_trigger_method: ";
+        RTSP_METHOD sink_request = RTSP_METHOD_UNKNOWN;
+
+        switch (config.triggers[index])
+        {
+            case WFD_SOURCE_SIM_TRIGGER_PAUSE:
+            {
+                body += "PAUSE\r\n";
+                sink_request = RTSP_METHOD_PAUSE;
+            }
+            break;
+            case WFD_SOURCE_SIM_TRIGGER_PLAY:
+            {
+                body += "PLAY\r\n";
+                sink_request = RTSP_METHOD_PLAY;
+            }
+            break;
+            default:
+            {
+                body += "TEARDOWN\r\n";
+                expect_close = true;
+            }
+            break;
+        }
+        sleep_msec(config.request_delay_ms);
+        status = send_request("SET_PARAMETER", WFD_SOURCE_SIM_URI, session_header, body, cseq);
+        if (WFD_SOURCE_SIM_OK == status)
+        {
+            status = wait_response(cseq, config, result);
+        }
+        // The sink answers a PAUSE/PLAY trigger with the request itself
+        if ((WFD_SOURCE_SIM_OK == status) && (RTSP_METHOD_UNKNOWN != sink_request))
+        {
+            status = wait_request(sink_request, config, result);
+        }
+        if (WFD_SOURCE_SIM_OK == status)
+        {
+            ++result.triggers_acked;
+        }
+    }
+
+    if ((WFD_SOURCE_SIM_OK == status) && ((expect_close) || (config.wait_for_sink_teardown)))
+    {
+        status = service_sink(expect_close ? config.response_timeout_ms : config.sink_teardown_timeout_ms, config, result);
+        // Running out of time here means the sink never ended the session
+        status = (WFD_SOURCE_SIM_OK == status) ? WFD_SOURCE_SIM_RESPONSE_TIMEOUT : status;
+    }
+
+    // Losing the sink is the expected way out once it has been asked to stop or has sent TEARDOWN
+    if ((WFD_SOURCE_SIM_SINK_CLOSED == status) && ((expect_close) || (result.sink_teardown_received)))
+    {
+        status = WFD_SOURCE_SIM_OK;
+    }
+    result.session_end_us = MiracastCommon::get_monotonic_time_us();
+    close_session();
+
+    result.status = status;
+    result.cpu_time_us = get_thread_cpu_time_us() - cpu_start_us;
+
+    if (WFD_SOURCE_SIM_OK != status)
+    {
+        MIRACASTLOG_ERROR("WFD source session failed [%s] after [%u] keep-alives",
+                            get_status_name(status),
+                            result.keep_alives_acked);
+    }
+    return status;
+}
@@ -0,0 +1,151 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _MIRACAST_WFD_SOURCE_SIMULATOR_H_
+#define _MIRACAST_WFD_SOURCE_SIMULATOR_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <MiracastRTSPParser.h>
+
+#define WFD_SOURCE_SIM_LOOPBACK_IP   "127.0.0.1"
+#define WFD_SOURCE_SIM_DFLT_SERVER_NAME   "MiracastWFDSourceSimulator/1.0"
+#define WFD_SOURCE_SIM_DFLT_VIDEO_FORMAT   "00 00 02 04 00000080 00000000 00000000 00 0000 0000 00 none none"
+#define WFD_SOURCE_SIM_DFLT_AUDIO_CODEC   "AAC 00000001 00"
+#define WFD_SOURCE_SIM_PRESENTATION_URL   "rtsp://" WFD_SOURCE_SIM_LOOPBACK_IP "/wfd1.0/streamid=0"
+#define WFD_SOURCE_SIM_DFLT_SESSION_ID   "1804289383"
+#define WFD_SOURCE_SIM_DFLT_ACCEPT_TIMEOUT_MSEC   ( 10000 )
+#define WFD_SOURCE_SIM_DFLT_RESPONSE_TIMEOUT_MSEC   ( 5000 )
+#define WFD_SOURCE_SIM_DFLT_SESSION_TIMEOUT_SEC   ( 30 )
+
+typedef enum wfd_source_sim_trigger_e
+{
+    WFD_SOURCE_SIM_TRIGGER_PAUSE = 0x00,
+    WFD_SOURCE_SIM_TRIGGER_PLAY,
+    WFD_SOURCE_SIM_TRIGGER_TEARDOWN
+}
+WFD_SOURCE_SIM_TRIGGER;
+
+typedef enum wfd_source_sim_status_e
+{
+    WFD_SOURCE_SIM_OK = 0x00,
+    WFD_SOURCE_SIM_SOCKET_ERROR,
+    WFD_SOURCE_SIM_ACCEPT_TIMEOUT,
+    WFD_SOURCE_SIM_RESPONSE_TIMEOUT,
+    WFD_SOURCE_SIM_UNEXPECTED_MSG,
+    WFD_SOURCE_SIM_ERROR_STATUS_RECEIVED,
+    WFD_SOURCE_SIM_SINK_CLOSED
+}
+WFD_SOURCE_SIM_STATUS;
+
+typedef struct wfd_source_sim_config_st
+{
+    std::string server_name;
+    /* wfd_video_formats selected in M4 */
+    std::string video_format;
+    std::string audio_codec;
+    unsigned int accept_timeout_ms;
+    unsigned int response_timeout_ms;
+    /* Delay between the TCP accept and M1 */
+    unsigned int m1_delay_ms;
+    /* Delay before every request the source originates */
+    unsigned int request_delay_ms;
+    /* Delay before every response to a sink request */
+    unsigned int response_delay_ms;
+    /* timeout= announced in the M6 Session header */
+    unsigned int session_timeout_sec;
+    unsigned int keep_alive_count;
+    unsigned int keep_alive_interval_ms;
+    /* Sent in order after the keep-alives, a TEARDOWN trigger ends the session */
+    std::vector<WFD_SOURCE_SIM_TRIGGER> triggers;
+    /* Once the script is done, keep the session up until the sink sends TEARDOWN or closes */
+    bool wait_for_sink_teardown;
+    unsigned int sink_teardown_timeout_ms;
+    /* Offer UIBC in M4 and wait for this many input packets after M7, 0 leaves UIBC off */
+    unsigned int uibc_packets;
+}
+WFD_SOURCE_SIM_CONFIG_STRUCT;
+
+typedef struct wfd_source_sim_result_st
+{
+    WFD_SOURCE_SIM_STATUS status;
+    /* CLOCK_MONOTONIC timestamps in microseconds, 0 if not reached */
+    uint64_t connected_us;
+    uint64_t play_response_us;
+    uint64_t session_end_us;
+    unsigned int keep_alives_acked;
+    unsigned int triggers_acked;
+    bool sink_teardown_received;
+    unsigned int uibc_packets_received;
+    /* CPU time spent by the simulator thread on this session */
+    uint64_t cpu_time_us;
+}
+WFD_SOURCE_SIM_RESULT_STRUCT;
+
+/**
+ * Minimal Wi-Fi Display source which drives one RTSP session per run_session()
+ * call over 127.0.0.1: M1-M7, optional UIBC input, M16 keep-alives and PAUSE/PLAY/TEARDOWN triggers,
+ * answering sink originated requests (M2, M6, M7, PAUSE, PLAY, TEARDOWN) as
+ * they arrive. Received messages are framed with MiracastRTSPStreamBuffer.
+ */
+class MiracastWFDSourceSimulator
+{
+public:
+    MiracastWFDSourceSimulator();
+    ~MiracastWFDSourceSimulator();
+
+    static void get_default_config(WFD_SOURCE_SIM_CONFIG_STRUCT &config);
+    static const char *get_status_name(WFD_SOURCE_SIM_STATUS status);
+
+    /* Listens on 127.0.0.1, port 0 picks an ephemeral port */
+    bool start(unsigned short port = 0);
+    void stop(void);
+    unsigned short get_port(void) const { return m_port; }
+    unsigned short get_uibc_port(void) const { return m_uibc_port; }
+
+    WFD_SOURCE_SIM_STATUS run_session(const WFD_SOURCE_SIM_CONFIG_STRUCT &config, WFD_SOURCE_SIM_RESULT_STRUCT &result);
+
+private:
+    int m_listen_fd;
+    int m_session_fd;
+    int m_uibc_listen_fd;
+    unsigned short m_port;
+    unsigned short m_uibc_port;
+    unsigned int m_cseq;
+    std::string m_send_buffer;
+    std::string m_sink_cseq;
+    std::string m_client_port;
+    MiracastRTSPStreamBuffer m_stream;
+
+    WFD_SOURCE_SIM_STATUS accept_session(unsigned int timeout_ms);
+    void close_session(void);
+    WFD_SOURCE_SIM_STATUS send_buffer(void);
+    WFD_SOURCE_SIM_STATUS receive_message(unsigned int timeout_ms);
+    WFD_SOURCE_SIM_STATUS send_request(const char *method, const char *uri, const char *headers, const std::string &body, unsigned int &cseq);
+    WFD_SOURCE_SIM_STATUS send_response(const RTSPStringView &cseq, const std::string &headers, unsigned int delay_ms);
+    WFD_SOURCE_SIM_STATUS handle_sink_request(const WFD_SOURCE_SIM_CONFIG_STRUCT &config, WFD_SOURCE_SIM_RESULT_STRUCT &result);
+    WFD_SOURCE_SIM_STATUS wait_response(unsigned int cseq, const WFD_SOURCE_SIM_CONFIG_STRUCT &config, WFD_SOURCE_SIM_RESULT_STRUCT &result);
+    WFD_SOURCE_SIM_STATUS wait_request(RTSP_METHOD method, const WFD_SOURCE_SIM_CONFIG_STRUCT &config, WFD_SOURCE_SIM_RESULT_STRUCT &result);
+    WFD_SOURCE_SIM_STATUS service_sink(unsigned int duration_ms, const WFD_SOURCE_SIM_CONFIG_STRUCT &config, WFD_SOURCE_SIM_RESULT_STRUCT &result);
+    WFD_SOURCE_SIM_STATUS run_m1_m7(const WFD_SOURCE_SIM_CONFIG_STRUCT &config, WFD_SOURCE_SIM_RESULT_STRUCT &result);
+    WFD_SOURCE_SIM_STATUS receive_uibc(const WFD_SOURCE_SIM_CONFIG_STRUCT &config, WFD_SOURCE_SIM_RESULT_STRUCT &result);
+};
+
+#endif
@@ -0,0 +1,34 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2023 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _SOC_MIRACAST_PLAYER_H_
+#define _SOC_MIRACAST_PLAYER_H_
+
+#include <gst/gst.h>
+
+/*
+ * Headless stand-in for the MiracastPlayerHal interface, for the player
+ * benchmark on machines without the SoC library. The benchmark only runs
+ * the headless sinks, so the audio sink is never asked for.
+ */
+void SoC_ConfigureVideoDecodeErrorPolicy(void);
+GstElement *SoC_GetAudioSinkProperty(void);
+void SoC_ReleaseAudioSinkProperty(GstElement *audio_sink);
+
+#endif
@@ -18,6 +18,9 @@
  */
 
 #include "MiracastCommon.h"
+#include <errno.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
 
 MiracastThread::MiracastThread(std::string thread_name, size_t stack_size, size_t msg_size, size_t queue_depth, void (*callback)(void *), void *user_data)
 {
@@ -147,6 +150,14 @@ int8_t MiracastThread::receive_message(void *message, size_t msg_size, int sem_w
     return status;
 }
 
+uint64_t MiracastCommon::get_monotonic_time_us( void )
+{
+    struct timespec ts = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (static_cast<uint64_t>(ts.tv_sec) * 1000000ULL) + (static_cast<uint64_t>(ts.tv_nsec) / 1000ULL);
+}
+
 std::string MiracastCommon::parse_opt_flag( std::string file_name , bool integer_check , bool debugStats )
 {
     std::string return_buffer = "";
@@ -347,7 +358,6 @@ void MessageQueue::sendData(void* new_value,int wait_time_ms)
     }
     m_internalQueue.push(new_value);
     m_currentMsgCount++;
-    std::cout << "[sendData] data at address: " << new_value << std::endl;
     // Notify consumer that new data is available
     m_condNotEmpty.notify_one();
     MIRACASTLOG_TRACE("Exiting...");
@@ -398,4 +408,184 @@ void MessageQueue::detachQueue(void)
     m_condNotFull.notify_all();
 
     MIRACASTLOG_TRACE("Exiting...");
-}
\ No newline at end of file
+}
+
+MessageRing::MessageRing(size_t capacity, void (*free_cb)(void *param))
+{
+    MIRACASTLOG_TRACE("Entering...");
+    m_capacity = 1;
+    while (m_capacity < capacity)
+    {
+        m_capacity <<= 1;
+    }
+    m_mask = m_capacity - 1;
+    m_slots = new std::atomic<void *>[m_capacity];
+    for (size_t index = 0; index < m_capacity; ++index)
+    {
+        m_slots[index].store(nullptr, std::memory_order_relaxed);
+    }
+    m_read_index.store(0);
+    m_write_index.store(0);
+    m_consumer_waiting.store(false);
+    m_detached.store(false);
+    m_dropped.store(0);
+    m_free_resource_cb = free_cb;
+    m_event_fd = -1;
+    sem_init(&m_data_sem, 0, 0);
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+MessageRing::~MessageRing()
+{
+    void *value = nullptr;
+
+    MIRACASTLOG_TRACE("Entering...");
+    detach();
+    while (0 < pop_all(&value, 1, 0))
+    {
+        if (nullptr != m_free_resource_cb)
+        {
+            m_free_resource_cb(value);
+        }
+    }
+    sem_destroy(&m_data_sem);
+    if (-1 != m_event_fd)
+    {
+        close(m_event_fd);
+    }
+    delete[] m_slots;
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+bool MessageRing::push(void *value)
+{
+    uint64_t write_index = m_write_index.load(std::memory_order_relaxed);
+    uint64_t read_index = m_read_index.load(std::memory_order_acquire);
+    bool dropped = false;
+
+    if (m_capacity <= (write_index - read_index))
+    {
+        void *oldest = m_slots[read_index & m_mask].load(std::memory_order_relaxed);
+
+        // Losing the race means the consumer just made room
+        if (m_read_index.compare_exchange_strong(read_index, read_index + 1, std::memory_order_acq_rel))
+        {
+            if (nullptr != m_free_resource_cb)
+            {
+                m_free_resource_cb(oldest);
+            }
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            dropped = true;
+        }
+    }
+    m_slots[write_index & m_mask].store(value, std::memory_order_relaxed);
+    m_write_index.store(write_index + 1, std::memory_order_seq_cst);
+
+    if ((m_consumer_waiting.load(std::memory_order_seq_cst)) && (m_consumer_waiting.exchange(false)))
+    {
+        if (-1 != m_event_fd)
+        {
+            uint64_t event = 1;
+
+            if (sizeof(event) != write(m_event_fd, &event, sizeof(event)))
+            {
+                MIRACASTLOG_ERROR("Unable to signal the consumer, errno[%d]", errno);
+            }
+        }
+        else
+        {
+            sem_post(&m_data_sem);
+        }
+    }
+    return !dropped;
+}
+
+size_t MessageRing::pop_all(void **values, size_t max_count, unsigned int wait_time_ms)
+{
+    size_t count = 0;
+
+    while (true)
+    {
+        uint64_t read_index = m_read_index.load(std::memory_order_acquire);
+
+        while ((count < max_count) && (read_index != m_write_index.load(std::memory_order_acquire)))
+        {
+            void *value = m_slots[read_index & m_mask].load(std::memory_order_relaxed);
+
+            // Fails only if the producer dropped this entry, read_index is reloaded then
+            if (m_read_index.compare_exchange_weak(read_index, read_index + 1, std::memory_order_acq_rel))
+            {
+                values[count++] = value;
+                ++read_index;
+            }
+        }
+        if ((0 < count) || (0 == wait_time_ms) || (m_detached.load()))
+        {
+            return count;
+        }
+
+        m_consumer_waiting.store(true, std::memory_order_seq_cst);
+        if ((m_read_index.load(std::memory_order_seq_cst) == m_write_index.load(std::memory_order_seq_cst)) && (!m_detached.load()))
+        {
+            struct timespec ts;
+
+            clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_sec += wait_time_ms / 1000;
+            ts.tv_nsec += static_cast<long>(wait_time_ms % 1000) * 1000000L;
+            if (1000000000L <= ts.tv_nsec)
+            {
+                ts.tv_sec += 1;
+                ts.tv_nsec -= 1000000000L;
+            }
+            if ((-1 == sem_timedwait(&m_data_sem, &ts)) && (ETIMEDOUT == errno))
+            {
+                m_consumer_waiting.store(false);
+                return 0;
+            }
+        }
+        m_consumer_waiting.store(false);
+    }
+}
+
+void MessageRing::detach(void)
+{
+    MIRACASTLOG_TRACE("Entering...");
+    m_detached.store(true);
+    sem_post(&m_data_sem);
+    MIRACASTLOG_TRACE("Exiting...");
+}
+
+int MessageRing::get_event_fd(void)
+{
+    if (-1 == m_event_fd)
+    {
+        m_event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (-1 == m_event_fd)
+        {
+            MIRACASTLOG_ERROR("Unable to create the eventfd, errno[%d]", errno);
+        }
+        else
+        {
+            // The first push() wakes the consumer up
+            m_consumer_waiting.store(true, std::memory_order_seq_cst);
+        }
+    }
+    return m_event_fd;
+}
+
+bool MessageRing::arm_event_fd(void)
+{
+    uint64_t event = 0;
+
+    // Signals already taken care of by the pop_all() that came before
+    while (sizeof(event) == read(m_event_fd, &event, sizeof(event)))
+    {
+    }
+    m_consumer_waiting.store(true, std::memory_order_seq_cst);
+    if (m_read_index.load(std::memory_order_seq_cst) == m_write_index.load(std::memory_order_seq_cst))
+    {
+        return true;
+    }
+    // Either taken back here, or push() already signalled the fd and the next wake-up picks the entries up
+    return !m_consumer_waiting.exchange(false);
+}
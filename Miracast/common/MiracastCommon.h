@@ -29,10 +29,12 @@
 #include <fstream>
 #include <glib.h>
 #include <semaphore.h>
+#include <stdint.h>
 #include <iostream>
 #include <queue>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
 #include <MiracastLogger.h>
 
 using namespace std;
@@ -112,6 +114,8 @@ typedef enum controller_framework_states_e
     RTSP_STOP_STREAMING = 0x0000FF0E,
     RTSP_NOTIFY_GSTPLAYER_STATE = 0x000FF000F,
     RTSP_SELF_ABORT = 0x000FF0010,
+    RTSP_UPDATE_LATENCY_PROFILE = 0x000FF0011,
+    RTSP_UPDATE_ELEMENT_TRACER = 0x000FF0012,
     RTSP_INVALID_ACTION
 } eCONTROLLER_FW_STATES;
 
@@ -179,6 +183,42 @@ typedef enum miracast_gstplayer_states_e
     MIRACAST_GSTPLAYER_STATE_MAX,
 } eMIRA_GSTPLAYER_STATES;
 
+typedef enum miracast_gstplayer_latency_profile_e
+{
+    /* Lowest display latency, late packets are dropped instead of waited for */
+    MIRACAST_GSTPLAYER_LATENCY_PROFILE_GAMING = 0x00,
+    MIRACAST_GSTPLAYER_LATENCY_PROFILE_DEFAULT,
+    /* Deep buffering to ride out Wi-Fi retries and jitter */
+    MIRACAST_GSTPLAYER_LATENCY_PROFILE_ROBUST,
+    MIRACAST_GSTPLAYER_LATENCY_PROFILE_MAX
+} eMIRA_GSTPLAYER_LATENCY_PROFILE;
+
+typedef enum miracast_gstplayer_video_sink_e
+{
+    MIRACAST_GSTPLAYER_VIDEO_SINK_WESTEROS = 0x00,
+    /* Headless sinks for profiling off-target, the audio goes to a fakesink as well */
+    MIRACAST_GSTPLAYER_VIDEO_SINK_FAKESINK,
+    MIRACAST_GSTPLAYER_VIDEO_SINK_APPSINK,
+    MIRACAST_GSTPLAYER_VIDEO_SINK_MAX
+} eMIRA_GSTPLAYER_VIDEO_SINK;
+
+typedef enum miracast_gstplayer_pipeline_mode_e
+{
+    /* udpsrc..tsparse into an appsink, re-pushed into a playbin appsrc */
+    MIRACAST_GSTPLAYER_PIPELINE_MODE_DUAL = 0x00,
+    /* One pipeline from udpsrc through decodebin to the audio and video sinks */
+    MIRACAST_GSTPLAYER_PIPELINE_MODE_SINGLE
+} eMIRA_GSTPLAYER_PIPELINE_MODE;
+
+typedef struct miracast_gstplayer_sink_config_st
+{
+    eMIRA_GSTPLAYER_VIDEO_SINK video_sink;
+    /* Headless sinks only, westerossink follows the latency profile */
+    bool sync;
+    /* Decoders whose klass says Hardware are skipped, even a sink that takes the stream gets it decoded */
+    bool software_decode;
+} MIRACAST_GSTPLAYER_SINK_CONFIG_STRUCT;
+
 typedef enum miracast_service_error_code_e
 {
     MIRACAST_SERVICE_ERR_CODE_SUCCESS = 100,
@@ -230,6 +270,98 @@ typedef struct video_rect_st
 }
 VIDEO_RECT_STRUCT;
 
+#define MIRACAST_PLAYER_STATISTICS_MAX_TS_PIDS   ( 8 )
+
+typedef struct miracast_player_ts_pid_statistics_st
+{
+    uint16_t pid;
+    uint64_t packets;
+    uint64_t cc_errors;
+    uint32_t bitrate_kbps;
+} MIRACAST_PLAYER_TS_PID_STATISTICS_STRUCT;
+
+typedef struct miracast_player_statistics_st
+{
+    /* false once the session ended, the numbers are then its final ones */
+    bool streaming;
+    uint64_t duration_ms;
+    uint64_t rendered_frames;
+    uint64_t dropped_frames;
+    /* Bytes queued in the appsrc in front of the decoder, dual pipeline mode only */
+    uint64_t decoder_queue_bytes;
+    uint64_t rtp_packets;
+    uint64_t rtp_lost;
+    uint64_t rtp_late;
+    uint64_t rtp_duplicates;
+    /* Counted by the recvmmsg receiver only, 0 with udpsrc */
+    uint64_t rtp_reordered;
+    uint64_t kernel_drops;
+    /* Slot pool of the recvmmsg receiver, a miss is a slot filled for the first time */
+    uint32_t buffer_pool_size;
+    uint32_t buffer_pool_high_water;
+    uint64_t buffer_pool_hits;
+    uint64_t buffer_pool_misses;
+    uint64_t buffer_pool_exhausted;
+    /* Over the last collector interval */
+    uint32_t bitrate_kbps;
+    uint32_t jitterbuffer_latency_ms;
+    uint64_t ingress_to_render_avg_us;
+    /* From the M7 PLAY until the first RTP packet and until the first frame on screen, 0 until known */
+    uint64_t time_to_first_packet_us;
+    uint64_t time_to_first_frame_us;
+    /* launch() took the pipeline kept by the previous session. The setup runs until the pipeline is started */
+    bool pipeline_reused;
+    uint64_t pipeline_setup_us;
+    /* Mid-session M4s that changed the caps at the video sink. The gap runs from the last frame
+     * of the old format to the first of the new one, the latest and the worst of the session */
+    uint64_t format_switches;
+    uint64_t format_switch_gap_us;
+    uint64_t format_switch_gap_max_us;
+    uint64_t qos_messages;
+    /* From the latest QoS message, a positive jitter means the buffer arrived late */
+    int64_t qos_jitter_us;
+    double qos_proportion;
+    uint64_t qos_dropped;
+    /* From the TS inspector behind the depayloader. Continuity errors without RTP loss were already in the source stream */
+    uint64_t ts_packets;
+    uint64_t ts_cc_errors;
+    uint64_t ts_sync_losses;
+    uint64_t ts_transport_errors;
+    uint16_t pcr_pid;
+    uint64_t pcr_jitter_us;
+    uint64_t pcr_jitter_max_us;
+    unsigned int ts_pid_count;
+    MIRACAST_PLAYER_TS_PID_STATISTICS_STRUCT ts_pids[MIRACAST_PLAYER_STATISTICS_MAX_TS_PIDS];
+} MIRACAST_PLAYER_STATISTICS_STRUCT;
+
+/* Both pipelines of the dual mode hold about twenty elements, the autoplugged ones of playbin more */
+#define MIRACAST_PLAYER_MAX_TRACED_ELEMENTS   ( 32 )
+#define MIRACAST_PLAYER_TRACED_ELEMENT_NAME_SIZE   ( 48 )
+
+typedef struct miracast_player_element_latency_st
+{
+    char name[MIRACAST_PLAYER_TRACED_ELEMENT_NAME_SIZE];
+    uint64_t buffers_in;
+    uint64_t buffers_out;
+    /* From a buffer entering the element until it, or what was made of it, leaves. Smoothed,
+     * the worst over the last collector interval and the worst since tracing started */
+    uint64_t latency_avg_us;
+    uint64_t latency_max_us;
+    uint64_t latency_peak_us;
+    /* Buffers in and not yet out, only meaningful for elements passing one buffer for one */
+    uint32_t in_flight;
+    uint32_t in_flight_max;
+    /* current-level-bytes of queues and appsrc, 0 for the other elements */
+    uint64_t level_bytes;
+} MIRACAST_PLAYER_ELEMENT_LATENCY_STRUCT;
+
+typedef struct miracast_player_element_trace_st
+{
+    bool enabled;
+    unsigned int element_count;
+    MIRACAST_PLAYER_ELEMENT_LATENCY_STRUCT elements[MIRACAST_PLAYER_MAX_TRACED_ELEMENTS];
+} MIRACAST_PLAYER_ELEMENT_TRACE_STRUCT;
+
 typedef struct controller_msgq_st
 {
     char msg_buffer[2048];
@@ -252,6 +384,10 @@ typedef struct rtsp_hldr_msgq_st
     eM_PLAYER_STOP_REASON_CODE stop_reason_code;
     eM_PLAYER_REASON_CODE state_reason_code;
     eMIRA_GSTPLAYER_STATES  gst_player_state;
+    eMIRA_GSTPLAYER_LATENCY_PROFILE latency_profile;
+    bool element_tracer;
+    /* RTSP port of the source, 0 for the default */
+    unsigned short source_rtsp_port;
 } RTSP_HLDR_MSGQ_STRUCT;
 
 #define CONTROLLER_THREAD_NAME ("CONTROL_MSG_HANDLER")
@@ -336,6 +472,7 @@ class MiracastPlayerNotifier
 {
 public:
     virtual void onStateChange(const std::string& client_mac, const std::string& client_name, eMIRA_PLAYER_STATES player_state, eM_PLAYER_REASON_CODE reason_code) = 0;
+    virtual void onPlayerStatistics(const MIRACAST_PLAYER_STATISTICS_STRUCT &/*statistics*/) {}
 };
 
 class MiracastThread
@@ -368,6 +505,7 @@ class MiracastCommon
         static std::string parse_opt_flag( std::string file_name , bool integer_check = false, bool debugStats = true );
         static int execute_SystemCommand( const char* system_command_buffer );
         static bool execute_PopenCommand( const char* popen_command, const char* expected_char, unsigned int retry_count, std::string& popen_buffer, unsigned int interval_micro_sec );
+        static uint64_t get_monotonic_time_us( void );
 };
 
 #define DEFAULT_MSGQ_WAIT_TIME_MS   (3000*1000)
@@ -392,4 +530,52 @@ public:
     void detachQueue(void);
 };
 
+#define DEFAULT_MSG_RING_WAIT_TIME_MS   ( 100 )
+
+/**
+ * Lock-free single producer, single consumer ring of pointers.
+ *
+ * push() never blocks. When the ring is full, it releases the oldest entry
+ * through free_cb to make room, so a stalled consumer only costs stale data.
+ * The consumer takes everything available at once with pop_all() and sleeps
+ * on a semaphore only when the ring is empty. A consumer running on a
+ * GMainContext instead watches get_event_fd() and calls arm_event_fd() once it
+ * has taken everything, the producer then signals the fd with the next push().
+ */
+class MessageRing
+{
+public:
+    /* capacity is rounded up to a power of two */
+    MessageRing(size_t capacity, void (*free_cb)(void *param));
+    ~MessageRing();
+    /* Producer side, returns false if an older entry was dropped */
+    bool push(void *value);
+    /* Consumer side, waits up to wait_time_ms while empty, returns the number of entries taken */
+    size_t pop_all(void **values, size_t max_count, unsigned int wait_time_ms = DEFAULT_MSG_RING_WAIT_TIME_MS);
+    void detach(void);
+    /* Switches the wake-up from the semaphore to an eventfd, -1 if none could be created */
+    int get_event_fd(void);
+    /* Consumer side, false if entries came in meanwhile and it has to pop_all() again */
+    bool arm_event_fd(void);
+    size_t get_capacity(void) const { return m_capacity; }
+    uint64_t get_dropped_count(void) const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<void *> *m_slots;
+    size_t m_capacity;
+    size_t m_mask;
+    /* Free running indices, the producer also moves m_read_index when it drops */
+    std::atomic<uint64_t> m_read_index;
+    std::atomic<uint64_t> m_write_index;
+    std::atomic<bool> m_consumer_waiting;
+    std::atomic<bool> m_detached;
+    std::atomic<uint64_t> m_dropped;
+    sem_t m_data_sem;
+    int m_event_fd;
+    void (*m_free_resource_cb)(void *);
+
+    MessageRing(const MessageRing &) = delete;
+    MessageRing &operator=(const MessageRing &) = delete;
+};
+
 #endif
\ No newline at end of file
@@ -22,6 +22,7 @@
 #include <thread>
 #include "ServiceMock.h"
 #include "MiracastPlayer.h"
+#include "MiracastRTPReceiver.h"
 #include "WrapsMock.h"
 #include <sys/time.h>
 
@@ -556,6 +557,53 @@ class MiracastPlayerEventTest : public MiracastPlayerTest {
 		}
 };
 
+/* RTSP handler without its thread, the session event seam made public for the tests */
+class MiracastRTSPSessionEventProbe : public MiracastRTSPMsg {
+	public:
+		MiracastRTSPSessionEventProbe() = default;
+		virtual ~MiracastRTSPSessionEventProbe() override = default;
+
+		using MiracastRTSPMsg::create_SessionEventDescriptors;
+		using MiracastRTSPMsg::signal_control_event;
+		using MiracastRTSPMsg::arm_keep_alive_timer;
+		using MiracastRTSPMsg::clear_control_event;
+		using MiracastRTSPMsg::wait_session_event;
+};
+
+/* Session epoll set of the RTSP handler connected to a loopback listener, no source involved */
+class MiracastRTSPSessionEventTest : public MiracastPlayerTest {
+	protected:
+		MiracastRTSPSessionEventProbe rtsp_probe;
+		int listen_fd = -1;
+		unsigned short listen_port = 0;
+
+		MiracastRTSPSessionEventTest()
+			: MiracastPlayerTest()
+		{
+			struct sockaddr_in addr = {};
+			socklen_t addr_len = sizeof(addr);
+
+			addr.sin_family = AF_INET;
+			addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+			listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+			if ((-1 != listen_fd) &&
+				(0 == bind(listen_fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr))) &&
+				(0 == listen(listen_fd, 1)) &&
+				(0 == getsockname(listen_fd, reinterpret_cast<struct sockaddr*>(&addr), &addr_len)))
+			{
+				listen_port = ntohs(addr.sin_port);
+			}
+		}
+
+		virtual ~MiracastRTSPSessionEventTest() override
+		{
+			if (-1 != listen_fd)
+			{
+				close(listen_fd);
+			}
+		}
+};
+
 TEST_F(MiracastPlayerTest, RegisteredMethods)
 {
 	EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("playRequest")));
@@ -563,6 +611,18 @@ TEST_F(MiracastPlayerTest, RegisteredMethods)
 	EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("setPlayerState")));
 	EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("setVideoRectangle")));
 	EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("setLogging")));
+	EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("getRTSPLatencyStats")));
+	EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("injectUIBCEvents")));
+	EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("setLatencyProfile")));
+	EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("getLatencyProfile")));
+	EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("getPlayerStatistics")));
+	EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("setPlayerStatisticsInterval")));
+	EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("setVideoSink")));
+	EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("getVideoSink")));
+	EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("setPipelineMode")));
+	EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("getPipelineMode")));
+	EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("setElementTracer")));
+	EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("getElementLatency")));
 }
 
 TEST_F(MiracastPlayerTest, Logging)
@@ -586,6 +646,176 @@ TEST_F(MiracastPlayerTest, setRTSPWaitTimeOutAndAVFormats)
         EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("setAudioFormats"), _T("{\"audio_codecs\": [{\"audio_format\": 0x01,\"modes\": 0x00000002,\"latency\": 0}]}"), response));
 }
 
+TEST_F(MiracastPlayerTest, injectUIBCEventsInvalidParams)
+{
+        EXPECT_EQ(Core::ERROR_GENERAL, handler.Invoke(connection, _T("injectUIBCEvents"), _T("{}"), response));
+        EXPECT_EQ(Core::ERROR_GENERAL, handler.Invoke(connection, _T("injectUIBCEvents"), _T("{\"events\": []}"), response));
+        EXPECT_EQ(Core::ERROR_GENERAL, handler.Invoke(connection, _T("injectUIBCEvents"), _T("{\"events\": [{\"type\": \"unknown\"}]}"), response));
+        EXPECT_EQ(Core::ERROR_GENERAL, handler.Invoke(connection, _T("injectUIBCEvents"), _T("{\"events\": [{\"type\": \"touch_down\"}]}"), response));
+        // No source has enabled UIBC
+        EXPECT_EQ(Core::ERROR_GENERAL, handler.Invoke(connection, _T("injectUIBCEvents"), _T("{\"events\": [{\"type\": \"key_down\",\"key_code\": 13}]}"), response));
+}
+
+TEST_F(MiracastPlayerTest, playRequestInvalidSourcePort)
+{
+        EXPECT_EQ(Core::ERROR_BAD_REQUEST, handler.Invoke(connection, _T("playRequest"), _T("{\"device_parameters\": {\"source_dev_ip\":\"127.0.0.1\",\"source_dev_mac\": \"A1:B2:C3:D4:E5:F6\",\"source_dev_name\":\"Sample-Android-Test-1\",\"sink_dev_ip\":\"192.168.59.1\",\"source_rtsp_port\": 70000}}"), response));
+        EXPECT_EQ(Core::ERROR_BAD_REQUEST, handler.Invoke(connection, _T("playRequest"), _T("{\"device_parameters\": {\"source_dev_ip\":\"127.0.0.1\",\"source_dev_mac\": \"A1:B2:C3:D4:E5:F6\",\"source_dev_name\":\"Sample-Android-Test-1\",\"sink_dev_ip\":\"192.168.59.1\",\"source_rtsp_port\": 0}}"), response));
+        EXPECT_EQ(Core::ERROR_BAD_REQUEST, handler.Invoke(connection, _T("playRequest"), _T("{\"device_parameters\": {\"source_dev_ip\":\"127.0.0.1\",\"source_dev_mac\": \"A1:B2:C3:D4:E5:F6\",\"source_dev_name\":\"Sample-Android-Test-1\",\"sink_dev_ip\":\"192.168.59.1\",\"source_rtsp_port\": -1}}"), response));
+}
+
+TEST_F(MiracastPlayerTest, getRTSPLatencyStats)
+{
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getRTSPLatencyStats"), _T("{}"), response));
+        EXPECT_NE(response.find("\"sources\":["), string::npos);
+        EXPECT_NE(response.find("\"param_cache\":{\"entries\":"), string::npos);
+        EXPECT_NE(response.find("\"success\":true"), string::npos);
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getRTSPLatencyStats"), _T("{\"reset\": true}"), response));
+        EXPECT_NE(response.find("\"success\":true"), string::npos);
+}
+
+TEST_F(MiracastPlayerTest, LatencyProfile)
+{
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getLatencyProfile"), _T("{}"), response));
+        EXPECT_EQ(response, string("{\"profile\":\"default\",\"success\":true}"));
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("setLatencyProfile"), _T("{\"profile\": \"gaming\"}"), response));
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getLatencyProfile"), _T("{}"), response));
+        EXPECT_EQ(response, string("{\"profile\":\"gaming\",\"success\":true}"));
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("setLatencyProfile"), _T("{\"profile\": \"default\"}"), response));
+        EXPECT_EQ(Core::ERROR_GENERAL, handler.Invoke(connection, _T("setLatencyProfile"), _T("{\"profile\": \"ultra\"}"), response));
+        EXPECT_EQ(Core::ERROR_GENERAL, handler.Invoke(connection, _T("setLatencyProfile"), _T("{}"), response));
+}
+
+TEST_F(MiracastPlayerTest, PlayerStatistics)
+{
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getPlayerStatistics"), _T("{}"), response));
+        EXPECT_NE(response.find("\"streaming\":false"), string::npos);
+        EXPECT_NE(response.find("\"interval\":0"), string::npos);
+        EXPECT_NE(response.find("\"ts_cc_errors\":0"), string::npos);
+        EXPECT_NE(response.find("\"time_to_first_frame_us\":0"), string::npos);
+        EXPECT_NE(response.find("\"pipeline_reused\":false"), string::npos);
+        EXPECT_NE(response.find("\"format_switches\":0"), string::npos);
+        EXPECT_NE(response.find("\"buffer_pool_hit_rate_pct\":0"), string::npos);
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("setPlayerStatisticsInterval"), _T("{\"interval\": 5}"), response));
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getPlayerStatistics"), _T("{}"), response));
+        EXPECT_NE(response.find("\"interval\":5"), string::npos);
+        EXPECT_EQ(Core::ERROR_GENERAL, handler.Invoke(connection, _T("setPlayerStatisticsInterval"), _T("{\"interval\": -1}"), response));
+        EXPECT_EQ(Core::ERROR_GENERAL, handler.Invoke(connection, _T("setPlayerStatisticsInterval"), _T("{}"), response));
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("setPlayerStatisticsInterval"), _T("{\"interval\": 0}"), response));
+}
+
+TEST_F(MiracastPlayerTest, VideoSink)
+{
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getVideoSink"), _T("{}"), response));
+        EXPECT_EQ(response, string("{\"sink\":\"westerossink\",\"sync\":true,\"software_decode\":false,\"success\":true}"));
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("setVideoSink"), _T("{\"sink\": \"fakesink\",\"sync\": false,\"software_decode\": true}"), response));
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getVideoSink"), _T("{}"), response));
+        EXPECT_EQ(response, string("{\"sink\":\"fakesink\",\"sync\":false,\"software_decode\":true,\"success\":true}"));
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("setVideoSink"), _T("{\"sink\": \"appsink\"}"), response));
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("setVideoSink"), _T("{\"sink\": \"westerossink\"}"), response));
+        EXPECT_EQ(Core::ERROR_GENERAL, handler.Invoke(connection, _T("setVideoSink"), _T("{\"sink\": \"xvimagesink\"}"), response));
+        EXPECT_EQ(Core::ERROR_GENERAL, handler.Invoke(connection, _T("setVideoSink"), _T("{}"), response));
+}
+
+TEST_F(MiracastPlayerTest, PipelineMode)
+{
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getPipelineMode"), _T("{}"), response));
+        EXPECT_EQ(response, string("{\"mode\":\"dual\",\"success\":true}"));
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("setPipelineMode"), _T("{\"mode\": \"single\"}"), response));
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getPipelineMode"), _T("{}"), response));
+        EXPECT_EQ(response, string("{\"mode\":\"single\",\"success\":true}"));
+        EXPECT_EQ(Core::ERROR_GENERAL, handler.Invoke(connection, _T("setPipelineMode"), _T("{\"mode\": \"triple\"}"), response));
+        EXPECT_EQ(Core::ERROR_GENERAL, handler.Invoke(connection, _T("setPipelineMode"), _T("{}"), response));
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("setPipelineMode"), _T("{\"mode\": \"dual\"}"), response));
+}
+
+TEST_F(MiracastPlayerTest, ElementTracer)
+{
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getElementLatency"), _T("{}"), response));
+        EXPECT_EQ(response, string("{\"enabled\":false,\"elements\":[],\"success\":true}"));
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("setElementTracer"), _T("{\"enabled\": true}"), response));
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getElementLatency"), _T("{}"), response));
+        EXPECT_NE(response.find("\"enabled\":true"), string::npos);
+        EXPECT_EQ(Core::ERROR_GENERAL, handler.Invoke(connection, _T("setElementTracer"), _T("{}"), response));
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("setElementTracer"), _T("{\"enabled\": false}"), response));
+}
+
+TEST_F(MiracastPlayerTest, RTPReceiverPoolExhaustedBlocks)
+{
+        MiracastRTPReceiver receiver(RTP_RECEIVER_BATCH_SIZE, RTP_RECEIVER_BATCH_SIZE);
+        RTP_RECEIVER_PACKET_STRUCT packets[RTP_RECEIVER_BATCH_SIZE];
+        RTP_RECEIVER_STATS_STRUCT stats;
+        std::vector<void*> held;
+        struct sockaddr_in addr = {};
+        uint8_t datagram[12] = { 0x80, 0x21 };
+        const int waits = 10;
+        uint64_t start_us = 0;
+        int sender_fd = -1;
+
+        ASSERT_TRUE(receiver.open(0));
+        sender_fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        ASSERT_NE(-1, sender_fd);
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(receiver.get_port());
+        for (uint16_t sequence = 0; sequence < RTP_RECEIVER_BATCH_SIZE; ++sequence)
+        {
+                datagram[2] = static_cast<uint8_t>(sequence >> 8);
+                datagram[3] = static_cast<uint8_t>(sequence);
+                EXPECT_EQ(static_cast<ssize_t>(sizeof(datagram)), sendto(sender_fd, datagram, sizeof(datagram), 0, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)));
+        }
+        // Every slot of a pool that cannot grow stays held
+        for (int attempt = 0; (attempt < 100) && (RTP_RECEIVER_BATCH_SIZE > held.size()); ++attempt)
+        {
+                int count = receiver.receive(packets, RTP_RECEIVER_BATCH_SIZE, 100);
+
+                for (int index = 0; index < count; ++index)
+                {
+                        held.push_back(packets[index].slot_handle);
+                }
+        }
+        ASSERT_EQ(static_cast<size_t>(RTP_RECEIVER_BATCH_SIZE), held.size());
+
+        // Waiting forever with no free slot backs off instead of spinning
+        start_us = MiracastCommon::get_monotonic_time_us();
+        for (int wait = 0; wait < waits; ++wait)
+        {
+                EXPECT_EQ(0, receiver.receive(packets, RTP_RECEIVER_BATCH_SIZE, -1));
+        }
+        EXPECT_GE(MiracastCommon::get_monotonic_time_us() - start_us, static_cast<uint64_t>(waits * RTP_RECEIVER_POOL_WAIT_MS * 1000));
+        receiver.get_statistics(stats);
+        EXPECT_EQ(static_cast<uint64_t>(waits), stats.pool_exhausted);
+
+        for (void *slot_handle : held)
+        {
+                MiracastRTPReceiver::release_slot(slot_handle);
+        }
+        close(sender_fd);
+}
+
+TEST_F(MiracastRTSPSessionEventTest, KeepAliveExpiryWithControlMessage)
+{
+	int source_fd = -1;
+
+	ASSERT_NE(0, listen_port);
+	ASSERT_TRUE(rtsp_probe.create_SessionEventDescriptors());
+	// Builds the epoll set over the connected socket, the timerfd and the eventfd
+	ASSERT_EQ(MIRACAST_OK, rtsp_probe.initiate_TCP("127.0.0.1", listen_port));
+	source_fd = accept(listen_fd, nullptr, nullptr);
+	ASSERT_NE(-1, source_fd);
+
+	// The timerfd becomes readable first, both are then reported by the same epoll_wait()
+	rtsp_probe.arm_keep_alive_timer(1);
+	sleep(2);
+	rtsp_probe.signal_control_event();
+
+	EXPECT_EQ(RTSP_CONTROL_MSG_PENDING, rtsp_probe.wait_session_event(0));
+	rtsp_probe.clear_control_event();
+	EXPECT_EQ(RTSP_KEEP_ALIVE_TIMEDOUT, rtsp_probe.wait_session_event(0));
+	EXPECT_EQ(RTSP_TIMEDOUT, rtsp_probe.wait_session_event(0));
+
+	close(source_fd);
+}
+
 #if 0
 TEST_F(MiracastPlayerEventTest, APP_REQUESTED_TO_STOP)
 {
@@ -1068,6 +1298,93 @@ TEST_F(MiracastPlayerEventTest, RTSP_Failure)
 
 	EVENT_UNSUBSCRIBE(0, _T("onStateChange"), _T("client.events"), message);
 }
+
+TEST_F(MiracastPlayerEventTest, RTSP_ParamCacheMissThenHit)
+{
+	std::string rtsp_response = "";
+	Core::Event Initiated(false, true);
+	Core::Event Stopped(false, true);
+	MiracastError error_code = MIRACAST_FAIL;
+	MiracastRTSPMsg *rtsp_obj = nullptr;
+	RTSP_PARAM_CACHE_COUNTERS_STRUCT before = {};
+	RTSP_PARAM_CACHE_COUNTERS_STRUCT counters = {};
+	RTSP_MSG_HANDLER_FORMAT rtsp_m1_m4_srcMsgbuffer[] =
+	{
+		{ RTSP_SEND , RTSP_SEND_M1_REQUEST , "OPTIONS * RTSP/1.0\r\nCSeq: 1\r\nServer: AllShareCast/Galaxy/Android13\r\nRequire: org.wfa.wfd1.0\r\n"},
+		{ RTSP_RECV , RTSP_RECV_M1_RESPONSE , "RTSP/1.0 200 OK\r\nPublic: \"org.wfa.wfd1.0, GET_PARAMETER, SET_PARAMETER\"\r\nCSeq: 1\r\n\r\n"},
+		{ RTSP_RECV , RTSP_RECV_M2_REQUEST , "OPTIONS * RTSP/1.0\r\nRequire: org.wfa.wfd1.0\r\nCSeq: %s"},
+		{ RTSP_SEND , RTSP_SEND_M2_RESPONSE , "RTSP/1.0 200 OK\r\nCSeq: %s\r\nPublic: org.wfa.wfd1.0, SETUP, TEARDOWN, PLAY, PAUSE, GET_PARAMETER, SET_PARAMETER\r\n" },
+		{ RTSP_SEND , RTSP_SEND_M3_REQUEST , "GET_PARAMETER rtsp://localhost/wfd1.0 RTSP/1.0\r\nCSeq: 2\r\nContent-Type: text/parameters\r\nContent-Length: 211\r\n\r\nwfd_video_formats\r\nwfd_audio_codecs\r\nwfd_uibc_capability\r\nwfd_client_rtp_ports\r\nwfd_content_protection\r\nwfd_sec_screensharing\r\nwfd_sec_portrait_display\r\nwfd_sec_rotation\r\nwfd_sec_hw_rotation\r\nwfd_sec_framerate\r\n" },
+		{ RTSP_RECV , RTSP_RECV_M3_RESPONSE , "RTSP/1.0 200 OK\r\nContent-Length: 210\r\nContent-Type: text/parameters\r\nCSeq: 2\r\n\r\nwfd_content_protection: none\r\nwfd_video_formats: 00 00 03 10 0001ffff 1fffffff 00001fff 00 0000 0000 10 none none\r\nwfd_audio_codecs: AAC 00000007 00\r\nwfd_client_rtp_ports: RTP/AVP/UDP;unicast 1991 0 mode=play\r\n" },
+		{ RTSP_SEND , RTSP_SEND_M4_REQUEST , "SET_PARAMETER rtsp://localhost/wfd1.0 RTSP/1.0\r\nCSeq: 3\r\nContent-Type: text/parameters\r\nContent-Length: 246\r\n\r\nwfd_video_formats: 00 00 02 04 00000080 00000000 00000000 00 0000 0000 00 none none\r\nwfd_audio_codecs: AAC 00000001 00\r\nwfd_presentation_URL: rtsp://192.168.49.1/wfd1.0/streamid=0 none\r\nwfd_client_rtp_ports: RTP/AVP/UDP;unicast 1990 0 mode=play\r\n" },
+		{ RTSP_RECV , RTSP_RECV_M4_RESPONSE , "RTSP/1.0 200 OK\r\nCSeq: 3\r\n" }
+	};
+	RTSP_MSG_HANDLER_FORMAT rtsp_m1_srcMsgbuffer[] =
+	{
+		{ RTSP_SEND , RTSP_SEND_M1_REQUEST , "OPTIONS * RTSP/1.0\r\nCSeq: 1\r\nServer: AllShareCast/Galaxy/Android13\r\nRequire: org.wfa.wfd1.0\r\n"},
+		{ RTSP_RECV , RTSP_RECV_M1_RESPONSE , "RTSP/1.0 200 OK\r\nPublic: \"org.wfa.wfd1.0, GET_PARAMETER, SET_PARAMETER\"\r\nCSeq: 1\r\n\r\n"}
+	};
+	int rtsp_m1_m4_srcMsgSize = static_cast<int>(sizeof(rtsp_m1_m4_srcMsgbuffer) / sizeof(rtsp_m1_m4_srcMsgbuffer[0]));
+	int rtsp_m1_srcMsgSize = static_cast<int>(sizeof(rtsp_m1_srcMsgbuffer) / sizeof(rtsp_m1_srcMsgbuffer[0]));
+	const char *play_request = "{\"device_parameters\": {\"source_dev_ip\":\"127.0.0.1\",\"source_dev_mac\": \"A1:B2:C3:D4:E5:01\",\"source_dev_name\":\"Sample-Android-Test-1\",\"sink_dev_ip\":\"192.168.59.1\"},\"video_rectangle\": {\"X\": 0,\"Y\" : 0,\"W\": 1920,\"H\": 1080}}";
+
+	rtsp_obj = MiracastRTSPMsg::getInstance(error_code);
+	ASSERT_NE(nullptr, rtsp_obj);
+	rtsp_obj->get_RTSPParamCacheCounters(before);
+
+	EXPECT_CALL(service, Submit(::testing::_, ::testing::_))
+		.Times(::testing::AnyNumber())
+		.WillRepeatedly(::testing::Invoke(
+					[&](const uint32_t, const Core::ProxyType<Core::JSON::IElement>& json) {
+					string text;
+					EXPECT_TRUE(json->ToString(text));
+					if (string::npos != text.find("\"state\":\"INITIATED\""))
+					{
+						Initiated.SetEvent();
+					}
+					else if (string::npos != text.find("\"state\":\"STOPPED\""))
+					{
+						Stopped.SetEvent();
+					}
+					return Core::ERROR_NONE;
+					}));
+
+	EVENT_SUBSCRIBE(0, _T("onStateChange"), _T("client.events"), message);
+
+	// First session of the source misses the cache, its M4 is then stored
+	EXPECT_TRUE(initialize_ServerSocket());
+	std::thread serverThread = std::thread([&]() { runRTSPSourceHandler( rtsp_m1_m4_srcMsgbuffer , rtsp_m1_m4_srcMsgSize , rtsp_response ); });
+	EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("playRequest"), play_request, response));
+
+	EXPECT_EQ(Core::ERROR_NONE, Initiated.Lock(10000));
+	rtsp_obj->get_RTSPParamCacheCounters(counters);
+	EXPECT_EQ(before.misses + 1, counters.misses);
+	EXPECT_EQ(before.hits, counters.hits);
+
+	serverThread.join();
+	EXPECT_EQ(rtsp_response, string("SUCCESS"));
+	release_SocketDescriptor();
+	EXPECT_EQ(Core::ERROR_NONE, Stopped.Lock(10000));
+
+	// Next session of the same source is seeded from the M4 cached above
+	Initiated.ResetEvent();
+	Stopped.ResetEvent();
+	EXPECT_TRUE(initialize_ServerSocket());
+	serverThread = std::thread([&]() { runRTSPSourceHandler( rtsp_m1_srcMsgbuffer , rtsp_m1_srcMsgSize , rtsp_response ); });
+	EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("playRequest"), play_request, response));
+
+	EXPECT_EQ(Core::ERROR_NONE, Initiated.Lock(10000));
+	rtsp_obj->get_RTSPParamCacheCounters(counters);
+	EXPECT_EQ(before.hits + 1, counters.hits);
+	EXPECT_EQ(before.misses + 1, counters.misses);
+
+	serverThread.join();
+	EXPECT_EQ(rtsp_response, string("SUCCESS"));
+	release_SocketDescriptor();
+	EXPECT_EQ(Core::ERROR_NONE, Stopped.Lock(10000));
+
+	EVENT_UNSUBSCRIBE(0, _T("onStateChange"), _T("client.events"), message);
+}
 #if 0
 TEST_F(MiracastPlayerEventTest, setPlayerState)
 {